@@ -171,6 +171,10 @@ void MainController::initAudioInput()
 {
     // The Engine handles audio input initialization based on settings.
     // We just need to make sure the Engine is started.
+    m_engine->setProcessingMode(m_settingsManager->dspThreadEnabled()
+                                    ? Sound2OscEngine::ProcessingMode::DedicatedThread
+                                    : Sound2OscEngine::ProcessingMode::EventLoop,
+                                m_settingsManager->dspThreadCpu());
     m_engine->start();
     
     // But we also need to handle the "No Input Device" dialog logic if needed.
@@ -203,7 +207,8 @@ void MainController::setBPM(float value)
 
 void MainController::activateBPM()
 {
-    m_engine->bpm()->resetCache();
+    BPMDetector* bpm = m_engine->bpm();
+    m_engine->runOnProcessingThread([bpm]() { bpm->resetCache(); });
     m_bpmTap.reset();
     // Engine timers are already running
 }
@@ -225,44 +230,44 @@ void MainController::setConsoleType(QString value)
 
 QList<qreal> MainController::getSpectrumPoints()
 {
-	// convert const QVector<float>& to QList<qreal> to be used in GUI:
+	// convert the spectrum of the display snapshot to QList<qreal> to be used in GUI:
 	QList<qreal> points;
-	const QVector<float>& spectrum = m_engine->fft()->getNormalizedSpectrum();
-	for (int i=0; i<spectrum.size(); ++i) {
-		points.append(spectrum[i]);
+	const std::vector<float>& spectrum = m_engine->displaySnapshot().spectrum;
+	for (const float value : spectrum) {
+		points.append(value);
 	}
 	return points;
 }
 
 QList<qreal> MainController::getWavePoints()
 {
-    // convert const QVector<float>& to QList<qreal> to be used in GUI:
+    // convert the flux history of the display snapshot to QList<qreal> to be used in GUI:
     QList<qreal> points;
-    const Qt3DCore::QCircularBuffer<float>& wave = m_engine->bpm()->getWaveDisplay();
-    for (int i = 0; i < wave.size(); ++i) {
-        points.append(wave.at(i) / 350 * m_engine->fft()->getScaledSpectrum().getGain());
+    const std::vector<float>& wave = m_engine->displaySnapshot().flux;
+    const float gain = m_engine->fft()->getScaledSpectrum().getGain();
+    for (const float value : wave) {
+        points.append(value / 350 * gain);
     }
     return points;
 }
 
 QList<bool> MainController::getWaveOnsets()
 {
-    // conert const QVector<bool>& to QList<bool> to be used in GUI:
+    // convert the onsets of the display snapshot to QList<bool> to be used in GUI:
     QList<bool> points;
-    const QVector<bool>& peaks = m_engine->bpm()->getOnsets();
-    for (int i = 0; i < peaks.size(); ++i) {
-        points.append(peaks[i]);
+    const std::vector<bool>& peaks = m_engine->displaySnapshot().onsets;
+    for (const bool peak : peaks) {
+        points.append(peak);
     }
     return points;
 }
 
 QList<QString> MainController::getWaveColors()
 {
-    // convert const Qt3DCore::QCircularBuffer<SpectrumColor>& to QList<QString> to be used in GUI:
+    // convert the colors of the display snapshot to QList<QString> to be used in GUI:
     QList<QString> points;
-    const auto& colors = m_engine->bpm()->getWaveColors();
-    for (int i = 0; i < colors.size(); ++i) {
-        const auto& c = colors.at(i);
+    const std::vector<SpectrumColor>& colors = m_engine->displaySnapshot().colors;
+    for (const SpectrumColor& c : colors) {
         points.append(QColor(c.r, c.g, c.b).name());
     }
     return points;
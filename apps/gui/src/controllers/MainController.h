@@ -357,6 +357,9 @@ private slots:
 	void onConnectedChanged();
 
 public:  // to allow access from OSCMapping class without getters
+	// returns the user defined bands of the engine
+	sound2osc::TriggerBank* getTriggerBank() { return m_engine->triggerBank(); }
+
 	std::unique_ptr<TriggerGuiController> m_bassController;  // GUI Controller for Bass TriggerGenerator
 	std::unique_ptr<TriggerGuiController> m_loMidController;  // GUI Controller for LoMid TriggerGenerator
 	std::unique_ptr<TriggerGuiController> m_hiMidController;  // GUI Controller for HiMid TriggerGenerator
@@ -108,6 +108,14 @@ public slots:
 	QString getLevelMessage() const { return m_trigger->getOscParameters().getLevelMessage(); }
 	void setLevelMessage(const QString& value) {m_trigger->getOscParameters().setLevelMessage(value); emit presetChanged(); }
 
+	// type of the level value as a name: "rounded" (float with 3 decimals), "float" or "int"
+	QString getLevelType() const { return sound2osc::OSCPacketTemplate::valueTypeName(m_trigger->getOscParameters().getLevelValueType()); }
+	void setLevelType(const QString& value) { m_trigger->getOscParameters().setLevelValueType(sound2osc::OSCPacketTemplate::valueTypeFromName(value)); emit presetChanged(); }
+
+	// destinations of the messages as a bit mask (bit n = destination n, 1 = primary destination)
+	qint64 getRoutes() const { return m_trigger->getOscParameters().getRoutes(); }
+	void setRoutes(qint64 value) { m_trigger->getOscParameters().setRoutes(static_cast<sound2osc::OSCRoutes::Mask>(value)); emit presetChanged(); }
+
 	qreal getMinLevelValue() const { return m_trigger->getOscParameters().getMinLevelValue(); }
 	void setMinLevelValue(const qreal& value) { m_trigger->getOscParameters().setMinLevelValue(value); emit presetChanged(); }
 
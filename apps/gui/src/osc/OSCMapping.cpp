@@ -98,6 +98,11 @@ void OSCMapping::handleMessage(OSCMessage msg)
         m_controller->m_envelopeController->toggleMute();
     } else if (msg.pathStartsWith("/sound2osc/silence/mute")) {
         m_controller->m_silenceController->toggleMute();
+    } else if (msg.pathStartsWith("/sound2osc/band/")) {
+        // add, remove and change user defined bands:
+        if (m_controller->getTriggerBank()->handleMessage(msg)) {
+            m_controller->onPresetChanged();
+        }
     }
 }
 
@@ -94,12 +94,46 @@ int main(int argc, char *argv[])
     );
     parser.addOption(inputDeviceOption);
 
+    QCommandLineOption sampleRateOption(
+        "sample-rate",
+        "Sample rate to request from the input device in Hz (default: native rate)",
+        "hz"
+    );
+    parser.addOption(sampleRateOption);
+
+    QCommandLineOption fftSizeOption(
+        "fft-size",
+        "Number of samples of one FFT: 1024, 2048, 4096 or 8192 (default: 4096)",
+        "samples"
+    );
+    parser.addOption(fftSizeOption);
+
+    QCommandLineOption fftHopOption(
+        "fft-hop",
+        "Samples between two FFT/trigger runs, sets the overlap (default: sample rate / 44)",
+        "samples"
+    );
+    parser.addOption(fftHopOption);
+
     QCommandLineOption verboseOption(
         "verbose",
         "Enable verbose output (debug logging)"
     );
     parser.addOption(verboseOption);
 
+    QCommandLineOption dspThreadOption(
+        "dsp-thread",
+        "Run FFT, triggers and BPM detection on a dedicated processing thread"
+    );
+    parser.addOption(dspThreadOption);
+
+    QCommandLineOption dspCpuOption(
+        "dsp-cpu",
+        "Pin the processing thread to the given CPU core (implies --dsp-thread)",
+        "core"
+    );
+    parser.addOption(dspCpuOption);
+
     QCommandLineOption listDevicesOption(
         "list-devices",
         "List available audio input devices and exit"
@@ -168,11 +202,62 @@ int main(int argc, char *argv[])
     if (parser.isSet(inputDeviceOption)) {
         settings->setInputDeviceName(parser.value(inputDeviceOption));
     }
+    if (parser.isSet(sampleRateOption)) {
+        bool ok;
+        int sampleRate = parser.value(sampleRateOption).toInt(&ok);
+        if (ok && sampleRate >= 0) {
+            settings->setInputSampleRate(sampleRate);
+        } else {
+            Logger::warning("Invalid sample rate: %1", parser.value(sampleRateOption));
+        }
+    }
+
+    if (parser.isSet(fftSizeOption)) {
+        bool ok;
+        int fftSize = parser.value(fftSizeOption).toInt(&ok);
+        if (ok && fftSize >= 1024 && fftSize <= 8192 && (fftSize & (fftSize - 1)) == 0) {
+            settings->setFftSize(fftSize);
+        } else {
+            Logger::warning("Invalid FFT size: %1", parser.value(fftSizeOption));
+        }
+    }
+    if (parser.isSet(fftHopOption)) {
+        bool ok;
+        int fftHop = parser.value(fftHopOption).toInt(&ok);
+        if (ok && fftHop >= 0) {
+            settings->setFftHopSize(fftHop);
+        } else {
+            Logger::warning("Invalid FFT hop: %1", parser.value(fftHopOption));
+        }
+    }
+
+    if (parser.isSet(dspThreadOption)) {
+        settings->setDspThreadEnabled(true);
+    }
+    if (parser.isSet(dspCpuOption)) {
+        bool ok;
+        int cpu = parser.value(dspCpuOption).toInt(&ok);
+        if (ok && cpu >= 0) {
+            settings->setDspThreadEnabled(true);
+            settings->setDspThreadCpu(cpu);
+        } else {
+            Logger::warning("Invalid CPU core: %1", parser.value(dspCpuOption));
+        }
+    }
+    engine.setProcessingMode(settings->dspThreadEnabled()
+                                 ? Sound2OscEngine::ProcessingMode::DedicatedThread
+                                 : Sound2OscEngine::ProcessingMode::EventLoop,
+                             settings->dspThreadCpu());
+
+    // User defined bands are added and changed with /sound2osc/band/... messages:
+    QObject::connect(engine.osc(), &OSCNetworkManager::messageReceived, [&engine](OSCMessage msg) {
+        engine.triggerBank()->handleMessage(msg);
+    });
 
     // Start the engine
     engine.start();
 
-    Logger::info("Active audio input: %1", engine.audioInput()->getActiveInputName());
+    Logger::info("Active audio input: %1 (%2 Hz)", engine.audioInput()->getActiveInputName(), engine.audioInput()->getSampleRate());
     Logger::info("OSC output: %1:%2", settings->oscIpAddress(), settings->oscUdpTxPort());
     Logger::info("Headless mode running. Press Ctrl+C to stop.");
 
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Speed of the FFT backends at the sizes used by the analysis
+
+#include "BenchUtils.h"
+
+#include <sound2osc/dsp/FFTBackend.h>
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sound2osc;
+
+int main()
+{
+    bench::printHeader("Real FFT (samples = transform size)");
+
+    for (int size : { 2048, 4096, 8192 }) {
+        std::vector<float> input(static_cast<std::size_t>(size));
+        std::vector<float> output(static_cast<std::size_t>(size));
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        for (float& value : input) value = distribution(rng);
+
+        for (const std::string& name : FFTBackend::available()) {
+            std::unique_ptr<BasicFFTInterface> fft = FFTBackend::create(name, size);
+            if (!fft) continue;
+            const double ns = bench::measureNs([&]() {
+                fft->doFft(output.data(), input.data());
+                bench::doNotOptimize(output[1]);
+            }, 200);
+            const std::string label = std::to_string(size) + " " + name;
+            bench::printResult(label.c_str(), ns, size);
+        }
+        std::printf("%-40s %s\n", (std::to_string(size) + " auto selects").c_str(),
+                    FFTBackend::fastest(size).c_str());
+    }
+    return 0;
+}
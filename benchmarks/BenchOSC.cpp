@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Cost of building the OSC packets of trigger messages compared to the
+// previous text based path
+
+#include "BenchUtils.h"
+
+#include <sound2osc/osc/OSCPacketTemplate.h>
+#include <sound2osc/osc/OSCParser.h>
+
+#include <QByteArray>
+#include <QString>
+
+#include <string>
+
+using namespace sound2osc;
+
+namespace {
+
+// The previous path of a level message: TriggerGenerator formatted the value,
+// OSCNetworkManager::sendMessage(QString) replaced the user and parsed the text.
+std::size_t legacyLevelPacket(const QString& levelMessage, const QString& user, double value)
+{
+    QString messageString = levelMessage + QString::number(value, 'f', 3);
+    messageString.replace("<USER>", user);
+    size_t outSize = 0;
+    char* packet = OSCPacketWriter::CreateForString(messageString.toLatin1().data(), outSize);
+    bench::doNotOptimize(packet);
+    delete[] packet;
+    return outSize;
+}
+
+} // namespace
+
+int main()
+{
+    const int iterations = 20000;
+    const QString user = "1";
+
+    bench::printHeader("Level message packet (1 message per call)");
+
+    for (const char* message : { "/eos/user/<USER>/sub/1=", "/sound2osc/out/band/bass/level=" }) {
+        const QString levelMessage = message;
+        const OSCPacketTemplate packetTemplate(levelMessage);
+        double value = 0.0;
+
+        const double legacy = bench::measureNs([&] {
+            value = value < 1.0 ? value + 0.001 : 0.0;
+            bench::doNotOptimize(legacyLevelPacket(levelMessage, user, value));
+        }, iterations);
+
+        const double encoded = bench::measureNs([&] {
+            value = value < 1.0 ? value + 0.001 : 0.0;
+            const QByteArray packet = packetTemplate.create(user, value);
+            bench::doNotOptimize(packet);
+        }, iterations);
+
+        const std::string label = message;
+        bench::printResult((label + " text").c_str(), legacy, 1);
+        bench::printResult((label + " template").c_str(), encoded, 1);
+    }
+
+    return 0;
+}
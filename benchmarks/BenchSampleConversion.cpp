@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Throughput of the PCM conversion and mono downmix compared to the
+// previous per-sample implementation
+
+#include "BenchUtils.h"
+
+#include <sound2osc/audio/SampleConversion.h>
+
+#include <QByteArray>
+#include <QVector>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sound2osc;
+
+namespace {
+
+enum class Format { Int16, Int32, UInt8, Float };
+
+const char* formatName(Format format)
+{
+    switch (format) {
+    case Format::Int16: return "int16";
+    case Format::Int32: return "int32";
+    case Format::UInt8: return "uint8";
+    case Format::Float: return "float";
+    }
+    return "";
+}
+
+int bytesPerSample(Format format)
+{
+    switch (format) {
+    case Format::Int16: return 2;
+    case Format::Int32: return 4;
+    case Format::UInt8: return 1;
+    case Format::Float: return 4;
+    }
+    return 0;
+}
+
+// The previous ingestion path: per-sample format switch into a new QVector<qreal>
+// (QAudioInputWrapper::audioDataReady) followed by the in-place downmix
+// (MonoAudioBuffer::convertToMonoInplace).
+void legacyConvert(const QByteArray& data, Format format, int channelCount, QVector<qreal>& result)
+{
+    const int sampleSize = bytesPerSample(format);
+    const qsizetype numSamples = data.size() / sampleSize;
+    QVector<qreal> realData(numSamples);
+    const char* ptr = data.constData();
+
+    for (qsizetype i = 0; i < numSamples; ++i) {
+        qreal scaled = 0.0;
+        switch (format) {
+        case Format::Int16:
+            {
+                qint16 pcmSample;
+                std::memcpy(&pcmSample, ptr, sizeof(pcmSample));
+                scaled = static_cast<qreal>(pcmSample) / 32768.0;
+            }
+            break;
+        case Format::Int32:
+            {
+                qint32 pcmSample;
+                std::memcpy(&pcmSample, ptr, sizeof(pcmSample));
+                scaled = static_cast<qreal>(pcmSample) / 2147483648.0;
+            }
+            break;
+        case Format::Float:
+            {
+                float pcmSample;
+                std::memcpy(&pcmSample, ptr, sizeof(pcmSample));
+                scaled = static_cast<qreal>(pcmSample);
+            }
+            break;
+        case Format::UInt8:
+            {
+                const quint8 pcmSample = static_cast<quint8>(*ptr);
+                scaled = (static_cast<qreal>(pcmSample) - 128.0) / 128.0;
+            }
+            break;
+        }
+        realData[i] = scaled;
+        ptr += sampleSize;
+    }
+
+    switch (channelCount) {
+    case 1:
+        break;
+    case 2:
+        for (qsizetype i = 0; i < realData.size(); i += 2) {
+            realData[i / 2] = (realData[i] + realData[i + 1]) / 2.0;
+        }
+        realData.resize(realData.size() / 2);
+        break;
+    default:
+        for (qsizetype i = 0; i < realData.size(); i += channelCount) {
+            qreal mono = 0.0;
+            for (int ch = 0; ch < channelCount; ++ch) {
+                mono += realData[i + ch];
+            }
+            mono /= channelCount;
+            realData[i / channelCount] = mono;
+        }
+        realData.resize(realData.size() / channelCount);
+        break;
+    }
+    result = realData;
+}
+
+void convert(const QByteArray& data, Format format, int frameCount, int channelCount, float* output)
+{
+    const char* raw = data.constData();
+    switch (format) {
+    case Format::Int16:
+        SampleConversion::interleavedToMono(reinterpret_cast<const int16_t*>(raw), frameCount, channelCount, output);
+        break;
+    case Format::Int32:
+        SampleConversion::interleavedToMono(reinterpret_cast<const int32_t*>(raw), frameCount, channelCount, output);
+        break;
+    case Format::UInt8:
+        SampleConversion::interleavedToMono(reinterpret_cast<const uint8_t*>(raw), frameCount, channelCount, output);
+        break;
+    case Format::Float:
+        SampleConversion::interleavedToMono(reinterpret_cast<const float*>(raw), frameCount, channelCount, output);
+        break;
+    }
+}
+
+QByteArray randomPcm(Format format, int sampleCount)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-0.9f, 0.9f);
+    QByteArray data(static_cast<qsizetype>(sampleCount) * bytesPerSample(format), Qt::Uninitialized);
+    for (int i = 0; i < sampleCount; ++i) {
+        const float value = distribution(rng);
+        char* dest = data.data() + static_cast<qsizetype>(i) * bytesPerSample(format);
+        switch (format) {
+        case Format::Int16: { const auto v = static_cast<int16_t>(value * 32767.0f); std::memcpy(dest, &v, sizeof(v)); break; }
+        case Format::Int32: { const auto v = static_cast<int32_t>(static_cast<double>(value) * 2147483647.0); std::memcpy(dest, &v, sizeof(v)); break; }
+        case Format::UInt8: { const auto v = static_cast<uint8_t>(128.0f + value * 127.0f); std::memcpy(dest, &v, sizeof(v)); break; }
+        case Format::Float: std::memcpy(dest, &value, sizeof(value)); break;
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+int main()
+{
+    // one audio callback worth of frames
+    const int frameCount = 512;
+    const int iterations = 2000;
+
+    bench::printHeader("Interleaved PCM to mono (512 frames per call)");
+
+    for (int channelCount : {2, 8}) {
+        for (Format format : {Format::Int16, Format::Int32, Format::UInt8, Format::Float}) {
+            const QByteArray data = randomPcm(format, frameCount * channelCount);
+            std::vector<float> output(static_cast<std::size_t>(frameCount));
+            QVector<qreal> legacyOutput;
+            const std::string label = std::string(formatName(format)) + " x" + std::to_string(channelCount);
+
+            const double legacy = bench::measureNs([&] {
+                legacyConvert(data, format, channelCount, legacyOutput);
+                bench::doNotOptimize(legacyOutput);
+            }, iterations);
+
+            SampleConversion::setSimdEnabled(false);
+            const double scalar = bench::measureNs([&] {
+                convert(data, format, frameCount, channelCount, output.data());
+                bench::doNotOptimize(output);
+            }, iterations);
+
+            SampleConversion::setSimdEnabled(true);
+            const double simd = bench::measureNs([&] {
+                convert(data, format, frameCount, channelCount, output.data());
+                bench::doNotOptimize(output);
+            }, iterations);
+
+            const double samples = frameCount * channelCount;
+            bench::printResult((label + " legacy").c_str(), legacy, samples);
+            bench::printResult((label + " scalar").c_str(), scalar, samples);
+            bench::printResult((label + " " + SampleConversion::kernelName()).c_str(), simd, samples);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Per-frame cost of scaling the linear FFT spectrum to the logarithmic
+// spectrum, of the band max queries and of the trigger evaluation compared
+// to the previous implementation
+
+#include "BenchUtils.h"
+
+#include <sound2osc/dsp/ScaledSpectrum.h>
+#include <sound2osc/dsp/FFTAnalyzer.h>
+#include <sound2osc/trigger/TriggerBatch.h>
+
+#include <QVector>
+#include <QtMath>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The previous ScaledSpectrum::updateWithLinearSpectrum(): band edges, dB
+// conversion and compression are calculated with qPow/qLn for every band
+// of every frame (without the AGC, which is unchanged).
+float legacyUpdate(const QVector<float>& linearSpectrum, int sampleRate, float gain, float compression,
+                   bool convertToDecibel, QVector<float>& normSpectrum)
+{
+    const int baseFreq = SCALED_SPECTRUM_BASE_FREQ;
+    const int scaledLength = SCALED_SPECTRUM_LENGTH;
+    const qreal freqScaleFactor = qPow(SCALED_SPECTRUM_MAX_FREQ / baseFreq, 1. / scaledLength);
+    const int linearLength = static_cast<int>(linearSpectrum.size());
+    double freq = baseFreq;
+    float maxValue = 0;
+    const float exponent = 1 / compression;
+    const double binsPerHz = linearLength / (sampleRate / 2.0);
+
+    for (int i = 0; i < scaledLength; ++i) {
+        double nextFreq = baseFreq * qPow(freqScaleFactor, i + 1);
+        const std::size_t startIndex = static_cast<std::size_t>(qMin(freq * binsPerHz, double(linearLength)));
+        const std::size_t endIndex = static_cast<std::size_t>(qMin(nextFreq * binsPerHz, double(linearLength)));
+        const std::size_t valuesTillNext = endIndex - startIndex;
+        freq = nextFreq;
+
+        float energy = startIndex < std::size_t(linearLength) ? linearSpectrum[static_cast<int>(startIndex)] : 0.0f;
+        for (std::size_t j = 1; j < valuesTillNext; ++j) {
+            energy += linearSpectrum[static_cast<int>(startIndex + j)];
+        }
+
+        if (convertToDecibel) {
+            float dB = 20.0f * static_cast<float>(qLn(static_cast<double>(energy)) / qLn(10.0));
+            float valueBeforeGain = (dB + 60.0f) / 60.0f;
+            maxValue = qMax(maxValue, valueBeforeGain);
+            normSpectrum[i] = qPow(qMax(0.0f, qMin(valueBeforeGain * gain, 1.0f)), exponent);
+        } else {
+            maxValue = qMax(maxValue, energy);
+            energy *= gain;
+            normSpectrum[i] = qPow(qMax(0.0f, qMin(energy, 1.0f)), exponent);
+        }
+    }
+    return maxValue;
+}
+
+// The previous ScaledSpectrum::getMaxLevel(midFreq, width): index calculation
+// with qLn and a linear scan of the band for every query.
+float legacyMaxLevel(const QVector<float>& normSpectrum, int midFreq, qreal width)
+{
+    const int scaledLength = SCALED_SPECTRUM_LENGTH;
+    const qreal logOfFreqScaleFactor = qLn(SCALED_SPECTRUM_MAX_FREQ / SCALED_SPECTRUM_BASE_FREQ) / scaledLength;
+    const int midIndex = static_cast<int>(qLn(midFreq / qreal(SCALED_SPECTRUM_BASE_FREQ)) / logOfFreqScaleFactor);
+    const int startIndex = qMax(0, qMin(int(midIndex - scaledLength * width / 2), scaledLength - 1));
+    int endIndex = qMax(0, qMin(int(midIndex + scaledLength * width / 2), scaledLength - 1));
+    if (endIndex == startIndex) endIndex = qMin(endIndex + 1, scaledLength - 1);
+    float max = 0.0f;
+    for (int i = startIndex; i <= endIndex; ++i) {
+        max = qMax(normSpectrum[i], max);
+    }
+    return max;
+}
+
+// The previous trigger evaluation: one virtual checkForTrigger() call per
+// trigger that reads its own parameters and compares the level on its own
+// (without the TriggerFilter and OSC output, which only run on changes).
+class LegacyTrigger
+{
+public:
+    virtual ~LegacyTrigger() = default;
+    virtual bool checkForTrigger(const ScaledSpectrum& spectrum, bool forceRelease) = 0;
+};
+
+class LegacyBandpass : public LegacyTrigger
+{
+public:
+    explicit LegacyBandpass(int midFreq) : m_midFreq(midFreq) {}
+
+    bool checkForTrigger(const ScaledSpectrum& spectrum, bool forceRelease) override
+    {
+        // the index range of the band only changes with its parameters:
+        const int midFreq = m_midFreq;
+        const qreal width = m_width;
+        if (midFreq != m_rangeMidFreq || width != m_rangeWidth) {
+            spectrum.getBandRange(midFreq, width, m_rangeStart, m_rangeEnd);
+            m_rangeMidFreq = midFreq;
+            m_rangeWidth = width;
+        }
+        const qreal value = static_cast<qreal>(spectrum.getMaxLevel(m_rangeStart, m_rangeEnd));
+        if (!m_isActive && value >= m_threshold && !forceRelease) {
+            m_isActive = true;
+        } else if ((m_isActive && value < m_threshold) || forceRelease) {
+            m_isActive = false;
+        }
+        m_changes += qAbs(m_lastValue - value) > 0.001 ? 1 : 0;
+        m_lastValue = value;
+        return m_isActive;
+    }
+
+private:
+    std::atomic<int> m_midFreq;
+    std::atomic<qreal> m_width{0.1};
+    std::atomic<qreal> m_threshold{0.5};
+    bool m_isActive = false;
+    qreal m_lastValue = 0;
+    int m_rangeMidFreq = -1;
+    qreal m_rangeWidth = -1;
+    int m_rangeStart = 0;
+    int m_rangeEnd = 0;
+    int m_changes = 0;
+};
+
+} // namespace
+
+int main()
+{
+    bench::printHeader("Linear to scaled spectrum (one frame, samples = bands)");
+
+    const int sampleRate = 44100;
+    for (int fftSize : { 4096, 8192 }) {
+        QVector<float> linear(fftSize / 2);
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> distribution(0.0f, 0.05f);
+        for (float& value : linear) value = distribution(rng);
+
+        for (bool decibel : { false, true }) {
+            for (float compression : { 1.0f, 2.0f }) {
+                QVector<float> legacyOutput(SCALED_SPECTRUM_LENGTH);
+                const double legacy = bench::measureNs([&]() {
+                    bench::doNotOptimize(legacyUpdate(linear, sampleRate, 1.0f, compression, decibel, legacyOutput));
+                }, 2000);
+
+                ScaledSpectrum spectrum(SCALED_SPECTRUM_BASE_FREQ, SCALED_SPECTRUM_LENGTH);
+                spectrum.setSampleRate(sampleRate);
+                spectrum.setAgcEnabled(false);
+                spectrum.setCompression(compression);
+                spectrum.setDecibelConversion(decibel);
+                const double current = bench::measureNs([&]() {
+                    spectrum.updateWithLinearSpectrum(linear);
+                    bench::doNotOptimize(spectrum.getNormalizedSpectrum()[0]);
+                }, 2000);
+
+                const std::string label = "fft " + std::to_string(fftSize) + (decibel ? " dB" : " linear")
+                                          + " comp " + std::to_string(static_cast<int>(compression));
+                bench::printResult((label + " legacy").c_str(), legacy, SCALED_SPECTRUM_LENGTH);
+                bench::printResult((label + " bin map").c_str(), current, SCALED_SPECTRUM_LENGTH);
+            }
+        }
+    }
+
+    bench::printHeader("Band max queries (one frame, samples = bands)");
+
+    ScaledSpectrum spectrum(SCALED_SPECTRUM_BASE_FREQ, SCALED_SPECTRUM_LENGTH);
+    spectrum.setAgcEnabled(false);
+    QVector<float> linear(NUM_SAMPLES / 2);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> distribution(0.0f, 0.05f);
+    for (float& value : linear) value = distribution(rng);
+    spectrum.updateWithLinearSpectrum(linear);
+    const QVector<float>& norm = spectrum.getNormalizedSpectrum();
+
+    for (int bands : { 6, 48 }) {
+        // bands spread logarithmically over the spectrum with a width of 10%:
+        QVector<int> midFreqs(bands);
+        QVector<int> startIndexes(bands);
+        QVector<int> endIndexes(bands);
+        for (int i = 0; i < bands; ++i) {
+            midFreqs[i] = static_cast<int>(SCALED_SPECTRUM_BASE_FREQ
+                                           * qPow(SCALED_SPECTRUM_MAX_FREQ / SCALED_SPECTRUM_BASE_FREQ, (i + 0.5) / bands));
+            spectrum.getBandRange(midFreqs[i], 0.1, startIndexes[i], endIndexes[i]);
+        }
+
+        const double legacy = bench::measureNs([&]() {
+            float sum = 0.0f;
+            for (int i = 0; i < bands; ++i) sum += legacyMaxLevel(norm, midFreqs[i], 0.1);
+            bench::doNotOptimize(sum);
+        }, 20000);
+        const double current = bench::measureNs([&]() {
+            float sum = 0.0f;
+            for (int i = 0; i < bands; ++i) sum += spectrum.getMaxLevel(startIndexes[i], endIndexes[i]);
+            bench::doNotOptimize(sum);
+        }, 20000);
+
+        const std::string label = std::to_string(bands) + " bands";
+        bench::printResult((label + " legacy scan").c_str(), legacy, bands);
+        bench::printResult((label + " sparse table").c_str(), current, bands);
+    }
+
+    bench::printHeader("Trigger evaluation (one frame, samples = triggers)");
+
+    for (int triggers : { 6, 64 }) {
+        std::vector<std::unique_ptr<LegacyTrigger>> legacyTriggers;
+        sound2osc::TriggerBatch batch;
+        for (int i = 0; i < triggers; ++i) {
+            const int midFreq = static_cast<int>(SCALED_SPECTRUM_BASE_FREQ
+                                                 * qPow(SCALED_SPECTRUM_MAX_FREQ / SCALED_SPECTRUM_BASE_FREQ, (i + 0.5) / triggers));
+            sound2osc::TriggerParameters parameters;
+            spectrum.getBandRange(midFreq, 0.1, parameters.startIndex, parameters.endIndex);
+            parameters.lowSolo = true;
+            parameters.soloOrder = i;
+            batch.add(parameters);
+            legacyTriggers.push_back(std::make_unique<LegacyBandpass>(midFreq));
+        }
+
+        const double legacy = bench::measureNs([&]() {
+            bool triggered = false;
+            for (const auto& trigger : legacyTriggers) {
+                triggered = trigger->checkForTrigger(spectrum, triggered) || triggered;
+            }
+            bench::doNotOptimize(triggered);
+        }, 20000);
+        const double current = bench::measureNs([&]() {
+            batch.evaluate(spectrum, true);
+            bench::doNotOptimize(batch.events().size());
+        }, 20000);
+
+        const std::string label = std::to_string(triggers) + " triggers";
+        bench::printResult((label + " virtual").c_str(), legacy, triggers);
+        bench::printResult((label + " batch").c_str(), current, triggers);
+    }
+    return 0;
+}
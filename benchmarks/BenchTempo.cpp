@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Accuracy and CPU time of the tempo estimators of the BPM detection
+// (beat strings and autocorrelation) on a corpus of synthetic click tracks
+
+#include "BenchUtils.h"
+
+#include <sound2osc/audio/MonoAudioBuffer.h>
+#include <sound2osc/bpm/BPMDetector.h>
+#include <sound2osc/bpm/BPMOscControler.h>
+#include <sound2osc/osc/OSCNetworkManager.h>
+
+#include <QCoreApplication>
+#include <QVector>
+#include <QtMath>
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 44100;
+constexpr int SECONDS = 20;
+constexpr int CHUNK_SIZE = SAMPLE_RATE / 44;  // one detection run per analysis frame of the engine
+
+const float TEMPOS[] = { 70.0f, 90.0f, 100.0f, 120.0f, 128.0f, 140.0f, 160.0f, 174.0f };
+
+enum class Pattern {
+    Kick,  // kick on every beat
+    HiHat,  // kick on every beat, hi-hat on the eighths
+    Dense,  // kick, snare on 2 and 4, hi-hat on the sixteenths
+    Jitter  // kick and hi-hat with +-10 ms of random timing
+};
+
+const char* patternName(Pattern pattern)
+{
+    switch (pattern) {
+    case Pattern::Kick: return "kick";
+    case Pattern::HiHat: return "kick + hi-hat 8th";
+    case Pattern::Dense: return "kick/snare + hi-hat 16th";
+    case Pattern::Jitter: return "kick + hi-hat, jitter";
+    }
+    return "";
+}
+
+void addKick(std::vector<float>& audio, int start)
+{
+    const int length = 2000;
+    for (int i = 0; i < length && start + i < static_cast<int>(audio.size()); ++i) {
+        const float t = static_cast<float>(i) / SAMPLE_RATE;
+        const float envelope = 1.0f - static_cast<float>(i) / length;
+        audio[static_cast<std::size_t>(start + i)] += static_cast<float>(qSin(2.0 * M_PI * 100.0 * t)) * envelope;
+    }
+}
+
+void addNoiseBurst(std::vector<float>& audio, int start, int length, float level, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    float last = 0.0f;
+    for (int i = 0; i < length && start + i < static_cast<int>(audio.size()); ++i) {
+        const float envelope = 1.0f - static_cast<float>(i) / static_cast<float>(length);
+        const float value = noise(random);
+        // first difference as a simple high pass:
+        audio[static_cast<std::size_t>(start + i)] += (value - last) * 0.5f * level * envelope;
+        last = value;
+    }
+}
+
+std::vector<float> synthesize(float bpm, Pattern pattern, std::mt19937& random)
+{
+    std::vector<float> audio(static_cast<std::size_t>(SAMPLE_RATE * SECONDS), 0.0f);
+    std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+    for (float& sample : audio) {
+        sample = noise(random);
+    }
+
+    std::uniform_real_distribution<double> jitter(-0.01, 0.01);
+    const double beat = 60.0 / bpm;  // seconds
+    for (int n = 0; n * beat < SECONDS; ++n) {
+        const double time = n * beat + (pattern == Pattern::Jitter ? jitter(random) : 0.0);
+        const int start = qMax(0, static_cast<int>(time * SAMPLE_RATE));
+        addKick(audio, start);
+        if (pattern == Pattern::Dense && n % 2 == 1) {
+            addNoiseBurst(audio, start, 3000, 0.6f, random);
+        }
+        if (pattern == Pattern::HiHat || pattern == Pattern::Jitter) {
+            const double offbeat = time + beat / 2 + (pattern == Pattern::Jitter ? jitter(random) : 0.0);
+            addNoiseBurst(audio, qMax(0, static_cast<int>(offbeat * SAMPLE_RATE)), 600, 0.3f, random);
+        }
+        if (pattern == Pattern::Dense) {
+            for (int sixteenth = 0; sixteenth < 4; ++sixteenth) {
+                addNoiseBurst(audio, static_cast<int>((time + sixteenth * beat / 4) * SAMPLE_RATE), 600, 0.3f, random);
+            }
+        }
+    }
+    return audio;
+}
+
+struct Result
+{
+    int cases = 0;
+    int exact = 0;  // within 3% of the tempo
+    int octave = 0;  // within 3% of the tempo, half or double
+    double totalNs = 0.0;  // all detectBPM() calls
+    double maxNs = 0.0;  // slowest detectBPM() call
+    uint64_t calls = 0;
+};
+
+void run(OSCNetworkManager& osc, BPMDetector::TempoEstimator estimator, const std::vector<float>& audio,
+         float bpm, Result& result)
+{
+    BPMOscControler bpmOsc(osc);
+    MonoAudioBuffer buffer(4096);
+    buffer.setSampleRate(SAMPLE_RATE);
+    BPMDetector detector(buffer, &bpmOsc);
+    detector.setMinBPM(0);  // only fold outside of 50 ... 299 BPM
+    detector.setTempoEstimator(estimator);
+
+    QVector<float> chunk(CHUNK_SIZE);
+    for (std::size_t position = 0; position + CHUNK_SIZE <= audio.size(); position += CHUNK_SIZE) {
+        std::copy(audio.begin() + static_cast<std::ptrdiff_t>(position),
+                  audio.begin() + static_cast<std::ptrdiff_t>(position + CHUNK_SIZE), chunk.begin());
+        buffer.putSamples(chunk, 1);
+
+        const auto start = std::chrono::steady_clock::now();
+        detector.detectBPM();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.totalNs += ns;
+        result.maxNs = std::max(result.maxNs, ns);
+        ++result.calls;
+    }
+
+    const float detected = detector.getBPM();
+    const auto near = [detected](float expected) { return qAbs(detected - expected) < 0.03f * expected; };
+    ++result.cases;
+    if (near(bpm)) ++result.exact;
+    if (near(bpm) || near(bpm * 2.0f) || near(bpm / 2.0f)) ++result.octave;
+}
+
+void printResult(Pattern pattern, const char* estimator, const Result& result)
+{
+    std::printf("%-26s %-16s %5d/%-3d %5d/%-3d %12.1f %12.1f\n", patternName(pattern), estimator,
+                result.exact, result.cases, result.octave, result.cases,
+                result.totalNs / static_cast<double>(result.calls) / 1000.0, result.maxNs / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    OSCNetworkManager osc;
+
+    std::printf("\nTempo estimation of %d s click tracks at %d tempos (%d - %d BPM), detectBPM() every %d samples\n",
+                SECONDS, static_cast<int>(std::size(TEMPOS)), static_cast<int>(TEMPOS[0]),
+                static_cast<int>(TEMPOS[std::size(TEMPOS) - 1]), CHUNK_SIZE);
+    std::printf("%-26s %-16s %9s %9s %12s %12s\n", "pattern", "estimator", "correct", "octave", "mean us", "max us");
+
+    std::mt19937 random(42);
+    for (Pattern pattern : { Pattern::Kick, Pattern::HiHat, Pattern::Dense, Pattern::Jitter }) {
+        Result strings;
+        Result autocorrelation;
+        for (float bpm : TEMPOS) {
+            const std::vector<float> audio = synthesize(bpm, pattern, random);
+            run(osc, BPMDetector::TempoEstimator::BeatStrings, audio, bpm, strings);
+            run(osc, BPMDetector::TempoEstimator::Autocorrelation, audio, bpm, autocorrelation);
+        }
+        printResult(pattern, "strings", strings);
+        printResult(pattern, "autocorrelation", autocorrelation);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// System calls and CPU time of sending the trigger messages of a frame with
+// one QUdpSocket::writeDatagram() per message compared to one sendmmsg() call
+
+#include "BenchUtils.h"
+
+#include <sound2osc/osc/OSCPacketTemplate.h>
+#include <sound2osc/osc/UdpBatchSender.h>
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QUdpSocket>
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+using namespace sound2osc;
+
+namespace {
+
+constexpr int MESSAGES_PER_SECOND = 10000;
+constexpr int FRAMES_PER_SECOND = 44;  // analysis rate of the engine
+constexpr int MESSAGES_PER_FRAME = MESSAGES_PER_SECOND / FRAMES_PER_SECOND;
+constexpr int SECONDS = 10;
+
+struct Result
+{
+    double cpuSeconds = 0.0;  // CPU time spent in the send calls
+    uint64_t systemCalls = 0;
+    uint64_t received = 0;
+};
+
+int drain(QUdpSocket& receiver)
+{
+    char buffer[2048];
+    int count = 0;
+    while (receiver.hasPendingDatagrams()) {
+        if (receiver.readDatagram(buffer, sizeof(buffer)) >= 0) ++count;
+    }
+    return count;
+}
+
+// sends SECONDS worth of frames, sendFrame returns the number of system calls it made
+template<typename SendFrame>
+Result run(QUdpSocket& receiver, const std::vector<QByteArray>& frame, SendFrame&& sendFrame)
+{
+    Result result;
+    for (int i = 0; i < SECONDS * FRAMES_PER_SECOND; ++i) {
+        const std::clock_t start = std::clock();
+        result.systemCalls += sendFrame(frame);
+        result.cpuSeconds += static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        // not measured, keeps the receive buffer from overflowing:
+        result.received += static_cast<uint64_t>(drain(receiver));
+    }
+    result.received += static_cast<uint64_t>(drain(receiver));
+    return result;
+}
+
+void printResult(const char* name, const Result& result)
+{
+    const double totalMessages = double(MESSAGES_PER_SECOND) * SECONDS;
+    std::printf("%-28s %12.0f %12.2f %12.1f %10.1f%%\n", name,
+                static_cast<double>(result.systemCalls) / SECONDS,
+                result.cpuSeconds * 1000.0 / SECONDS,
+                result.cpuSeconds * 1e9 / totalMessages,
+                static_cast<double>(result.received) * 100.0 / totalMessages);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QUdpSocket receiver;
+    QUdpSocket sender;
+    if (!receiver.bind(QHostAddress::LocalHost, 0) || !sender.bind(QHostAddress::LocalHost, 0)) {
+        std::printf("Could not bind the local UDP sockets\n");
+        return 1;
+    }
+    const QHostAddress address = QHostAddress::LocalHost;
+    const quint16 port = receiver.localPort();
+
+    // one level message per trigger:
+    const OSCPacketTemplate level("/eos/user/<USER>/sub/<USER>=");
+    std::vector<QByteArray> frame;
+    for (int i = 0; i < MESSAGES_PER_FRAME; ++i) {
+        frame.push_back(level.create(QString::number(i % 500 + 1), i / double(MESSAGES_PER_FRAME)));
+    }
+
+    std::printf("\nUDP send of %d messages/s (%d frames/s of %d messages) to localhost\n",
+                MESSAGES_PER_SECOND, FRAMES_PER_SECOND, MESSAGES_PER_FRAME);
+    std::printf("%-28s %12s %12s %12s %11s\n", "case", "syscalls/s", "CPU ms/s", "ns/message", "received");
+
+    const Result qt = run(receiver, frame, [&](const std::vector<QByteArray>& datagrams) {
+        for (const QByteArray& datagram : datagrams) {
+            sender.writeDatagram(datagram, address, port);
+        }
+        return static_cast<uint64_t>(datagrams.size());  // one sendmsg() per datagram
+    });
+    printResult("QUdpSocket::writeDatagram", qt);
+
+    if (!UdpBatchSender::isSupported()) {
+        std::printf("%-28s not available in this build (SOUND2OSC_WITH_SENDMMSG, Linux only)\n", "sendmmsg");
+        return 0;
+    }
+
+    UdpBatchSender batchSender;
+    const Result batched = run(receiver, frame, [&](const std::vector<QByteArray>& datagrams) {
+        const uint64_t before = batchSender.systemCalls();
+        const int sent = batchSender.send(sender.socketDescriptor(), address, port, datagrams);
+        bench::doNotOptimize(sent);
+        return batchSender.systemCalls() - before;
+    });
+    printResult("UdpBatchSender (sendmmsg)", batched);
+
+    return 0;
+}
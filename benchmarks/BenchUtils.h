@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Minimal timing helpers shared by the benchmarks
+
+#ifndef SOUND2OSC_BENCHMARKS_BENCHUTILS_H
+#define SOUND2OSC_BENCHMARKS_BENCHUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace bench {
+
+/**
+ * @brief Run a function repeatedly and return the best time per call in nanoseconds
+ *
+ * The function is called in batches of iterations, the fastest of several
+ * batches is reported to filter out scheduling noise.
+ */
+template<typename Function>
+double measureNs(Function&& function, int iterations = 1000, int batches = 7)
+{
+    // warm up caches and branch predictors:
+    for (int i = 0; i < iterations / 10 + 1; ++i) function();
+
+    double best = 1e300;
+    for (int batch = 0; batch < batches; ++batch) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) function();
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        best = std::min(best, ns / iterations);
+    }
+    return best;
+}
+
+/**
+ * @brief Keep the compiler from optimizing away a computed value
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+inline void printHeader(const char* title)
+{
+    std::printf("\n%s\n", title);
+    std::printf("%-40s %14s %14s\n", "case", "ns/call", "Msamples/s");
+}
+
+inline void printResult(const char* name, double nsPerCall, double samplesPerCall)
+{
+    std::printf("%-40s %14.1f %14.1f\n", name, nsPerCall, samplesPerCall / nsPerCall * 1000.0);
+}
+
+} // namespace bench
+
+#endif // SOUND2OSC_BENCHMARKS_BENCHUTILS_H
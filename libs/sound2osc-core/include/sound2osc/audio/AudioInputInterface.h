@@ -25,6 +25,7 @@
 
 #include "MonoAudioBuffer.h"
 
+#include <QtGlobal>
 #include <QString>
 #include <QStringList>
 #include <functional>
@@ -32,7 +33,8 @@
 // An interface for an audio input.
 // The input device can be selected
 // and the volume can be changed.
-// Calls putSamples() of MonoAudioBuffer when new data is available.
+// Calls putInterleaved() of MonoAudioBuffer when new data is available.
+// Samples are passed on in their native format and converted to float by the buffer.
 
 class AudioInputInterface
 {
@@ -50,7 +52,7 @@ public:
     virtual void stop() = 0;
 
     // Set a callback to be notified when samples are processed
-    // The int argument represents the number of new samples added
+    // The int argument represents the number of new (mono) samples added
     virtual void setCallback(Callback callback) = 0;
 
 	// returns a list of the names of all available input devices
@@ -65,6 +67,14 @@ public:
 	// changes the used input device by its name
 	virtual void setInputByName(const QString& name) = 0;
 
+	// returns the sample rate of the active input device in Hz
+	int getSampleRate() const { return m_buffer->getSampleRate(); }
+	// sets the sample rate to request when an input device is opened
+	// - 0 uses the native rate of the device (default, avoids resampling)
+	// - the device may choose another rate, see getSampleRate()
+	void setPreferredSampleRate(int sampleRate) { m_preferredSampleRate = qMax(0, sampleRate); }
+	int getPreferredSampleRate() const { return m_preferredSampleRate; }
+
 	// returns the volume of the input device [0...1]
 	virtual qreal getVolume() const = 0;
 	// sets the volume of the input device [0...1]
@@ -72,6 +82,7 @@ public:
 
 protected:
 	MonoAudioBuffer* m_buffer;  // a buffer storing the last audio samples
+	int m_preferredSampleRate = 0;  // requested sample rate in Hz, 0 for the native rate
 };
 
 
@@ -44,6 +44,7 @@ private:
     
     QString m_activeInputName;
     qreal m_volume{1.0};
+    int m_channels{2};  // channel count of the capture device
     Callback m_callback;
     
     void initContext();
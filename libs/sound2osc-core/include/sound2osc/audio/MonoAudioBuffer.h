@@ -23,37 +23,72 @@
 #ifndef MONOAUDIOBUFFER_H
 #define MONOAUDIOBUFFER_H
 
-#include <sound2osc/core/QCircularBuffer.h>
+#include <sound2osc/core/RingBuffer.h>
 
 #include <QVector>
 
+#include <atomic>
+#include <cstdint>
+
+// sample rate assumed until an input device reports its rate
+static constexpr int DEFAULT_SAMPLE_RATE = 44100;  // Hz
+
 
 // A class that receives audio samples and buffers these with circular buffering.
+// There must be only one writer (the audio input), readers may run on other threads.
+// Samples are stored as single precision floats, the format used by the FFT.
 class MonoAudioBuffer
 {
 
 public:
+	using Sample = float;  // sample type of the buffer and all analysis stages
+
 	explicit MonoAudioBuffer(int capacity);
 
-	// puts samples in the buffer
+	// puts interleaved PCM frames in the buffer, all channels are averaged to a mono signal
 	// - usually called by an AudioInputInterface object
-	void putSamples(QVector<qreal>& data, const int& channelCount);
+	// - integer samples are scaled to [-1...1]
+	// - does not allocate memory, safe to call from a real-time audio callback
+	void putInterleaved(const float* data, int frameCount, int channelCount);
+	void putInterleaved(const int16_t* data, int frameCount, int channelCount);
+	void putInterleaved(const int32_t* data, int frameCount, int channelCount);
+	void putInterleaved(const uint8_t* data, int frameCount, int channelCount);
+	// compatibility for double precision sources, converted to float
+	void putInterleaved(const double* data, int frameCount, int channelCount);
+
+	// puts interleaved samples in the buffer (see putInterleaved())
+	// - an incomplete last frame is ignored
+	void putSamples(const QVector<float>& data, const int& channelCount);
+	// compatibility shim for callers that still use QVector<qreal>
+	void putSamples(const QVector<double>& data, const int& channelCount);
 
-	// returns the value in the buffer at index i
-	const qreal& at(int i) const { return m_buffer[i]; }
+	// returns the value in the buffer at index i (0 is the oldest sample)
+	// - not protected against concurrent writes, prefer copySamples()
+	Sample at(int i) const { return m_buffer.at(m_buffer.writePosition() - m_capacity + i); }
+
+	// copies count samples starting at the absolute sample position start
+	// (i.e. the number of samples put before it) to dest
+	// - returns false if these samples are not (or no longer) in the buffer
+	bool copySamples(int64_t start, int count, Sample* dest) const { return m_buffer.copy(start, count, dest); }
+
+	// copies the newest count samples to dest
+	// - returns the absolute sample position of the first copied sample
+	int64_t copyLatestSamples(int count, Sample* dest) const { return m_buffer.copyLatest(count, dest); }
 
     // returns the number of samples that have ever been put in the buffer
-    int64_t getNumPutSamples() const { return m_numPutSamples; }
+    int64_t getNumPutSamples() const { return m_buffer.writePosition(); }
     int getCapacity() const { return m_capacity; }
 
-protected:
-	// Converts PCM data with multiple channels to mono by averaging all channels.
-	// Result is saved inplace and data object will be resized.
-	void convertToMonoInplace(QVector<qreal>& data, const int& channelCount) const;
+	// returns the sample rate of the samples in the buffer in Hz
+	int getSampleRate() const { return m_sampleRate.load(std::memory_order_acquire); }
+	// sets the sample rate negotiated with the input device
+	// - the analysis stages pick up the new rate with their next update
+	void setSampleRate(int sampleRate) { if (sampleRate > 0) m_sampleRate.store(sampleRate, std::memory_order_release); }
 
+protected:
     const int    m_capacity;  // max capacity of the buffer, should be length of FFT
-	Qt3DCore::QCircularBuffer<qreal>	m_buffer;  // a circular buffer, removing the oldest elements when inserting new ones
-    int64_t      m_numPutSamples; // the number of samples that have ever been put into the buffer
+	sound2osc::RingBuffer<Sample>	m_buffer;  // lock-free ring buffer, its write position is the number of samples ever put into it
+	std::atomic<int>	m_sampleRate;  // sample rate in Hz (written by the audio input, read by the analysis)
 };
 
 #endif // MONOAUDIOBUFFER_H
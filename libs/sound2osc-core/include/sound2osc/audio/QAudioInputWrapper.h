@@ -26,6 +26,7 @@
 #include <sound2osc/audio/AudioInputInterface.h>
 #include <sound2osc/audio/MonoAudioBuffer.h>
 
+#include <QByteArray>
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -62,8 +63,8 @@ public:
 
 
 private slots:
-	// Converts the incoming QByteArray to QVector<qreal>
-	// and scales down the values to [-1...1]
+	// Reads the available audio data into a preallocated buffer
+	// and passes it to MonoAudioBuffer, which scales it down to [-1...1]
 	// - called by Qt signal when audio data is ready
 	void audioDataReady();
 
@@ -73,6 +74,7 @@ protected:
 	QAudioSource*	m_audioSource;  // a pointer to the used audio source object (Qt6 replacement for QAudioInput)
 	QIODevice*		m_audioIODevice;  // a pointer to the stream like "device" used while recording
 	QString			m_activeInputName;  // the name of the active audio input
+	QByteArray		m_readBuffer;  // preallocated buffer for the raw audio data
     Callback        m_callback;
 };
 
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Vectorized PCM format conversion and mono downmix
+
+#ifndef SOUND2OSC_AUDIO_SAMPLECONVERSION_H
+#define SOUND2OSC_AUDIO_SAMPLECONVERSION_H
+
+#include <cstdint>
+
+namespace sound2osc {
+namespace SampleConversion {
+
+/**
+ * @brief Convert interleaved PCM frames to mono float samples in [-1...1]
+ *
+ * All channels of a frame are averaged. The conversion is fused with the
+ * downmix and uses SSE2/AVX2 on x86 or NEON on ARM, the best kernel
+ * supported by the CPU is selected at runtime. None of the functions
+ * allocate memory, they are safe to call from a real-time audio callback.
+ *
+ * @param input Interleaved samples (frameCount * channelCount values)
+ * @param frameCount Number of frames to convert
+ * @param channelCount Number of channels per frame
+ * @param output Destination for frameCount mono samples
+ */
+void interleavedToMono(const float* input, int frameCount, int channelCount, float* output);
+void interleavedToMono(const int16_t* input, int frameCount, int channelCount, float* output);
+void interleavedToMono(const int32_t* input, int frameCount, int channelCount, float* output);
+void interleavedToMono(const uint8_t* input, int frameCount, int channelCount, float* output);
+
+/**
+ * @brief Name of the active kernel set ("avx2", "sse2", "neon" or "scalar")
+ */
+const char* kernelName();
+
+/**
+ * @brief Enable or disable the SIMD kernels (enabled by default)
+ * Disabling them forces the scalar fallback, e.g. for tests and benchmarks.
+ */
+void setSimdEnabled(bool enabled);
+
+} // namespace SampleConversion
+} // namespace sound2osc
+
+#endif // SOUND2OSC_AUDIO_SAMPLECONVERSION_H
@@ -23,16 +23,26 @@
 #ifndef BPMDETECTOR_H
 #define BPMDETECTOR_H
 
-#include <sound2osc/dsp/BasicFFTInterface.h>
 #include <sound2osc/dsp/ScaledSpectrum.h>
+#include <sound2osc/dsp/STFTStage.h>
 #include <sound2osc/audio/MonoAudioBuffer.h>
 #include <sound2osc/bpm/BPMOscControler.h>
+#include <sound2osc/bpm/TempoAutocorrelation.h>
+#include <sound2osc/bpm/BeatTracker.h>
+#include <sound2osc/bpm/OnsetBand.h>
+#include <sound2osc/bpm/OnsetStream.h>
+#include <sound2osc/osc/OSCPacketTemplate.h>
 
 #include <sound2osc/core/QCircularBuffer.h>
 #include <QtMath>
+#include <QList>
+#include <QMutex>
+#include <QString>
 #include <QVector>
+#include <atomic>
 #include <list>
 #include <memory>
+#include <vector>
 
 // Rate to calculate the BPM (significantly lower than the sampling period,
 // but still only quater the buffer length, so this should be fine)
@@ -52,13 +62,23 @@ class BeatString;
 class BPMDetector
 {
 public:
-    explicit BPMDetector(const MonoAudioBuffer& buffer, BPMOscControler* osc);
+    // Algorithm that finds the tempo in the onsets of the history
+    enum class TempoEstimator {
+        BeatStrings,  // strings of evenly spaced onsets (cost grows with the number of onsets)
+        Autocorrelation  // comb filtered autocorrelation of the spectral flux (constant cost)
+    };
+
+    explicit BPMDetector(const MonoAudioBuffer& buffer, BPMOscControler* osc, sound2osc::STFTStage* stft = nullptr); // uses a private STFTStage if stft is nullptr
     ~BPMDetector();
 
+    void setSampleRate(int sampleRate); // derives hop, FFT size and cache length from the sample rate and clears the cache (called automatically when the rate of the buffer changes)
+
     void resetCache(); // to be called when the bpm detection is restarted after a pause, to remove old data from the buffer
 
     void detectBPM(); // recalculates the BPM considering the newest data in the buffer
 
+    void detectBPM(int64_t endPosition); // recalculates the BPM considering the data in the buffer up to the absolute sample position endPosition
+
     float getBPM() { return m_bpm; } // returns the detected BPM
 
     bool bpmIsOld() { return m_framesSinceLastBPMDetection / BPM_UPDATE_RATE > 5; } // returns wether the last time a value detected was longer than five seconds ago
@@ -69,24 +89,68 @@ public:
 
     void setTransmitBpm(bool value) { m_transmitBpm = value; }
 
-    // Helper functions to display a nice GUI
-    const QVector<bool>& getOnsets() { return m_onsetBuffer; }
-    const Qt3DCore::QCircularBuffer<float>& getWaveDisplay() { return m_spectralFluxBuffer; }
+    void setTempoEstimator(TempoEstimator estimator) { m_tempoEstimator = estimator; }
+
+    TempoEstimator getTempoEstimator() const { return m_tempoEstimator; }
+
+    void setTransmitBeats(bool value) { m_transmitBeats = value; } // true to send a tick for every predicted beat
+
+    void setBeatLead(int samples) { m_beatLead = samples; } // how far ahead of the analyzed position the beats are due at the receiver (pipeline and network latency)
+
+    bool beatIsLocked() const { return m_beatLocked; } // returns wether the beat tracker follows the phase of the beat
+
+    void setOnsetBands(const QList<sound2osc::OnsetBand>& bands); // frequency bands with an onset detection of their own, applied with the next detectBPM() (thread safe)
+
+    void setTransmitOnsets(bool value) { m_transmitOnsets = value; } // true to send the onsets of the bands via OSC
+
+    static int maxHistoryLength(); // the upper limit of the frames of the flux history at any sample rate
+
+    // Helper functions to display a nice GUI (processing side only, the GUI reads the copies of Sound2OscEngine::displaySnapshot())
+    const Qt3DCore::QCircularBuffer<bool>& getOnsets() { return m_fluxOnsets.onsets(); }
+    const Qt3DCore::QCircularBuffer<float>& getWaveDisplay() { return m_fluxOnsets.flux(); }
+    int getBandCount() const { return static_cast<int>(m_bands.size()); }
+    const Qt3DCore::QCircularBuffer<bool>& getBandOnsets(int band) { return m_bands[static_cast<size_t>(band)].stream.onsets(); }
     const Qt3DCore::QCircularBuffer<SpectrumColor>& getWaveColors() { return m_waveColors; }
 
 protected:
-    // calculates a Hann Window for FFT and saves it to m_window
-    void calculateWindow();
+    // a frequency band of setOnsetBands() with its flux history
+    struct BandOnsets {
+        sound2osc::OnsetBand    band;
+        int                     firstBin; // first bin of the band
+        int                     endBin; // bin after the last one of the band
+        sound2osc::OSCPacketTemplate message; // the OSC message of an onset, encoded once
+        sound2osc::OnsetStream  stream; // spectral flux and onsets of the band
+    };
+
+    // conversions between frequencies, frames and milliseconds at the current sample rate
+    int frequencyToIndex(int frequency) const;
+    int framesToMs(int frames) const;
+    int msToFrames(int ms) const;
+
+    // appends the spectral flux of a frame of the STFTStage to the spectral flux history and the bands
+    void updateSpectralFlux(const sound2osc::STFTFrame& frame);
+
+    // maps the frequencies of the bands to bins and sets their history length
+    void configureBands();
+
+    // appends the color of a frame of the STFTStage to the waveform colors
+    void updateWaveColor(const sound2osc::STFTFrame& frame);
+
+    // performs onset recognition on the frames added since the last call, for the whole spectrum and the bands
+    void updateOnsets();
 
-    // updates the arrays of spectral flux values
-    void updateSpectralFluxes(int from);
+    // spectral flux of the frame at index i of the history, normalized with the current average and standard deviation
+    float normalizedFlux(int i) const { return m_fluxOnsets.normalized(i); }
 
-    // performs onset recognition
-    void updateOnsets();
+    // passes the tempo to the beat tracker and sends the beats that are due at the receiver before the next call
+    void updateBeats(int64_t endPosition);
 
     // categorize intervalls between the onsets into clusters
     void updateStrings();
 
+    // finds the tempo candidates in the autocorrelation of the spectral flux and stores them as strings
+    void updateAutocorrelation();
+
     // helper function for the evaluation
     BeatString* plausibleStringForInterval(float interval, float maxScore);
 
@@ -94,25 +158,40 @@ protected:
     void evaluateStrings();
 
     const MonoAudioBuffer&              m_inputBuffer; // buffer that stores the audio samples
-    int64_t                             m_lastInputBufferNumSamples; // the number of samples ever put into the buffer when last getting data from there
     int                                 m_refreshesSinceCalculation; // used to calculate the bpm every n-th call
-    float                               m_bpm; // the detected bpm
+    std::atomic<float>                  m_bpm; // the detected bpm (atomic: read by the UI while detection may run on the processing thread)
     int                                 m_framesSinceLastBPMDetection; // time since the bpm has last changed in frames
-    int                                 m_minBPM; // the minimum bpm that sets the range of possible bpms as min to 2*min. That solves the 60 vs 120 BPM debate
-    std::unique_ptr<BasicFFTInterface>  m_fft; // FFT implementation
-    QVector<float>                      m_window; // array with window data
-    QVector<bool>                       m_onsetBuffer; // a boolen buffer indicating wether there was a onset i frames ago
-    Qt3DCore::QCircularBuffer<float>    m_spectralFluxBuffer; // a float buffer caching the spectral flux of the bands of the last frames
-    QVector<float>                      m_spectralFluxNormalized; // a vector to copy the normalized spectral flux data into
+    std::atomic<int>                    m_minBPM; // the minimum bpm that sets the range of possible bpms as min to 2*min. That solves the 60 vs 120 BPM debate
+    int                                 m_sampleRate; // sample rate of the input in Hz
+    int                                 m_hopSize; // the number of samples the detection moves forward per frame
+    int                                 m_fftSize; // the number of samples fft-ed for each frame
+    int                                 m_framesToCache; // the number of frames cached for detection (five seconds)
+    std::unique_ptr<sound2osc::STFTStage> m_ownStft; // STFTStage if none is shared
+    sound2osc::STFTStage*               m_stft; // computes the windowed FFT of each frame
+    int                                 m_fluxSubscription; // subscription of updateSpectralFlux() at m_stft
+    int                                 m_colorSubscription; // subscription of updateWaveColor() at m_stft
+    sound2osc::OnsetStream              m_fluxOnsets; // the spectral flux of the last frames and the onsets detected in it
+    int64_t                             m_lastFluxEnd; // absolute sample position of the end of the newest frame of the history
+    std::vector<BandOnsets>             m_bands; // the onset bands (only used by the processing side)
+    QMutex                              m_bandsMutex; // guards m_pendingBands
+    QList<sound2osc::OnsetBand>         m_pendingBands; // the bands of the last setOnsetBands()
+    std::atomic<bool>                   m_bandsChanged; // true if m_pendingBands has to be applied
+    std::atomic<bool>                   m_transmitOnsets; // true if the onsets of the bands should be transmitted via OSC
     Qt3DCore::QCircularBuffer<SpectrumColor>   m_waveColors; // the color for each sample to give spectral information in the GUI
-    QVector<float>                      m_buffer;  // buffer for prepared data (intermediate result)
-    QVector<float>                      m_fftOutput; // buffer for FFT Data
-    QVector<float>                      m_currentSpectrum; // the spectrum currently being calculated
-    QVector<float>                      m_lastSpectrum; // the spectrum calculated in the last frame for calculating the spectral flux, which is a difference
+    QVector<float>                      m_lastSpectrum; // the magnitudes of the last frame for calculating the spectral flux, which is a difference
+    QVector<float>                      m_fluxIncrease; // the increase of the magnitude of each bin in the current frame
     std::list<BeatString>              m_beatStrings; // the IOI Clusters identified from the intervalls
     Qt3DCore::QCircularBuffer<float>    m_lastIntervals; // the last bpm values stored as their interval, to achieve smoothing
     float                               m_lastWinningInterval; // the last outputed bpm as an interval before doubling/halfing
-    bool                                m_transmitBpm;  // true if the BPM should be transmitted via OSC
+    std::atomic<bool>                   m_transmitBpm;  // true if the BPM should be transmitted via OSC
+    std::atomic<TempoEstimator>         m_tempoEstimator; // the algorithm that finds the tempo candidates
+    sound2osc::TempoAutocorrelation     m_tempoAutocorrelation; // the autocorrelation estimator
+    QVector<float>                      m_onsetStrength; // the spectral flux above its average (widened by a frame), input of the autocorrelation
+    sound2osc::BeatTracker              m_beatTracker; // follows the phase of the beat on the onsets and the detected tempo
+    std::atomic<bool>                   m_beatLocked; // copy of m_beatTracker.isLocked() for the UI
+    std::atomic<bool>                   m_transmitBeats; // true if the predicted beats should be transmitted via OSC
+    std::atomic<int>                    m_beatLead; // samples ahead of the analyzed position that the beats are due at the receiver
+    int64_t                             m_lastBeatsEnd; // end position of the last updateBeats() call
 
     BPMOscControler*                    m_oscController; // the object respoinsible for handling osc output
 };
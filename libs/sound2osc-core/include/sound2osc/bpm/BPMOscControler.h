@@ -26,6 +26,9 @@
 #include <sound2osc/osc/OSCNetworkManager.h>
 #include <QSettings>
 #include <QJsonObject>
+#include <QMutex>
+
+#include <atomic>
 
 class BPMOscControler
 {
@@ -37,9 +40,22 @@ public:
     void setBPMMute(bool mute);
     void toggleBPMMute();
 
+    // Destinations of the user specified commands (bit n = destination n, see OSCRoutes)
+    sound2osc::OSCRoutes::Mask getRoutes() const { return m_routes; }
+    void setRoutes(sound2osc::OSCRoutes::Mask routes) { m_routes = routes; }
+
     // Called by the bpm detector to make the controller send the new bpm to the clients
     void transmitBPM(float bpm);
 
+    // Called by the bpm detector to send a tick for a predicted beat that is due delay seconds from now
+    void transmitBeat(double delay);
+
+    // Returns if the ticks are sent with the time tag of their beat (see OSCNetworkManager::sendMessageAt())
+    bool beatsAreTimeTagged() const { return m_osc.isFrameTimeTagged(); }
+
+    // Called by the bpm detector to send an onset of a band (a level message, velocity 0 - 1)
+    void transmitOnset(const sound2osc::OSCPacketTemplate& message, float velocity);
+
     // Restores the state from e.g. a preset
     void restore(QSettings& settings);
 
@@ -52,10 +68,11 @@ public:
 
     // --------------------------------------- GUI Functions -----------------------------------------------
     // Returns the commands
-    QStringList getCommands() { return m_oscCommands; }
+    QStringList getCommands() { QMutexLocker locker(&m_commandsMutex); return m_oscCommands; }
 
     // Sets the command at the given index
     void setCommands(QStringList commands) {
+        QMutexLocker locker(&m_commandsMutex);
         m_oscCommands = QStringList(commands);
     }
 
@@ -63,6 +80,9 @@ public:
 protected:
     bool                m_bpmMute; // If the bpm osc is muted
     OSCNetworkManager&  m_osc; // The network manager to send network signals thorugh
+    std::atomic<sound2osc::OSCRoutes::Mask> m_routes; // Destinations of the commands (default is the primary destination)
+    const sound2osc::OSCPacketTemplate m_beatMessage; // The beat tick, encoded once
+    mutable QMutex      m_commandsMutex; // Guards m_oscCommands, transmitBPM() may run on the processing thread
     QStringList         m_oscCommands; // The osc messages to be sent on a tempo changed. Delivered as finished strings with the <BPM> (<BPM1-2>, <BPM4> etc. for fractions from 1/4 to 4) qualifier to be changed. The message is generated in the qml because thats the way tim did it with the other osc messages
 };
 
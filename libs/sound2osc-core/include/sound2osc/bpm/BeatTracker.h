@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Beat phase tracking on the detected onsets and tempo
+
+#ifndef SOUND2OSC_BPM_BEATTRACKER_H
+#define SOUND2OSC_BPM_BEATTRACKER_H
+
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Locks onto the phase of the beat and predicts the next beats
+ *
+ * The BPM detection only finds the tempo. The tracker places a grid with
+ * the beat interval of that tempo on the onsets, so that the beats can be
+ * sent before they happen instead of after an onset was detected (which is
+ * at least the FFT window and the peak picking window late).
+ *
+ * - Acquisition: the phase is the onset that has the most (strength
+ *   weighted) onsets of the history on its grid, at least LOCK_ONSETS.
+ * - Tracking: each onset within TOLERANCE of a predicted beat corrects the
+ *   phase and the interval like a second order PLL. Onsets between the
+ *   beats (e.g. off-beat hi-hats) are ignored. The interval may deviate by
+ *   MAX_INTERVAL_DEVIATION from the detected tempo, which is only known to
+ *   a few milliseconds.
+ * - The lock is lost after LOST_BEATS beats without a matching onset, and
+ *   when the tempo changes by more than MAX_INTERVAL_DEVIATION.
+ *
+ * Only the beats are tracked, not the bars: the tracker does not know which
+ * beat is the downbeat.
+ *
+ * All positions are absolute sample positions of the input. Not thread safe.
+ */
+class BeatTracker
+{
+public:
+    static constexpr int HISTORY = 32;  ///< onsets kept for the acquisition
+    static constexpr int LOCK_ONSETS = 3;  ///< onsets on the grid needed for a lock
+    static constexpr int LOST_BEATS = 8;  ///< beats without onset until the lock is lost
+
+    static constexpr double TOLERANCE = 0.15;  ///< max. distance of a matching onset (fraction of the interval)
+    static constexpr double PHASE_GAIN = 0.3;  ///< part of the error corrected in the phase
+    static constexpr double INTERVAL_GAIN = 0.05;  ///< part of the error corrected in the interval
+    static constexpr double MAX_INTERVAL_DEVIATION = 0.04;  ///< of the interval of the detected tempo
+
+    BeatTracker();
+
+    /**
+     * @brief Forget the onsets and the phase
+     */
+    void reset();
+
+    /**
+     * @brief Set the beat interval of the detected tempo in samples (0 = no tempo)
+     * Small changes keep the phase, larger ones start a new acquisition.
+     */
+    void setInterval(double interval);
+
+    /**
+     * @brief Add a detected onset
+     * @param position Sample position of the onset
+     * @param strength Weight of the onset (e.g. its normalized spectral flux), > 0
+     */
+    void addOnset(double position, float strength);
+
+    /**
+     * @brief Take the next predicted beat before a position
+     *
+     * Beats before from are skipped (they can not be sent in time anymore),
+     * the first beat in [from, to) is returned and will not be returned again.
+     * @param position set to the sample position of the beat
+     * @return false if no beat is due or there is no lock
+     */
+    bool takeBeat(double from, double to, double& position);
+
+    bool isLocked() const { return m_locked; }
+
+    /**
+     * @brief The tracked beat interval in samples (0 without tempo)
+     */
+    double interval() const { return m_interval; }
+
+    /**
+     * @brief Position of the next beat that was not taken yet (only valid with a lock)
+     */
+    double nextBeat() const { return m_nextBeat; }
+
+private:
+    struct Onset
+    {
+        double position;
+        float strength;
+    };
+
+    // finds the phase in the onset history, true if enough onsets are on the grid
+    bool acquire();
+
+    void unlock();
+
+    double m_tempoInterval;  // interval of the detected tempo
+    double m_interval;  // tracked interval
+    double m_nextBeat;  // position of the next beat not taken yet
+    double m_lastMatch;  // position of the last onset on the grid
+    bool m_locked;
+    std::vector<Onset> m_onsets;  // the last HISTORY onsets (ring buffer)
+    int m_nextOnset;  // index of the next onset in m_onsets
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_BPM_BEATTRACKER_H
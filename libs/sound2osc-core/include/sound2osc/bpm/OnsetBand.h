@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Frequency band with its own onset detection (e.g. kick, snare and hi-hat)
+
+#ifndef SOUND2OSC_BPM_ONSETBAND_H
+#define SOUND2OSC_BPM_ONSETBAND_H
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+namespace sound2osc {
+
+/**
+ * @brief A frequency range whose spectral flux is searched for onsets of its own
+ *
+ * Each onset of the band is sent as /sound2osc/onset/<name>.
+ */
+struct OnsetBand
+{
+    QString name;
+    int lowHz = 0;
+    int highHz = 0;
+
+    bool operator==(const OnsetBand& other) const;
+    bool operator!=(const OnsetBand& other) const { return !(*this == other); }
+
+    /**
+     * @brief True if the name is valid and the high frequency is above the low one
+     */
+    bool isValid() const { return isValidName(name) && highHz > lowHz; }
+
+    /**
+     * @brief Map with the keys name, low and high (for the settings)
+     */
+    QVariantMap toVariant() const;
+
+    /**
+     * @brief Band of a map of toVariant(), the name is empty if it is not valid
+     */
+    static OnsetBand fromVariant(const QVariant& value);
+
+    /**
+     * @brief True if the name can be used in the OSC path of the onsets
+     * (not empty, no spaces, no '/' and none of the special characters # * , ? [ ] { } =)
+     */
+    static bool isValidName(const QString& name);
+
+    /**
+     * @brief Kick, snare and hi-hat
+     */
+    static QList<OnsetBand> defaults();
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_BPM_ONSETBAND_H
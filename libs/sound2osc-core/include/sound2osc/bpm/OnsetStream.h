@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Spectral flux history with incremental onset detection
+
+#ifndef SOUND2OSC_BPM_ONSETSTREAM_H
+#define SOUND2OSC_BPM_ONSETSTREAM_H
+
+#include <sound2osc/core/QCircularBuffer.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief History of a spectral flux signal and the onsets detected in it
+ *
+ * Peak picking after "Evaluation of the Audio Beat Tracking System BeatRoot"
+ * by Simon Dixon (Journal of New Music Research, 36, 2007/8). A frame is an
+ * onset if its flux
+ * 1. is above the past threshold (a recursive average of the previous frames),
+ * 2. is the maximum of the frames within +- WINDOW frames,
+ * 3. is above the average of the frames from -MULTIPLIER * WINDOW to + WINDOW
+ *    (normalized to the average and standard deviation of the history),
+ * 4. is optionally a minimum number of standard deviations above the average
+ *    of the history (see setMinDeviation()).
+ *
+ * Average and standard deviation are running sums over the history, and
+ * update() only evaluates the frames added since the last call (each one as
+ * soon as the WINDOW frames after it are there), so the effort does not
+ * depend on the length of the history. The onsets of older frames are kept,
+ * they are not evaluated again with the normalization of later calls.
+ *
+ * Used for the spectral flux of the whole spectrum (tempo detection) and for
+ * the flux of single frequency bands (onset triggers). Not thread safe.
+ */
+class OnsetStream
+{
+public:
+    static constexpr int WINDOW = 5;  ///< frames around a local maximum
+    static constexpr int MULTIPLIER = 3;  ///< extends the average threshold window before the frame
+    static constexpr float PAST_THRESHOLD_WEIGHT = 0.84f;
+    static constexpr float AVERAGE_THRESHOLD_DELTA = 0.008f;
+
+    explicit OnsetStream(int length = 0);
+
+    /**
+     * @brief Set the number of frames of the history, clears the history
+     */
+    void setLength(int frames);
+
+    /**
+     * @brief Lower limit of the standard deviation used for the normalization
+     * Prevents onsets in the noise floor, where the flux hardly varies.
+     */
+    void setMinStdDev(float value) { m_minStdDev = value; }
+
+    /**
+     * @brief Minimum distance of an onset above the average of the history, in standard deviations
+     * 0 (default) disables the criterion. Needed for signals that may contain only noise,
+     * e.g. a frequency band without an instrument in it.
+     */
+    void setMinDeviation(float standardDeviations) { m_minDeviationFactor = standardDeviations; }
+
+    /**
+     * @brief Remove all frames and onsets
+     */
+    void reset();
+
+    /**
+     * @brief Append the flux of a new frame, the oldest frame is dropped when the history is full
+     */
+    void add(float flux);
+
+    /**
+     * @brief Detect the onsets in the frames added since the last call
+     * @return History indices of the new onsets (valid until the next add())
+     */
+    const std::vector<int>& update();
+
+    /**
+     * @brief Flux normalized with the average and standard deviation of the last update()
+     */
+    float normalized(int i) const { return (m_flux[i] - m_average) / m_stdDev; }
+
+    const Qt3DCore::QCircularBuffer<float>& flux() const { return m_flux; }
+    const Qt3DCore::QCircularBuffer<bool>& onsets() const { return m_onsets; }
+
+    int count() const { return m_flux.count(); }
+    bool isFull() const { return m_flux.count() >= m_flux.capacity(); }
+
+    float average() const { return m_average; }
+
+    /**
+     * @brief Largest flux of the history (0 if it is empty)
+     */
+    float maximum() const { return m_historyMaximum.maximum(); }
+
+private:
+    // The maximum of the last frames: a queue of the frames with decreasing flux, frames
+    // with a lower flux than a newer one can never be the maximum again. The queue is a
+    // ring of the maximum number of frames, push() does not allocate.
+    class MaximumQueue
+    {
+    public:
+        void setCapacity(int frames);
+        void clear() { m_begin = 0; m_size = 0; }
+
+        // appends a frame and drops the frames before firstFrame
+        void push(int64_t frame, float flux, int64_t firstFrame);
+
+        float maximum() const { return m_size > 0 ? m_entries[static_cast<std::size_t>(m_begin)].flux : 0.0f; }
+
+    private:
+        struct Entry
+        {
+            int64_t frame;
+            float flux;
+        };
+
+        // entry i of the queue, 0 is the oldest
+        Entry& entry(int i) { return m_entries[static_cast<std::size_t>((m_begin + i) % static_cast<int>(m_entries.size()))]; }
+
+        std::vector<Entry> m_entries;
+        int m_begin = 0;  // index of the oldest entry
+        int m_size = 0;  // number of entries
+    };
+
+    static constexpr int LOCAL_MAXIMUM_FRAMES = 2 * WINDOW + 1;  // frames of the local maximum window
+
+    Qt3DCore::QCircularBuffer<float> m_flux;  // flux of the last frames
+    Qt3DCore::QCircularBuffer<bool> m_onsets;  // true if there was an onset at the frame
+    std::vector<int> m_newOnsets;  // result of update()
+    int64_t m_frames;  // number of frames added since the history was reset
+    int64_t m_evaluatedFrames;  // number of those frames that update() has processed
+    double m_sum;  // running sum of the history
+    double m_squareSum;  // running sum of the squares of the history
+    float m_minStdDev;
+    float m_minDeviationFactor;  // setMinDeviation()
+    float m_minDeviation;  // minimum flux above the average at the last update()
+    float m_average;  // average of the history at the last update()
+    float m_stdDev;  // standard deviation used to normalize at the last update()
+    float m_pastThreshold;  // recursive past threshold
+    MaximumQueue m_localMaximum;  // maximum of the local maximum window of the next frame to evaluate
+    MaximumQueue m_historyMaximum;  // maximum of the history
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_BPM_ONSETSTREAM_H
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Tempo candidates from the autocorrelation of an onset strength signal
+
+#ifndef SOUND2OSC_BPM_TEMPOAUTOCORRELATION_H
+#define SOUND2OSC_BPM_TEMPOAUTOCORRELATION_H
+
+#include <sound2osc/dsp/BasicFFTInterface.h>
+
+#include <memory>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Estimates beat intervals with an FFT based autocorrelation and a comb filter
+ *
+ * The beat string search of the BPMDetector compares every pair of onsets
+ * and follows each pair through the history, its cost grows with the square
+ * of the number of onsets (dense material) times the history length. This
+ * estimator has a cost that only depends on the history length:
+ *
+ * - The autocorrelation of the onset strength (e.g. the spectral flux above
+ *   its average) is calculated as the inverse FFT of its power spectrum,
+ *   zero padded so that the correlation is not circular. The power spectrum
+ *   is real and even, so its forward FFT is the autocorrelation as well.
+ * - Each lag of the tempo range is scored with a comb over its first
+ *   COMB_TEETH multiples, so that a lag is only strong if the pulse repeats.
+ *   The autocorrelation is not normalized to the overlap (biased), which
+ *   favours the shorter of two lags that repeat equally well (beats over bars).
+ * - The local maxima of the comb are the candidates, refined to a fraction
+ *   of a frame by parabolic interpolation.
+ *
+ * All buffers are allocated in setFormat(), analyze() does not allocate.
+ * setFormat() only allocates and creates an FFT for lengths above the
+ * length of prepare(), which the owner calls before the analysis runs.
+ */
+class TempoAutocorrelation
+{
+public:
+    /**
+     * @brief A beat interval and its comb score (relative to the energy of the signal)
+     */
+    struct Candidate
+    {
+        float interval;  ///< in frames of the onset strength signal
+        float score;
+    };
+
+    /// Number of multiples of a lag that are summed for its score
+    static constexpr int COMB_TEETH = 4;
+
+    /// Maximum number of candidates returned by analyze()
+    static constexpr int MAX_CANDIDATES = 8;
+
+    TempoAutocorrelation();
+    ~TempoAutocorrelation();
+
+    TempoAutocorrelation(const TempoAutocorrelation&) = delete;
+    TempoAutocorrelation& operator=(const TempoAutocorrelation&) = delete;
+
+    /**
+     * @brief Set the length of the signal and the range of intervals (in frames)
+     */
+    void setFormat(int length, int minInterval, int maxInterval);
+
+    /**
+     * @brief Create the FFTs and buffers for all lengths up to maxLength in advance
+     * Creating an FFT can be slow (the "auto" backend times every backend,
+     * FFTW plans the transform), setFormat() reuses them.
+     */
+    void prepare(int maxLength);
+
+    int length() const { return m_length; }
+
+    /**
+     * @brief Calculate the candidates of a signal of length() values
+     * @return the candidates with the highest score first (empty for a silent signal)
+     */
+    const std::vector<Candidate>& analyze(const float* signal);
+
+    /**
+     * @brief Autocorrelation of the last analyze(), normalized to 1 at lag 0
+     * (lags 0 ... length() - 1)
+     */
+    const std::vector<float>& autocorrelation() const { return m_autocorrelation; }
+
+private:
+    // FFT size for a signal of the given length
+    static int fftSizeFor(int length);
+
+    // the FFT of a size, created if it was not prepared
+    BasicFFTInterface* fft(int size);
+
+    int m_length;
+    int m_minInterval;
+    int m_maxInterval;
+    std::vector<std::unique_ptr<BasicFFTInterface>> m_ffts;  // all FFTs that were created
+    BasicFFTInterface* m_fft;  // FFT of the current length, one of m_ffts
+    std::vector<float> m_padded;  // signal and zeros, then the power spectrum
+    std::vector<float> m_spectrum;
+    std::vector<float> m_autocorrelation;
+    std::vector<float> m_comb;  // score of each lag up to m_maxInterval + 1
+    std::vector<Candidate> m_candidates;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_BPM_TEMPOAUTOCORRELATION_H
@@ -8,10 +8,14 @@
 #ifndef SOUND2OSC_CONFIG_SETTINGSMANAGER_H
 #define SOUND2OSC_CONFIG_SETTINGSMANAGER_H
 
+#include <sound2osc/bpm/OnsetBand.h>
+#include <sound2osc/osc/OSCDestination.h>
+
 #include <QObject>
 #include <QString>
 #include <QRect>
 #include <QHostAddress>
+#include <QList>
 #include <memory>
 
 namespace sound2osc {
@@ -88,6 +92,48 @@ public:
     bool oscInputEnabled() const;
     void setOscInputEnabled(bool enabled);
 
+    /**
+     * @brief Send the messages of one analysis frame as OSC bundles
+     */
+    bool oscBundleFrames() const;
+    void setOscBundleFrames(bool enabled);
+
+    /**
+     * @brief Maximum size of one bundle in bytes, larger frames are split
+     */
+    int oscMaxBundleSize() const;
+    void setOscMaxBundleSize(int size);
+
+    /**
+     * @brief Additional OSC destinations, entry n - 1 is destination n of the route masks
+     */
+    QList<OSCDestination> oscDestinations() const;
+    void setOscDestinations(const QList<OSCDestination>& destinations);
+
+    /**
+     * @brief Destinations of the feedback messages of sound2osc (bit n = destination n)
+     */
+    quint32 oscFeedbackRoutes() const;
+    void setOscFeedbackRoutes(quint32 routes);
+
+    /**
+     * @brief Send a /sound2osc/beat tick for every beat predicted by the beat tracker
+     */
+    bool oscBeatEnabled() const;
+    void setOscBeatEnabled(bool enabled);
+
+    /**
+     * @brief Latency of the network and the receiver in ms, the beat ticks are sent this much earlier
+     */
+    int oscBeatLatency() const;
+    void setOscBeatLatency(int ms);
+
+    /**
+     * @brief Send a /sound2osc/onset/<band> trigger for every onset in one of the onset bands
+     */
+    bool oscOnsetsEnabled() const;
+    void setOscOnsetsEnabled(bool enabled);
+
     // =========================================================================
     // OSC Logging Settings
     // =========================================================================
@@ -115,6 +161,46 @@ public:
     QString inputDeviceName() const;
     void setInputDeviceName(const QString& name);
 
+    /// Sample rate requested from the input device in Hz (0 = native rate of the device)
+    int inputSampleRate() const;
+    void setInputSampleRate(int sampleRate);
+
+    // =========================================================================
+    // Processing Settings
+    // =========================================================================
+
+    /// Run FFT, triggers and BPM detection on a dedicated thread
+    bool dspThreadEnabled() const;
+    void setDspThreadEnabled(bool enabled);
+
+    /// CPU core to pin the processing thread to (-1 = no affinity)
+    int dspThreadCpu() const;
+    void setDspThreadCpu(int cpu);
+
+    /// Number of samples of one FFT of the spectrum analysis (1024, 2048, 4096 or 8192)
+    int fftSize() const;
+    void setFftSize(int samples);
+
+    /// Samples between two FFT/trigger analysis runs (0 = sample rate / 44)
+    int fftHopSize() const;
+    void setFftHopSize(int samples);
+
+    /// Samples between two BPM detection runs (0 = sample rate / 44)
+    int bpmHopSize() const;
+    void setBpmHopSize(int samples);
+
+    /// FFT implementation ("auto", "ffft", "radix" or "fftw"), applied when the engine starts
+    QString fftBackend() const;
+    void setFftBackend(const QString& name);
+
+    /// Tempo estimator of the BPM detection ("strings" or "autocorrelation")
+    QString tempoEstimator() const;
+    void setTempoEstimator(const QString& name);
+
+    /// Frequency bands with their own onset detection (e.g. kick, snare, hi-hat)
+    QList<OnsetBand> onsetBands() const;
+    void setOnsetBands(const QList<OnsetBand>& bands);
+
     // =========================================================================
     // Persistence
     // =========================================================================
@@ -152,6 +238,10 @@ signals:
     void useTcpChanged();
     void useOsc_1_1Changed();
     void oscInputEnabledChanged();
+    void oscBundleSettingsChanged();
+    void oscDestinationsChanged();
+    void oscBeatSettingsChanged();
+    void oscOnsetSettingsChanged();
     void oscLogSettingsChanged();
     
     // Window signals
@@ -160,6 +250,10 @@ signals:
     
     // Input signals
     void inputDeviceNameChanged();
+    void inputSampleRateChanged();
+
+    // Processing signals
+    void processingSettingsChanged();
     
     // General
     void settingsChanged();
@@ -182,12 +276,29 @@ private:
     bool m_useTcp = false;
     bool m_useOsc_1_1 = false;
     bool m_oscInputEnabled = true;
+    bool m_oscBundleFrames = false;
+    int m_oscMaxBundleSize = 1472;
+    QList<OSCDestination> m_oscDestinations;
+    quint32 m_oscFeedbackRoutes = 1;
+    bool m_oscBeatEnabled = false;
+    int m_oscBeatLatency = 0;
+    bool m_oscOnsetsEnabled = false;
     bool m_oscLogIncoming = true;
     bool m_oscLogOutgoing = true;
     
     QRect m_windowGeometry;
     bool m_windowMaximized = false;
     QString m_inputDeviceName;
+    int m_inputSampleRate = 0;
+
+    bool m_dspThreadEnabled = false;
+    int m_dspThreadCpu = -1;
+    int m_fftSize = 4096;
+    int m_fftHopSize = 0;
+    int m_bpmHopSize = 0;
+    QString m_fftBackend = QStringLiteral("auto");
+    QString m_tempoEstimator = QStringLiteral("strings");
+    QList<OnsetBand> m_onsetBands = OnsetBand::defaults();
 };
 
 } // namespace sound2osc
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Cache line size used to separate data written by different threads
+
+#ifndef SOUND2OSC_CORE_CACHELINE_H
+#define SOUND2OSC_CORE_CACHELINE_H
+
+#include <cstddef>
+
+namespace sound2osc {
+
+/**
+ * @brief Size of a cache line on all supported targets (x86-64, ARMv7/v8)
+ *
+ * Members that are written by different threads are aligned to it so that
+ * they do not share a cache line (false sharing).
+ */
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_CACHELINE_H
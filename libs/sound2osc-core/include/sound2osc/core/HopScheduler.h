@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Sample-accurate scheduling of periodic analysis runs
+
+#ifndef SOUND2OSC_CORE_HOPSCHEDULER_H
+#define SOUND2OSC_CORE_HOPSCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace sound2osc {
+
+/**
+ * @brief Schedules analysis runs at fixed sample positions of the input stream
+ *
+ * The scheduler is keyed on an absolute sample counter (e.g.
+ * MonoAudioBuffer::getNumPutSamples()), so a run is due every hopSize samples
+ * independent of the size of the audio callbacks. Each call to next()
+ * returns the end position of one due hop, the caller analyzes the samples
+ * up to exactly this position. After a long callback several hops are due
+ * and are returned one after the other, the phase never drifts.
+ *
+ * If the consumer falls behind by more than maxLag samples, the oldest hops
+ * are skipped in whole multiples of the hop size (see skippedHops()), e.g.
+ * because their samples are no longer in the buffer.
+ *
+ * isDue() may be called from any thread (usually the audio callback to decide
+ * whether to wake the processing side), all other functions must be called
+ * from the consuming thread.
+ */
+class HopScheduler
+{
+public:
+    explicit HopScheduler(int hopSize = 1024)
+        : m_hopSize(std::max(1, hopSize))
+        , m_maxLag(0)
+        , m_next(m_hopSize)
+        , m_skippedHops(0)
+    {
+    }
+
+    int hopSize() const { return m_hopSize; }
+
+    /**
+     * @brief Change the hop size
+     * The next hop is due hopSize samples after the last returned one.
+     */
+    void setHopSize(int hopSize)
+    {
+        hopSize = std::max(1, hopSize);
+        if (hopSize == m_hopSize) return;
+        const int64_t last = m_next.load(std::memory_order_relaxed) - m_hopSize;
+        m_hopSize = hopSize;
+        m_next.store(last + m_hopSize, std::memory_order_release);
+    }
+
+    /**
+     * @brief Maximum number of samples the consumer may lag behind (0 = unlimited)
+     */
+    void setMaxLag(int64_t samples) { m_maxLag = std::max<int64_t>(0, samples); }
+    int64_t maxLag() const { return m_maxLag; }
+
+    /**
+     * @brief Restart the schedule, the first hop is due hopSize samples after position
+     */
+    void reset(int64_t position)
+    {
+        m_next.store(position + m_hopSize, std::memory_order_release);
+        m_skippedHops = 0;
+    }
+
+    /**
+     * @brief Absolute sample position at which the next hop is due
+     */
+    int64_t nextPosition() const { return m_next.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if at least one hop is due at the given position (thread safe)
+     */
+    bool isDue(int64_t position) const { return position >= nextPosition(); }
+
+    /**
+     * @brief Take the next due hop
+     * @param position Current absolute sample position of the input
+     * @param hopEnd Set to the end position of the due hop
+     * @return false if no hop is due
+     */
+    bool next(int64_t position, int64_t& hopEnd)
+    {
+        int64_t due = m_next.load(std::memory_order_relaxed);
+        if (position < due) return false;
+
+        if (m_maxLag > 0 && position - due > m_maxLag) {
+            const int64_t skip = (position - due - m_maxLag + m_hopSize - 1) / m_hopSize;
+            due += skip * m_hopSize;
+            m_skippedHops += static_cast<uint64_t>(skip);
+        }
+
+        hopEnd = due;
+        m_next.store(due + m_hopSize, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of hops that were skipped because the consumer fell behind
+     */
+    uint64_t skippedHops() const { return m_skippedHops; }
+
+private:
+    int m_hopSize;
+    int64_t m_maxLag;
+    std::atomic<int64_t> m_next;  // absolute position of the next due hop
+    uint64_t m_skippedHops;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_HOPSCHEDULER_H
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Dedicated worker thread for the DSP pipeline
+
+#ifndef SOUND2OSC_CORE_PROCESSINGTHREAD_H
+#define SOUND2OSC_CORE_PROCESSINGTHREAD_H
+
+#include <sound2osc/core/SpscQueue.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sound2osc {
+
+/**
+ * @brief Worker thread that runs the analysis pipeline outside of the Qt event loop
+ *
+ * The audio callback calls wake() after new samples arrived, the worker then
+ * executes all pending commands followed by the work function. Commands are
+ * passed through a lock-free queue so that control changes (e.g. from the GUI)
+ * are applied between two analysis runs and never race with them.
+ *
+ * post() must always be called from the same control thread (usually the
+ * Qt main thread), wake() may be called from any thread including a
+ * real-time audio callback.
+ */
+class ProcessingThread
+{
+public:
+    using Function = std::function<void()>;
+
+    explicit ProcessingThread(std::size_t commandCapacity = 256);
+    ~ProcessingThread();
+
+    ProcessingThread(const ProcessingThread&) = delete;
+    ProcessingThread& operator=(const ProcessingThread&) = delete;
+
+    /**
+     * @brief Start the worker thread
+     * @param work Function to call after each wake-up
+     * @param cpuCore Index of the CPU core to pin the thread to, -1 for no affinity
+     * @return true if the thread was started
+     */
+    bool start(Function work, int cpuCore = -1);
+
+    /**
+     * @brief Stop the worker thread and wait until it finished
+     * Commands that are still queued are executed before the thread exits.
+     */
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if the caller is executed by the worker thread
+     */
+    bool isCurrentThread() const;
+
+    /**
+     * @brief Signal that new work is available (real-time safe, does not lock)
+     */
+    void wake();
+
+    /**
+     * @brief Queue a command to be executed by the worker thread
+     * @return false if the queue is full, the command is not moved from in this case
+     */
+    bool post(Function&& command);
+
+private:
+    void run();
+    void executeCommands();
+    static bool pinToCpu(int cpuCore);
+
+    SpscQueue<Function> m_commands;
+    Function m_work;
+    std::thread m_thread;
+    int m_cpuCore = -1;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_workPending{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_PROCESSINGTHREAD_H
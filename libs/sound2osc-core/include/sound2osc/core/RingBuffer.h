@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Lock-free single-producer / multi-reader ring buffer
+
+#ifndef SOUND2OSC_CORE_RINGBUFFER_H
+#define SOUND2OSC_CORE_RINGBUFFER_H
+
+#include <sound2osc/core/CacheLine.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Ring buffer for one writer thread and any number of reader threads
+ *
+ * Elements are addressed by their absolute position, i.e. the number of
+ * elements written before them. The writer publishes its cursor after each
+ * chunk, readers can access the newest capacity() elements up to that cursor.
+ * Positions before the first write (down to -capacity()) read as T().
+ *
+ * The storage is twice as large as the readable range (rounded up to a power
+ * of two), so the writer never touches the readable range while it fills the
+ * next chunk. Readers take a Snapshot (a view of up to two contiguous spans),
+ * read it and then verify with isIntact() that it was not overwritten in the
+ * meantime. copy() does all of this and copies with memcpy.
+ */
+template<typename T>
+class RingBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer requires a trivially copyable type");
+
+public:
+    /**
+     * @brief View of a range of elements, split in two spans where it wraps around
+     */
+    struct Snapshot {
+        const T* first = nullptr;
+        int firstSize = 0;
+        const T* second = nullptr;
+        int secondSize = 0;
+        int64_t start = 0;  ///< absolute position of first[0]
+        bool valid = false;  ///< false if the range was not available
+
+        int size() const { return firstSize + secondSize; }
+    };
+
+    /**
+     * @brief Writable region returned by prepareWrite(), may also be split in two spans
+     */
+    struct WriteRegion {
+        T* first = nullptr;
+        int firstSize = 0;
+        T* second = nullptr;
+        int secondSize = 0;
+
+        int size() const { return firstSize + secondSize; }
+    };
+
+    explicit RingBuffer(int capacity)
+        : m_capacity(std::max(1, capacity))
+        , m_storage(storageSizeFor(m_capacity), T())
+        , m_mask(static_cast<int64_t>(m_storage.size()) - 1)
+        , m_maxChunk(static_cast<int>(m_storage.size()) - m_capacity)
+    {
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * @brief Number of elements that can be read behind the write cursor
+     */
+    int capacity() const { return m_capacity; }
+
+    /**
+     * @brief Number of elements ever written (the published write cursor)
+     */
+    int64_t writePosition() const { return m_writePosition.load(std::memory_order_acquire); }
+
+    // ------------------------- Writer -------------------------
+
+    /**
+     * @brief Get a region to write up to count elements into (writer thread only)
+     * The region may be smaller than requested, at most capacity() elements are
+     * handed out at once. Call commitWrite() afterwards to publish them.
+     */
+    WriteRegion prepareWrite(int count)
+    {
+        WriteRegion region;
+        count = std::min(std::max(0, count), m_maxChunk);
+        const int64_t position = m_writePosition.load(std::memory_order_relaxed);
+        const int offset = static_cast<int>(position & m_mask);
+        const int storageSize = static_cast<int>(m_storage.size());
+        region.first = m_storage.data() + offset;
+        region.firstSize = std::min(count, storageSize - offset);
+        region.second = m_storage.data();
+        region.secondSize = count - region.firstSize;
+        return region;
+    }
+
+    /**
+     * @brief Publish count elements written to the region from prepareWrite()
+     */
+    void commitWrite(int count)
+    {
+        const int64_t position = m_writePosition.load(std::memory_order_relaxed);
+        m_writePosition.store(position + count, std::memory_order_release);
+    }
+
+    /**
+     * @brief Append count elements (writer thread only)
+     */
+    void write(const T* data, int count)
+    {
+        while (count > 0) {
+            const WriteRegion region = prepareWrite(count);
+            std::memcpy(region.first, data, sizeof(T) * static_cast<std::size_t>(region.firstSize));
+            std::memcpy(region.second, data + region.firstSize, sizeof(T) * static_cast<std::size_t>(region.secondSize));
+            commitWrite(region.size());
+            data += region.size();
+            count -= region.size();
+        }
+    }
+
+    // ------------------------- Readers -------------------------
+
+    /**
+     * @brief Get a view of count elements starting at the absolute position start
+     * The snapshot is invalid if the range is not completely within the newest
+     * capacity() elements.
+     */
+    Snapshot snapshot(int64_t start, int count) const
+    {
+        Snapshot result;
+        result.start = start;
+        const int64_t end = writePosition();
+        if (count < 0 || count > m_capacity || start < end - m_capacity || start + count > end) {
+            return result;
+        }
+        const int offset = static_cast<int>(start & m_mask);
+        const int storageSize = static_cast<int>(m_storage.size());
+        result.first = m_storage.data() + offset;
+        result.firstSize = std::min(count, storageSize - offset);
+        result.second = m_storage.data();
+        result.secondSize = count - result.firstSize;
+        result.valid = true;
+        return result;
+    }
+
+    /**
+     * @brief Get a view of the newest count elements
+     */
+    Snapshot latest(int count) const
+    {
+        return snapshot(writePosition() - count, count);
+    }
+
+    /**
+     * @brief Check that the data of a snapshot read so far has not been overwritten
+     * Call this after reading the snapshot.
+     */
+    bool isIntact(const Snapshot& snapshot) const
+    {
+        if (!snapshot.valid) return false;
+        // order the data reads before the cursor read:
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the writer only modifies elements that are older than the readable range:
+        return snapshot.start >= m_writePosition.load(std::memory_order_relaxed) - m_capacity;
+    }
+
+    /**
+     * @brief Copy count elements starting at the absolute position start to dest
+     * @return false if the range is not (or no longer) available
+     */
+    bool copy(int64_t start, int count, T* dest) const
+    {
+        const Snapshot view = snapshot(start, count);
+        if (!view.valid) return false;
+        std::memcpy(dest, view.first, sizeof(T) * static_cast<std::size_t>(view.firstSize));
+        std::memcpy(dest + view.firstSize, view.second, sizeof(T) * static_cast<std::size_t>(view.secondSize));
+        return isIntact(view);
+    }
+
+    /**
+     * @brief Copy the newest count elements to dest
+     * @return absolute position of the first copied element
+     */
+    int64_t copyLatest(int count, T* dest) const
+    {
+        count = std::min(std::max(0, count), m_capacity);
+        int64_t start = writePosition() - count;
+        // retry if the writer overtook the reader (only possible if it was preempted
+        // for longer than it takes to write capacity() elements):
+        while (!copy(start, count, dest)) {
+            start = writePosition() - count;
+        }
+        return start;
+    }
+
+    /**
+     * @brief Element at an absolute position (not checked for being overwritten)
+     */
+    T at(int64_t position) const
+    {
+        return m_storage[static_cast<std::size_t>(position & m_mask)];
+    }
+
+private:
+    static std::size_t storageSizeFor(int capacity)
+    {
+        std::size_t size = 1;
+        while (size < static_cast<std::size_t>(capacity)) size <<= 1;
+        return size * 2;
+    }
+
+    const int m_capacity;  // number of readable elements
+    std::vector<T> m_storage;  // storage with a power of two size >= 2 * capacity
+    const int64_t m_mask;  // storage size - 1
+    const int m_maxChunk;  // max. number of elements written before publishing
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_writePosition{0};  // published write cursor
+    char m_padding[CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)] = {};  // keep following data off the cursor's cache line
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_RINGBUFFER_H
@@ -15,14 +15,21 @@
 #include <sound2osc/audio/MonoAudioBuffer.h>
 #include <sound2osc/audio/AudioInputInterface.h>
 #include <sound2osc/dsp/FFTAnalyzer.h>
+#include <sound2osc/dsp/STFTStage.h>
 #include <sound2osc/osc/OSCNetworkManager.h>
 #include <sound2osc/bpm/BPMDetector.h>
 #include <sound2osc/bpm/BPMOscControler.h>
 #include <sound2osc/trigger/TriggerGenerator.h>
+#include <sound2osc/trigger/TriggerBank.h>
 #include <sound2osc/config/ConfigStore.h>
 #include <sound2osc/config/SettingsManager.h>
+#include <sound2osc/core/ProcessingThread.h>
+#include <sound2osc/core/HopScheduler.h>
+#include <sound2osc/core/TripleBuffer.h>
 
 #include <atomic>
+#include <functional>
+#include <vector>
 
 namespace sound2osc {
 // class QAudioInputWrapper; // Removed as we use the interface base class
@@ -40,6 +47,32 @@ class Sound2OscEngine : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief Where the analysis pipeline (FFT, triggers, BPM) is executed
+     */
+    enum class ProcessingMode {
+        EventLoop,       ///< Queued to the thread of the engine (Qt main thread)
+        DedicatedThread  ///< On a separate worker thread fed by the audio callback
+    };
+
+    /**
+     * @brief Time without audio callbacks after which the trigger outputs are released (ms)
+     *
+     * The delays of the triggers (off delay, max hold) follow the sample
+     * position of the input, without new samples they do not end.
+     */
+    static constexpr int INPUT_STALL_TIMEOUT = 1000;
+
+    /**
+     * @brief Copy of the analysis data that the GUI displays
+     */
+    struct DisplaySnapshot {
+        std::vector<float> spectrum;  ///< normalized spectrum (0...1)
+        std::vector<float> flux;  ///< spectral flux history of the BPM detection, oldest first
+        std::vector<bool> onsets;  ///< onsets of the frames of the flux history
+        std::vector<SpectrumColor> colors;  ///< color of the frames of the flux history
+    };
+
     explicit Sound2OscEngine(std::shared_ptr<SettingsManager> settings, QObject *parent = nullptr);
     ~Sound2OscEngine() override;
 
@@ -51,7 +84,8 @@ public:
 
     /**
      * @brief Stop the processing engine
-     * Stops audio input and processing timers.
+     * Stops audio input and processing timers, active trigger outputs are
+     * released with their Off messages.
      */
     void stop();
 
@@ -75,15 +109,64 @@ public:
     TriggerGenerator* getEnvelope() { return m_envelope.get(); }
     TriggerGenerator* getSilence() { return m_silence.get(); }
 
+    // User defined bands, evaluated after the fixed triggers
+    TriggerBank* triggerBank() { return m_triggerBank.get(); }
+
+    /**
+     * @brief Latest display data of the analysis (thread of the engine only)
+     *
+     * The processing side copies the spectrum and the flux history after each
+     * analysis run, the GUI never reads the buffers of the analysis, which the
+     * worker thread writes and reallocates (e.g. when the sample rate changes).
+     * The reference stays valid until the next call.
+     */
+    const DisplaySnapshot& displaySnapshot();
+
     // -- Configuration --
     
     void setLowSoloMode(bool enabled);
     bool getLowSoloMode() const { return m_lowSoloMode; }
 
+    /**
+     * @brief Select where the analysis pipeline runs
+     * Takes effect on the next start(), a running engine is restarted.
+     * @param mode Processing mode
+     * @param cpuCore CPU core to pin the worker thread to (-1 = no affinity)
+     */
+    void setProcessingMode(ProcessingMode mode, int cpuCore = -1);
+    ProcessingMode getProcessingMode() const { return m_processingMode; }
+
+    /**
+     * @brief Set the distance between two analysis runs in samples
+     * FFT/trigger and BPM analysis run at exact positions of the input stream,
+     * independent of the size of the audio callbacks.
+     * @param fftHopSize Hop of the FFT and triggers, 0 = sample rate / 44
+     * @param bpmHopSize Hop of the BPM detection, 0 = sample rate / 44
+     */
+    void setAnalysisHopSizes(int fftHopSize, int bpmHopSize);
+
+    /**
+     * @brief Set the number of samples of one FFT of the spectrum analysis
+     * Small sizes react faster to transients, large sizes resolve low frequencies
+     * better. Applied by the processing side before the next analysis run.
+     * @param size Power of 2 from MIN_FFT_SIZE to MAX_FFT_SIZE (1024...8192)
+     */
+    void setFftSize(int size);
+
+    /**
+     * @brief Execute a change of DSP state without racing the analysis pipeline
+     *
+     * In DedicatedThread mode the command is passed to the worker thread through
+     * a lock-free queue and executed between two analysis runs. Otherwise (or when
+     * the engine is stopped) it is executed immediately.
+     * Must be called from the thread of the engine.
+     */
+    void runOnProcessingThread(std::function<void()> command);
+
     // -- Preset State Management --
     
     /**
-     * @brief Serialize the complete engine state (triggers, BPM settings, etc.) to JSON
+     * @brief Serialize the complete engine state (triggers, bands, BPM settings, etc.) to JSON
      */
     QJsonObject toState() const;
 
@@ -104,23 +187,50 @@ public slots:
     void applySettings();
 
 private slots:
-    void onFftTimer();
-    void onBpmTimer();
+    void onAnalysisDue();
     void onStatusTimer();
+    void onStallTimer();
 
 private:
     void initializeComponents();
     void connectComponents();
     void onAudioProcessed(int count);
+    void processAnalysis();
+    void runDueAnalysis();
+    void publishDisplay();
+    void releaseOutputs();
+    int beatLead(int64_t hopEnd);
+    void updateAnalysisSettings();
+    void applyState(const QJsonObject& state);
 
     bool m_running;
-    bool m_lowSoloMode;
-    std::atomic<int> m_accumulatedSamples{0};
+    std::atomic<bool> m_lowSoloMode;
+    std::atomic<bool> m_analysisPending{false};
+
+    // Analysis hops keyed on the sample counter of the audio buffer
+    // (only advanced on the processing side, isDue() is checked by the audio callback)
+    HopScheduler m_fftScheduler;
+    HopScheduler m_bpmScheduler;
+    std::atomic<int> m_fftHopSetting{0};  // 0 = derived from the sample rate
+    std::atomic<int> m_bpmHopSetting{0};  // 0 = derived from the sample rate
+    std::atomic<int> m_fftSizeSetting{NUM_SAMPLES};
+
+    // Position and time of the last audio callback, to measure how far the analysis lags behind
+    // the input (the beat ticks are sent ahead by this delay)
+    std::atomic<int64_t> m_audioPosition{0};
+    std::atomic<int64_t> m_audioTime{0};  // steady clock in ns
+    int64_t m_releasedAudioTime = 0;  // m_audioTime of the last release by onStallTimer()
+    std::atomic<int> m_beatLatencySetting{0};  // ms
+    double m_pipelineDelay = 0.0;  // samples, smoothed (processing side only)
+
+    ProcessingMode m_processingMode = ProcessingMode::EventLoop;
+    int m_processingCpu = -1;
 
     std::shared_ptr<SettingsManager> m_settings;
 
     // Components
     std::unique_ptr<MonoAudioBuffer> m_audioBuffer;
+    std::unique_ptr<STFTStage> m_stft;  // FFT frames shared by the FFT analyzer and the BPM detector
     std::unique_ptr<AudioInputInterface> m_audioInput;
     std::unique_ptr<OSCNetworkManager> m_osc;
     std::unique_ptr<BPMOscControler> m_bpmOsc;
@@ -133,16 +243,23 @@ private:
     std::unique_ptr<TriggerGenerator> m_high;
     std::unique_ptr<TriggerGenerator> m_envelope;
     std::unique_ptr<TriggerGenerator> m_silence;
+    std::unique_ptr<TriggerBank> m_triggerBank;
     
     // Container for FFTAnalyzer (which expects raw pointers)
     QVector<TriggerGeneratorInterface*> m_triggerInterfaces;
     
     std::unique_ptr<FFTAnalyzer> m_fft;
 
+    // display data, written by the processing side after each analysis run
+    TripleBuffer<DisplaySnapshot> m_display;
+
     // Timers
-    // QTimer m_fftTimer; // Removed in favor of event-driven loop
-    QTimer m_bpmTimer;
+    // FFT and BPM are driven by the hop schedulers from the audio callback
     QTimer m_statusTimer;
+    QTimer m_stallTimer;  // releases the trigger outputs when the input stalls
+
+    // Declared last so that it is joined before the components it uses are destroyed
+    ProcessingThread m_processingThread;
 };
 
 } // namespace sound2osc
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Bounded lock-free single-producer / single-consumer queue
+
+#ifndef SOUND2OSC_CORE_SPSCQUEUE_H
+#define SOUND2OSC_CORE_SPSCQUEUE_H
+
+#include <sound2osc/core/CacheLine.h>
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer and one consumer thread
+ *
+ * All slots are allocated in the constructor, push() and pop() never allocate
+ * themselves (moving T may, depending on the type). The capacity is rounded
+ * up to the next power of two.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : m_slots(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_slots.size() - 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an element (producer thread only)
+     * @return false if the queue is full, the element is left untouched then
+     */
+    bool push(T&& value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= m_slots.size()) {
+            return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (consumer thread only)
+     * @return false if the queue is empty
+     */
+    bool pop(T& value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Check if the queue is empty (approximate when called concurrently)
+     */
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return m_slots.size(); }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    std::vector<T> m_slots;
+    const std::size_t m_mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{0};  // next slot to read (consumer)
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{0};  // next slot to write (producer)
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_SPSCQUEUE_H
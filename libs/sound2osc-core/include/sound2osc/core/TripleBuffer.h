@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Lock-free hand-over of the latest value from one writer to one reader thread
+
+#ifndef SOUND2OSC_CORE_TRIPLEBUFFER_H
+#define SOUND2OSC_CORE_TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+namespace sound2osc {
+
+/**
+ * @brief Three buffers that pass the latest value from one writer thread to one reader thread
+ *
+ * The writer fills back() and calls publish(), the reader calls update()
+ * and reads front(). Neither side ever waits for the other: the buffers are
+ * only exchanged by swapping their indexes with an atomic "middle" buffer.
+ * The reader skips values that were published in the meantime and always
+ * gets the latest one. No allocations after the constructor.
+ *
+ * After publish() back() is one of the older buffers, the writer has to
+ * write the complete value again.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief Call function for each of the three buffers, e.g. to reserve memory
+     * Only before the writer and the reader use the buffers.
+     */
+    template<typename Function>
+    void initialize(Function function)
+    {
+        for (T& buffer : m_buffers) {
+            function(buffer);
+        }
+    }
+
+    /**
+     * @brief Buffer to write the next value to (writer thread only)
+     */
+    T& back() { return m_buffers[static_cast<std::size_t>(m_back)]; }
+
+    /**
+     * @brief Hand the value in back() over to the reader (writer thread only)
+     */
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * @brief Take the latest published value (reader thread only)
+     * @return true if front() changed since the last update()
+     */
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Value of the last update() (reader thread only)
+     */
+    const T& front() const { return m_buffers[static_cast<std::size_t>(m_front)]; }
+
+private:
+    static constexpr int INDEX = 3;  // mask of the buffer index
+    static constexpr int FRESH = 4;  // set if the middle buffer was not read yet
+
+    std::array<T, 3> m_buffers{};
+    std::atomic<int> m_middle{2};  // index of the middle buffer and FRESH flag
+    int m_back = 1;  // writer
+    int m_front = 0;  // reader
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_CORE_TRIPLEBUFFER_H
@@ -30,7 +30,12 @@ public:
 	virtual ~BasicFFTInterface() {}
 
 	// Calculates the FFT of a float array and writes the result to the output array.
+	// The output contains the real parts of the bins 0...N/2 followed by
+	// the negated imaginary parts of the bins 1...N/2-1 (layout of FFTReal).
 	virtual void doFft(float* output, const float* input) = 0;
+
+	// Returns the number of samples of the input (and output) array.
+	virtual int size() const = 0;
 };
 
 #endif // BASICFFTINTERFACE_H
@@ -25,6 +25,9 @@
 
 #include <sound2osc/dsp/BasicFFTInterface.h>
 #include <sound2osc/dsp/ScaledSpectrum.h>
+#include <sound2osc/dsp/STFTStage.h>
+#include <sound2osc/trigger/TimingWheel.h>
+#include <sound2osc/trigger/TriggerBatch.h>
 #include <sound2osc/trigger/TriggerGeneratorInterface.h>
 #include <sound2osc/audio/MonoAudioBuffer.h>
 
@@ -34,16 +37,15 @@
 #include <QDebug>
 #include <memory>
 
-// the number of samples used for FFT expressed as an exponent of 2
+// the default number of samples used for FFT expressed as an exponent of 2
 static constexpr int NUM_SAMPLES_EXPONENT = 12;
 
-// the real number of samples calculated from NUM_SAMPLES_EXPONENT
+// the default number of samples calculated from NUM_SAMPLES_EXPONENT
 static constexpr int NUM_SAMPLES = 1 << NUM_SAMPLES_EXPONENT;  // 2^12 = 4096
 
-// maximum absolute value in the result of the FFT
-// estimated from previous tests (exponent/samples: max value):
-// 11/2048: 51, 12/4096: 96, 13/8192: 195, 14/16384: 350
-static constexpr int MAX_FFT_VALUE = 96;
+// range of FFT sizes that can be selected at runtime (powers of 2)
+static constexpr int MIN_FFT_SIZE = 1024;  // ~23ms at 44.1kHz, fast transients
+static constexpr int MAX_FFT_SIZE = 8192;  // ~186ms at 44.1kHz, 5.4Hz bass resolution
 
 // number of frequency bins in the resulting ScaledSpectrum
 static constexpr int SCALED_SPECTRUM_LENGTH = 200;
@@ -51,20 +53,46 @@ static constexpr int SCALED_SPECTRUM_LENGTH = 200;
 // base frequency of the ScaledSpectrum in Hz
 static constexpr int SCALED_SPECTRUM_BASE_FREQ = 20;  // Hz
 
-// A class to prepare the content of an audio buffer for FFT,
-// calculate the FFT and create a ScaledSpectrum of the results.
-// Calls checkForTrigger() of a TriggerGeneratorContainer object when a new FFT is done.
+// A class to get the FFT of the content of an audio buffer from an STFTStage
+// and create a ScaledSpectrum of the results.
+// The STFTStage may be shared with other analysis stages (e.g. the BPMDetector),
+// frames of the same size and position are transformed only once.
+// Evaluates all triggers of a TriggerGeneratorContainer object with a TriggerBatch when a new FFT is done
+// and passes the resulting events to handleTriggerEvent() of the triggers that changed.
+// The delays of their TriggerFilters are scheduled in a TimingWheel that follows the
+// sample position of the analyzed samples.
+// The linear spectrum is normalized to the FFT size, so that a full scale sine
+// results in 1.0 independent of the selected size.
 class FFTAnalyzer
 {
 
 public:
-	explicit FFTAnalyzer(const MonoAudioBuffer& buffer, QVector<TriggerGeneratorInterface*>& m_triggerContainer);
+	// uses a private STFTStage if stft is nullptr
+	explicit FFTAnalyzer(const MonoAudioBuffer& buffer, QVector<TriggerGeneratorInterface*>& m_triggerContainer,
+						 sound2osc::STFTStage* stft = nullptr);
 	~FFTAnalyzer();
 
-	// calculates the FFT based on the data in the inputBuffer and updates the ScaledSpectrum
-	// - usually called periodically 44 times per second
+	// calculates the FFT based on the latest data in the inputBuffer and updates the ScaledSpectrum
     void calculateFFT(bool lowSoloMode);
 
+	// calculates the FFT of the samples that end at the absolute sample position endPosition
+	// - usually called by the engine for every analysis hop (44 times per second)
+	// - uses the latest samples if these samples are no longer in the buffer
+	void calculateFFT(bool lowSoloMode, int64_t endPosition);
+
+	// returns the number of samples of one FFT
+	int getFftSize() const { return m_fftSize; }
+
+	// sets the number of samples of one FFT
+	// - rounded down to a power of 2 in the range MIN_FFT_SIZE...MAX_FFT_SIZE
+	// - must not be called concurrently with calculateFFT()
+	void setFftSize(int size);
+
+	// releases the outputs of all triggers (see TriggerFilter::release())
+	// - to be called by the processing side when the analysis stops or the input stalls
+	// - the raw triggers start inactive with the next calculateFFT()
+	void releaseOutputs();
+
 	// returns the normalized spectrum of the ScaledSpectrum
 	const QVector<float>& getNormalizedSpectrum() const { return m_scaledSpectrum.getNormalizedSpectrum(); }
 
@@ -74,18 +102,32 @@ public:
 	// returns a modifiable ScaledSpectrum reference to change its parameters
 	ScaledSpectrum& getScaledSpectrum() { return m_scaledSpectrum; }
 
+	// returns the TimingWheel used by the TriggerFilters of all triggers
+	const sound2osc::TimingWheel& getTimingWheel() const { return m_timingWheel; }
+
 protected:
-	// calculates a Hann Window for FFT and saves it to m_window
-	void calculateWindow();
+	// updates spectrum and triggers with a frame of the STFTStage
+	// - uses m_lowSoloMode and m_hopEnd of the calculateFFT() call
+	void analyzeFrame(const sound2osc::STFTFrame& frame);
+
+	// copies changed trigger parameters to m_triggerBatch
+	// - attaches the TriggerFilters of new triggers to m_timingWheel
+	void updateTriggerBatch();
 
 	const MonoAudioBuffer&	m_inputBuffer;  // buffer that stores the audio samples
+	int						m_fftSize;  // number of samples of one FFT
+	float					m_normalization;  // factor to scale FFT magnitudes to 0...1
 	QVector<TriggerGeneratorInterface*>& m_triggerContainer;  // list of all controlled triggerGenerators
-	std::unique_ptr<BasicFFTInterface> m_fft;  // FFT implementation
-	QVector<float>			m_buffer;  // buffer for prepared data (intermediate result)
-	QVector<float>			m_window;  // array with window data
-	QVector<float>			m_fftOutput;  // buffer containing the FFT output (intermediate result)
+	std::unique_ptr<sound2osc::STFTStage> m_ownStft;  // STFTStage if none is shared
+	sound2osc::STFTStage*	m_stft;  // computes the windowed FFT
+	int						m_subscription;  // subscription at m_stft (frames on request)
+	bool					m_lowSoloMode;  // low solo mode of the current calculateFFT() call
+	int64_t					m_hopEnd;  // end position of the hop of the current calculateFFT() call
+	bool					m_analyzed;  // true if a frame was analyzed in the current calculateFFT() call
 	QVector<float>			m_linearSpectrum;  // buffer containing the non-scaled spectrum data (intermediate result)
 	ScaledSpectrum			m_scaledSpectrum;  // stores the scaled data of the spectrum
+	sound2osc::TriggerBatch	m_triggerBatch;  // thresholds, band ranges and state of all triggers (same indexes as m_triggerContainer)
+	sound2osc::TimingWheel	m_timingWheel;  // on / off delays and max hold of all TriggerFilters
 };
 
 #endif // FFTWRAPPER_H
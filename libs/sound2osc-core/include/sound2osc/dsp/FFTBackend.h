@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Registry of the available FFT implementations
+
+#ifndef SOUND2OSC_DSP_FFTBACKEND_H
+#define SOUND2OSC_DSP_FFTBACKEND_H
+
+#include <sound2osc/dsp/BasicFFTInterface.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sound2osc {
+namespace FFTBackend {
+
+/**
+ * @brief Names of the compiled in backends
+ *
+ * - "ffft": the bundled FFTReal (sizes 2^3 ... 2^16)
+ * - "radix": native radix-2/4 FFT with split storage (RadixFFT)
+ * - "fftw": FFTW single precision, if it was found at configure time
+ *
+ * All backends produce the output layout of FFTReal (see BasicFFTInterface).
+ */
+std::vector<std::string> available();
+
+/**
+ * @brief Create an FFT of a specific backend
+ * @param name Name of a backend from available()
+ * @param size Number of samples, a power of two
+ * @return nullptr if the backend is unknown or does not support the size
+ */
+std::unique_ptr<BasicFFTInterface> create(const std::string& name, int size);
+
+/**
+ * @brief Create an FFT with the selected backend (see select())
+ * Falls back to "ffft" if the selected backend does not support the size.
+ */
+std::unique_ptr<BasicFFTInterface> create(int size);
+
+/**
+ * @brief Select the backend used by create(int)
+ * @param name Name of a backend from available() or "auto" (default) to use
+ *             the fastest backend for each size, measured on first use
+ * @return false if the name is unknown, the selection is unchanged then
+ */
+bool select(const std::string& name);
+
+/**
+ * @brief The selected backend name or "auto"
+ */
+std::string selected();
+
+/**
+ * @brief Name of the fastest backend for the given size
+ * Every backend is timed once per size, the result is cached.
+ */
+std::string fastest(int size);
+
+} // namespace FFTBackend
+} // namespace sound2osc
+
+#endif // SOUND2OSC_DSP_FFTBACKEND_H
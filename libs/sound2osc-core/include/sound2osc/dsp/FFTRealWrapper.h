@@ -45,6 +45,8 @@ public:
 
 	void doFft(float *output, const float *input) override { m_fftreal.do_fft(output, input); }
 
+	int size() const override { return 1 << LENGTH_EXPONENT; }
+
 protected:
 	ffft::FFTRealFixLen<LENGTH_EXPONENT> m_fftreal;
 };
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Branch free approximations of log2, exp2 and pow for per-bin DSP loops
+
+#ifndef SOUND2OSC_DSP_FASTMATH_H
+#define SOUND2OSC_DSP_FASTMATH_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace sound2osc {
+namespace FastMath {
+
+// All functions only use arithmetic on the results of comparisons instead of
+// branches or ternaries, because the compiler does not turn float comparisons
+// into selects without -fno-trapping-math. Loops over arrays that call them
+// are vectorized.
+
+/**
+ * @brief x limited to [low, high]
+ */
+inline float clamp(float x, float low, float high)
+{
+    const float below = static_cast<float>(x < low);
+    const float above = static_cast<float>(x > high);
+    x += below * (low - x);
+    return x + above * (high - x);
+}
+
+/**
+ * @brief log2(x) for normal positive floats, absolute error < 4e-6
+ *
+ * The exponent is taken from the bits of x, the mantissa is reduced to
+ * [0.71, 1.41) and log2 of it is computed with the series of atanh.
+ * Zero, denormals and negative values must be clamped by the caller.
+ */
+inline float log2(float x)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127;
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    // move the mantissa to [sqrt(0.5), sqrt(2)) to keep t small:
+    const int high = static_cast<int>(mantissa > 1.41421356f);
+    mantissa *= 1.0f - 0.5f * static_cast<float>(high);
+    exponent += high;
+
+    // log2(m) = 2 / ln(2) * atanh(t) with t = (m - 1) / (m + 1), |t| < 0.172
+    const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float t2 = t * t;
+    const float series = t * (2.88539008f + t2 * (0.961796693f + t2 * (0.577078016f + t2 * 0.412198583f)));
+    return static_cast<float>(exponent) + series;
+}
+
+/**
+ * @brief 2^y, relative error < 3e-7, y is clamped to [-126, 126]
+ */
+inline float exp2(float y)
+{
+    // split into integer and fraction, the bias makes the truncation a floor:
+    y = FastMath::clamp(y, -126.0f, 126.0f);
+    const int integer = static_cast<int>(y + 127.0f);
+    // 2^f = sqrt(2) * e^g with g = (f - 0.5) * ln(2), |g| <= 0.347
+    const float g = (y - static_cast<float>(integer - 127) - 0.5f) * 0.693147181f;
+    const float series = 1.0f + g * (1.0f + g * (0.5f + g * (0.166666667f + g * (0.0416666667f
+                         + g * (0.00833333333f + g * 0.00138888889f)))));
+    const std::uint32_t bits = static_cast<std::uint32_t>(integer) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return scale * 1.41421356f * series;
+}
+
+/**
+ * @brief x^exponent for x >= 0 (0 for x <= 1e-30), relative error < 1e-5 for moderate exponents
+ */
+inline float pow(float x, float exponent)
+{
+    const float positive = static_cast<float>(x > 1e-30f);
+    const float base = x + (1.0f - positive) * (1e-30f - x);
+    return positive * FastMath::exp2(exponent * FastMath::log2(base));
+}
+
+} // namespace FastMath
+} // namespace sound2osc
+
+#endif // SOUND2OSC_DSP_FASTMATH_H
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Native real FFT with split real/imaginary storage
+
+#ifndef SOUND2OSC_DSP_RADIXFFT_H
+#define SOUND2OSC_DSP_RADIXFFT_H
+
+#include <sound2osc/dsp/BasicFFTInterface.h>
+
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Real FFT of any power of two size, computed as a complex FFT of half the size
+ *
+ * The complex FFT is an iterative radix-2 FFT on separate real and imaginary
+ * arrays, so the butterflies of the later stages run over contiguous memory
+ * and are vectorized by the compiler. Pairs of stages are merged into
+ * radix-4 passes to halve the memory traffic. All tables are computed in
+ * the constructor, doFft() does not allocate.
+ *
+ * The output has the layout of FFTReal, i.e. real parts of the bins 0...N/2
+ * followed by the negated imaginary parts of the bins 1...N/2-1, so it can
+ * replace FFTRealWrapper without changes to the callers.
+ */
+class RadixFFT : public BasicFFTInterface
+{
+public:
+    /**
+     * @param size Number of input samples, a power of two >= 8
+     */
+    explicit RadixFFT(int size);
+
+    void doFft(float* output, const float* input) override;
+    int size() const override { return m_size; }
+
+private:
+    void complexFft();
+    void radix2Pass(int h);
+    void radix4Pass(int h);
+
+    const int m_size;  // number of real input samples
+    const int m_half;  // size of the complex FFT
+    std::vector<int> m_bitReverse;  // input index for each position of the complex FFT
+    std::vector<float> m_twiddleRe;  // twiddles of each stage, stage with h butterflies starts at index h
+    std::vector<float> m_twiddleIm;
+    std::vector<float> m_postRe;  // twiddles to split the complex result into the real spectrum
+    std::vector<float> m_postIm;
+    std::vector<float> m_re;  // working buffers of the complex FFT
+    std::vector<float> m_im;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_DSP_RADIXFFT_H
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Short-time Fourier transform of the input shared by all analysis stages
+
+#ifndef SOUND2OSC_DSP_STFTSTAGE_H
+#define SOUND2OSC_DSP_STFTSTAGE_H
+
+#include <sound2osc/dsp/BasicFFTInterface.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class MonoAudioBuffer;
+
+namespace sound2osc {
+
+/**
+ * @brief One windowed spectrum of the input, passed to the subscribers of an STFTStage
+ *
+ * Only valid during the callback. The FFT output is shared by all
+ * subscribers that receive the frame, so it must not be modified.
+ */
+class STFTFrame
+{
+public:
+    /**
+     * @brief Number of samples of the window (FFT size)
+     */
+    int size() const { return m_size; }
+
+    /**
+     * @brief Absolute sample position after the last sample of the window
+     */
+    int64_t endPosition() const { return m_endPosition; }
+
+    /**
+     * @brief FFT of the Hann windowed samples in the layout of BasicFFTInterface
+     * (size() values, not normalized)
+     */
+    const float* fftOutput() const { return m_fftOutput; }
+
+    /**
+     * @brief Magnitude of the bins 0 ... size() / 2 - 1 (not normalized)
+     * Calculated when the first subscriber asks for it.
+     */
+    const float* magnitudes() const;
+
+private:
+    friend class STFTStage;
+
+    int m_size = 0;
+    int64_t m_endPosition = 0;
+    const float* m_fftOutput = nullptr;
+    mutable float* m_magnitudes = nullptr;
+    mutable bool m_hasMagnitudes = false;
+};
+
+/**
+ * @brief Computes each windowed spectrum of the input once for all consumers
+ *
+ * The FFT analyzer (trigger spectrum) and the BPM detector (spectral flux,
+ * waveform colours) each windowed and transformed the samples of the input
+ * buffer with their own FFT. Now every consumer subscribes with the size of
+ * its window and its hop, and the stage publishes the frames that are due.
+ * A frame is transformed once for all subscriptions that need the same size
+ * at the same end position, e.g. the spectral flux and the waveform colours,
+ * or consumers of the same size whose hops are multiples of each other.
+ *
+ * A subscription with a hop of 0 only gets the frames requested with
+ * request(), for consumers that are driven by a HopScheduler.
+ *
+ * The FFT, window and buffers of a window size are created on first use and
+ * kept when no subscription uses the size anymore. Creating an FFT can be
+ * slow (the "auto" backend times every backend, FFTW plans the transform),
+ * so the owner creates the sizes that the analysis can switch to with
+ * prepare() before the analysis runs.
+ *
+ * Frames whose samples are no longer in the buffer are skipped. The stage is
+ * not thread safe, all functions are called from the analysis side (or
+ * before it runs). The callbacks must not subscribe or unsubscribe.
+ */
+class STFTStage
+{
+public:
+    using Callback = std::function<void(const STFTFrame&)>;
+
+    explicit STFTStage(const MonoAudioBuffer& buffer);
+    ~STFTStage();
+
+    STFTStage(const STFTStage&) = delete;
+    STFTStage& operator=(const STFTStage&) = delete;
+
+    /**
+     * @brief Subscribe to the frames of size samples every hop samples
+     * @param size Number of samples of the window, a power of two
+     * @param hop Samples between two frames, 0 for frames on request()
+     * @return id of the subscription
+     * The first frame ends size samples after the current input position.
+     */
+    int subscribe(int size, int hop, Callback callback);
+
+    void unsubscribe(int id);
+
+    /**
+     * @brief Create the FFT, window and buffers of a window size in advance
+     * Subscribing to or switching to a prepared size does not allocate.
+     */
+    void prepare(int size);
+
+    /**
+     * @brief Change the window size and hop of a subscription
+     * The next frame ends size samples after the current input position.
+     */
+    void setFormat(int id, int size, int hop);
+
+    /**
+     * @brief Set the end position of the next frame of a subscription
+     */
+    void restart(int id, int64_t endPosition);
+
+    /**
+     * @brief Request the frame that ends at endPosition and publish all due frames up to it
+     * The frame is skipped if its samples are not (or no longer) in the buffer.
+     */
+    void request(int id, int64_t endPosition);
+
+    /**
+     * @brief Publish all frames of all subscriptions that end up to endPosition (oldest first)
+     */
+    void process(int64_t endPosition);
+
+    /**
+     * @brief Number of FFTs computed since construction (for tests and benchmarks)
+     */
+    uint64_t transformCount() const { return m_transformCount; }
+
+private:
+    struct Subscription
+    {
+        int id;
+        int size;
+        int hop;
+        int64_t next;  // end position of the next frame, INT64_MAX if none is due
+        Callback callback;
+    };
+
+    // FFT, window and buffers of one window size
+    struct Transform
+    {
+        int size;
+        std::unique_ptr<BasicFFTInterface> fft;
+        std::vector<float> window;
+        std::vector<float> samples;
+        std::vector<float> output;
+        std::vector<float> magnitudes;
+    };
+
+    Subscription* find(int id);
+    Transform& transform(int size);
+
+    // windows and transforms the samples of the frame, false if they are not in the buffer
+    bool compute(Transform& transform, int64_t endPosition);
+
+    // end position of the first frame after endPosition whose samples can still be in the buffer
+    int64_t firstAvailable(const Subscription& subscription) const;
+
+    const MonoAudioBuffer& m_inputBuffer;
+    std::vector<Subscription> m_subscriptions;
+    std::vector<Transform> m_transforms;
+    int m_nextId;
+    uint64_t m_transformCount;
+    STFTFrame m_frame;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_DSP_STFTSTAGE_H
@@ -28,12 +28,24 @@
 
 #include <QVector>
 
+#include <atomic>
+
+// upper end of the scaled frequency axis in Hz
+// (independent from the sample rate, so that positions on the axis are stable)
+static constexpr qreal SCALED_SPECTRUM_MAX_FREQ = 22050.0;  // Hz
+
 // ----------------- AGC Constants -----------------
 
 // AGC = Automatic Gain Control
 
-// number of samples to average for the AGC calculation
-static const int AGC_AVERAGING_LENGTH = 44*2;  // samples
+// the AGC timings are given in seconds, the steps per frame are derived from the frame rate
+// (see ScaledSpectrum::setFrameRate())
+
+// default number of spectrum updates per second
+static constexpr float AGC_DEFAULT_FRAME_RATE = 44.0f;  // fps
+
+// duration of the last max values to average for the AGC calculation
+static constexpr float AGC_AVERAGING_TIME = 2.0f;  // s
 
 // headroom to leave when using AGC [0...1]
 static constexpr float AGC_HEADROOM = 0.1f;  // 10%
@@ -41,13 +53,11 @@ static constexpr float AGC_HEADROOM = 0.1f;  // 10%
 // min value for AGC to be active == max value of noise [0...1]
 static constexpr float AGC_NOISE_THRESHOLD = 0.1f; // 10%
 
-// amount to increase the gain per frame when gain is too low
-// i.e. 1 / <frames needed to increase the gain from 0 to 1>
-static constexpr float AGC_INCREMENT_STEPSIZE = 1.0f / (3*44);  // 3s * 44fps
+// time to increase the gain from 0 to 1 when gain is too low
+static constexpr float AGC_INCREMENT_TIME = 3.0f;  // s
 
-// amount to decrease the gain per frame when gain is too high
-// i.e. 1 / <frames needed to decrease the gain from 1 to 0>
-static constexpr float AGC_DECREMENT_STEPSIZE = 1.0f / (1*44);  // 1s * 44fps
+// time to decrease the gain from 1 to 0 when gain is too high
+static constexpr float AGC_DECREMENT_TIME = 1.0f;  // s
 
 // minimum gain of AGC
 static constexpr float AGC_MIN_GAIN = 0.5f;
@@ -88,6 +98,18 @@ public:
 	// sets if the AGC is enabled
 	void setAgcEnabled(bool value) { m_agcEnabled = value; }
 
+	// returns the sample rate of the linear spectrum in Hz
+	int getSampleRate() const { return m_sampleRate; }
+	// sets the sample rate of the linear spectrum to map its bins to frequencies
+	// - bins above SCALED_SPECTRUM_MAX_FREQ are ignored, missing bins read as 0
+	void setSampleRate(int sampleRate) { m_sampleRate = qMax(1, sampleRate); }
+
+	// returns the number of updates per second the AGC timings are based on
+	float getFrameRate() const { return m_frameRate; }
+	// sets the number of updates per second (sample rate / hop size)
+	// - resets the AGC history if the value changed
+	void setFrameRate(float framesPerSecond);
+
 	// Scales the incoming linear spectrum to a logarithmic spectrum.
 	// Results will be written in dbSpectrum and normSpectrum.
 	void updateWithLinearSpectrum(const QVector<float>& linearSpectrum);
@@ -105,28 +127,64 @@ public:
 	// returns the energy level of a certain frequency
 	float getLevelAtFreq(const int& freq) const { return m_normSpectrum[getIndexForFreq(freq)]; }
 
+	// calculates the range of indexes [startIndex...endIndex] of a frequency band
+	// - width is relative to the whole spectrum [0...1]
+	void getBandRange(const int& midFreq, const qreal& width, int& startIndex, int& endIndex) const;
+
 	// returns the max level within a frequency band
 	float getMaxLevel(const int& midFreq, const qreal& width) const;
 
+	// returns the max level between two indexes (both included) in O(1)
+	// - used by triggers that cached their range with getBandRange()
+	float getMaxLevel(int startIndex, int endIndex) const;
+
+	// writes the max levels of count ranges to maxLevels (same as getMaxLevel(startIndex, endIndex) for each)
+	// - used by the TriggerBatch to query all bands without a call per band
+	void getMaxLevels(const int* startIndexes, const int* endIndexes, float* maxLevels, int count) const;
+
 	// returns the overall max level
-	float getMaxLevel() const;
+	float getMaxLevel() const { return m_maxLevel; }
 
 private:
 	// calculates the required gain and changes the actual gain in small steps
 	// based on the last maximum values of the FFT
 	void updateAGC();
 
+	// calculates the range of linear bins of each scaled band
+	// - only called when the length or the sample rate of the linear spectrum changed
+	void updateBinMap(int linearLength);
+
+	// builds the sparse table of range maxima of the normalized spectrum
+	// - called once per update, so that any number of band queries are O(1)
+	void updateRangeMax();
+
 protected:
 	const int		m_baseFreq;  // lowest frequency of input data
 	const int		m_scaledLength;  // resulting number of frequency bins after scaling
 	qreal			m_freqScaleFactor;  // internal factor used to calculate the scaled frequencies
 	qreal			m_logOfFreqScaleFactor;  // log of m_freqScaleFactor (often used in calculations)
-	float			m_gain;  // Gain factor
-	float			m_compression;  // Compression factor (the higher it is the more the energy values get compressed)
-	bool			m_convertToDecibel;  // true if the energy values should be converted to dB
+	int				m_sampleRate;  // sample rate of the linear spectrum in Hz
+	// parameters are atomic because they are changed by the UI while the spectrum
+	// may be updated on the processing thread:
+	std::atomic<float>	m_gain;  // Gain factor
+	std::atomic<float>	m_compression;  // Compression factor (the higher it is the more the energy values get compressed)
+	std::atomic<bool>	m_convertToDecibel;  // true if the energy values should be converted to dB
 	QVector<float>	m_normSpectrum;  // stores the spectrum with energy values between 0 and 1
-	bool			m_agcEnabled;  // true if AGC is enabled
+	std::atomic<bool>	m_agcEnabled;  // true if AGC is enabled
+	float			m_frameRate;  // number of updates per second
+	float			m_agcIncrementStep;  // amount to increase the gain per frame when gain is too low
+	float			m_agcDecrementStep;  // amount to decrease the gain per frame when gain is too high
 	Qt3DCore::QCircularBuffer<float> m_lastMaxValues;  // list of last maximum energy values used for AGC
+	int				m_mappedLength;  // length of the linear spectrum the bin map was calculated for
+	int				m_mappedSampleRate;  // sample rate the bin map was calculated for
+	QVector<int>	m_bandStart;  // first linear bin of each band
+	QVector<int>	m_bandCount;  // number of linear bins of each band (0 above the Nyquist frequency)
+	QVector<float>	m_bandEnergy;  // summed energy of each band (intermediate result)
+	// sparse table: level k stores the max of the 2^k values starting at each index
+	// (level 0 is the normalized spectrum itself, level k starts at k * m_scaledLength)
+	QVector<float>	m_rangeMax;
+	QVector<int>	m_rangeLevel;  // floor(log2(n)) for each range length n
+	float			m_maxLevel;  // overall max level of the last update
 };
 
 #endif // SPECTRUM_H
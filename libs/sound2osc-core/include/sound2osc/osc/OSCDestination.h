@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Additional OSC target and the route masks that select the targets of a message
+
+#ifndef SOUND2OSC_OSC_OSCDESTINATION_H
+#define SOUND2OSC_OSC_OSCDESTINATION_H
+
+#include <QHostAddress>
+#include <QString>
+#include <QVariant>
+
+#include <cstdint>
+
+namespace sound2osc {
+
+/**
+ * @brief Bit masks that select the destinations of a message
+ *
+ * Bit n selects destination n. Destination 0 is the primary destination
+ * configured by the OSC settings (address, ports, TCP and OSC 1.1), the
+ * destinations 1 to MAX_DESTINATIONS - 1 are the entries of the destination
+ * table of OSCNetworkManager.
+ */
+namespace OSCRoutes {
+
+using Mask = uint32_t;
+
+constexpr int MAX_DESTINATIONS = 32;
+
+/**
+ * @brief Only the primary destination, the default of all messages
+ */
+constexpr Mask PRIMARY = 1u;
+
+constexpr Mask ALL = 0xffffffffu;
+
+/**
+ * @brief Default of OSCNetworkManager::sendMessage(): the feedback routes for
+ * forced messages (the status of sound2osc), the primary destination for others
+ */
+constexpr Mask DEFAULT = 0;
+
+constexpr Mask forDestination(int index) { return Mask(1) << index; }
+
+} // namespace OSCRoutes
+
+/**
+ * @brief An additional target of the OSC output (e.g. a media server or a visualizer)
+ */
+struct OSCDestination
+{
+    enum class Protocol {
+        Udp,
+        Tcp,  ///< TCP with OSC 1.0 framing (packet size before each packet)
+        Slip  ///< TCP with OSC 1.1 SLIP framing
+    };
+
+    QString name;
+    QHostAddress address = QHostAddress(QHostAddress::LocalHost);
+    quint16 port = 8000;
+    Protocol protocol = Protocol::Udp;
+    bool enabled = true;
+
+    bool operator==(const OSCDestination& other) const;
+    bool operator!=(const OSCDestination& other) const { return !(*this == other); }
+
+    /**
+     * @brief Map with the keys name, host, port, protocol and enabled (for the settings)
+     */
+    QVariantMap toVariant() const;
+    static OSCDestination fromVariant(const QVariant& value);
+
+    /**
+     * @brief Name of a protocol used in settings ("udp", "tcp", "slip")
+     */
+    static QString protocolName(Protocol protocol);
+
+    /**
+     * @brief Protocol of a name of protocolName(), Udp if the name is unknown
+     */
+    static Protocol protocolFromName(const QString& name);
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_OSCDESTINATION_H
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Collects the OSC packets of one analysis frame into size limited bundles
+
+#ifndef SOUND2OSC_OSC_OSCFRAMEBUNDLER_H
+#define SOUND2OSC_OSC_OSCFRAMEBUNDLER_H
+
+#include <sound2osc/osc/OSCDestination.h>
+
+#include <QByteArray>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Packs the encoded packets of one analysis frame into OSC bundles
+ *
+ * Without bundling every trigger message of a frame is sent as a datagram
+ * of its own. The bundler collects the packets and packs them into as few
+ * "#bundle" packets as possible, each of them at most maxBundleSize() bytes
+ * (the UDP payload that fits into one Ethernet frame by default), so the
+ * bundles are not fragmented on the way. A packet that does not fit into an
+ * empty bundle is sent in a bundle of its own. The order of the packets is
+ * kept.
+ *
+ * Each packet has a route mask (see OSCRoutes). takeRouted() groups the
+ * destinations that receive the same packets, so the bundles are created
+ * once per group and not once per destination.
+ *
+ * Not thread safe, used by the thread that runs the analysis.
+ */
+class OSCFrameBundler
+{
+public:
+    /**
+     * @brief Default maximum bundle size: 1500 bytes Ethernet MTU - 20 bytes IPv4 - 8 bytes UDP header
+     */
+    static constexpr int DEFAULT_MAX_BUNDLE_SIZE = 1472;
+
+    /**
+     * @brief Smallest maximum bundle size: header, one element size and the shortest message
+     */
+    static constexpr int MIN_BUNDLE_SIZE = 32;
+
+    /**
+     * @brief Size of "#bundle" and the time tag
+     */
+    static constexpr int BUNDLE_HEADER_SIZE = 16;
+
+    int maxBundleSize() const { return m_maxBundleSize; }
+    void setMaxBundleSize(int size);
+
+    /**
+     * @brief Datagrams of a frame for all destinations of routes
+     */
+    struct RoutedDatagrams
+    {
+        OSCRoutes::Mask routes = 0;
+        std::vector<QByteArray> datagrams;
+    };
+
+    /**
+     * @brief Add an encoded OSC packet (message or bundle) for the destinations of routes
+     */
+    void add(const QByteArray& packet, OSCRoutes::Mask routes = OSCRoutes::PRIMARY);
+
+    bool isEmpty() const { return m_packets.empty(); }
+    int packetCount() const { return static_cast<int>(m_packets.size()); }
+
+    /**
+     * @brief Remove all collected packets without creating bundles
+     */
+    void clear() { m_packets.clear(); m_routes.clear(); }
+
+    /**
+     * @brief Pack all collected packets into bundles with the given time tag and remove them
+     */
+    std::vector<QByteArray> takeBundles(uint64_t timeTag);
+
+    /**
+     * @brief Remove and return the collected packets without bundling them
+     */
+    std::vector<QByteArray> takePackets();
+
+    /**
+     * @brief Remove the collected packets grouped by the destinations that receive them
+     * @param bundle true to pack the packets of each group into bundles with timeTag
+     */
+    std::vector<RoutedDatagrams> takeRouted(bool bundle, uint64_t timeTag);
+
+    /**
+     * @brief A bundle with only the given packet, e.g. to give a message of a frame a later time tag
+     */
+    static QByteArray bundle(const QByteArray& packet, uint64_t timeTag);
+
+    /**
+     * @brief OSC (NTP) time tag of a point in time: seconds since 1900 and a 32 bit fraction
+     */
+    static uint64_t toTimeTag(std::chrono::system_clock::time_point time);
+
+private:
+    std::vector<QByteArray> packBundles(const std::vector<QByteArray>& packets, uint64_t timeTag) const;
+
+    int m_maxBundleSize = DEFAULT_MAX_BUNDLE_SIZE;
+    std::vector<QByteArray> m_packets;
+    std::vector<OSCRoutes::Mask> m_routes;  // route mask of each packet
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_OSCFRAMEBUNDLER_H
@@ -25,13 +25,26 @@
 
 #include <sound2osc/osc/OSCParser.h>
 #include <sound2osc/osc/OSCMessage.h>
+#include <sound2osc/osc/OSCPacketTemplate.h>
+#include <sound2osc/osc/OSCFrameBundler.h>
+#include <sound2osc/osc/UdpBatchSender.h>
+#include <sound2osc/osc/UdpSendSocket.h>
+#include <sound2osc/osc/OSCDestination.h>
+#include <sound2osc/osc/OSCStreamDeframer.h>
 #include <sound2osc/core/utils.h>
 
+#include <QMutex>
 #include <QObject>
 #include <QTcpSocket>
 #include <QUdpSocket>
 #include <QTimer>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class QThread;
 
 // time to try to connect again after an error in ms
 static const int TRY_CONNECT_AGAIN_TIME = 3000;  // ms
@@ -52,6 +65,9 @@ static const int MAX_LOG_LENGTH = 1000;
 // A class that manages OSC data exchange.
 // It can send and receive OSC messages via UDP and TCP
 // and supports OSC 1.0 and 1.1 packet-framing.
+// Messages may be sent from any thread. Other threads than the owner thread
+// (i.e. the processing thread) send UDP datagrams themselves through a socket
+// of their own, only TCP packets and the log are passed to the owner thread.
 class OSCNetworkManager : public QObject
 {
 	Q_OBJECT
@@ -69,7 +85,7 @@ public:
 	// returns the port to send UDP messages to
 	quint16 getUdpTxPort() const { return m_udpTxPort; }
 	// sets the port to send UDP messages to
-	void setUdpTxPort(const quint16& value) { m_udpTxPort = limit(0, value, 65535); updateUdpBinding(); emit addressChanged(); }
+	void setUdpTxPort(const quint16& value) { m_udpTxPort = limit(0, value, 65535); updateUdpBinding(); updateSendTargets(); emit addressChanged(); }
 
 	// returns the port to receive UDP messages from
 	quint16 getUdpRxPort() const { return m_udpRxPort; }
@@ -90,7 +106,7 @@ public:
 	QString getEosUser() const { return m_eosUser; }
 
 	// sets the user used for Eos messages (default is 0 -> Background User)
-	void setEosUser(QString value) { m_eosUser = value; }
+	void setEosUser(QString value) { m_eosUser = value; updateSendTargets(); }
 
 	// returns if TCP is used to send OSC messages
 	bool getUseTcp() const { return m_useTcp; }
@@ -105,6 +121,50 @@ public:
 	// returns if the TCP socket is connected, returns true if UDP is used
 	bool isConnected() const;
 
+	// returns the additional destinations, entry n - 1 is destination n of the route masks
+	// (destination 0 is the primary destination configured above)
+	const QList<sound2osc::OSCDestination>& getDestinations() const { return m_destinations; }
+	// sets the additional destinations (at most 31), TCP destinations are connected
+	void setDestinations(const QList<sound2osc::OSCDestination>& destinations);
+
+	// returns the destinations of forced messages that are sent without routes (feedback of sound2osc)
+	sound2osc::OSCRoutes::Mask getFeedbackRoutes() const { return m_feedbackRoutes; }
+	// sets the destinations of forced messages that are sent without routes (default is the primary destination)
+	void setFeedbackRoutes(sound2osc::OSCRoutes::Mask value) { m_feedbackRoutes = value; }
+
+	// returns if the messages of an analysis frame are sent as OSC bundles
+	bool getBundleFrames() const { return m_bundleFrames; }
+	// sets if the messages of an analysis frame are sent as OSC bundles (default is false)
+	void setBundleFrames(bool value) { m_bundleFrames = value; }
+
+	// returns the maximum size of a bundle in bytes
+	int getMaxBundleSize() const { return m_maxBundleSize; }
+	// sets the maximum size of a bundle in bytes, larger frames are split into several bundles
+	// (default is 1472 bytes, the UDP payload of one Ethernet frame)
+	void setMaxBundleSize(int value) { m_maxBundleSize = qMax(sound2osc::OSCFrameBundler::MIN_BUNDLE_SIZE, value); }
+
+	// ------------------- Frame Bundling --------------------
+
+	// starts to collect the messages sent by the calling thread (i.e. during one analysis pass)
+	// does nothing if frames are neither bundled nor sent with one sendmmsg() call
+	// the Eos user must not be changed while a frame is open
+	void beginFrame();
+
+	// sends the messages collected since beginFrame(), as OSC bundles with the
+	// time tag of beginFrame() if bundling is enabled
+	// UDP datagrams are sent with one system call if supported (see UdpBatchSender)
+	void endFrame();
+
+	// returns if the messages sent by the calling thread get a time tag (a frame with bundling is open)
+	bool isFrameTimeTagged() const;
+
+	// Sends a message that is due delay seconds after the time tag of the current frame (i.e. a predicted beat)
+	// - with isFrameTimeTagged() it gets a bundle of its own in the frame with the later time tag,
+	//   a receiver that supports time tags executes it on time
+	// - otherwise it is sent right away
+	void sendMessageAt(double delay, const sound2osc::OSCPacketTemplate& message, double value = 0.0,
+					   sound2osc::OSCRoutes::Mask routes = sound2osc::OSCRoutes::DEFAULT);
+
 	// ------------------- Logging --------------------
 
 	// returns the log as a QStringList to be displayed in UI
@@ -126,12 +186,25 @@ public slots:
 
 	// ------------------- Send Message --------------------
 
+	// All variants send the message to the destinations selected by routes (see OSCRoutes),
+	// the message is encoded once for all destinations.
+	// Without routes forced messages go to the feedback routes, others to the primary destination.
+
 	// Sends an OSC packet with a message in the following format:
 	// /x/y/z=1.0,2.0
-	void sendMessage(QString messageString, bool forced = false);
+	void sendMessage(QString messageString, bool forced = false) { sendMessageTo(sound2osc::OSCRoutes::DEFAULT, messageString, forced); }
+
+	// Sends an OSC packet with a message in the format above to the destinations of routes
+	// (the routes come first, sendMessage(path, "1", true) would be ambiguous otherwise)
+	void sendMessageTo(sound2osc::OSCRoutes::Mask routes, QString messageString, bool forced = false);
 
 	// Sends an OSC message with a string as the only argument
-	void sendMessage(QString path, QString argument, bool forced = false);
+	void sendMessage(QString path, QString argument, bool forced = false, sound2osc::OSCRoutes::Mask routes = sound2osc::OSCRoutes::DEFAULT);
+
+	// Sends a message that was encoded in advance (i.e. a trigger message)
+	// - value is the argument of level messages, it is ignored by other messages
+	void sendMessage(const sound2osc::OSCPacketTemplate& message, double value = 0.0, bool forced = false,
+					 sound2osc::OSCRoutes::Mask routes = sound2osc::OSCRoutes::DEFAULT);
 
 signals:
 
@@ -168,18 +241,66 @@ protected:
 	// binds the UDP socket to the correct port or disables the binding if TCP is used
 	void updateUdpBinding();
 
-	// sends raw OSC message data
-	void sendMessageData(char* packet, size_t outSize);
+	// returns the destinations of a message sent with the given routes
+	sound2osc::OSCRoutes::Mask resolveRoutes(sound2osc::OSCRoutes::Mask routes, bool forced) const;
+
+	// sends raw OSC message data to the destinations of routes
+	void sendMessageData(const char* packet, size_t outSize, sound2osc::OSCRoutes::Mask routes);
+
+	// sends raw OSC message data to one destination (0 = primary destination)
+	void sendToDestination(int index, const char* packet, size_t outSize);
+
+	// sends raw OSC message data to the primary destination
+	void sendToPrimary(const char* packet, size_t outSize);
+
+	// returns if a frame was opened by the calling thread
+	bool isFrameOpen() const;
+
+	// adds an encoded packet for the destinations of routes and its log text to the open frame
+	void addToFrame(const QByteArray& packet, sound2osc::OSCRoutes::Mask routes, const QString& logText);
 
-	// returns and removes the raw OSC message data from a framed packet in a TCP stream
-	// or returns nothing if the OSC message is not yet complete
-	QByteArray popPacketFromStreamData(QByteArray& data) const;
-	QByteArray popPacketLengthFramedPacketFromStreamData(QByteArray& data) const;
-	QByteArray popSlipFramedPacketFromStreamData(QByteArray& data) const;
+	// sends the datagrams of a frame and adds the log texts of its messages
+	void sendFrame(const std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams>& groups, const QStringList& log);
+
+	// sends the datagrams of a frame to one destination (0 = primary destination)
+	void sendFrameToDestination(int index, const std::vector<QByteArray>& datagrams);
 
 	// adds a text to the log
 	void addToLog(QString text) const;
 
+	// ------------------- Sending from other threads --------------------
+
+	// the send settings read by other threads than the owner thread
+	// (immutable, replaced by updateSendTargets() on every change)
+	struct SendTargets
+	{
+		QHostAddress address;  // primary destination
+		quint16 udpTxPort = 0;
+		bool useTcp = false;
+		QString eosUser;
+		QList<sound2osc::OSCDestination> destinations;
+	};
+
+	// publishes the current send settings to other threads
+	void updateSendTargets();
+
+	// returns the last published send settings
+	std::shared_ptr<const SendTargets> sendTargets() const;
+
+	// sends an encoded packet from another thread than the owner thread
+	void sendPacketFromWorker(const QByteArray& packet, sound2osc::OSCRoutes::Mask routes, const QString& logText);
+
+	// sends the datagrams of a frame from another thread than the owner thread
+	void sendFrameFromWorker(const std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams>& groups, const QStringList& log);
+
+	// sends datagrams to the UDP destinations of routes through m_workerSocket (m_workerMutex must be locked)
+	// returns the routes that have to be sent by the owner thread (TCP)
+	sound2osc::OSCRoutes::Mask sendFromWorker(const std::vector<QByteArray>& datagrams, sound2osc::OSCRoutes::Mask routes);
+
+	// passes log texts to the owner thread, which adds them and emits packetSent()
+	// (at most one call is queued to the owner thread at a time)
+	void notifyOwner(const QStringList& log);
+
 private slots:
 
 	// tries to establish a connection via TCP
@@ -199,10 +320,10 @@ private slots:
 	void readIncomingTcpStream();
 
 	// processes incoming raw data and checks if it is an OSC bundle
-	void processIncomingRawData(QByteArray msgData);
+	void processIncomingRawData(const QByteArray& msgData);
 
 	// processes incoming single raw OSC messages
-	void processIncomingRawMessage(QByteArray msgData);
+	void processIncomingRawMessage(const QByteArray& msgData);
 
 private:
 	QUdpSocket				m_udpSocket;  // UDP socket
@@ -211,15 +332,36 @@ private:
 	quint16					m_udpTxPort;  // UDP Tx Port
 	quint16					m_udpRxPort;  // UDP Rx Port
 	quint16					m_tcpPort;  // TCP Port (Rx and Tx)
-	bool					m_isEnabled;  // output enabled (can be overwriten by "forced" argument)
+	std::atomic<bool>		m_isEnabled;  // output enabled (can be overwriten by "forced" argument)
 	bool					m_useTcp;  // true if TCP should be used instead of UDP
 	QTimer					m_tryConnectAgainTimer;  // Timer to connect again after error
 	OSCStream::EnumFrameMode m_tcpFrameMode;  // TCP frame mode (OSC 1.0 or 1.1 SLIP)
 	mutable QStringList		m_log;  // log of incoming and / or outgoing messages
-	bool					m_logIncomingMsg;  // true if incoming messages should be logged
-	bool					m_logOutgoingMsg;  // true if outgoing messages should be logged
+	std::atomic<bool>		m_logIncomingMsg;  // true if incoming messages should be logged
+	std::atomic<bool>		m_logOutgoingMsg;  // true if outgoing messages should be logged
 	QString					m_eosUser;  // number of the Eos User (default = 0 -> Background User)
-	QByteArray				m_incompleteStreamData;  // may contain the begin of an incomplete OSC packet (from TCP stream)
+	sound2osc::OSCStreamDeframer m_streamDeframer;  // splits the incoming TCP stream into OSC packets
+	std::atomic<bool>		m_bundleFrames;  // true if the messages of a frame are sent as bundles
+	std::atomic<int>		m_maxBundleSize;  // maximum size of a bundle in bytes
+	std::atomic<QThread*>	m_frameThread;  // thread that opened the current frame, nullptr if no frame is open
+	sound2osc::OSCFrameBundler m_frame;  // packets of the current frame (only used by m_frameThread)
+	QStringList				m_frameLog;  // log texts of the current frame (only used by m_frameThread)
+	QString					m_frameUser;  // Eos user of the current frame
+	std::chrono::system_clock::time_point m_frameTime;  // time tag of the current frame
+	bool					m_frameBundled;  // true if the current frame is sent as bundles
+	sound2osc::UdpBatchSender m_udpBatchSender;  // sends the UDP datagrams of a frame at once
+	QList<sound2osc::OSCDestination> m_destinations;  // additional destinations (destination 1 to n)
+	std::vector<std::unique_ptr<QTcpSocket>> m_destinationSockets;  // TCP socket of each additional destination (nullptr for UDP)
+	std::atomic<sound2osc::OSCRoutes::Mask> m_feedbackRoutes;  // destinations of forced messages without routes
+	std::atomic<bool>		m_hasDestinations;  // true if there are additional destinations
+	mutable QMutex			m_sendTargetsMutex;  // guards m_sendTargets
+	std::shared_ptr<const SendTargets> m_sendTargets;  // send settings for other threads than the owner thread
+	QMutex					m_workerMutex;  // guards the members below, used by other threads than the owner thread
+	sound2osc::UdpSendSocket m_workerSocket;  // sends the UDP datagrams of other threads
+	sound2osc::UdpBatchSender m_workerBatchSender;  // sends the datagrams of a frame through m_workerSocket at once
+	std::vector<QByteArray>	m_workerDatagrams;  // the packet of sendPacketFromWorker() (reused)
+	QStringList				m_workerLog;  // log texts of other threads, taken by the owner thread
+	std::atomic<bool>		m_workerNotifyPending;  // true if a call of the owner thread to take m_workerLog is queued
 };
 
 #endif // OSCWRAPPER_H
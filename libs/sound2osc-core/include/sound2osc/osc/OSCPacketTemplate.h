@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// OSC message in text form that is encoded once and sent many times
+
+#ifndef SOUND2OSC_OSC_OSCPACKETTEMPLATE_H
+#define SOUND2OSC_OSC_OSCPACKETTEMPLATE_H
+
+#include <QByteArray>
+#include <QString>
+
+namespace sound2osc {
+
+/**
+ * @brief Binary OSC packet of a message in the "/path=argument,..." text form
+ *
+ * The on, off and level messages of the triggers are configured as text and
+ * were converted to an OSC packet for every message that is sent. The
+ * template encodes the message when it is set, sending it only copies the
+ * packet and patches the value of level messages in place.
+ *
+ * A message that ends with '=' or ',' is a level message: the value is
+ * appended as a binary argument of the ValueType of the template. A "<USER>"
+ * placeholder in the path is replaced with the Eos user when the packet is
+ * created. Messages whose encoding depends on the user (a "<USER>" in a
+ * string argument) are encoded again for every packet.
+ *
+ * Copies share the packet data (QByteArray), so templates can be passed to
+ * another thread cheaply.
+ */
+class OSCPacketTemplate
+{
+public:
+    /**
+     * @brief OSC type of the value of level messages
+     */
+    enum class ValueType {
+        Rounded,  ///< float32 rounded to 3 decimals, the same as the text form "/path=0.123" (default)
+        Float,  ///< float32 with full precision
+        Int  ///< int32 rounded to the nearest integer
+    };
+
+    OSCPacketTemplate() = default;
+
+    /**
+     * @brief Encode a message in the "/path=argument,..." text form
+     */
+    explicit OSCPacketTemplate(const QString& message, ValueType valueType = ValueType::Rounded);
+
+    bool isEmpty() const { return m_message.isEmpty(); }
+
+    /**
+     * @brief The message in text form as it was set
+     */
+    const QString& message() const { return m_message; }
+
+    /**
+     * @brief True if a value is appended to the message (level message)
+     */
+    bool hasValue() const { return m_hasValue; }
+
+    ValueType valueType() const { return m_valueType; }
+
+    /**
+     * @brief True if the packet is encoded, false if it is encoded for every user
+     */
+    bool isEncoded() const { return !m_packet.isEmpty(); }
+
+    /**
+     * @brief Create the packet for the given Eos user and value
+     * @param value argument of level messages, ignored by other messages
+     * @return empty if the message is not valid OSC (e.g. does not start with '/')
+     */
+    QByteArray create(const QString& user, double value = 0.0) const;
+
+    /**
+     * @brief The message in text form with the user and value (e.g. for the log)
+     */
+    QString toString(const QString& user, double value = 0.0) const;
+
+    /**
+     * @brief Name of a ValueType used in settings ("rounded", "float", "int")
+     */
+    static QString valueTypeName(ValueType valueType);
+
+    /**
+     * @brief ValueType of a name of valueTypeName(), Rounded if the name is unknown
+     */
+    static ValueType valueTypeFromName(const QString& name);
+
+private:
+    QString m_message;
+    ValueType m_valueType = ValueType::Rounded;
+    bool m_hasValue = false;
+    QByteArray m_packet;  // encoded packet, a "<USER>" in the path is not replaced yet
+    int m_pathSize = 0;  // length of the path in m_packet (without the terminating zero)
+    bool m_userInPath = false;  // true if the path contains "<USER>"
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_OSCPACKETTEMPLATE_H
@@ -304,6 +304,15 @@ public:
 	bool Write(char *buf, size_t size) const override;
 	virtual char* Create(size_t &size) const;
 	virtual void AddPacket(OSCPacketElement *packet);
+	virtual bool empty() const {return m_Q.empty();}
+	virtual size_t size() const {return m_Q.size();}
+
+	// NTP time-tag of the bundle (default 0)
+	virtual uint64_t GetTimeTag() const {return m_TimeTag;}
+	virtual void SetTimeTag(uint64_t timeTag) {m_TimeTag = timeTag;}
+
+	// time-tag 1 means "immediately" (OSC 1.0)
+	static const uint64_t TIME_TAG_IMMEDIATELY = 1;
 
 private:
 	// not allowed
@@ -314,6 +323,23 @@ protected:
 	typedef std::deque<OSCPacketElement*> PACKET_Q;
 
 	PACKET_Q	m_Q;
+	uint64_t	m_TimeTag;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// an already encoded OSC packet (e.g. to add it to a bundle)
+class OSCRawPacket
+	: public OSCPacketElement
+{
+public:
+	OSCRawPacket(const char *data, size_t size);
+
+	size_t ComputeSize() const override;
+	bool Write(char *buf, size_t size) const override;
+
+private:
+	std::string	m_Data;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
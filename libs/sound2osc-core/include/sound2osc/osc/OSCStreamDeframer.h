@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Incremental deframer of the OSC packets in a TCP stream
+
+#ifndef SOUND2OSC_OSC_OSCSTREAMDEFRAMER_H
+#define SOUND2OSC_OSC_OSCSTREAMDEFRAMER_H
+
+#include <sound2osc/osc/OSCParser.h>
+
+#include <QByteArray>
+
+#include <vector>
+
+class QIODevice;
+
+namespace sound2osc {
+
+/**
+ * @brief Splits a TCP stream into OSC packets (OSC 1.0 size prefix or OSC 1.1 SLIP)
+ *
+ * The received data is appended to a buffer that is reused between reads,
+ * next() returns each complete packet as a view into that buffer without
+ * copying it. A packet stays valid until the next append() or readFrom(),
+ * clear() and setFrameMode() keep the memory, so it is readable after them
+ * as well. Consumed data is only discarded when the buffer needs space, so
+ * a burst of packets (e.g. the state that Eos sends on connect) is read in
+ * time linear in its size.
+ *
+ * SLIP escapes are decoded in place in the same pass that looks for the END
+ * of the packet, a packet that is split over several reads is not scanned
+ * again.
+ *
+ * Limits (see OSCStream): at most MAX_BUF_SIZE bytes are buffered, beyond
+ * that append() and readFrom() fail and discard the buffered data. With a
+ * size prefix (OSC 1.0) that is not positive or above MAX_FRAME_SIZE next()
+ * returns Invalid, a SLIP packet (OSC 1.1) is only limited by the buffer.
+ */
+class OSCStreamDeframer
+{
+public:
+    enum class Result {
+        Packet,  ///< a complete packet was returned
+        Incomplete,  ///< more data is needed for the next packet
+        Invalid  ///< the data is not framed in the frame mode, the buffered data was discarded
+    };
+
+    explicit OSCStreamDeframer(OSCStream::EnumFrameMode frameMode = OSCStream::FRAME_MODE_1_0);
+
+    OSCStream::EnumFrameMode frameMode() const { return m_frameMode; }
+
+    /**
+     * @brief Set the frame mode, discards the buffered data
+     */
+    void setFrameMode(OSCStream::EnumFrameMode frameMode);
+
+    /**
+     * @brief Discard the buffered data (e.g. for a new connection)
+     *
+     * The memory of the buffer is kept, so a packet returned by next() stays
+     * readable until the next append().
+     */
+    void clear();
+
+    /**
+     * @brief Number of received bytes that were not returned as packets yet
+     */
+    qsizetype bufferedSize() const { return m_end - m_begin; }
+
+    /**
+     * @brief Append received data
+     * @return false if the buffer would exceed OSCStream::MAX_BUF_SIZE, the buffered data is discarded then
+     */
+    bool append(const char* data, qsizetype size);
+
+    /**
+     * @brief Append all data that is available on a device (without a temporary copy)
+     * @return false if the buffer would exceed OSCStream::MAX_BUF_SIZE or reading failed
+     */
+    bool readFrom(QIODevice& device);
+
+    /**
+     * @brief Get the next complete packet
+     * @param packet set to the packet data if Result::Packet is returned, it
+     * refers to the buffer (QByteArray::fromRawData) and is valid until the
+     * next append() or readFrom()
+     */
+    Result next(QByteArray& packet);
+
+private:
+    // makes space for size bytes at the end of the buffer and returns it
+    char* reserve(qsizetype size);
+
+    Result nextLengthFramed(QByteArray& packet);
+    Result nextSlipFramed(QByteArray& packet);
+
+    OSCStream::EnumFrameMode m_frameMode;
+    std::vector<char> m_buffer;
+    qsizetype m_begin;  // start of the data that was not returned yet (start of the current packet)
+    qsizetype m_end;  // end of the received data
+    // SLIP: the packet is decoded in place from m_begin to m_decoded,
+    // the received data from m_scanned to m_end is not decoded yet
+    qsizetype m_decoded;
+    qsizetype m_scanned;
+    bool m_escape;  // the last scanned character was a SLIP ESC
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_OSCSTREAMDEFRAMER_H
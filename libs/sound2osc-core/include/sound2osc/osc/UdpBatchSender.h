@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Sends a batch of UDP datagrams with one system call where supported
+
+#ifndef SOUND2OSC_OSC_UDPBATCHSENDER_H
+#define SOUND2OSC_OSC_UDPBATCHSENDER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Sends the datagrams of one frame through an existing UDP socket with sendmmsg()
+ *
+ * QUdpSocket::writeDatagram() costs one system call per datagram. With many
+ * triggers and several destinations a frame consists of hundreds of
+ * datagrams, so on Linux they are handed to the kernel with a single
+ * sendmmsg() call instead. The datagrams are written to the descriptor of
+ * the QUdpSocket, so they leave from the same local port as before.
+ *
+ * Only available if the library is built with SOUND2OSC_WITH_SENDMMSG on
+ * Linux, see isSupported(). Elsewhere send() does nothing and the caller
+ * falls back to QUdpSocket.
+ *
+ * Not thread safe, used by the thread that owns the socket.
+ */
+class UdpBatchSender
+{
+public:
+    UdpBatchSender();
+    ~UdpBatchSender();
+
+    UdpBatchSender(const UdpBatchSender&) = delete;
+    UdpBatchSender& operator=(const UdpBatchSender&) = delete;
+
+    /**
+     * @brief True if batched sending is available in this build
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Send datagrams to one destination through a bound UDP socket
+     * @param socketDescriptor native descriptor of the socket (QUdpSocket::socketDescriptor())
+     * @return number of datagrams that were sent from the beginning of the list,
+     *         the caller has to send the remaining ones on another way
+     */
+    int send(qintptr socketDescriptor, const QHostAddress& address, quint16 port,
+             const std::vector<QByteArray>& datagrams);
+
+    /**
+     * @brief Forget the cached address family of the socket (e.g. after it was bound again)
+     */
+    void reset();
+
+    /**
+     * @brief Number of system calls made by send() so far
+     */
+    uint64_t systemCalls() const { return m_systemCalls; }
+
+private:
+    struct Batch;
+
+    std::unique_ptr<Batch> m_batch;  // native message headers, reused for every send()
+    uint64_t m_systemCalls = 0;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_UDPBATCHSENDER_H
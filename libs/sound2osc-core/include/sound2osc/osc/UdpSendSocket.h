@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Native UDP socket for sending from threads without a Qt event loop
+
+#ifndef SOUND2OSC_OSC_UDPSENDSOCKET_H
+#define SOUND2OSC_OSC_UDPSENDSOCKET_H
+
+#include <QHostAddress>
+
+#include <cstddef>
+
+namespace sound2osc {
+
+/**
+ * @brief Unbound UDP socket of the operating system, only used to send datagrams
+ *
+ * A QUdpSocket belongs to the thread that created it and needs an event
+ * dispatcher in that thread, so the processing thread (a plain std::thread)
+ * can't use one. This socket has no thread affinity and sends synchronously,
+ * so the worker sends its datagrams itself instead of queuing them to the
+ * event loop of the main thread. The descriptor can be passed to
+ * UdpBatchSender.
+ *
+ * The socket is dual stack (IPv6 with IPv4 mapped addresses) if the system
+ * supports it, IPv4 otherwise. Datagrams leave from an ephemeral port.
+ *
+ * Not thread safe.
+ */
+class UdpSendSocket
+{
+public:
+    UdpSendSocket();
+    ~UdpSendSocket();
+
+    UdpSendSocket(const UdpSendSocket&) = delete;
+    UdpSendSocket& operator=(const UdpSendSocket&) = delete;
+
+    /**
+     * @brief Create the socket if it is not open yet
+     * @return true if the socket is open
+     */
+    bool open();
+
+    void close();
+
+    bool isOpen() const { return m_descriptor != -1; }
+
+    /**
+     * @brief Native descriptor of the socket, -1 if it is not open
+     */
+    qintptr descriptor() const { return m_descriptor; }
+
+    /**
+     * @brief Send one datagram
+     * @return false if the socket is not open, the address can't be reached
+     *         with its address family or the system rejected the datagram
+     */
+    bool send(const QHostAddress& address, quint16 port, const char* data, std::size_t size);
+
+private:
+    qintptr m_descriptor;
+    int m_family;  // address family of the socket
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_OSC_UDPSENDSOCKET_H
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Hierarchical timing wheel driven by the sample clock of the audio input
+
+#ifndef SOUND2OSC_TRIGGER_TIMINGWHEEL_H
+#define SOUND2OSC_TRIGGER_TIMINGWHEEL_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sound2osc {
+
+/**
+ * @brief Schedules deadlines on the absolute sample position of the input stream
+ *
+ * Used for the on delay, off delay and max hold of all TriggerFilters instead
+ * of one QTimer per deadline. The wheel does not depend on an event loop or
+ * on the wall clock: advance() is called by the processing side with the
+ * sample position of each analysis hop and runs the callbacks of all timers
+ * whose deadline is at or before this position, ordered by deadline. The
+ * result only depends on the audio stream, so the gating is reproducible and
+ * the exact deadline of each callback is known (see deadline()).
+ *
+ * Timers are sorted into LEVELS wheels of SLOTS slots each. A slot of level 0
+ * covers one tick of TICK_SAMPLES samples, a slot of level n covers SLOTS^n
+ * ticks. When level 0 completes a rotation, the next slot of level 1 is
+ * distributed to the lower level (and so on), so starting and stopping a
+ * timer is O(1) and advance() only looks at the slots of the elapsed ticks.
+ * Levels without timers are skipped, so large jumps of the position are cheap.
+ * Deadlines beyond the range of the top level are kept in its last slot and
+ * sorted in again when it is reached.
+ *
+ * Not thread safe, all functions must be called by the thread that calls
+ * advance() (or be synchronized by the owner).
+ */
+class TimingWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    static constexpr int TICK_SHIFT = 5;  // log2 of TICK_SAMPLES
+    static constexpr int TICK_SAMPLES = 1 << TICK_SHIFT;  // samples per tick (0.7 ms at 44.1 kHz)
+    static constexpr int SLOT_BITS = 6;  // log2 of SLOTS
+    static constexpr int SLOTS = 1 << SLOT_BITS;  // slots per level
+    static constexpr int LEVELS = 4;  // range of SLOTS^LEVELS ticks (3.4 hours at 44.1 kHz)
+
+    explicit TimingWheel(int sampleRate = 44100);
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /**
+     * @brief Sample rate used to convert durations in seconds to samples
+     */
+    int sampleRate() const { return m_sampleRate; }
+    void setSampleRate(int sampleRate);
+
+    /**
+     * @brief Number of samples of a duration in seconds (rounded, at least 0)
+     */
+    int64_t samplesFor(double seconds) const;
+
+    /**
+     * @brief Sample position of the last advance()
+     */
+    int64_t position() const { return m_position; }
+
+    /**
+     * @brief Create an inactive timer that calls callback when its deadline is reached
+     * @return id of the timer, used by all other functions
+     */
+    int createTimer(Callback callback);
+
+    /**
+     * @brief Stop and release a timer, its id may be reused by createTimer()
+     */
+    void destroyTimer(int timer);
+
+    /**
+     * @brief Allocate the storage for count timers, createTimer() and
+     * destroyTimer() do not allocate up to count
+     */
+    void reserve(int count);
+
+    /**
+     * @brief (Re)start a timer with an absolute deadline in samples
+     * A deadline at or before position() is due at the next advance().
+     */
+    void start(int timer, int64_t deadline);
+
+    /**
+     * @brief (Re)start a timer with a deadline relative to position()
+     */
+    void startAfter(int timer, double seconds) { start(timer, m_position + samplesFor(seconds)); }
+
+    /**
+     * @brief Stop a timer without calling its callback
+     */
+    void stop(int timer);
+
+    bool isActive(int timer) const { return m_timers[static_cast<std::size_t>(timer)].slot >= 0; }
+
+    /**
+     * @brief Deadline of the last start() of a timer (also while its callback runs)
+     */
+    int64_t deadline(int timer) const { return m_timers[static_cast<std::size_t>(timer)].deadline; }
+
+    /**
+     * @brief Number of timers that are started and not yet due
+     */
+    int activeTimers() const { return m_activeTimers; }
+
+    /**
+     * @brief Advance to the given sample position and run all callbacks that are due
+     * Callbacks may start and stop timers, timers started with a deadline
+     * at or before position run in the same call. Positions before
+     * position() are ignored.
+     */
+    void advance(int64_t position);
+
+private:
+    struct Timer
+    {
+        int64_t deadline = 0;
+        Callback callback;
+        int next = -1;  // next timer in the same slot
+        int previous = -1;  // previous timer in the same slot
+        int slot = -1;  // index in m_slots, -1 if not active
+    };
+
+    void insert(int timer);
+    void unlink(int timer);
+    void cascade();
+    bool expireCurrentSlot();
+
+    int m_sampleRate;
+    int64_t m_position;  // sample position of the last advance()
+    int64_t m_tick;  // current tick, all earlier ticks are processed
+    int m_activeTimers;
+    int m_levelTimers[LEVELS];  // number of active timers per level
+    std::vector<int> m_slots;  // first timer of each slot (-1 = empty), level n starts at n * SLOTS
+    std::vector<Timer> m_timers;
+    std::vector<int> m_freeTimers;  // ids of destroyed timers
+    std::vector<int> m_due;  // timers of the current slot that are due (intermediate result)
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_TRIGGER_TIMINGWHEEL_H
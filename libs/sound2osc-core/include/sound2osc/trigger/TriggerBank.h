@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Runtime configurable set of bandpass triggers
+
+#ifndef SOUND2OSC_TRIGGER_TRIGGERBANK_H
+#define SOUND2OSC_TRIGGER_TRIGGERBANK_H
+
+#include <sound2osc/core/TripleBuffer.h>
+#include <sound2osc/dsp/ScaledSpectrum.h>
+#include <sound2osc/osc/OSCMessage.h>
+#include <sound2osc/trigger/TimingWheel.h>
+#include <sound2osc/trigger/TriggerBatch.h>
+#include <sound2osc/trigger/TriggerFilter.h>
+#include <sound2osc/trigger/TriggerOscParameters.h>
+
+#include <QJsonArray>
+#include <QMutex>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Forward declaration to reduce dependencies:
+class OSCNetworkManager;
+
+namespace sound2osc {
+
+/**
+ * @brief A set of user defined bandpass triggers that can be changed at runtime
+ *
+ * In addition to the fixed triggers of the engine (bass, loMid, ...), any
+ * number of bands up to MAX_BANDS can be added, removed and reconfigured while
+ * the analysis is running. The parameters and the state of all bands are
+ * stored as parallel arrays (index = band) and evaluated by a TriggerBatch in
+ * one pass over the spectrum. The time domain filtering (on/off delay, max
+ * hold) and the OSC messages of each band are handled by a TriggerFilter and
+ * TriggerOscParameters like for the fixed triggers.
+ *
+ * Bands are addressed by their index or by their unique name. In OSC
+ * addresses (see handleMessage()) the index is 1-based.
+ *
+ * All functions except evaluate() may be called by any control thread (UI,
+ * incoming OSC messages), they are synchronized by a mutex that evaluate()
+ * never takes. Every change publishes a copy of the parameters of all bands
+ * in a TripleBuffer, the processing side picks up the latest copy at the
+ * start of evaluate() without waiting. The OSC parameters of each band
+ * publish their encoded messages, level range and routes the same way (see
+ * TriggerOscParameters::messages()), so the On, Off and Level messages are
+ * sent without a lock as well. Filters and OSC parameters of the
+ * bands are allocated by the control side and only released after the
+ * processing side stopped using them, so evaluate() neither allocates nor
+ * frees memory. The delays of the TriggerFilters are scheduled in a
+ * TimingWheel of the bank that is only used by evaluate().
+ *
+ * Changes take effect with the next evaluate(), level(), isActive() and
+ * isOutputActive() report the state of the last evaluate().
+ *
+ * The output of a band that is removed while it is active (also by clear()
+ * and fromState()) is released with its Off message by the next evaluate()
+ * or releaseOutputs().
+ */
+class TriggerBank
+{
+public:
+    static constexpr int MAX_BANDS = 64;
+
+    explicit TriggerBank(OSCNetworkManager* osc);
+    ~TriggerBank();
+
+    TriggerBank(const TriggerBank&) = delete;
+    TriggerBank& operator=(const TriggerBank&) = delete;
+
+    // ---------------- Bands -------------
+
+    /**
+     * @brief Add a band and return its index
+     * The default OSC messages of the band are /sound2osc/out/band/<name>/trigger=1
+     * (on), .../trigger=0 (off) and .../level= (level).
+     * @return -1 if the name is invalid or already used, or MAX_BANDS is reached
+     */
+    int addBand(const QString& name, int midFreq, qreal width = 0.1);
+
+    /**
+     * @brief Remove a band, the indexes of the following bands move down by one
+     * An active output of the band sends its Off message.
+     */
+    bool removeBand(int index);
+
+    /**
+     * @brief Remove all bands
+     */
+    void clear();
+
+    int size() const;
+
+    /**
+     * @brief Index of a band by name or by its 1-based number as used in OSC addresses
+     * @return -1 if there is no such band
+     */
+    int find(const QString& nameOrNumber) const;
+
+    /**
+     * @brief A name can be used for a band if it is not empty, not a number,
+     * contains no '/' or whitespace and is not a command of handleMessage()
+     */
+    static bool isValidName(const QString& name);
+
+    QString name(int index) const;
+
+    // middle frequency in Hz [10...22050]
+    int midFreq(int index) const;
+    void setMidFreq(int index, int value);
+
+    // width relative to the whole spectrum ]0...1]
+    qreal width(int index) const;
+    void setWidth(int index, qreal value);
+
+    // threshold to activate the trigger [0...1]
+    qreal threshold(int index) const;
+    void setThreshold(int index, qreal value);
+
+    // a muted band does not send any OSC messages
+    bool mute(int index) const;
+    void setMute(int index, bool value);
+
+    // max level within the band at the last level change (> 0.001) [0...1]
+    qreal level(int index) const;
+
+    // true if the level is above the threshold (before the TriggerFilter)
+    bool isActive(int index) const;
+
+    // ---------------- Filter and OSC messages -------------
+    // (see TriggerFilter and TriggerOscParameters)
+
+    // on delay in seconds
+    qreal onDelay(int index) const;
+    void setOnDelay(int index, qreal value);
+
+    // off delay in seconds
+    qreal offDelay(int index) const;
+    void setOffDelay(int index, qreal value);
+
+    // max hold time in seconds, 0 = off
+    qreal maxHold(int index) const;
+    void setMaxHold(int index, qreal value);
+
+    // true if the filtered output is active (the On message was sent)
+    bool isOutputActive(int index) const;
+
+    // OSC message sent when the output is activated
+    QString onMessage(int index) const;
+    void setOnMessage(int index, const QString& value);
+
+    // OSC message sent when the output is released
+    QString offMessage(int index) const;
+    void setOffMessage(int index, const QString& value);
+
+    // OSC path of the level value
+    QString levelMessage(int index) const;
+    void setLevelMessage(int index, const QString& value);
+
+    // destinations of the messages of a band (see OSCRoutes)
+    OSCRoutes::Mask routes(int index) const;
+    void setRoutes(int index, OSCRoutes::Mask value);
+
+    // --------------- Evaluation -----------
+
+    /**
+     * @brief Check all bands against the spectrum and send triggers and levels
+     * Only to be called by the processing side (one thread at a time), takes no lock.
+     * @param lowSoloMode only the band with the lowest frequency that is above
+     * its threshold is active
+     * @param position absolute sample position at the end of the analyzed
+     * samples, the delays of the TriggerFilters that ended up to it are handled
+     */
+    void evaluate(const ScaledSpectrum& spectrum, bool lowSoloMode, int64_t position);
+
+    /**
+     * @brief Release the outputs of all bands with their Off messages
+     * The delays only end with the positions passed to evaluate(), so the
+     * processing side calls this when the analysis stops or the input stalls.
+     * Same thread rules as evaluate(), the bands start inactive with the next
+     * evaluate().
+     */
+    void releaseOutputs();
+
+    // ---------------- Save and Restore ---------------
+
+    /**
+     * @brief All bands with their parameters, filter and OSC settings
+     */
+    QJsonArray toState() const;
+
+    /**
+     * @brief Replace all bands with the bands of the state
+     */
+    void fromState(const QJsonArray& state);
+
+    // ---------------- OSC Control ---------------
+
+    /**
+     * @brief Handle an incoming /sound2osc/band/... message
+     *
+     * - /sound2osc/band/add <name> [midFreq] [width]
+     * - /sound2osc/band/clear
+     * - /sound2osc/band/<name or number>/remove
+     * - /sound2osc/band/<name or number>/mid_freq <Hz>
+     * - /sound2osc/band/<name or number>/width <0...1>
+     * - /sound2osc/band/<name or number>/threshold <0...1>
+     * - /sound2osc/band/<name or number>/mute [bool]
+     * - /sound2osc/band/<name or number>/mute/toggle
+     *
+     * @return false if the message is not addressed to the bank
+     */
+    bool handleMessage(OSCMessage msg);
+
+private:
+    // OSC parameters, filter and state of one band, owned by the control side
+    struct Output
+    {
+        explicit Output(OSCNetworkManager* osc);
+        TriggerOscParameters oscParameters;
+        TriggerFilter filter;
+        std::atomic<bool> active{false};  // state of the band in the last evaluate()
+        std::atomic<float> level{0.0f};  // level of the last Level event
+    };
+
+    // control side parameters of one band
+    struct Band
+    {
+        QString name;
+        int midFreq;
+        qreal width;
+        float threshold;
+        bool mute;
+        std::unique_ptr<Output> output;
+    };
+
+    // copy of the parameters of all bands that is handed over to evaluate() (index = band)
+    struct Parameters
+    {
+        int count = 0;
+        uint64_t generation = 0;  // number of the publishLocked() call
+        std::array<Output*, MAX_BANDS> outputs{};
+        std::array<int, MAX_BANDS> midFreqs{};
+        std::array<qreal, MAX_BANDS> widths{};
+        std::array<float, MAX_BANDS> thresholds{};
+        std::array<char, MAX_BANDS> mutes{};
+    };
+
+    bool isValidIndex(int index) const { return index >= 0 && index < static_cast<int>(m_bands.size()); }
+    int findLocked(const QString& nameOrNumber) const;
+    int addBandLocked(const QString& name, int midFreq, qreal width);
+    void removeBandLocked(int index);
+    void publishLocked();
+    void sendMuteFeedback(int index) const;
+
+    // processing side:
+    void adopt(const Parameters& parameters);
+    void sendLevel(int index, float value) const;
+
+    OSCNetworkManager* m_osc;  // used to send the messages of all bands, may be null
+
+    // delays of all TriggerFilters, only used by evaluate()
+    // (declared before the Outputs, which release their timers):
+    TimingWheel m_wheel;
+
+    // ---- control side, guarded by m_mutex:
+    mutable QMutex m_mutex;
+    std::vector<Band> m_bands;
+    uint64_t m_generation;  // generation of the last published Parameters
+    // removed Outputs with the generation that does not contain them anymore:
+    std::vector<std::pair<uint64_t, std::unique_ptr<Output>>> m_retired;
+
+    // ---- hand-over:
+    TripleBuffer<Parameters> m_published;
+    std::atomic<uint64_t> m_adoptedGeneration;  // generation used by evaluate()
+
+    // ---- processing side, only used by evaluate():
+    Parameters m_current;  // parameters of the last adopted generation
+    std::array<char, MAX_BANDS> m_rangeValid;  // false if the range of the band was not calculated yet
+    TriggerBatch m_batch;  // thresholds, band ranges, levels and active state of all bands (same indexes)
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_TRIGGER_TRIGGERBANK_H
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Evaluation of many triggers in one pass over parallel arrays
+
+#ifndef SOUND2OSC_TRIGGER_TRIGGERBATCH_H
+#define SOUND2OSC_TRIGGER_TRIGGERBATCH_H
+
+#include <cstdint>
+#include <vector>
+
+class ScaledSpectrum;
+
+namespace sound2osc {
+
+/**
+ * @brief Parameters of one trigger in a TriggerBatch
+ */
+struct TriggerParameters
+{
+    int startIndex = 0;  ///< first index of the band in the ScaledSpectrum
+    int endIndex = 0;  ///< last index of the band in the ScaledSpectrum (included)
+    float threshold = 0.5f;  ///< the trigger is active at or above this level [0...1]
+    bool invert = false;  ///< use 1 - level (e.g. for a silence trigger)
+    bool lowSolo = false;  ///< takes part in the low solo mode (bandpass triggers)
+    int soloOrder = 0;  ///< in low solo mode only the active trigger with the lowest order (>= 0) stays active
+};
+
+/**
+ * @brief A change of a trigger found by TriggerBatch::evaluate()
+ */
+struct TriggerEvent
+{
+    enum Type : std::uint8_t {
+        On,  ///< the level reached the threshold
+        Off,  ///< the level fell below the threshold or was released by the low solo mode
+        Level  ///< the level changed by more than MIN_LEVEL_CHANGE since the last Level event
+    };
+
+    int trigger;  ///< index of the trigger in the batch
+    Type type;
+    float value;  ///< current level [0...1] (after inversion)
+};
+
+/**
+ * @brief Evaluates any number of triggers against a spectrum in one pass
+ *
+ * Thresholds, band ranges, the active state and the last reported level of
+ * all triggers are stored in parallel arrays. evaluate() reads the level of
+ * each band from the sparse table of the ScaledSpectrum (O(1) per trigger)
+ * and then computes all threshold crossings and level changes in loops
+ * without branches that the compiler vectorizes. Only the triggers that
+ * changed produce a TriggerEvent, so the caller only does the per-trigger
+ * work (timers, building OSC messages) when there is something to send.
+ *
+ * Not thread safe, the owner synchronizes parameter changes with evaluate().
+ */
+class TriggerBatch
+{
+public:
+    // minimum change of the level to report a TriggerEvent::Level
+    static constexpr float MIN_LEVEL_CHANGE = 0.001f;
+
+    int size() const { return static_cast<int>(m_thresholds.size()); }
+
+    /**
+     * @brief Add a trigger (inactive, level 0) and return its index
+     */
+    int add(const TriggerParameters& parameters);
+
+    /**
+     * @brief Remove a trigger, the indexes of the following triggers move down by one
+     */
+    void remove(int index);
+
+    void clear();
+
+    /**
+     * @brief Allocate the arrays for count triggers, add() does not allocate up to count
+     */
+    void reserve(int count);
+
+    /**
+     * @brief Change all parameters of a trigger, its state is kept
+     */
+    void setParameters(int index, const TriggerParameters& parameters);
+
+    void setRange(int index, int startIndex, int endIndex);
+    void setThreshold(int index, float threshold);
+    void setSoloOrder(int index, int order);
+
+    /**
+     * @brief Restore the state of a trigger (e.g. after the batch was rebuilt)
+     */
+    void setState(int index, bool active, float level);
+
+    float threshold(int index) const { return m_thresholds[static_cast<std::size_t>(index)]; }
+
+    // level of the last Level event of a trigger
+    float level(int index) const { return m_levels[static_cast<std::size_t>(index)]; }
+
+    // true if the level of the trigger is at or above its threshold
+    bool isActive(int index) const { return m_active[static_cast<std::size_t>(index)] != 0; }
+
+    /**
+     * @brief Evaluate all triggers, the changes are returned by events()
+     * @param lowSoloMode only the active lowSolo trigger with the lowest soloOrder stays active
+     */
+    void evaluate(const ScaledSpectrum& spectrum, bool lowSoloMode);
+
+    /**
+     * @brief Events of the last evaluate(), On / Off before Level of the same trigger
+     */
+    const std::vector<TriggerEvent>& events() const { return m_events; }
+
+private:
+    // parameters:
+    std::vector<int> m_startIndexes;
+    std::vector<int> m_endIndexes;
+    std::vector<float> m_thresholds;
+    std::vector<float> m_inverts;  // 1 if inverted, otherwise 0
+    std::vector<int> m_lowSolo;  // 1 if taking part in the low solo mode, otherwise 0
+    std::vector<int> m_soloOrders;
+
+    // state:
+    std::vector<int> m_active;  // 1 if active, otherwise 0
+    std::vector<float> m_levels;  // level of the last Level event
+
+    // intermediate results:
+    std::vector<float> m_values;  // current level of each trigger
+    std::vector<int> m_changes;  // bit mask of the events of each trigger
+    std::vector<TriggerEvent> m_events;
+};
+
+} // namespace sound2osc
+
+#endif // SOUND2OSC_TRIGGER_TRIGGERBATCH_H
@@ -27,24 +27,31 @@
 
 #include <QObject>
 #include <QString>
-#include <QTimer>
 #include <QSettings>
 #include <QtMath>
 #include <QJsonObject>
 
+#include <atomic>
+
 
 // Forward declaration to reduce dependencies:
 class OSCNetworkManager;
+namespace sound2osc { class TimingWheel; }
 
 
 // This class is used to receive trigger signals from a TriggerGenerator
 // and filter them in time domain accordingly to some parameters.
+// The delays are deadlines in a TimingWheel that is advanced with the
+// sample position of the analysis, so they are independent of the event loop.
+// Without new samples the deadlines do not pass, when the analysis stops
+// (or the input stalls) the output is released by release().
 class TriggerFilter : public QObject
 {
 	Q_OBJECT
 
 public:
     explicit TriggerFilter(OSCNetworkManager* osc, TriggerOscParameters& oscParameters, bool mute);
+	~TriggerFilter() override;
 
     void setMute(bool mute) { m_mute = mute; }
 
@@ -69,13 +76,26 @@ public:
 	void setMaxHold(const qreal& value) { m_maxHold = qMax(0.0, value); }
 
 
+	// returns the TimingWheel that schedules the delays (may be null)
+	sound2osc::TimingWheel* getTimingWheel() const { return m_wheel; }
+
+	// sets the TimingWheel that schedules the delays
+	// - must be called by the thread that advances the wheel (or before it is used)
+	// - without a TimingWheel the on and off signals are sent without delay and max hold
+	void setTimingWheel(sound2osc::TimingWheel* wheel);
+
+
 	// to be called when the trigger from the raw signal is activated
-	// - starts onDelayTimer
+	// - starts the on delay
 	void triggerOn();
 	// to be called when the trigger from the raw signal is released
-	// - starts offDelayTimer
+	// - starts the off delay
 	void triggerOff();
 
+	// to be called when the analysis stops and the delays will not end anymore
+	// - stops all delays and sends the off signal if the output is active
+	void release();
+
 	// to be called when the filtered on signal should be sent
 	void sendOnSignal();
 	// to be called when the filtered off signal should be sent
@@ -96,13 +116,14 @@ public:
 
 signals:
 	// will be emitted when filtered on signal is sent
+	// - emitted by the thread that advances the TimingWheel
 	void onSignalSent();
 	// will be emitted when filtered off signal is sent
 	void offSignalSent();
 
 public slots:
 	// will be called after on delay time if no triggerOff happend
-	// - calls sendOnSignal() and starts holdMaxTimer
+	// - calls sendOnSignal() and starts the max hold
 	void onOnDelayEnd();
 
 	// will be called after off delay time if no triggerOn happend
@@ -114,15 +135,16 @@ public slots:
 	void onMaxHoldEnd();
 
 protected:
-    bool        m_mute; // Wether the associated band is muted
-	qreal		m_onDelay;  // On delay in seconds
-	qreal		m_offDelay;  // Off delay in seconds
-	qreal		m_maxHold;  // max hold time (decay) in seconds
-	bool		m_outputIsActive;  // true if trigger is activated and not yet released
-
-	QTimer		m_onDelayTimer;  // Timer object for On delay
-	QTimer		m_maxHoldTimer;  // Timer object for max hold (decay)
-	QTimer		m_offDelayTimer;  // Timer object for Off delay
+    std::atomic<bool> m_mute; // Wether the associated band is muted
+	std::atomic<qreal> m_onDelay;  // On delay in seconds
+	std::atomic<qreal> m_offDelay;  // Off delay in seconds
+	std::atomic<qreal> m_maxHold;  // max hold time (decay) in seconds
+	std::atomic<bool> m_outputIsActive;  // true if trigger is activated and not yet released
+
+	sound2osc::TimingWheel* m_wheel;  // schedules the timers below, may be null
+	int			m_onDelayTimer;  // timer of the On delay in m_wheel
+	int			m_maxHoldTimer;  // timer of the max hold (decay) in m_wheel
+	int			m_offDelayTimer;  // timer of the Off delay in m_wheel
 
 	OSCNetworkManager* m_osc;  // pointer to OSCNetworkManager instance (i.e. of MainController)
 	TriggerOscParameters& m_oscParameters;  // Reference to OSC parameters (message strings) to use
@@ -69,21 +69,21 @@ public:
 	int getMidFreq() const { return m_midFreq; }
 
 	// sets the middle frequency of the frequency band [20...22050]
-	void setMidFreq(const int& value) { m_midFreq = limit(10, value, 22050); }
+	void setMidFreq(const int& value) { m_midFreq = limit(10, value, 22050); markParametersChanged(); }
 
 
 	// returns the width of the frequency band [0...1]
 	qreal getWidth() const { return m_width; }
 
 	// sets the width of the frequency band ]0...1]
-	void setWidth(const qreal& value) { m_width = limit(0.00001, value, 1); }
+	void setWidth(const qreal& value) { m_width = limit(0.00001, value, 1); markParametersChanged(); }
 
 
 	// returns the threshold that is used to generate the trigger [0...1]
 	qreal getThreshold() const { return m_threshold; }
 
 	// sets the threshold that is used to generate the trigger [0...1]
-	void setThreshold(const qreal& value) { m_threshold = limit(0, value, 1); }
+	void setThreshold(const qreal& value) { m_threshold = limit(0, value, 1); markParametersChanged(); }
 
 	// returns a reference to the internal TriggerFilter
 	TriggerFilter& getTriggerFilter() override { return m_filter; }
@@ -94,12 +94,19 @@ public:
 
 	// --------------- calculate Level and Trigger -----------
 
-	// returns the last maximum value within the frequency band [0...1]
+	// returns the maximum value within the frequency band at the last level change (> 0.001) [0...1]
 	qreal getCurrentLevel() const { return m_lastValue; }
 
 	// checks if the max level within the frequency band is greater than the threshold
+	// - evaluates only this trigger, the FFTAnalyzer evaluates all triggers with a TriggerBatch
     bool checkForTrigger(const ScaledSpectrum& spectrum, bool forceRelease) override;
 
+	// returns the band range (the whole spectrum if this is not a bandpass), threshold and inversion
+	sound2osc::TriggerParameters getTriggerParameters(const ScaledSpectrum& spectrum) const override;
+
+	// starts / releases the TriggerFilter or sends the level message
+	void handleTriggerEvent(const sound2osc::TriggerEvent& event) override;
+
 	// ---------------- Save and Restore ---------------
 
 	// saves parameters in QSettings
@@ -125,7 +132,11 @@ protected:
 	std::atomic<qreal> m_width;  // width of bandpass [0...1]
 	std::atomic<qreal> m_threshold;  // threshold for Trigger generation [0...1]
 	bool			m_isActive;  // true if value is above threshold
-	qreal			m_lastValue;  // last value (used to check if new level message should be sent)
+	qreal			m_lastValue;  // value of the last level change (used to check if new level message should be sent)
+	int				m_rangeMidFreq;  // midFreq the cached index range was calculated for
+	qreal			m_rangeWidth;  // width the cached index range was calculated for
+	int				m_rangeStart;  // first index of the band in the ScaledSpectrum
+	int				m_rangeEnd;  // last index of the band in the ScaledSpectrum
 	TriggerOscParameters m_oscParameters;  // OSC parameter object (stores OSC messages)
 	TriggerFilter m_filter;  // TriggerFilter instance (for "filtering" in time domain: delays and decay)
 
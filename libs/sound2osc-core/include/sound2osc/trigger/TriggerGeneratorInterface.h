@@ -24,11 +24,14 @@
 #define TRIGGERGENERATORINTERFACE_H
 
 #include <sound2osc/dsp/ScaledSpectrum.h>
+#include <sound2osc/trigger/TriggerBatch.h>
 #include <sound2osc/trigger/TriggerFilter.h>
 
 #include <QObject>
 #include <QJsonObject>
 
+#include <atomic>
+
 
 // Forward declaration to reduce dependencies:
 class OSCNetworkManager;
@@ -47,6 +50,19 @@ public:
     // forceRelease is true when low solo mode is active and a lower trigger was activated
     virtual bool checkForTrigger(const ScaledSpectrum& spectrum, bool forceRelease) = 0;
 
+    // returns the band range, threshold and inversion used by the TriggerBatch of the FFTAnalyzer
+    // - only called after takeParametersChanged() returned true
+    virtual sound2osc::TriggerParameters getTriggerParameters(const ScaledSpectrum& spectrum) const = 0;
+
+    // handles an On, Off or Level event found by the TriggerBatch of the FFTAnalyzer
+    virtual void handleTriggerEvent(const sound2osc::TriggerEvent& event) = 0;
+
+    // returns true once after the trigger parameters changed (and at the beginning)
+    bool takeParametersChanged() {
+        return m_parametersChanged.load(std::memory_order_relaxed)
+               && m_parametersChanged.exchange(false, std::memory_order_acquire);
+    }
+
 	// returns a reference to the internal TriggerFilter
 	virtual TriggerFilter& getTriggerFilter() = 0;
 
@@ -64,7 +80,13 @@ public:
     bool isBandpass() const { return m_isBandpass; }
 
 protected:
+    // to be called after a parameter returned by getTriggerParameters() was changed
+    void markParametersChanged() { m_parametersChanged.store(true, std::memory_order_release); }
+
     const bool m_isBandpass;  // true if this is a bandpass (with frequency and width parameter)
+
+private:
+    std::atomic<bool> m_parametersChanged{true};  // true if getTriggerParameters() has to be called
 };
 
 
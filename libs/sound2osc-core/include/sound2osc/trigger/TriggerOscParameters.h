@@ -23,46 +23,86 @@
 #ifndef TRIGGEROSCPARAMETERS_H
 #define TRIGGEROSCPARAMETERS_H
 
+#include <sound2osc/osc/OSCPacketTemplate.h>
+#include <sound2osc/osc/OSCDestination.h>
+#include <sound2osc/core/TripleBuffer.h>
+
 #include <QtGlobal>
 #include <QString>
+#include <QMutex>
 #include <QSettings>
 #include <QJsonObject>
 
 // A class to store OSC parameters (messages and min and max values).
+// The UI and incoming OSC messages change the parameters, the accessors
+// are guarded by a mutex.
+// The messages are encoded to OSC packets when they are set (see OSCPacketTemplate),
+// outside of the mutex. Every change publishes a copy of everything that is sent
+// (templates, min and max level value, routes), the processing thread reads
+// this copy with messages() without a lock.
 class TriggerOscParameters
 {
 public:
+	// everything the processing thread needs to send the messages of a trigger
+	struct Messages
+	{
+		sound2osc::OSCPacketTemplate on;
+		sound2osc::OSCPacketTemplate off;
+		sound2osc::OSCPacketTemplate level;
+		qreal minLevelValue = 0;
+		qreal maxLevelValue = 1;
+		sound2osc::OSCRoutes::Mask routes = sound2osc::OSCRoutes::PRIMARY;
+
+		// scales a level of 0...1 to minLevelValue...maxLevelValue
+		qreal scaleLevel(qreal value) const { return minLevelValue + value * (maxLevelValue - minLevelValue); }
+	};
+
 	TriggerOscParameters();
 
+	// returns the latest copy of the encoded messages, min and max level value and routes
+	// - only to be called by the processing side (one thread at a time), never blocks
+	// - the reference stays valid until the next call
+	const Messages& messages() const { m_published.update(); return m_published.front(); }
+
 	// returns the OSC message to be sent when the trigger is activated
-	QString getOnMessage() const { return m_onMessage; }
+	QString getOnMessage() const { QMutexLocker locker(&m_mutex); return m_onMessage.message(); }
 	// sets the OSC message to be sent when the trigger is activated
-	void setOnMessage(const QString& value) { m_onMessage = value; }
+	void setOnMessage(const QString& value);
 
 	// returns the OSC message to be sent when the trigger is released
-	QString getOffMessage() const { return m_offMessage; }
+	QString getOffMessage() const { QMutexLocker locker(&m_mutex); return m_offMessage.message(); }
 	// sets the OSC message to be sent when the trigger is released
-	void setOffMessage(const QString& value) { m_offMessage = value; }
+	void setOffMessage(const QString& value);
 
 	// returns the OSC path where the level value should be sent to
-	QString getLevelMessage() const { return m_levelMessage; }
+	QString getLevelMessage() const { QMutexLocker locker(&m_mutex); return m_levelMessage.message(); }
 	// sets the OSC path where the level value should be sent to
-	void setLevelMessage(const QString& value) { m_levelMessage = value; }
+	void setLevelMessage(const QString& value);
+
+	// returns the OSC type of the level value (float with 3 decimals, float or int)
+	sound2osc::OSCPacketTemplate::ValueType getLevelValueType() const { QMutexLocker locker(&m_mutex); return m_levelMessage.valueType(); }
+	// sets the OSC type of the level value, the value is scaled to the min and max level value before
+	void setLevelValueType(sound2osc::OSCPacketTemplate::ValueType value);
 
 	// returns the value to send when the trigger level is zero
-	qreal getMinLevelValue() const { return m_minLevelValue; }
+	qreal getMinLevelValue() const { QMutexLocker locker(&m_mutex); return m_minLevelValue; }
 	// sets the value to send when the trigger level is zero
-	void setMinLevelValue(const qreal& value) { m_minLevelValue = value; }
+	void setMinLevelValue(const qreal& value) { QMutexLocker locker(&m_mutex); m_minLevelValue = value; publishLocked(); }
 
 	// returns the value to send when the trigger level is at its maximum
-	qreal getMaxLevelValue() const { return m_maxLevelValue; }
+	qreal getMaxLevelValue() const { QMutexLocker locker(&m_mutex); return m_maxLevelValue; }
 	// sets the value to send when the trigger level is at its maximum
-	void setMaxLevelValue(const qreal& value) { m_maxLevelValue = value; }
+	void setMaxLevelValue(const qreal& value) { QMutexLocker locker(&m_mutex); m_maxLevelValue = value; publishLocked(); }
+
+	// returns the destinations of the On, Off and Level messages (bit n = destination n, see OSCRoutes)
+	sound2osc::OSCRoutes::Mask getRoutes() const { QMutexLocker locker(&m_mutex); return m_routes; }
+	// sets the destinations of the On, Off and Level messages (default is the primary destination)
+	void setRoutes(sound2osc::OSCRoutes::Mask value) { QMutexLocker locker(&m_mutex); m_routes = value; publishLocked(); }
 
 	// returns a short label that describes the OSC target
-	QString getLabelText() const { return m_labelText; }
+	QString getLabelText() const { QMutexLocker locker(&m_mutex); return m_labelText; }
 	// sets a short label that describes the OSC target
-	void setLabelText(const QString& value) { m_labelText = value; }
+	void setLabelText(const QString& value) { QMutexLocker locker(&m_mutex); m_labelText = value; }
 
 	// --------------------- Save / Restore ---------------------
 
@@ -79,12 +119,22 @@ public:
 	void resetParameters();
 
 protected:
-	QString		m_onMessage;  // On message ("/path/value=argument")
-	QString		m_offMessage;  // Off message ("/path/value=argument")
-	QString		m_levelMessage;  // Level message ("/path/value=")
+	// hands a copy of the sent parameters over to messages(), m_mutex must be locked
+	void publishLocked();
+
+	// sets the Level message with the text and value type, encoded outside of m_mutex
+	// - a null pointer keeps the current text or value type
+	void setLevel(const QString* message, const sound2osc::OSCPacketTemplate::ValueType* valueType);
+
+	sound2osc::OSCPacketTemplate m_onMessage;  // On message ("/path/value=argument")
+	sound2osc::OSCPacketTemplate m_offMessage;  // Off message ("/path/value=argument")
+	sound2osc::OSCPacketTemplate m_levelMessage;  // Level message ("/path/value=") and type of the level value
 	qreal		m_minLevelValue;  // min value to be used for Level message
 	qreal		m_maxLevelValue;  // max value to be used for Level message
+	sound2osc::OSCRoutes::Mask m_routes;  // destinations of all messages
 	QString		m_labelText;  // Short description text of parameters to be displayed in UI
+	mutable QMutex	m_mutex;  // guards all members above
+	mutable sound2osc::TripleBuffer<Messages> m_published;  // written under m_mutex, read by the processing thread
 
 };
 
@@ -161,7 +161,7 @@ void MiniaudioInputWrapper::initDevice(const ma_device_id* id)
     config.capture.pDeviceID = const_cast<ma_device_id*>(id);
     config.capture.format = ma_format_f32;
     config.capture.channels = 2; // Stereo
-    config.sampleRate = 44100;
+    config.sampleRate = static_cast<ma_uint32>(m_preferredSampleRate); // 0 = native rate of the device
     config.dataCallback = data_callback_c;
     config.pUserData = this;
 
@@ -169,6 +169,9 @@ void MiniaudioInputWrapper::initDevice(const ma_device_id* id)
         sound2osc::Logger::error("Failed to initialize miniaudio device");
         return;
     }
+    m_channels = static_cast<int>(m_device.capture.channels);
+    m_buffer->setSampleRate(static_cast<int>(m_device.sampleRate));
+    sound2osc::Logger::info("Audio input opened at %1 Hz", static_cast<int>(m_device.sampleRate));
     m_deviceInit = true;
 }
 
@@ -187,32 +190,14 @@ void MiniaudioInputWrapper::setVolume(const qreal& value)
 
 void MiniaudioInputWrapper::onData(const void* pInput, ma_uint32 frameCount)
 {
-    if (frameCount == 0) return;
-
-    const float* samples = static_cast<const float*>(pInput);
-    QVector<qreal> buffer(frameCount); // qreal is double by default in Qt, or float?
-    // In sound2osc, MonoAudioBuffer expects QVector<qreal>. 
-    // Miniaudio gives interleaved stereo float (L R L R).
-    // But MonoAudioBuffer::putSamples takes QVector<qreal>& data, channelCount.
-    // It handles conversion to mono.
-    // So we just need to pass the raw data?
-    // putSamples expects: "Converts PCM data with multiple channels to mono... data object will be resized"
-    // Wait, putSamples implementation:
-    // void MonoAudioBuffer::putSamples(QVector<qreal>& data, const int& channelCount)
-    // It calls convertToMonoInplace.
-    
-    // So we need to put the interleaved data into QVector<qreal>.
-    // samples has 2 * frameCount floats.
-    
-    int channels = 2;
-    buffer.resize(frameCount * channels);
-    for (ma_uint32 i = 0; i < frameCount * channels; ++i) {
-        buffer[i] = static_cast<qreal>(samples[i]);
-    }
+    if (frameCount == 0 || !pInput) return;
 
-    m_buffer->putSamples(buffer, channels);
+    // Miniaudio delivers interleaved f32 frames, they are converted to mono
+    // directly into the ring buffer without any allocation on this thread:
+    const int frames = static_cast<int>(frameCount);
+    m_buffer->putInterleaved(static_cast<const float*>(pInput), frames, m_channels);
 
     if (m_callback) {
-        m_callback(frameCount);
+        m_callback(frames);
     }
 }
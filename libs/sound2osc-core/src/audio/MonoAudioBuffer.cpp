@@ -22,57 +22,117 @@
 
 #include <sound2osc/audio/MonoAudioBuffer.h>
 
+#include <sound2osc/audio/SampleConversion.h>
 #include <sound2osc/dsp/FFTAnalyzer.h>
 
-MonoAudioBuffer::MonoAudioBuffer(int capacity)
-	: m_capacity(capacity)
-	, m_buffer(capacity)
-    , m_numPutSamples(0)
-{
-	for (int i=0; i < m_buffer.capacity(); ++i) {
-		m_buffer.push_back(0.0);
-	}
-}
+namespace {
 
-void MonoAudioBuffer::putSamples(QVector<qreal>& data, const int& channelCount)
+// Converts interleaved PCM frames to mono with the vectorized kernels of
+// SampleConversion directly into the free space of the ring buffer.
+template<typename T>
+void writeInterleaved(sound2osc::RingBuffer<float>& buffer, const T* data, int frameCount, int channelCount)
 {
-	// convert incoming mulitchannel audio to mono:
-	convertToMonoInplace(data, channelCount);
+	if (!data || channelCount <= 0) return;
 
-	for (int i=0; i<data.size(); ++i) {
-		m_buffer.push_back(data[i]);
-    }
-
-    m_numPutSamples += data.size();
+	while (frameCount > 0) {
+		const auto region = buffer.prepareWrite(frameCount);
+		sound2osc::SampleConversion::interleavedToMono(data, region.firstSize, channelCount, region.first);
+		sound2osc::SampleConversion::interleavedToMono(data + region.firstSize * channelCount, region.secondSize, channelCount, region.second);
+		buffer.commitWrite(region.size());
+		data += region.size() * channelCount;
+		frameCount -= region.size();
+	}
 }
 
-void MonoAudioBuffer::convertToMonoInplace(QVector<qreal>& data, const int& channelCount) const {
-	// - assumes that data for two channels A and B looks like ABABABABAB...
-	// - channels are average to get mono signal
-	// - result will be written inplace and data object will be decreased in size
+// Converts count interleaved double precision frames to mono by averaging all channels.
+// - assumes that data for two channels A and B looks like ABABABABAB...
+void convertToMono(float* dest, int count, const double* data, int channelCount)
+{
 	switch (channelCount) {
 	case 1:
+		for (int i=0; i<count; ++i) {
+			dest[i] = static_cast<float>(data[i]);
+		}
 		break;
 	case 2:
-		for (int i=0; i<data.size(); i+=2) {
+		for (int i=0; i<count; ++i) {
 			// calculate average of both channels:
-			data[i/2] = (data[i] + data[i+1]) / 2.0;
+			dest[i] = static_cast<float>((data[2*i] + data[2*i+1]) / 2.0);
 		}
-		data.resize(data.size() / 2);
 		break;
 	default:
-		for (int i=0; i<data.size(); i+=channelCount) {
-			qreal mono = 0.0;
+		for (int i=0; i<count; ++i) {
+			const double* frame = data + i * channelCount;
+			double mono = 0.0;
 			for (int ch=0; ch<channelCount; ++ch) {
 				// sum up all channels:
-				mono += data[i+ch];
+				mono += frame[ch];
 			}
 			// calculate average of all channels:
-			mono /= channelCount;
-			data[i/channelCount] = mono;
+			dest[i] = static_cast<float>(mono / channelCount);
 		}
-		data.resize(data.size() / channelCount);
 		break;
 	}
+}
+
+// Writes interleaved double precision frames (already in [-1...1]), used by the qreal compatibility API.
+void writeInterleaved(sound2osc::RingBuffer<float>& buffer, const double* data, int frameCount, int channelCount)
+{
+	if (!data || channelCount <= 0) return;
+
+	while (frameCount > 0) {
+		const auto region = buffer.prepareWrite(frameCount);
+		convertToMono(region.first, region.firstSize, data, channelCount);
+		convertToMono(region.second, region.secondSize, data + region.firstSize * channelCount, channelCount);
+		buffer.commitWrite(region.size());
+		data += region.size() * channelCount;
+		frameCount -= region.size();
+	}
+}
+
+} // namespace
+
+MonoAudioBuffer::MonoAudioBuffer(int capacity)
+	: m_capacity(capacity)
+	, m_buffer(capacity)
+	, m_sampleRate(DEFAULT_SAMPLE_RATE)
+{
+	// the ring buffer is zero initialized, no need to fill it
+}
+
+void MonoAudioBuffer::putInterleaved(const float* data, int frameCount, int channelCount)
+{
+	writeInterleaved(m_buffer, data, frameCount, channelCount);
+}
+
+void MonoAudioBuffer::putInterleaved(const double* data, int frameCount, int channelCount)
+{
+	writeInterleaved(m_buffer, data, frameCount, channelCount);
+}
+
+void MonoAudioBuffer::putInterleaved(const int16_t* data, int frameCount, int channelCount)
+{
+	writeInterleaved(m_buffer, data, frameCount, channelCount);
+}
 
+void MonoAudioBuffer::putInterleaved(const int32_t* data, int frameCount, int channelCount)
+{
+	writeInterleaved(m_buffer, data, frameCount, channelCount);
+}
+
+void MonoAudioBuffer::putInterleaved(const uint8_t* data, int frameCount, int channelCount)
+{
+	writeInterleaved(m_buffer, data, frameCount, channelCount);
+}
+
+void MonoAudioBuffer::putSamples(const QVector<float>& data, const int& channelCount)
+{
+	if (channelCount <= 0) return;
+	putInterleaved(data.constData(), static_cast<int>(data.size()) / channelCount, channelCount);
+}
+
+void MonoAudioBuffer::putSamples(const QVector<double>& data, const int& channelCount)
+{
+	if (channelCount <= 0) return;
+	putInterleaved(data.constData(), static_cast<int>(data.size()) / channelCount, channelCount);
 }
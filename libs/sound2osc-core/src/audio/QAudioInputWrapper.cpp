@@ -31,6 +31,9 @@
 
 #include <iostream>
 
+// number of frames read from the device at once
+static const int READ_BUFFER_FRAMES = 4096;
+
 QAudioInputWrapper::QAudioInputWrapper(MonoAudioBuffer *buffer)
     : AudioInputInterface(buffer)
     , m_audioSource(nullptr)
@@ -38,7 +41,8 @@ QAudioInputWrapper::QAudioInputWrapper(MonoAudioBuffer *buffer)
 {
     // Set up the desired format:
     // If the input device doesn't support this the nearest format will be used.
-    m_desiredAudioFormat.setSampleRate(44100);
+    // (the sample rate is chosen when the device is opened)
+    m_desiredAudioFormat.setSampleRate(DEFAULT_SAMPLE_RATE);
     m_desiredAudioFormat.setChannelCount(2);
     // Qt6: Use setSampleFormat instead of setSampleSize/setSampleType/setCodec/setByteOrder
     m_desiredAudioFormat.setSampleFormat(QAudioFormat::Int16);
@@ -101,6 +105,10 @@ void QAudioInputWrapper::setInputByName(const QString &inputName)
         }
     }
 
+    // use the preferred sample rate or the native rate of the device to avoid resampling:
+    const int sampleRate = m_preferredSampleRate > 0 ? m_preferredSampleRate : selectedDevice.preferredFormat().sampleRate();
+    m_desiredAudioFormat.setSampleRate(sampleRate);
+
     // check if desired format is supported:
     if (!selectedDevice.isFormatSupported(m_desiredAudioFormat)) {
         qWarning() << "Default audio format not supported, trying to use the nearest.";
@@ -108,7 +116,7 @@ void QAudioInputWrapper::setInputByName(const QString &inputName)
         // Try to get a supported format from the device's preferred format
         m_actualAudioFormat = selectedDevice.preferredFormat();
         // Override with our preferences where possible
-        m_actualAudioFormat.setSampleRate(44100);
+        m_actualAudioFormat.setSampleRate(sampleRate);
         m_actualAudioFormat.setChannelCount(2);
         if (!selectedDevice.isFormatSupported(m_actualAudioFormat)) {
             // Fall back to device's preferred format entirely
@@ -118,10 +126,15 @@ void QAudioInputWrapper::setInputByName(const QString &inputName)
         m_actualAudioFormat = m_desiredAudioFormat;
     }
 
+    // all analysis stages derive their timing from the sample rate of the buffer:
+    m_buffer->setSampleRate(m_actualAudioFormat.sampleRate());
+
     // create new input:
     m_activeInputName = inputName;
     m_audioSource = new QAudioSource(selectedDevice, m_actualAudioFormat, this);
     m_audioSource->setVolume(1.0f);
+    // allocate the read buffer once per device, it is reused for every chunk:
+    m_readBuffer.resize(qsizetype(READ_BUFFER_FRAMES) * qMax(1, m_actualAudioFormat.bytesPerFrame()));
     m_audioIODevice = m_audioSource->start();
     if (m_audioIODevice) {
         connect(m_audioIODevice, &QIODevice::readyRead, this, &QAudioInputWrapper::audioDataReady);
@@ -165,64 +178,49 @@ void QAudioInputWrapper::setVolume(const qreal &value)
 void QAudioInputWrapper::audioDataReady()
 {
     if (!m_audioIODevice) return;
-    
-    // read data from input as QByteArray:
-    QByteArray data = m_audioIODevice->readAll();
-    
-    // Qt6: bytesPerSample() returns the size per sample
-    const int bytesPerSample = m_actualAudioFormat.bytesPerSample();
-    if (bytesPerSample <= 0) return;
-    
-    const qsizetype numSamples = data.size() / bytesPerSample;
-    if (numSamples <= 0) return;
-    
-    QVector<qreal> realData(numSamples);
-    const char *ptr = data.constData();
 
-    // Handle different sample formats
-    QAudioFormat::SampleFormat sampleFormat = m_actualAudioFormat.sampleFormat();
-    
-    for (qsizetype i = 0; i < numSamples; ++i) {
-        qreal scaled = 0.0;
-        
+    // Qt6: bytesPerFrame() returns the size of one sample for all channels
+    const int channelCount = m_actualAudioFormat.channelCount();
+    const int bytesPerFrame = m_actualAudioFormat.bytesPerFrame();
+    if (channelCount <= 0 || bytesPerFrame <= 0) return;
+
+    const QAudioFormat::SampleFormat sampleFormat = m_actualAudioFormat.sampleFormat();
+    const int maxFrames = static_cast<int>(m_readBuffer.size()) / bytesPerFrame;
+    if (maxFrames <= 0) return;
+    int totalFrames = 0;
+
+    // read only complete frames into the preallocated buffer,
+    // the rest stays in the device until the next call:
+    while (m_audioIODevice->bytesAvailable() >= bytesPerFrame) {
+        const qint64 framesAvailable = m_audioIODevice->bytesAvailable() / bytesPerFrame;
+        const int framesToRead = static_cast<int>(qMin<qint64>(framesAvailable, maxFrames));
+        const qint64 bytesRead = m_audioIODevice->read(m_readBuffer.data(), qint64(framesToRead) * bytesPerFrame);
+        if (bytesRead <= 0) break;
+        const int frames = static_cast<int>(bytesRead / bytesPerFrame);
+
+        // Call MonoAudioBuffer as next element in processing chain:
+        const char* data = m_readBuffer.constData();
         switch (sampleFormat) {
         case QAudioFormat::Int16:
-            {
-                const qint16 pcmSample = *reinterpret_cast<const qint16*>(ptr);
-                scaled = static_cast<qreal>(pcmSample) / 32768.0;
-            }
+            m_buffer->putInterleaved(reinterpret_cast<const int16_t*>(data), frames, channelCount);
             break;
         case QAudioFormat::Int32:
-            {
-                const qint32 pcmSample = *reinterpret_cast<const qint32*>(ptr);
-                scaled = static_cast<qreal>(pcmSample) / 2147483648.0;
-            }
+            m_buffer->putInterleaved(reinterpret_cast<const int32_t*>(data), frames, channelCount);
             break;
         case QAudioFormat::Float:
-            {
-                const float pcmSample = *reinterpret_cast<const float*>(ptr);
-                scaled = static_cast<qreal>(pcmSample);
-            }
+            m_buffer->putInterleaved(reinterpret_cast<const float*>(data), frames, channelCount);
             break;
         case QAudioFormat::UInt8:
-            {
-                const quint8 pcmSample = *reinterpret_cast<const quint8*>(ptr);
-                scaled = (static_cast<qreal>(pcmSample) - 128.0) / 128.0;
-            }
+            m_buffer->putInterleaved(reinterpret_cast<const uint8_t*>(data), frames, channelCount);
             break;
         default:
             // Unknown format, skip
-            break;
+            return;
         }
-        
-        realData[i] = scaled;
-        ptr += bytesPerSample;
+        totalFrames += frames;
     }
 
-    // Call MonoAudioBuffer as next element in processing chain:
-    m_buffer->putSamples(realData, m_actualAudioFormat.channelCount());
-
-    if (m_callback) {
-        m_callback(realData.size());
+    if (m_callback && totalFrames > 0) {
+        m_callback(totalFrames);
     }
 }
@@ -0,0 +1,439 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/audio/SampleConversion.h>
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOUND2OSC_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are compiled with a target attribute and selected at runtime,
+// so the library itself still runs on CPUs without AVX2:
+#if defined(SOUND2OSC_HAVE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOUND2OSC_HAVE_AVX2
+#define SOUND2OSC_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SOUND2OSC_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace sound2osc {
+namespace SampleConversion {
+
+namespace {
+
+// Integer samples are converted to float first (without scaling) in chunks of
+// this size, the chunk then stays in L1 cache for the downmix.
+constexpr int CHUNK_SAMPLES = 1024;
+
+constexpr float INT16_SCALE = 1.0f / 32768.0f;
+constexpr float INT32_SCALE = 1.0f / 2147483648.0f;
+constexpr float UINT8_SCALE = 1.0f / 128.0f;
+
+struct Kernels {
+    const char* name;
+    // convert count samples to float without scaling (uint8 is shifted by -128):
+    void (*convertInt16)(const int16_t* input, int count, float* output);
+    void (*convertInt32)(const int32_t* input, int count, float* output);
+    void (*convertUInt8)(const uint8_t* input, int count, float* output);
+    // sum up all channels of each frame and multiply the sum with gain:
+    void (*downmix)(const float* input, int frameCount, int channelCount, float gain, float* output);
+};
+
+// ------------------------------------- Scalar -------------------------------------
+
+void convertInt16Scalar(const int16_t* input, int count, float* output)
+{
+    for (int i = 0; i < count; ++i) output[i] = static_cast<float>(input[i]);
+}
+
+void convertInt32Scalar(const int32_t* input, int count, float* output)
+{
+    for (int i = 0; i < count; ++i) output[i] = static_cast<float>(input[i]);
+}
+
+void convertUInt8Scalar(const uint8_t* input, int count, float* output)
+{
+    for (int i = 0; i < count; ++i) output[i] = static_cast<float>(static_cast<int>(input[i]) - 128);
+}
+
+void downmixScalar(const float* input, int frameCount, int channelCount, float gain, float* output)
+{
+    switch (channelCount) {
+    case 1:
+        for (int i = 0; i < frameCount; ++i) output[i] = input[i] * gain;
+        break;
+    case 2:
+        for (int i = 0; i < frameCount; ++i) output[i] = (input[2*i] + input[2*i+1]) * gain;
+        break;
+    default:
+        for (int i = 0; i < frameCount; ++i) {
+            const float* frame = input + i * channelCount;
+            float sum = 0.0f;
+            for (int ch = 0; ch < channelCount; ++ch) sum += frame[ch];
+            output[i] = sum * gain;
+        }
+        break;
+    }
+}
+
+const Kernels SCALAR_KERNELS = {
+    "scalar", convertInt16Scalar, convertInt32Scalar, convertUInt8Scalar, downmixScalar
+};
+
+// -------------------------------------- SSE2 --------------------------------------
+
+#ifdef SOUND2OSC_HAVE_SSE2
+
+void convertInt16Sse2(const int16_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // sign extend by placing the 16 bit values in the upper half and shifting back:
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(output + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(output + i + 4, _mm_cvtepi32_ps(hi));
+    }
+    convertInt16Scalar(input + i, count - i, output + i);
+}
+
+void convertInt32Sse2(const int32_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm_storeu_ps(output + i, _mm_cvtepi32_ps(v));
+    }
+    convertInt32Scalar(input + i, count - i, output + i);
+}
+
+void convertUInt8Sse2(const uint8_t* input, int count, float* output)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi16(128);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i lo16 = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), offset);
+        const __m128i hi16 = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), offset);
+        _mm_storeu_ps(output + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo16, lo16), 16)));
+        _mm_storeu_ps(output + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo16, lo16), 16)));
+        _mm_storeu_ps(output + i + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi16, hi16), 16)));
+        _mm_storeu_ps(output + i + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi16, hi16), 16)));
+    }
+    convertUInt8Scalar(input + i, count - i, output + i);
+}
+
+// Downmix for a channel count that is a multiple of 4 (e.g. 4 or 8 channel interfaces):
+// the channels of each frame are summed up to 4 partial sums, then 4 frames are
+// transposed so that adding the rows yields the 4 mono samples.
+void downmixQuadSse2(const float* input, int frameCount, int channelCount, float gain, float* output)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const int vectorsPerFrame = channelCount / 4;
+    int i = 0;
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 partial[4];
+        for (int f = 0; f < 4; ++f) {
+            const float* frame = input + (i + f) * channelCount;
+            __m128 sum = _mm_loadu_ps(frame);
+            for (int v = 1; v < vectorsPerFrame; ++v) sum = _mm_add_ps(sum, _mm_loadu_ps(frame + 4 * v));
+            partial[f] = sum;
+        }
+        _MM_TRANSPOSE4_PS(partial[0], partial[1], partial[2], partial[3]);
+        const __m128 mono = _mm_add_ps(_mm_add_ps(partial[0], partial[1]), _mm_add_ps(partial[2], partial[3]));
+        _mm_storeu_ps(output + i, _mm_mul_ps(mono, g));
+    }
+    downmixScalar(input + i * channelCount, frameCount - i, channelCount, gain, output + i);
+}
+
+void downmixSse2(const float* input, int frameCount, int channelCount, float gain, float* output)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    if (channelCount == 1) {
+        for (; i + 4 <= frameCount; i += 4) {
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(input + i), g));
+        }
+    } else if (channelCount == 2) {
+        for (; i + 4 <= frameCount; i += 4) {
+            const __m128 a = _mm_loadu_ps(input + 2 * i);      // L0 R0 L1 R1
+            const __m128 b = _mm_loadu_ps(input + 2 * i + 4);  // L2 R2 L3 R3
+            const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_add_ps(left, right), g));
+        }
+    } else if (channelCount % 4 == 0) {
+        downmixQuadSse2(input, frameCount, channelCount, gain, output);
+        return;
+    }
+    downmixScalar(input + i * channelCount, frameCount - i, channelCount, gain, output + i);
+}
+
+const Kernels SSE2_KERNELS = {
+    "sse2", convertInt16Sse2, convertInt32Sse2, convertUInt8Sse2, downmixSse2
+};
+
+#endif // SOUND2OSC_HAVE_SSE2
+
+// -------------------------------------- AVX2 --------------------------------------
+
+#ifdef SOUND2OSC_HAVE_AVX2
+
+SOUND2OSC_TARGET_AVX2
+void convertInt16Avx2(const int16_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+        _mm256_storeu_ps(output + i, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(lo)));
+        _mm256_storeu_ps(output + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(hi)));
+    }
+    convertInt16Scalar(input + i, count - i, output + i);
+}
+
+SOUND2OSC_TARGET_AVX2
+void convertInt32Avx2(const int32_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        _mm256_storeu_ps(output + i, _mm256_cvtepi32_ps(v));
+    }
+    convertInt32Scalar(input + i, count - i, output + i);
+}
+
+SOUND2OSC_TARGET_AVX2
+void convertUInt8Avx2(const uint8_t* input, int count, float* output)
+{
+    const __m256i offset = _mm256_set1_epi32(128);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i lo = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i hi = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i + 8));
+        _mm256_storeu_ps(output + i, _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(lo), offset)));
+        _mm256_storeu_ps(output + i + 8, _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(hi), offset)));
+    }
+    convertUInt8Scalar(input + i, count - i, output + i);
+}
+
+SOUND2OSC_TARGET_AVX2
+void downmixAvx2(const float* input, int frameCount, int channelCount, float gain, float* output)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    if (channelCount == 1) {
+        for (; i + 8 <= frameCount; i += 8) {
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), g));
+        }
+    } else if (channelCount == 2) {
+        for (; i + 8 <= frameCount; i += 8) {
+            const __m256 a = _mm256_loadu_ps(input + 2 * i);      // L0 R0 L1 R1 | L2 R2 L3 R3
+            const __m256 b = _mm256_loadu_ps(input + 2 * i + 8);  // L4 R4 L5 R5 | L6 R6 L7 R7
+            // shuffles work per 128 bit lane: L0 L1 L4 L5 | L2 L3 L6 L7
+            const __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m256 sum = _mm256_mul_ps(_mm256_add_ps(left, right), g);
+            // restore the frame order by swapping the middle 64 bit blocks:
+            const __m256d ordered = _mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_ps(output + i, _mm256_castpd_ps(ordered));
+        }
+    } else if (channelCount % 4 == 0) {
+        downmixQuadSse2(input, frameCount, channelCount, gain, output);
+        return;
+    }
+    downmixScalar(input + i * channelCount, frameCount - i, channelCount, gain, output + i);
+}
+
+const Kernels AVX2_KERNELS = {
+    "avx2", convertInt16Avx2, convertInt32Avx2, convertUInt8Avx2, downmixAvx2
+};
+
+#endif // SOUND2OSC_HAVE_AVX2
+
+// -------------------------------------- NEON --------------------------------------
+
+#ifdef SOUND2OSC_HAVE_NEON
+
+void convertInt16Neon(const int16_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t v = vld1q_s16(input + i);
+        vst1q_f32(output + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))));
+        vst1q_f32(output + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))));
+    }
+    convertInt16Scalar(input + i, count - i, output + i);
+}
+
+void convertInt32Neon(const int32_t* input, int count, float* output)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(output + i, vcvtq_f32_s32(vld1q_s32(input + i)));
+    }
+    convertInt32Scalar(input + i, count - i, output + i);
+}
+
+void convertUInt8Neon(const uint8_t* input, int count, float* output)
+{
+    const int16x8_t offset = vdupq_n_s16(128);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t v = vld1q_u8(input + i);
+        const int16x8_t lo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v))), offset);
+        const int16x8_t hi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v))), offset);
+        vst1q_f32(output + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))));
+        vst1q_f32(output + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))));
+        vst1q_f32(output + i + 8, vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))));
+        vst1q_f32(output + i + 12, vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))));
+    }
+    convertUInt8Scalar(input + i, count - i, output + i);
+}
+
+void downmixNeon(const float* input, int frameCount, int channelCount, float gain, float* output)
+{
+    const float32x4_t g = vdupq_n_f32(gain);
+    int i = 0;
+    if (channelCount == 1) {
+        for (; i + 4 <= frameCount; i += 4) {
+            vst1q_f32(output + i, vmulq_f32(vld1q_f32(input + i), g));
+        }
+    } else if (channelCount == 2) {
+        for (; i + 4 <= frameCount; i += 4) {
+            const float32x4x2_t lr = vld2q_f32(input + 2 * i);  // deinterleaves L and R
+            vst1q_f32(output + i, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), g));
+        }
+#if defined(__aarch64__)
+    } else if (channelCount % 4 == 0) {
+        // see downmixQuadSse2(), pairwise adds replace the transpose here
+        const int vectorsPerFrame = channelCount / 4;
+        for (; i + 4 <= frameCount; i += 4) {
+            float32x4_t partial[4];
+            for (int f = 0; f < 4; ++f) {
+                const float* frame = input + (i + f) * channelCount;
+                float32x4_t sum = vld1q_f32(frame);
+                for (int v = 1; v < vectorsPerFrame; ++v) sum = vaddq_f32(sum, vld1q_f32(frame + 4 * v));
+                partial[f] = sum;
+            }
+            const float32x4_t mono = vpaddq_f32(vpaddq_f32(partial[0], partial[1]), vpaddq_f32(partial[2], partial[3]));
+            vst1q_f32(output + i, vmulq_f32(mono, g));
+        }
+#endif
+    }
+    downmixScalar(input + i * channelCount, frameCount - i, channelCount, gain, output + i);
+}
+
+const Kernels NEON_KERNELS = {
+    "neon", convertInt16Neon, convertInt32Neon, convertUInt8Neon, downmixNeon
+};
+
+#endif // SOUND2OSC_HAVE_NEON
+
+// ------------------------------------ Dispatch ------------------------------------
+
+const Kernels* detectKernels()
+{
+#if defined(SOUND2OSC_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+#endif
+#if defined(SOUND2OSC_HAVE_SSE2)
+    return &SSE2_KERNELS;
+#elif defined(SOUND2OSC_HAVE_NEON)
+    return &NEON_KERNELS;
+#else
+    return &SCALAR_KERNELS;
+#endif
+}
+
+std::atomic<const Kernels*>& activeKernels()
+{
+    static std::atomic<const Kernels*> active{detectKernels()};
+    return active;
+}
+
+const Kernels& kernels()
+{
+    return *activeKernels().load(std::memory_order_relaxed);
+}
+
+template<typename T, typename Convert>
+void convertAndDownmix(const T* input, int frameCount, int channelCount, float scale, float* output, Convert convert)
+{
+    if (!input || frameCount <= 0 || channelCount <= 0) return;
+    const Kernels& k = kernels();
+    const float gain = scale / static_cast<float>(channelCount);
+
+    // frames per chunk, at least one even for absurd channel counts:
+    const int framesPerChunk = channelCount <= CHUNK_SAMPLES ? CHUNK_SAMPLES / channelCount : 1;
+    if (channelCount > CHUNK_SAMPLES) {
+        // no chunk buffer large enough, convert sample by sample:
+        for (int i = 0; i < frameCount; ++i) {
+            float sum = 0.0f;
+            for (int ch = 0; ch < channelCount; ++ch) {
+                float value;
+                convert(k, input + i * channelCount + ch, 1, &value);
+                sum += value;
+            }
+            output[i] = sum * gain;
+        }
+        return;
+    }
+
+    float chunk[CHUNK_SAMPLES];
+    for (int i = 0; i < frameCount; i += framesPerChunk) {
+        const int frames = frameCount - i < framesPerChunk ? frameCount - i : framesPerChunk;
+        convert(k, input + i * channelCount, frames * channelCount, chunk);
+        k.downmix(chunk, frames, channelCount, gain, output + i);
+    }
+}
+
+} // namespace
+
+void interleavedToMono(const float* input, int frameCount, int channelCount, float* output)
+{
+    if (!input || frameCount <= 0 || channelCount <= 0) return;
+    // no format conversion needed, downmix directly from the input:
+    kernels().downmix(input, frameCount, channelCount, 1.0f / static_cast<float>(channelCount), output);
+}
+
+void interleavedToMono(const int16_t* input, int frameCount, int channelCount, float* output)
+{
+    convertAndDownmix(input, frameCount, channelCount, INT16_SCALE, output,
+                      [](const Kernels& k, const int16_t* in, int count, float* out) { k.convertInt16(in, count, out); });
+}
+
+void interleavedToMono(const int32_t* input, int frameCount, int channelCount, float* output)
+{
+    convertAndDownmix(input, frameCount, channelCount, INT32_SCALE, output,
+                      [](const Kernels& k, const int32_t* in, int count, float* out) { k.convertInt32(in, count, out); });
+}
+
+void interleavedToMono(const uint8_t* input, int frameCount, int channelCount, float* output)
+{
+    convertAndDownmix(input, frameCount, channelCount, UINT8_SCALE, output,
+                      [](const Kernels& k, const uint8_t* in, int count, float* out) { k.convertUInt8(in, count, out); });
+}
+
+const char* kernelName()
+{
+    return kernels().name;
+}
+
+void setSimdEnabled(bool enabled)
+{
+    activeKernels().store(enabled ? detectKernels() : &SCALAR_KERNELS, std::memory_order_relaxed);
+}
+
+} // namespace SampleConversion
+} // namespace sound2osc
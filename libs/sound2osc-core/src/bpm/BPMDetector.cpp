@@ -22,12 +22,13 @@
 
 #include <sound2osc/bpm/BPMDetector.h>
 
-#include <sound2osc/dsp/FFTRealWrapper.h>
 #include <sound2osc/core/QCircularBuffer.h>
 
 #include <QTime>
 
+#include <algorithm>
 #include <list>
+#include <numeric>
 
 /* The BPM Detector is responsible for detecting the musical tempo of the input Signal 
  * in Beats Per Minute. This inforamtion is then sent via osc to set Tempo of an effect
@@ -81,25 +82,38 @@
  * smoothing it in relation the previous values.
  * The stages are described in detail below
  *
- * 1. Spectral Flux `updateSpectralFluxes()`
- * -----------------------------------------
+ * 1. Spectral Flux `updateSpectralFlux()`
+ * ----------------------------------------
  * To detect onsets even in very dense music material, merely analyzing the amplitude
  * has proven inefficient. This is why this uses the spectral flux, which is calculated
- * by regularly taking an fft of the audio data and summing the increases per band.
+ * by regularly taking an fft of the audio data and summing the increases of the
+ * magnitude per bin.
  * We analyze the latest 2048 samples of audio data every time 256 new samples come in.
  * This creates an overlap of 87%, which is fine because it ensures a high resolution
  * (172 fps at 44100 kHz) while still including frequencies even under 50Hz. The 256
  * Samples were chosen because we wanted at least 100 fps of prescision, and the 2048
- * were then determined by experiment.
+ * were then determined by experiment. At other sample rates the hop is scaled to keep
+ * the frame rate, and the FFT size is the power of two closest to the same duration.
+ * The windowed FFT of these frames comes from an STFTStage that may be shared with
+ * the FFTAnalyzer. The spectral flux and the waveform colors are two subscribers of
+ * the same frames, so each frame is transformed once.
+ * The increases of all bins are computed in one pass. Besides the flux of the whole
+ * spectrum, the flux of each band of setOnsetBands() (e.g. kick, snare and hi-hat)
+ * is summed from them and kept in a history of its own.
  *
  * 2. Onset Detection `updateOnsets()`
  * -----------------------------------
- * Onset detection is performed every time new samples come in, because the peak 
- * detection algorithm takes an input of values normalized to an average of 0 and
- * a standard deviation of 1. This ensures that the volume of the signal has no
- * effect on the detection, but requires repeating the whole peak detection to ensure
- * that onsets are detected even if they are only considered onsets once they are two
- * seconds old.
+ * Onset detection is performed every time new samples come in. The peak detection
+ * algorithm takes an input of values normalized to an average of 0 and a standard
+ * deviation of 1, which ensures that the volume of the signal has no effect on the
+ * detection. Average and standard deviation are kept as running sums over the
+ * history, and only the new frames are evaluated (each one as soon as the frames of
+ * its local maximum window are there), so the effort does not depend on the length
+ * of the history. The onsets of older frames are kept, they are not evaluated again
+ * with the normalization of later calls. The detection is implemented by OnsetStream.
+ * The bands have the same detection on their own flux, their onsets are sent as
+ * onset triggers via BPMOscControler::transmitOnset(). They react to the hits of one
+ * instrument only, independently of the level of the other bands.
  *
  * _The spectral flux and onset detection approach are taken from the magnificent paper
  * "Evaluation of the Audio Beat Tracking System BeatRoot" by Simon Dixon_
@@ -117,6 +131,12 @@
  * the search continues. If this happens again, the search terminates. Strings with
  * less than 4 onsets (excluding ghost onsets of course) are discarded.
  *
+ * The cost of this search grows with the square of the number of onsets, which causes
+ * spikes on dense material. With setTempoEstimator(TempoEstimator::Autocorrelation)
+ * `updateAutocorrelation()` is used instead: the peaks of the comb filtered
+ * autocorrelation of the spectral flux are used as strings, at a cost that only
+ * depends on the history length.
+ *
  * 4. Evaluation and Smoothing `evaluateStrings()`
  * -----------------------------------------------
  * As a first step, the string that has the highest score (sum of the collected 
@@ -142,30 +162,58 @@
  * getBPM(). The OscController is also notified.
  * If no interval could be identified, a counter is increased to eventually return
  * true from bpmIsOld()
+ *
+ * 5. Beat Tracking `updateBeats()`
+ * --------------------------------
+ * The tempo alone says nothing about where the beats are. A BeatTracker places a
+ * grid with the interval of the detected tempo on the onsets and follows their phase,
+ * ignoring onsets between the beats. As an onset is only detected after the local
+ * maximum window, the beats are predicted from the grid instead. The owner sets
+ * m_beatLead to the delay of the processing plus the network latency: a beat at the
+ * analyzed position plus the lead is due at the receiver now. Every call sends the beats
+ * that are due until the next call with BPMOscControler::transmitBeat(). In bundled OSC
+ * frames each beat gets the time tag of the frame plus its delay, so a receiver that
+ * supports time tags executes it exactly on the beat. Without bundles the beats are sent
+ * right away and are off by up to half a hop.
  */
 
 // --------------------------------------- Constants for BPM Detection ------------------------------
 
 // the number of samples that the bpm detection moves forward as the exponent of 2
+// (at REFERENCE_SAMPLE_RATE, the hop is scaled with the actual sample rate)
 static const int NUM_BPM_SAMPLES_EXPONENT = 8;
 
 // the real number of samples calculated from NUM_BPM_SAMPLES_EXPONENT
 static const int NUM_BPM_SAMPLES = 1 << NUM_BPM_SAMPLES_EXPONENT;
 
 // the number of samples fft-ed for each sample (more to allow overlap) as an exponent of 2
+// (at REFERENCE_SAMPLE_RATE, the nearest power of two is used for other sample rates)
 static const int NUM_BPM_FFT_SAMPLES_EXPONENT = 11;
 
 // the number of samples fft-ed for each sample (more to allow overlap
 static const int NUM_BPM_FFT_SAMPLES = 1 << NUM_BPM_FFT_SAMPLES_EXPONENT;
 
-// Sampling Rate
-static const int SAMPLE_RATE = 44100;
+// range of the FFT size exponent for other sample rates
+static const int MIN_BPM_FFT_SAMPLES_EXPONENT = 10;
+static const int MAX_BPM_FFT_SAMPLES_EXPONENT = 13;
+
+// Sampling Rate the sizes above were chosen for
+static const int REFERENCE_SAMPLE_RATE = 44100;
+
+// lower limit of the standard deviation of the spectral flux, the ADC noise floor stays below it
+// (music is usually over 15, to about 5000)
+static const float MIN_FLUX_STD_DEV = 3.0f;
+
+// the number of standard deviations a band onset must be above the average flux of the band
+// (a band may contain only noise, which would have onsets as well)
+static const float MIN_BAND_ONSET_DEVIATION = 3.0f;
 
 // the number of seconds to be cached for detection
 static const int SECONDS_TO_CACHE = 5;
 
-// the number of frames to be cached, based on the seconds
-static const int FRAMES_TO_CACHE = (SAMPLE_RATE / NUM_BPM_SAMPLES) * SECONDS_TO_CACHE;
+// upper limit of the cached frames at any sample rate (the hop is rounded, so the frame rate
+// is only about REFERENCE_SAMPLE_RATE / NUM_BPM_SAMPLES), the autocorrelation is prepared for it
+static const int MAX_FRAMES_TO_CACHE = 2 * (REFERENCE_SAMPLE_RATE / NUM_BPM_SAMPLES) * SECONDS_TO_CACHE;
 
 // the number of refresh calls to wait before calculating the bpm
 static const int CALLS_TO_WAIT = 5;
@@ -187,16 +235,16 @@ inline float msToBPM(const float ms) {
     return 60000.0f / ms;
 }
 
-inline int frequencyToIndex(const int frequency) {
-    return NUM_BPM_FFT_SAMPLES*frequency / SAMPLE_RATE;
+int BPMDetector::frequencyToIndex(const int frequency) const {
+    return m_fftSize*frequency / m_sampleRate;
 }
 
-inline int framesToMs(const int frames) {
-    return frames * NUM_BPM_SAMPLES * 1000 / SAMPLE_RATE;
+int BPMDetector::framesToMs(const int frames) const {
+    return frames * m_hopSize * 1000 / m_sampleRate;
 }
 
-inline int msToFrames(const int ms) {
-    return ms * SAMPLE_RATE / NUM_BPM_SAMPLES / 1000;
+int BPMDetector::msToFrames(const int ms) const {
+    return ms * m_sampleRate / m_hopSize / 1000;
 }
 
 constexpr int GLOBAL_MIN_BPM = 50;
@@ -226,50 +274,128 @@ inline float bpmInRange(float bpm, const int minBPM) {
 // ---------------------------------- Initialization and Interfacting ---------------------------------
 
 
-BPMDetector::BPMDetector(const MonoAudioBuffer &buffer, BPMOscControler *osc) :
+BPMDetector::BPMDetector(const MonoAudioBuffer &buffer, BPMOscControler *osc, sound2osc::STFTStage* stft) :
     m_inputBuffer(buffer)
-  , m_lastInputBufferNumSamples(0)
   , m_refreshesSinceCalculation(0)
   , m_bpm(0)
   , m_framesSinceLastBPMDetection(0)
   , m_minBPM(75)
-  , m_window(NUM_BPM_FFT_SAMPLES)
-  , m_onsetBuffer(FRAMES_TO_CACHE)
-  , m_spectralFluxBuffer(FRAMES_TO_CACHE)
-  , m_spectralFluxNormalized(FRAMES_TO_CACHE)
-  , m_waveColors(FRAMES_TO_CACHE)
-  , m_buffer(NUM_BPM_FFT_SAMPLES)
-  , m_fftOutput(NUM_BPM_FFT_SAMPLES)
-  , m_currentSpectrum(NUM_BPM_FFT_SAMPLES)
-  , m_lastSpectrum(NUM_BPM_FFT_SAMPLES)
+  , m_sampleRate(0)
+  , m_hopSize(NUM_BPM_SAMPLES)
+  , m_fftSize(NUM_BPM_FFT_SAMPLES)
+  , m_framesToCache(0)
+  , m_ownStft(stft ? nullptr : std::make_unique<sound2osc::STFTStage>(buffer))
+  , m_stft(stft ? stft : m_ownStft.get())
+  , m_fluxSubscription(-1)
+  , m_colorSubscription(-1)
+  , m_lastFluxEnd(0)
+  , m_bandsChanged(false)
+  , m_transmitOnsets(false)
   , m_beatStrings()
   , m_lastIntervals(INTERVALS_TO_STORE)
+  , m_lastWinningInterval(0)
   , m_transmitBpm(false)
+  , m_tempoEstimator(TempoEstimator::BeatStrings)
+  , m_beatLocked(false)
+  , m_transmitBeats(false)
+  , m_beatLead(0)
+  , m_lastBeatsEnd(0)
   , m_oscController(osc)
 {
-    m_fft = std::make_unique<FFTRealWrapper<NUM_BPM_FFT_SAMPLES_EXPONENT>>();
-    calculateWindow();
+    // setSampleRate() is called again by the analysis when the sample rate of the input
+    // changes, the FFTs and the spectrum buffers are created for all rates here:
+    m_tempoAutocorrelation.prepare(MAX_FRAMES_TO_CACHE);
+    m_lastSpectrum.reserve((1 << MAX_BPM_FFT_SAMPLES_EXPONENT) / 2);
+    m_fluxIncrease.reserve((1 << MAX_BPM_FFT_SAMPLES_EXPONENT) / 2);
+    setSampleRate(buffer.getSampleRate());
 }
 
 BPMDetector::~BPMDetector()
 {
+    m_stft->unsubscribe(m_fluxSubscription);
+    m_stft->unsubscribe(m_colorSubscription);
+}
+
+int BPMDetector::maxHistoryLength()
+{
+    return MAX_FRAMES_TO_CACHE;
+}
+
+void BPMDetector::setSampleRate(int sampleRate)
+{
+    m_sampleRate = qMax(1, sampleRate);
+
+    // scale the hop with the sample rate to keep the frame rate of about 172 fps,
+    // all frame based timings (cache length, intervals) depend on it:
+    m_hopSize = qMax(1, qRound(double(NUM_BPM_SAMPLES) * m_sampleRate / REFERENCE_SAMPLE_RATE));
+    m_framesToCache = (m_sampleRate / m_hopSize) * SECONDS_TO_CACHE;
+
+    // use the power of two closest to the reference window duration (46ms),
+    // limited so that a window and the samples of one hop still fit in the input buffer:
+    const double exactExponent = qLn(double(NUM_BPM_FFT_SAMPLES) * m_sampleRate / REFERENCE_SAMPLE_RATE) / qLn(2.0);
+    int exponent = limit(MIN_BPM_FFT_SAMPLES_EXPONENT, qRound(exactExponent), MAX_BPM_FFT_SAMPLES_EXPONENT);
+    while (exponent > MIN_BPM_FFT_SAMPLES_EXPONENT && (2 << exponent) > m_inputBuffer.getCapacity()) {
+        --exponent;
+    }
+    m_fftSize = 1 << exponent;
+    m_lastSpectrum.fill(0.0f, m_fftSize / 2);
+    m_fluxIncrease.fill(0.0f, m_fftSize / 2);
+
+    // both consumers get the same frames, the FFT is computed once for them:
+    if (m_fluxSubscription < 0) {
+        m_fluxSubscription = m_stft->subscribe(m_fftSize, m_hopSize, [this](const sound2osc::STFTFrame& frame) { updateSpectralFlux(frame); });
+        m_colorSubscription = m_stft->subscribe(m_fftSize, m_hopSize, [this](const sound2osc::STFTFrame& frame) { updateWaveColor(frame); });
+    } else {
+        m_stft->setFormat(m_fluxSubscription, m_fftSize, m_hopSize);
+        m_stft->setFormat(m_colorSubscription, m_fftSize, m_hopSize);
+    }
+
+    m_fluxOnsets.setLength(m_framesToCache);
+    m_fluxOnsets.setMinStdDev(MIN_FLUX_STD_DEV);
+    configureBands();
+    m_waveColors = Qt3DCore::QCircularBuffer<SpectrumColor>(m_framesToCache);
+
+    // intervals of the tempo range of the autocorrelation (GLOBAL_MAX_BPM ... GLOBAL_MIN_BPM):
+    m_tempoAutocorrelation.setFormat(m_framesToCache, msToFrames(static_cast<int>(bpmToMs(GLOBAL_MAX_BPM))),
+                                     msToFrames(static_cast<int>(bpmToMs(GLOBAL_MIN_BPM))) + 1);
+    m_onsetStrength.resize(m_framesToCache);
+    resetCache();
 }
 
 void BPMDetector::resetCache()
 {
     m_bpm = 0.0;
-    m_onsetBuffer.fill(false);
-    m_spectralFluxBuffer.clear();
+    m_fluxOnsets.reset();
+    for (BandOnsets& band : m_bands) {
+        band.stream.reset();
+    }
     m_waveColors.clear();
-    m_lastInputBufferNumSamples = m_inputBuffer.getNumPutSamples();
+    m_beatTracker.reset();
+    m_beatLocked = false;
+
+    // the first frame starts at the current position:
+    const int64_t firstFrameEnd = m_inputBuffer.getNumPutSamples() + m_fftSize;
+    m_stft->restart(m_fluxSubscription, firstFrameEnd);
+    m_stft->restart(m_colorSubscription, firstFrameEnd);
+}
+
+void BPMDetector::setOnsetBands(const QList<sound2osc::OnsetBand>& bands)
+{
+    QMutexLocker locker(&m_bandsMutex);
+    m_pendingBands = bands;
+    m_bandsChanged = true;
 }
 
-void BPMDetector::calculateWindow()
+void BPMDetector::configureBands()
 {
-    // Hann Window function
-    // used to prepare the PCM data for FFT
-    for (int i=0; i<NUM_BPM_FFT_SAMPLES; ++i) {
-        m_window[i] = 0.5f * (1 - static_cast<float>(qCos((2 * M_PI * i) / (NUM_BPM_FFT_SAMPLES - 1))));
+    const int halfSize = m_fftSize / 2;
+    for (BandOnsets& band : m_bands) {
+        band.firstBin = limit(1, frequencyToIndex(band.band.lowHz), halfSize);
+        band.endBin = limit(band.firstBin, frequencyToIndex(band.band.highHz) + 1, halfSize);
+        band.stream.setLength(m_framesToCache);
+        // the same noise floor per bin as the whole spectrum
+        band.stream.setMinStdDev(MIN_FLUX_STD_DEV * static_cast<float>(band.endBin - band.firstBin) / static_cast<float>(halfSize));
+        band.stream.setMinDeviation(MIN_BAND_ONSET_DEVIATION);
     }
 }
 
@@ -300,21 +426,44 @@ void BPMDetector::setMinBPM(int value) {
 // 3. evaluate these and smooth the output
 void BPMDetector::detectBPM()
 {
-    // add as many new samples to the spectral flux history as available
-    int64_t currentNumPutSamples = m_inputBuffer.getNumPutSamples();
-    while (currentNumPutSamples - m_lastInputBufferNumSamples > NUM_BPM_FFT_SAMPLES) {
-        updateSpectralFluxes(m_inputBuffer.getCapacity() - static_cast<int>(currentNumPutSamples - m_lastInputBufferNumSamples));
-        m_lastInputBufferNumSamples += NUM_BPM_SAMPLES;
+    detectBPM(m_inputBuffer.getNumPutSamples());
+}
+
+void BPMDetector::detectBPM(const int64_t endPosition)
+{
+    // follow the sample rate of the input (it changes when another device is opened)
+    if (m_inputBuffer.getSampleRate() != m_sampleRate) {
+        setSampleRate(m_inputBuffer.getSampleRate());
     }
 
-    // if the buffer isn't full yet, don't continue
-    if (m_spectralFluxBuffer.count() < m_spectralFluxBuffer.capacity()) {
-        return;
+    // apply the bands of setOnsetBands() (called by another thread)
+    if (m_bandsChanged.exchange(false)) {
+        QMutexLocker locker(&m_bandsMutex);
+        m_bands.clear();
+        m_bands.reserve(static_cast<size_t>(m_pendingBands.size()));
+        for (const sound2osc::OnsetBand& band : m_pendingBands) {
+            if (!band.isValid()) continue;
+            const sound2osc::OSCPacketTemplate message("/sound2osc/onset/" + band.name + "=", sound2osc::OSCPacketTemplate::ValueType::Float);
+            m_bands.push_back({ band, 0, 0, message, sound2osc::OnsetStream() });
+        }
+        configureBands();
     }
 
-    // Analyze the spectral flux to retrieve onsets information
+    // add the frames up to endPosition to the spectral flux history
+    // (frames of a shared STFTStage may have been published already):
+    m_stft->process(endPosition);
+
+    // Analyze the new spectral flux values to retrieve onsets information
     updateOnsets();
 
+    // Send the beats that are due before the next call (already with the onsets of this call)
+    updateBeats(endPosition);
+
+    // if the buffer isn't full yet, don't continue
+    if (!m_fluxOnsets.isFull()) {
+        return;
+    }
+
     // Use a counter to only perform the tempo detection calculations every n times, because they are expensive
     m_refreshesSinceCalculation++;
     if (m_refreshesSinceCalculation >= CALLS_TO_WAIT) {
@@ -323,68 +472,68 @@ void BPMDetector::detectBPM()
         return;
     }
 
-    // Retrieve a set of strings of evenly spaced onsets
-    updateStrings();
+    // Retrieve a set of strings of evenly spaced onsets (or the candidates of the autocorrelation)
+    if (m_tempoEstimator == TempoEstimator::Autocorrelation) {
+        updateAutocorrelation();
+    } else {
+        updateStrings();
+    }
 
     // Find the highest scored string, and perform smoothing to get a consisten value
     evaluateStrings();
 }
 
 
-// Calculates the spectral flux for the samples from the given index
-// Spectral flux is the sum of only the *increases* in frequency.
+// Calculates the spectral flux of a frame of the STFTStage
+// Spectral flux is the sum of only the *increases* in the magnitude of the bins.
 // See "Evaluation of the Audio Beat Tracking System BeatRoot" by Simon Dixon
 // (in Journal of New Music Research, 36, 2007/8) for further detail
-void BPMDetector::updateSpectralFluxes(const int fromIndex)
+void BPMDetector::updateSpectralFlux(const sound2osc::STFTFrame& frame)
 {
-    // Stop if the index to go forward from is out of the buffers bound
-    if (fromIndex+NUM_BPM_FFT_SAMPLES >= m_inputBuffer.getCapacity() || fromIndex < 0) {
-        return;
+    // the magnitudes are calculated once for all subscribers of the frame
+    const float* magnitudes = frame.magnitudes();
+    float* lastSpectrum = m_lastSpectrum.data();
+    float* increase = m_fluxIncrease.data();
+    const int halfSize = m_fftSize / 2;
+
+    // the increase of every bin in one pass without branches (vectorized by the compiler),
+    // the flux of the whole spectrum and of each band is the sum over its bins
+    for (int i = 0; i < halfSize; ++i) {
+        increase[i] = std::max(magnitudes[i] - lastSpectrum[i], 0.0f);
+        lastSpectrum[i] = magnitudes[i];
     }
 
-    // apply hann window to new data to prepare it for the FFT
-    for (int i=0; i < NUM_BPM_FFT_SAMPLES; ++i) {
-        m_buffer[i] = static_cast<float>(m_inputBuffer.at(fromIndex+i)) * m_window[i];
+    // Store the new spectral flux values
+    // (scaled to the reference FFT size, the FFT output is not normalized)
+    const float scale = static_cast<float>(NUM_BPM_FFT_SAMPLES) / static_cast<float>(m_fftSize);
+    m_fluxOnsets.add(std::accumulate(increase, increase + halfSize, 0.0f) * scale);
+    for (BandOnsets& band : m_bands) {
+        band.stream.add(std::accumulate(increase + band.firstBin, increase + band.endBin, 0.0f) * scale);
     }
+    m_lastFluxEnd = frame.endPosition();
+}
 
-    // apply FFT:
-    m_fft->doFft(m_fftOutput.data(), m_buffer.constData());
-
-    // calculate spectral flux by adding all increases in energy in each band
-    float flux = 0.0;
-
-    for (int i = 0; i < NUM_BPM_FFT_SAMPLES / 2; ++i) {
-        if (m_fftOutput[i] > m_lastSpectrum[i]) {
-            flux += (m_fftOutput[i] - m_lastSpectrum[i]);
-        }
-        if (m_fftOutput[i + NUM_BPM_FFT_SAMPLES / 2] > m_lastSpectrum[i + NUM_BPM_FFT_SAMPLES / 2]) {
-            flux += (m_fftOutput[i + NUM_BPM_FFT_SAMPLES / 2] - m_lastSpectrum[i + NUM_BPM_FFT_SAMPLES / 2]);
-        }
-    }
-
-    // Store the new spectral flux value
-    m_spectralFluxBuffer.push_back(flux);
-
-    // Store the spectrum for comparison in the next iteration
-    m_lastSpectrum = m_fftOutput;
-
+// Calculates a color for the gui that represents the spectral content of a frame
+void BPMDetector::updateWaveColor(const sound2osc::STFTFrame& frame)
+{
+    const float* fftOutput = frame.fftOutput();
+    const int halfSize = m_fftSize / 2;
 
-    // Calculate a color for the gui that represents the spectral content of this sample
     // The amount of red, green and blue is proportional to the amount of low, mid and high
     // in the signal, and the color
     int col[] = {0,0,0}; // r,g and b values in 0..255
 
     // Sum up low, mid an high frequencies
     for (int i = 0; i < frequencyToIndex(200); i++) {
-        col[0] += static_cast<int>(qAbs(m_fftOutput[i])*1000);
+        col[0] += static_cast<int>(qAbs(fftOutput[i])*1000);
     }
 
     for (int i = frequencyToIndex(200); i < frequencyToIndex(2000); i+=10) {
-        col[1] += static_cast<int>(qAbs(m_fftOutput[i])*5000);
+        col[1] += static_cast<int>(qAbs(fftOutput[i])*5000);
     }
 
-    for (int i = frequencyToIndex(2000); i < NUM_BPM_FFT_SAMPLES / 2; i+=20) {
-        col[2] += static_cast<int>(qAbs(m_fftOutput[i])*10000);
+    for (int i = frequencyToIndex(2000); i < halfSize; i+=20) {
+        col[2] += static_cast<int>(qAbs(fftOutput[i])*10000);
     }
 
     // Normalize so that at least one value is 255
@@ -406,106 +555,58 @@ void BPMDetector::updateSpectralFluxes(const int fromIndex)
     m_waveColors.push_back({col[0],col[1],col[2]});
 }
 
-// finds onsets in the audio material
-// Algorithm is again from "Evaluation of the Audio Beat Tracking System BeatRoot"
-// by Simon Dixon (in Journal of New Music Research, 36, 2007/8)
+// finds onsets in the audio material (see OnsetStream)
+// Only the frames added since the last call are evaluated, the onsets of the whole
+// spectrum are passed to the beat tracker, the onsets of the bands are sent via OSC.
 void BPMDetector::updateOnsets()
 {
-    // clear the onset history
-    for (int i=0; i < FRAMES_TO_CACHE; ++i) {
-        m_onsetBuffer[i] = false;
+    const int count = m_fluxOnsets.count();
+    for (const int n : m_fluxOnsets.update()) {
+        // the onset is at the center of the FFT window of its frame
+        const int64_t position = m_lastFluxEnd - int64_t(count - 1 - n) * m_hopSize - m_fftSize / 2;
+        m_beatTracker.addOnset(double(position), qMax(0.001f, normalizedFlux(n)));
     }
-    // normalize the spectral flux to an average of 0 and a standard deviation of 1,
-    // by determining the current average and standard deviation and then subtracting
-    // the average from each value and dividing it by the standard Deviation
-    float average = 0.0;
-    for (int i=0; i < FRAMES_TO_CACHE; ++i) {
-        average += m_spectralFluxBuffer[i];
-    }
-    average = average / static_cast<float>(FRAMES_TO_CACHE);
 
-    float variance = 0.0;
-    for (int i = 0; i < FRAMES_TO_CACHE; ++i) {
-        variance += m_spectralFluxBuffer[i]*m_spectralFluxBuffer[i];
-    }
-    float stdDev = qSqrt(variance);
+    for (BandOnsets& band : m_bands) {
+        for (const int n : band.stream.update()) {
+            if (!m_transmitOnsets || !m_oscController) continue;
 
-    // Cap the standard Deviation to prevent onset detection in ADC Noise Floor, which has a
-    // stdDev of under 20 (music is usually over 100, to about 30000)
-    stdDev = qMax(stdDev, 20.0f);
-
-    for (int i = 0; i < FRAMES_TO_CACHE; ++i) {
-        m_spectralFluxNormalized[i] = (m_spectralFluxBuffer[i] - average) / stdDev;
-    }
-
-    const char w = 5; //window for local maximum detection
-    const char m = 3; // multiplier to increase range before onset
-    const float pastThresholdWeight = 0.84f;
-    const float averageThresholdDelta = 0.008f;
-
-    // detect onsets by iterating over spectral flux and checking for the three criteria
-    // that a sample must fullfill to be considered an onset
-    // 1. Past Threshold: have a greater value than the (g in the paper)
-    // 2. Local Maximum: have value greater than the neighboring samples within a window of +- w samples
-    // 3. Average Threshold: have a greater value than the average of the surrounding samples (-m*w to +w) with an added Delta
-    // The order is changed from the paper, to ensure calculation of the recursive function, while keeping
-    // the code easy to read
-
-    float pastThreshold = m_spectralFluxNormalized[m*w-1];
-
-    // Iterate over all samples except the edges where there are not enough surrounding samples
-    for (int n=m*w; n < FRAMES_TO_CACHE - w; ++n) {
-
-        // ------------------------------- 1. Past Threshold -----------------------------
-        // Calculate the past threshold recursively, as the maximum between a weighted average between
-        // the last threshold and the last sample, and the last sample itself
-        float pastThresholdNew = qMax(m_spectralFluxNormalized[n-1], pastThresholdWeight*pastThreshold + (1-pastThresholdWeight)*m_spectralFluxNormalized[n-1]);
-        pastThreshold = pastThresholdNew;
-
-        // Continue if the sample does not meet the past threshold
-        if (m_spectralFluxNormalized[n] < pastThreshold) {
-            continue;
+            // the velocity is relative to the loudest frame of the band history
+            const float max = band.stream.maximum();
+            m_oscController->transmitOnset(band.message, max > 0.0f ? band.stream.flux()[n] / max : 0.0f);
         }
+    }
+}
 
-        // -------------------------------- 2. Local Maximum -----------------------------
-        // Compare to the releavant surronding samples
-        bool localMaximum = true;
-        for (int k = n-w; k <= n+w; ++k) {
-            if (m_spectralFluxNormalized[n] < m_spectralFluxNormalized[k]) {
-                localMaximum = false;
-                break;
-            }
-        }
-
-        // Continue of the sample does no meet the local neighbour criterium
-        if (!localMaximum) {
-            continue;
-        }
-
-        // ---------------------------- 3. Average Threshold -----------------------------
-        // Sum the surounding samples, then divide by their number and add the delta
-        float averageThreshold = 0.0;
-        for (int k = n-w*m; k < n+w; ++k) {
-            averageThreshold += m_spectralFluxNormalized[k];
-        }
-        averageThreshold /= (m*w + w +1);
-        averageThreshold += averageThresholdDelta;
-
-        // Continue if the sample does not meet the average threshold
-        if (m_spectralFluxNormalized[n] < averageThreshold) {
-            continue;
+// follows the detected tempo with the beat tracker and sends the beats that are predicted
+// before the next call
+void BPMDetector::updateBeats(const int64_t endPosition)
+{
+    const float bpm = m_bpm;
+    m_beatTracker.setInterval(bpm > 0 ? 60.0 * m_sampleRate / static_cast<double>(bpm) : 0.0);
+
+    // the beats until the next call (a hop later) are sent now. With time tags the receiver
+    // executes each of them on its beat, without them they are sent half a hop early on average.
+    const int64_t hop = qBound(int64_t(0), endPosition - m_lastBeatsEnd, int64_t(m_sampleRate));
+    m_lastBeatsEnd = endPosition;
+    const bool timeTagged = m_oscController && m_oscController->beatsAreTimeTagged();
+    const int64_t dueNow = endPosition + m_beatLead;
+    const int64_t end = dueNow + (timeTagged ? hop : hop / 2);
+
+    // beats before endPosition are too late (e.g. after a lost lock or a skipped call)
+    double position = 0.0;
+    while (m_beatTracker.takeBeat(double(endPosition), double(end), position)) {
+        if (m_transmitBeats && m_oscController) {
+            m_oscController->transmitBeat(qMax(0.0, (position - double(dueNow)) / m_sampleRate));
         }
-
-        // Set the sample to be an onset if it has met all the criteria
-        m_onsetBuffer[n] = true;
     }
+    m_beatLocked = m_beatTracker.isLocked();
 }
 
 
 // constants that store the cluster width (allowed deviation for two intervals to be considered
 // related) and the maximum interval considered sensible to analyze
 const static int CLUSTER_WIDTH = 30; // ms
-static int CLUSTER_WIDTH_IN_FRAMES = msToFrames(CLUSTER_WIDTH); // frames
 const static int MAX_INTERVAL = 2000; // ms
 
 // A class that models a Sequence of Beats, by only storing the average interval and the
@@ -580,6 +681,7 @@ void BPMDetector::updateStrings()
 {
     // Delete all existing strings
     m_beatStrings.clear();
+    const Qt3DCore::QCircularBuffer<bool>& onsets = m_fluxOnsets.onsets();
 
     // Iterate of all pairs of indices i and j, where there is an onset at
     // both indices and i < j. Then try to find as many onsets as possible
@@ -593,10 +695,10 @@ void BPMDetector::updateStrings()
     // i----j-x--x----x-x--x----x--x-------x--x--x-x----x
     //
     //
-    for (int i = 0; i < FRAMES_TO_CACHE; ++i) {
-        if (m_onsetBuffer[i]) {
-            for (int j = i+1; j < FRAMES_TO_CACHE; ++j) {
-                if (m_onsetBuffer[j]) {
+    for (int i = 0; i < m_framesToCache; ++i) {
+        if (onsets[i]) {
+            for (int j = i+1; j < m_framesToCache; ++j) {
+                if (onsets[j]) {
 
                     // Detect the interval and score, and continue right away if the interval is to short or to long
                     float interval = static_cast<float>(framesToMs(j-i));
@@ -605,7 +707,7 @@ void BPMDetector::updateStrings()
                     }
                     // Take the minimum of the two onsets fluxes as the score, to weigh intervals between strong
                     // onsets more
-                    float score = qMin(m_spectralFluxNormalized[i], m_spectralFluxNormalized[j]);
+                    float score = qMin(normalizedFlux(i), normalizedFlux(j));
 
                     // Initialize a new Beat String with tha interval and score
                     BeatString string(interval, score);
@@ -619,7 +721,7 @@ void BPMDetector::updateStrings()
                     bool skipedBeat = false;
 
                     // Iterate over all future indices
-                    for (int k = j+msToFrames(static_cast<int>(minInterval)); k < FRAMES_TO_CACHE; ++k) {
+                    for (int k = j+msToFrames(static_cast<int>(minInterval)); k < m_framesToCache; ++k) {
                         // Calculate the interval from the last onset
                         float currentInterval = static_cast<float>(framesToMs(k-lastOnsetIndex));
 
@@ -637,9 +739,9 @@ void BPMDetector::updateStrings()
                             }
                         }
                         // If an onset was found, update the string and set it as the last onset
-                        if (m_onsetBuffer[k]) {
+                        if (onsets[k]) {
                             // The score is the minimum of the two onsets spectral fluxes
-                            float currentScore = qMin(m_spectralFluxNormalized[lastOnsetIndex], m_spectralFluxNormalized[k]);
+                            float currentScore = qMin(normalizedFlux(lastOnsetIndex), normalizedFlux(k));
                             string.addInterval(currentInterval, currentScore);
                             lastOnsetIndex = k;
 
@@ -685,6 +787,35 @@ void BPMDetector::updateStrings()
     }
 }
 
+// Alternative to updateStrings() with a cost that does not depend on the number of onsets:
+// The tempo candidates are the peaks of the comb filtered autocorrelation of the spectral
+// flux above its average, widened by a frame (see TempoAutocorrelation). Each one is stored
+// as a string with its comb score, so the evaluation and smoothing are the same for both
+// estimators.
+void BPMDetector::updateAutocorrelation()
+{
+    m_beatStrings.clear();
+
+    // The onsets of the magnitude flux are peaks of a single frame. The comb only scores the
+    // whole multiples of a lag, so the multiples of a beat interval that is a fraction of
+    // frames miss them, and a lag with a worse but whole-frame period wins (e.g. 3/2 of the
+    // beat with hi-hats on the eighths). Each frame takes the maximum of its neighbours so
+    // that the teeth hit the peaks up to a frame off.
+    float previous = 0.0f;
+    float current = qMax(0.0f, normalizedFlux(0));
+    for (int i = 0; i < m_framesToCache; ++i) {
+        const float next = i + 1 < m_framesToCache ? qMax(0.0f, normalizedFlux(i + 1)) : 0.0f;
+        m_onsetStrength[i] = qMax(previous, qMax(current, next));
+        previous = current;
+        current = next;
+    }
+
+    const float frameDuration = 1000.0f * static_cast<float>(m_hopSize) / static_cast<float>(m_sampleRate); // ms
+    for (const auto& candidate : m_tempoAutocorrelation.analyze(m_onsetStrength.constData())) {
+        m_beatStrings.push_back(BeatString(candidate.interval * frameDuration, candidate.score));
+    }
+}
+
 // Checks a given interval for sufficent support in the strings,
 // to evaluate if after a drastic tempo change the old tempo is still plausible
 // This is the case if there is an string within CLUSTER_WIDTH of the interval
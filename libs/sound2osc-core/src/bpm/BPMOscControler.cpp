@@ -26,6 +26,8 @@
 BPMOscControler::BPMOscControler(OSCNetworkManager &osc) :
     m_bpmMute(false)
   , m_osc(osc)
+  , m_routes(sound2osc::OSCRoutes::PRIMARY)
+  , m_beatMessage("/sound2osc/beat")
   , m_oscCommands()
 {
 }
@@ -48,6 +50,9 @@ void BPMOscControler::restore(QSettings& settings)
 {
     int count = settings.value("bpm/osc/count").toInt();
 
+    m_routes = settings.value("bpm/osc/routes", sound2osc::OSCRoutes::PRIMARY).toUInt();
+
+    QMutexLocker locker(&m_commandsMutex);
     m_oscCommands.clear();
     for (int index = 0; index < count; ++index) {
         QString command = settings.value("bpm/osc/" + QString::number(index)).toString();
@@ -57,8 +62,11 @@ void BPMOscControler::restore(QSettings& settings)
 
 // Save the commands for e.g. a preset
 void BPMOscControler::save(QSettings& settings) {
+    QMutexLocker locker(&m_commandsMutex);
+
     // Save the number of commands
     settings.setValue("bpm/osc/count", m_oscCommands.size());
+    settings.setValue("bpm/osc/routes", m_routes.load());
 
     // Store each command under the key "bpm/osc/*index*"
     for (int index = 0; index < m_oscCommands.size(); ++index) {
@@ -70,10 +78,12 @@ QJsonObject BPMOscControler::toState() const
 {
     QJsonObject state;
     QJsonArray commands;
+    QMutexLocker locker(&m_commandsMutex);
     for (const QString& cmd : m_oscCommands) {
         commands.append(cmd);
     }
     state["commands"] = commands;
+    if (m_routes != sound2osc::OSCRoutes::PRIMARY) state["routes"] = static_cast<qint64>(m_routes.load());
     // Mute state is typically not saved in the preset but runtime, 
     // but the original code didn't save it. Let's stick to commands for now.
     return state;
@@ -81,6 +91,9 @@ QJsonObject BPMOscControler::toState() const
 
 void BPMOscControler::fromState(const QJsonObject& state)
 {
+    m_routes = static_cast<sound2osc::OSCRoutes::Mask>(state["routes"].toInteger(sound2osc::OSCRoutes::PRIMARY));
+
+    QMutexLocker locker(&m_commandsMutex);
     m_oscCommands.clear();
     if (state.contains("commands")) {
         QJsonArray commands = state["commands"].toArray();
@@ -97,8 +110,8 @@ void BPMOscControler::transmitBPM(float bpm)
     if (m_bpmMute) return;
 
     // Send user specified commands
-
-    for (QString& command : m_oscCommands) {
+    const QStringList commands = getCommands();
+    for (const QString& command : commands) {
         //Continue if the command is invalid, e.g. because it doesn't have a BPM
         if (command.indexOf("<BPM") == -1) {
             continue;
@@ -119,9 +132,28 @@ void BPMOscControler::transmitBPM(float bpm)
         message.replace("<BPM8>", "0" + QString::number(qRound(bpm*8)));
         message.replace("<BPM16>", "0" + QString::number(qRound(bpm*16)));
         message.replace("<BPM32>", "0" + QString::number(qRound(bpm*32)));
-        m_osc.sendMessage(message);
+        m_osc.sendMessageTo(m_routes, message);
     }
 
     // Send information command
     m_osc.sendMessage("/sound2osc/out/bpm=" + QString::number(qRound(bpm)), true);
 }
+
+// Called by the bpm detector to send a predicted beat
+void BPMOscControler::transmitBeat(double delay)
+{
+    // Don't transmit if mute is engaged
+    if (m_bpmMute) return;
+
+    // Sent to the destinations of the commands, they are the ones that follow the tempo
+    m_osc.sendMessageAt(delay, m_beatMessage, 0.0, m_routes);
+}
+
+// Called by the bpm detector to send an onset of a band
+void BPMOscControler::transmitOnset(const sound2osc::OSCPacketTemplate& message, float velocity)
+{
+    // Don't transmit if mute is engaged
+    if (m_bpmMute) return;
+
+    m_osc.sendMessage(message, static_cast<double>(velocity), false, m_routes);
+}
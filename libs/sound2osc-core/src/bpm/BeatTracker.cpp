@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/bpm/BeatTracker.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sound2osc {
+
+BeatTracker::BeatTracker()
+    : m_tempoInterval(0.0)
+    , m_interval(0.0)
+    , m_nextBeat(0.0)
+    , m_lastMatch(0.0)
+    , m_locked(false)
+    , m_nextOnset(0)
+{
+    m_onsets.reserve(HISTORY);
+}
+
+void BeatTracker::reset()
+{
+    m_tempoInterval = 0.0;
+    m_interval = 0.0;
+    m_onsets.clear();
+    m_nextOnset = 0;
+    unlock();
+}
+
+void BeatTracker::unlock()
+{
+    m_locked = false;
+}
+
+void BeatTracker::setInterval(double interval)
+{
+    interval = std::max(0.0, interval);
+    if (interval == m_tempoInterval) return;
+
+    const bool smallChange = m_tempoInterval > 0.0
+        && std::abs(interval - m_tempoInterval) <= MAX_INTERVAL_DEVIATION * m_tempoInterval;
+    m_tempoInterval = interval;
+
+    if (interval <= 0.0) {
+        m_interval = 0.0;
+        unlock();
+        return;
+    }
+    if (m_locked && smallChange) {
+        // keep the phase and the tracked interval, within the range of the new tempo:
+        m_interval = std::clamp(m_interval, interval * (1.0 - MAX_INTERVAL_DEVIATION),
+                                interval * (1.0 + MAX_INTERVAL_DEVIATION));
+        return;
+    }
+    m_interval = interval;
+    unlock();
+    acquire();
+}
+
+void BeatTracker::addOnset(double position, float strength)
+{
+    const Onset onset { position, std::max(strength, 1e-6f) };
+    if (static_cast<int>(m_onsets.size()) < HISTORY) {
+        m_onsets.push_back(onset);
+    } else {
+        m_onsets[static_cast<std::size_t>(m_nextOnset)] = onset;
+    }
+    m_nextOnset = (m_nextOnset + 1) % HISTORY;
+
+    if (m_tempoInterval <= 0.0) return;
+    if (!m_locked) {
+        acquire();
+        return;
+    }
+
+    // distance to the nearest beat of the grid (the onset may be older than the last taken beat):
+    const double beats = std::round((position - m_nextBeat) / m_interval);
+    const double error = position - (m_nextBeat + beats * m_interval);
+    if (std::abs(error) > TOLERANCE * m_interval) return;
+
+    m_nextBeat += PHASE_GAIN * error;
+    m_interval = std::clamp(m_interval + INTERVAL_GAIN * error, m_tempoInterval * (1.0 - MAX_INTERVAL_DEVIATION),
+                            m_tempoInterval * (1.0 + MAX_INTERVAL_DEVIATION));
+    m_lastMatch = std::max(m_lastMatch, position);
+}
+
+bool BeatTracker::acquire()
+{
+    if (static_cast<int>(m_onsets.size()) < LOCK_ONSETS) return false;
+
+    const double interval = m_tempoInterval;
+    double newest = m_onsets.front().position;
+    for (const Onset& onset : m_onsets) {
+        newest = std::max(newest, onset.position);
+    }
+    // older onsets may belong to another tempo:
+    const double oldest = newest - LOST_BEATS * interval;
+
+    // the onset with the most (strong) onsets on its grid:
+    const Onset* anchor = nullptr;
+    float bestScore = 0.0f;
+    int bestCount = 0;
+    for (const Onset& candidate : m_onsets) {
+        if (candidate.position < oldest) continue;
+        float score = 0.0f;
+        int count = 0;
+        for (const Onset& onset : m_onsets) {
+            if (onset.position < oldest) continue;
+            const double beats = (onset.position - candidate.position) / interval;
+            if (std::abs(beats - std::round(beats)) <= TOLERANCE) {
+                score += onset.strength;
+                ++count;
+            }
+        }
+        if (score > bestScore) {
+            anchor = &candidate;
+            bestScore = score;
+            bestCount = count;
+        }
+    }
+    if (!anchor || bestCount < LOCK_ONSETS) return false;
+
+    // start with the average phase of the onsets on the grid:
+    double phase = 0.0;
+    double lastMatch = anchor->position;
+    for (const Onset& onset : m_onsets) {
+        if (onset.position < oldest) continue;
+        const double beats = (onset.position - anchor->position) / interval;
+        const double error = beats - std::round(beats);
+        if (std::abs(error) <= TOLERANCE) {
+            phase += error * interval;
+            lastMatch = std::max(lastMatch, onset.position);
+        }
+    }
+    const double origin = anchor->position + phase / bestCount;
+
+    m_interval = interval;
+    m_nextBeat = origin + (std::floor((newest - origin) / interval) + 1.0) * interval;
+    m_lastMatch = lastMatch;
+    m_locked = true;
+    return true;
+}
+
+bool BeatTracker::takeBeat(double from, double to, double& position)
+{
+    while (m_locked && m_nextBeat < to) {
+        const double beat = m_nextBeat;
+        m_nextBeat += m_interval;
+        if (beat - m_lastMatch > LOST_BEATS * m_interval) {
+            // no onsets on the grid anymore, acquire the phase again with the next onsets:
+            unlock();
+            return false;
+        }
+        if (beat < from) continue;
+
+        position = beat;
+        return true;
+    }
+    return false;
+}
+
+} // namespace sound2osc
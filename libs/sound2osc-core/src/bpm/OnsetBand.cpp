@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/bpm/OnsetBand.h>
+
+#include <QtGlobal>
+
+namespace sound2osc {
+
+bool OnsetBand::operator==(const OnsetBand& other) const
+{
+    return name == other.name && lowHz == other.lowHz && highHz == other.highHz;
+}
+
+QVariantMap OnsetBand::toVariant() const
+{
+    QVariantMap map;
+    map["name"] = name;
+    map["low"] = lowHz;
+    map["high"] = highHz;
+    return map;
+}
+
+OnsetBand OnsetBand::fromVariant(const QVariant& value)
+{
+    const QVariantMap map = value.toMap();
+    OnsetBand band;
+    const QString name = map.value("name").toString();
+    if (isValidName(name)) band.name = name;
+    band.lowHz = qMax(0, map.value("low").toInt());
+    band.highHz = qMax(band.lowHz, map.value("high").toInt());
+    return band;
+}
+
+bool OnsetBand::isValidName(const QString& name)
+{
+    // the path is written in the "/path=value" text form, OSC reserves the others for patterns:
+    static const QString reserved = QStringLiteral("/#*,?[]{}=");
+    if (name.isEmpty()) return false;
+    for (const QChar c : name) {
+        if (c.isSpace() || reserved.contains(c)) return false;
+    }
+    return true;
+}
+
+QList<OnsetBand> OnsetBand::defaults()
+{
+    return {
+        { QStringLiteral("kick"), 30, 150 },
+        { QStringLiteral("snare"), 200, 2500 },
+        { QStringLiteral("hihat"), 6000, 16000 }
+    };
+}
+
+} // namespace sound2osc
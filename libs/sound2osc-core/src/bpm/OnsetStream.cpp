@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/bpm/OnsetStream.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sound2osc {
+
+OnsetStream::OnsetStream(int length)
+    : m_frames(0)
+    , m_evaluatedFrames(0)
+    , m_sum(0.0)
+    , m_squareSum(0.0)
+    , m_minStdDev(1.0f)
+    , m_minDeviationFactor(0.0f)
+    , m_minDeviation(0.0f)
+    , m_average(0.0f)
+    , m_stdDev(1.0f)
+    , m_pastThreshold(0.0f)
+{
+    m_localMaximum.setCapacity(LOCAL_MAXIMUM_FRAMES);
+    setLength(length);
+}
+
+void OnsetStream::setLength(int frames)
+{
+    frames = std::max(0, frames);
+    m_flux = Qt3DCore::QCircularBuffer<float>(frames);
+    m_onsets = Qt3DCore::QCircularBuffer<bool>(frames);
+    m_newOnsets.clear();
+    m_newOnsets.reserve(static_cast<std::size_t>(frames));
+    m_historyMaximum.setCapacity(frames);
+    reset();
+}
+
+void OnsetStream::reset()
+{
+    m_flux.clear();
+    m_onsets.clear();
+    m_newOnsets.clear();
+    m_frames = 0;
+    m_evaluatedFrames = 0;
+    m_sum = 0.0;
+    m_squareSum = 0.0;
+    m_localMaximum.clear();
+    m_historyMaximum.clear();
+}
+
+void OnsetStream::add(float flux)
+{
+    if (m_flux.capacity() == 0) return;
+
+    if (m_flux.isFull()) {
+        const double oldest = m_flux.first();
+        m_sum -= oldest;
+        m_squareSum -= oldest * oldest;
+    }
+    m_flux.push_back(flux);
+    m_onsets.push_back(false);
+    const double value = static_cast<double>(flux);
+    m_sum += value;
+    m_squareSum += value * value;
+    m_historyMaximum.push(m_frames, flux, m_frames + 1 - m_flux.capacity());
+    ++m_frames;
+
+    // sum up the history again once per history length, so that rounding errors
+    // of the running sums don't accumulate:
+    if (m_frames % m_flux.capacity() == 0) {
+        m_sum = 0.0;
+        m_squareSum = 0.0;
+        for (int i = 0; i < m_flux.size(); ++i) {
+            const double historyValue = static_cast<double>(m_flux[i]);
+            m_sum += historyValue;
+            m_squareSum += historyValue * historyValue;
+        }
+    }
+}
+
+void OnsetStream::MaximumQueue::setCapacity(int frames)
+{
+    m_entries.resize(static_cast<std::size_t>(std::max(1, frames)));
+    clear();
+}
+
+void OnsetStream::MaximumQueue::push(int64_t frame, float flux, int64_t firstFrame)
+{
+    while (m_size > 0 && entry(0).frame < firstFrame) {
+        m_begin = (m_begin + 1) % static_cast<int>(m_entries.size());
+        --m_size;
+    }
+    while (m_size > 0 && entry(m_size - 1).flux <= flux) {
+        --m_size;
+    }
+    entry(m_size++) = { frame, flux };
+}
+
+const std::vector<int>& OnsetStream::update()
+{
+    m_newOnsets.clear();
+    const int count = m_flux.count();
+    if (count == 0) {
+        return m_newOnsets;
+    }
+
+    // normalize the flux to an average of 0 and a standard deviation of 1 with the
+    // running sums (the deviation is capped to ignore the noise floor)
+    m_average = static_cast<float>(m_sum / count);
+    m_stdDev = std::max(static_cast<float>(std::sqrt(std::max(0.0, m_squareSum))), m_minStdDev);
+    const double variance = std::max(0.0, m_squareSum / count - (m_sum / count) * (m_sum / count));
+    m_minDeviation = m_minDeviationFactor * static_cast<float>(std::sqrt(variance));
+
+    constexpr int w = WINDOW;
+    constexpr int m = MULTIPLIER;
+
+    // the frames that are no longer in the history can't be evaluated anymore
+    // (only if more frames than the history length were added since the last call):
+    m_evaluatedFrames = std::max(m_evaluatedFrames, m_frames - count);
+
+    // The order of the criteria is changed from the paper, to ensure calculation of the
+    // recursive past threshold. The first two compare flux values only, so they are
+    // evaluated on the flux itself, which doesn't change with the normalization.
+    for (; m_evaluatedFrames < m_frames; ++m_evaluatedFrames) {
+        // the newest frame enters the local maximum window of the frame w frames before it
+        const int newest = count - static_cast<int>(m_frames - m_evaluatedFrames);
+        m_localMaximum.push(m_evaluatedFrames, m_flux[newest], m_evaluatedFrames - 2*w);
+
+        // skip the first frames where there are not enough surrounding frames
+        const int64_t frame = m_evaluatedFrames - w;
+        const int n = newest - w;
+        if (frame < m*w || n < m*w) {
+            continue;
+        }
+
+        // 1. Past Threshold: the maximum of a weighted average of the last threshold
+        // and the last frame, and the last frame itself
+        if (frame == m*w) {
+            m_pastThreshold = m_flux[n-1];
+        }
+        m_pastThreshold = std::max(m_flux[n-1], PAST_THRESHOLD_WEIGHT*m_pastThreshold + (1-PAST_THRESHOLD_WEIGHT)*m_flux[n-1]);
+        if (m_flux[n] < m_pastThreshold) {
+            continue;
+        }
+
+        // 2. Local Maximum
+        if (m_flux[n] < m_localMaximum.maximum()) {
+            continue;
+        }
+
+        // 3. Average Threshold
+        float averageThreshold = 0.0f;
+        for (int k = n-w*m; k < n+w; ++k) {
+            averageThreshold += normalized(k);
+        }
+        averageThreshold /= (m*w + w + 1);
+        averageThreshold += AVERAGE_THRESHOLD_DELTA;
+        if (normalized(n) < averageThreshold) {
+            continue;
+        }
+
+        // 4. Deviation: the flux of the frame stands out of the history (the criteria above
+        // are independent of the level, so without it a signal of noise has onsets too)
+        if (m_flux[n] - m_average < m_minDeviation) {
+            continue;
+        }
+
+        m_onsets[n] = true;
+        m_newOnsets.push_back(n);
+    }
+    return m_newOnsets;
+}
+
+} // namespace sound2osc
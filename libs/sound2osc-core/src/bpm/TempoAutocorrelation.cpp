@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/bpm/TempoAutocorrelation.h>
+
+#include <sound2osc/dsp/FFTBackend.h>
+
+#include <algorithm>
+
+namespace sound2osc {
+
+namespace {
+
+constexpr int MIN_FFT_SIZE = 16;
+
+} // namespace
+
+TempoAutocorrelation::TempoAutocorrelation()
+    : m_length(0)
+    , m_minInterval(0)
+    , m_maxInterval(0)
+    , m_fft(nullptr)
+{
+}
+
+TempoAutocorrelation::~TempoAutocorrelation() = default;
+
+void TempoAutocorrelation::setFormat(int length, int minInterval, int maxInterval)
+{
+    m_length = std::max(1, length);
+    // the comb needs the neighbours of each lag for the local maxima:
+    m_maxInterval = std::max(1, std::min(maxInterval, m_length - 2));
+    m_minInterval = std::max(2, std::min(minInterval, m_maxInterval));
+
+    m_fft = fft(fftSizeFor(m_length));
+    const int fftSize = m_fft->size();
+    m_padded.assign(static_cast<std::size_t>(fftSize), 0.0f);
+    m_spectrum.assign(static_cast<std::size_t>(fftSize), 0.0f);
+    m_autocorrelation.assign(static_cast<std::size_t>(m_length), 0.0f);
+    m_comb.assign(static_cast<std::size_t>(m_maxInterval + 2), 0.0f);
+    m_candidates.clear();
+    m_candidates.reserve(MAX_CANDIDATES + 1);
+}
+
+void TempoAutocorrelation::prepare(int maxLength)
+{
+    const int maxSize = fftSizeFor(maxLength);
+    for (int size = MIN_FFT_SIZE; size <= maxSize; size *= 2) {
+        fft(size);
+    }
+    m_padded.reserve(static_cast<std::size_t>(maxSize));
+    m_spectrum.reserve(static_cast<std::size_t>(maxSize));
+    m_autocorrelation.reserve(static_cast<std::size_t>(maxLength));
+    m_comb.reserve(static_cast<std::size_t>(maxLength));
+}
+
+int TempoAutocorrelation::fftSizeFor(int length)
+{
+    // zero padded to at least twice the length, the lags up to length - 1 are not circular then:
+    int fftSize = MIN_FFT_SIZE;
+    while (fftSize < 2 * length) {
+        fftSize *= 2;
+    }
+    return fftSize;
+}
+
+BasicFFTInterface* TempoAutocorrelation::fft(int size)
+{
+    for (const auto& existing : m_ffts) {
+        if (existing->size() == size) return existing.get();
+    }
+    m_ffts.push_back(FFTBackend::create(size));
+    return m_ffts.back().get();
+}
+
+const std::vector<TempoAutocorrelation::Candidate>& TempoAutocorrelation::analyze(const float* signal)
+{
+    m_candidates.clear();
+    if (!m_fft) return m_candidates;
+
+    const int fftSize = m_fft->size();
+    const int half = fftSize / 2;
+    float* padded = m_padded.data();
+    float* spectrum = m_spectrum.data();
+
+    std::copy(signal, signal + m_length, padded);
+    std::fill(padded + m_length, padded + fftSize, 0.0f);
+    m_fft->doFft(spectrum, padded);
+
+    // power spectrum, symmetric so that its FFT is real (FFTReal layout:
+    // real parts of the bins 0 ... N/2, then imaginary parts of 1 ... N/2-1):
+    padded[0] = spectrum[0] * spectrum[0];
+    padded[half] = spectrum[half] * spectrum[half];
+    for (int k = 1; k < half; ++k) {
+        const float power = spectrum[k] * spectrum[k] + spectrum[half + k] * spectrum[half + k];
+        padded[k] = power;
+        padded[fftSize - k] = power;
+    }
+    m_fft->doFft(spectrum, padded);
+
+    // the real parts are the autocorrelation (times the FFT size):
+    const float energy = spectrum[0];
+    if (!(energy > 0.0f)) {
+        std::fill(m_autocorrelation.begin(), m_autocorrelation.end(), 0.0f);
+        return m_candidates;
+    }
+    for (int lag = 0; lag < m_length; ++lag) {
+        m_autocorrelation[static_cast<std::size_t>(lag)] = spectrum[lag] / energy;
+    }
+
+    // comb over the multiples of each lag:
+    const float* autocorrelation = m_autocorrelation.data();
+    float* comb = m_comb.data();
+    for (int lag = m_minInterval - 1; lag <= m_maxInterval + 1; ++lag) {
+        float score = 0.0f;
+        for (int tooth = 1; tooth <= COMB_TEETH && tooth * lag < m_length; ++tooth) {
+            score += autocorrelation[tooth * lag];
+        }
+        comb[lag] = score;
+    }
+
+    // local maxima, the strongest first:
+    for (int lag = m_minInterval; lag <= m_maxInterval; ++lag) {
+        const float previous = comb[lag - 1];
+        const float score = comb[lag];
+        const float next = comb[lag + 1];
+        if (!(score > 0.0f) || score <= previous || score < next) continue;
+
+        // vertex of the parabola through the lag and its neighbours:
+        const float curvature = previous - 2.0f * score + next;
+        const float offset = curvature < 0.0f ? std::clamp(0.5f * (previous - next) / curvature, -0.5f, 0.5f) : 0.0f;
+        const Candidate candidate { static_cast<float>(lag) + offset, score - 0.25f * (previous - next) * offset };
+
+        const auto position = std::find_if(m_candidates.begin(), m_candidates.end(),
+                                           [&candidate](const Candidate& other) { return other.score < candidate.score; });
+        if (position - m_candidates.begin() >= MAX_CANDIDATES) continue;
+        m_candidates.insert(position, candidate);
+        if (static_cast<int>(m_candidates.size()) > MAX_CANDIDATES) {
+            m_candidates.pop_back();
+        }
+    }
+    return m_candidates;
+}
+
+} // namespace sound2osc
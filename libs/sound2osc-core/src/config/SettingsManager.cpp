@@ -32,6 +32,49 @@ SettingsManager::~SettingsManager()
     save();
 }
 
+namespace {
+
+QList<OSCDestination> destinationsFromVariant(const QVariant& value)
+{
+    QList<OSCDestination> destinations;
+    for (const QVariant& entry : value.toList()) {
+        destinations.append(OSCDestination::fromVariant(entry));
+    }
+    return destinations;
+}
+
+QVariantList destinationsToVariant(const QList<OSCDestination>& destinations)
+{
+    QVariantList list;
+    for (const OSCDestination& destination : destinations) {
+        list.append(destination.toVariant());
+    }
+    return list;
+}
+
+QList<OnsetBand> onsetBandsFromVariant(const QVariant& value)
+{
+    QList<OnsetBand> bands;
+    for (const QVariant& entry : value.toList()) {
+        const OnsetBand band = OnsetBand::fromVariant(entry);
+        if (band.isValid()) {
+            bands.append(band);
+        }
+    }
+    return bands;
+}
+
+QVariantList onsetBandsToVariant(const QList<OnsetBand>& bands)
+{
+    QVariantList list;
+    for (const OnsetBand& band : bands) {
+        list.append(band.toVariant());
+    }
+    return list;
+}
+
+} // namespace
+
 void SettingsManager::initDefaults()
 {
     m_oscIpAddress = "127.0.0.1";
@@ -42,9 +85,25 @@ void SettingsManager::initDefaults()
     m_useTcp = false;
     m_useOsc_1_1 = false;
     m_oscInputEnabled = true;
+    m_oscBundleFrames = false;
+    m_oscMaxBundleSize = 1472;
+    m_oscDestinations.clear();
+    m_oscFeedbackRoutes = OSCRoutes::PRIMARY;
+    m_oscBeatEnabled = false;
+    m_oscBeatLatency = 0;
+    m_oscOnsetsEnabled = false;
     m_oscLogIncoming = true;
     m_oscLogOutgoing = true;
     m_windowMaximized = false;
+    m_inputSampleRate = 0;
+    m_dspThreadEnabled = false;
+    m_dspThreadCpu = -1;
+    m_fftSize = 4096;
+    m_fftHopSize = 0;
+    m_bpmHopSize = 0;
+    m_fftBackend = QStringLiteral("auto");
+    m_tempoEstimator = QStringLiteral("strings");
+    m_onsetBands = OnsetBand::defaults();
 }
 
 // ============================================================================
@@ -163,6 +222,106 @@ void SettingsManager::setOscInputEnabled(bool enabled)
     }
 }
 
+bool SettingsManager::oscBundleFrames() const
+{
+    return m_oscBundleFrames;
+}
+
+void SettingsManager::setOscBundleFrames(bool enabled)
+{
+    if (m_oscBundleFrames != enabled) {
+        m_oscBundleFrames = enabled;
+        emit oscBundleSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::oscMaxBundleSize() const
+{
+    return m_oscMaxBundleSize;
+}
+
+void SettingsManager::setOscMaxBundleSize(int size)
+{
+    size = qMax(32, size);
+    if (m_oscMaxBundleSize != size) {
+        m_oscMaxBundleSize = size;
+        emit oscBundleSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+QList<OSCDestination> SettingsManager::oscDestinations() const
+{
+    return m_oscDestinations;
+}
+
+void SettingsManager::setOscDestinations(const QList<OSCDestination>& destinations)
+{
+    if (m_oscDestinations != destinations) {
+        m_oscDestinations = destinations;
+        emit oscDestinationsChanged();
+        emit settingsChanged();
+    }
+}
+
+quint32 SettingsManager::oscFeedbackRoutes() const
+{
+    return m_oscFeedbackRoutes;
+}
+
+void SettingsManager::setOscFeedbackRoutes(quint32 routes)
+{
+    if (m_oscFeedbackRoutes != routes) {
+        m_oscFeedbackRoutes = routes;
+        emit oscDestinationsChanged();
+        emit settingsChanged();
+    }
+}
+
+bool SettingsManager::oscBeatEnabled() const
+{
+    return m_oscBeatEnabled;
+}
+
+void SettingsManager::setOscBeatEnabled(bool enabled)
+{
+    if (m_oscBeatEnabled != enabled) {
+        m_oscBeatEnabled = enabled;
+        emit oscBeatSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::oscBeatLatency() const
+{
+    return m_oscBeatLatency;
+}
+
+void SettingsManager::setOscBeatLatency(int ms)
+{
+    ms = qBound(0, ms, 1000);
+    if (m_oscBeatLatency != ms) {
+        m_oscBeatLatency = ms;
+        emit oscBeatSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+bool SettingsManager::oscOnsetsEnabled() const
+{
+    return m_oscOnsetsEnabled;
+}
+
+void SettingsManager::setOscOnsetsEnabled(bool enabled)
+{
+    if (m_oscOnsetsEnabled != enabled) {
+        m_oscOnsetsEnabled = enabled;
+        emit oscOnsetSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
 // ============================================================================
 // OSC Logging Settings
 // ============================================================================
@@ -242,6 +401,142 @@ void SettingsManager::setInputDeviceName(const QString& name)
     }
 }
 
+int SettingsManager::inputSampleRate() const
+{
+    return m_inputSampleRate;
+}
+
+void SettingsManager::setInputSampleRate(int sampleRate)
+{
+    sampleRate = qMax(0, sampleRate);
+    if (m_inputSampleRate != sampleRate) {
+        m_inputSampleRate = sampleRate;
+        emit inputSampleRateChanged();
+        emit settingsChanged();
+    }
+}
+
+// ============================================================================
+// Processing Settings
+// ============================================================================
+
+bool SettingsManager::dspThreadEnabled() const
+{
+    return m_dspThreadEnabled;
+}
+
+void SettingsManager::setDspThreadEnabled(bool enabled)
+{
+    if (m_dspThreadEnabled != enabled) {
+        m_dspThreadEnabled = enabled;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::dspThreadCpu() const
+{
+    return m_dspThreadCpu;
+}
+
+void SettingsManager::setDspThreadCpu(int cpu)
+{
+    cpu = qMax(-1, cpu);
+    if (m_dspThreadCpu != cpu) {
+        m_dspThreadCpu = cpu;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::fftSize() const
+{
+    return m_fftSize;
+}
+
+void SettingsManager::setFftSize(int samples)
+{
+    samples = qBound(1024, samples, 8192);
+    if (m_fftSize != samples) {
+        m_fftSize = samples;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::fftHopSize() const
+{
+    return m_fftHopSize;
+}
+
+void SettingsManager::setFftHopSize(int samples)
+{
+    samples = qMax(0, samples);
+    if (m_fftHopSize != samples) {
+        m_fftHopSize = samples;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+int SettingsManager::bpmHopSize() const
+{
+    return m_bpmHopSize;
+}
+
+void SettingsManager::setBpmHopSize(int samples)
+{
+    samples = qMax(0, samples);
+    if (m_bpmHopSize != samples) {
+        m_bpmHopSize = samples;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+QString SettingsManager::fftBackend() const
+{
+    return m_fftBackend;
+}
+
+void SettingsManager::setFftBackend(const QString& name)
+{
+    const QString backend = name.isEmpty() ? QStringLiteral("auto") : name;
+    if (m_fftBackend != backend) {
+        m_fftBackend = backend;
+        emit settingsChanged();
+    }
+}
+
+QString SettingsManager::tempoEstimator() const
+{
+    return m_tempoEstimator;
+}
+
+void SettingsManager::setTempoEstimator(const QString& name)
+{
+    const QString estimator = name.isEmpty() ? QStringLiteral("strings") : name;
+    if (m_tempoEstimator != estimator) {
+        m_tempoEstimator = estimator;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
+QList<OnsetBand> SettingsManager::onsetBands() const
+{
+    return m_onsetBands;
+}
+
+void SettingsManager::setOnsetBands(const QList<OnsetBand>& bands)
+{
+    if (m_onsetBands != bands) {
+        m_onsetBands = bands;
+        emit processingSettingsChanged();
+        emit settingsChanged();
+    }
+}
+
 // ============================================================================
 // Persistence
 // ============================================================================
@@ -265,6 +560,13 @@ bool SettingsManager::load()
         m_useTcp = m_configStore->getValue("osc/useTcp", false).toBool();
         m_useOsc_1_1 = m_configStore->getValue("osc/useOsc_1_1", false).toBool();
         m_oscInputEnabled = m_configStore->getValue("osc/inputEnabled", true).toBool();
+        m_oscBundleFrames = m_configStore->getValue("osc/bundleFrames", false).toBool();
+        m_oscMaxBundleSize = qMax(32, m_configStore->getValue("osc/maxBundleSize", 1472).toInt());
+        m_oscDestinations = destinationsFromVariant(m_configStore->getValue("osc/destinations"));
+        m_oscFeedbackRoutes = m_configStore->getValue("osc/feedbackRoutes", OSCRoutes::PRIMARY).toUInt();
+        m_oscBeatEnabled = m_configStore->getValue("osc/beatEnabled", false).toBool();
+        m_oscBeatLatency = qBound(0, m_configStore->getValue("osc/beatLatency", 0).toInt(), 1000);
+        m_oscOnsetsEnabled = m_configStore->getValue("osc/onsetsEnabled", false).toBool();
         m_oscLogIncoming = m_configStore->getValue("osc/logIncoming", true).toBool();
         m_oscLogOutgoing = m_configStore->getValue("osc/logOutgoing", true).toBool();
         
@@ -272,6 +574,18 @@ bool SettingsManager::load()
         m_windowMaximized = m_configStore->getValue("window/maximized", false).toBool();
         
         m_inputDeviceName = m_configStore->getValue("audio/inputDevice").toString();
+        m_inputSampleRate = qMax(0, m_configStore->getValue("audio/sampleRate", 0).toInt());
+
+        m_dspThreadEnabled = m_configStore->getValue("engine/dspThread", false).toBool();
+        m_dspThreadCpu = qMax(-1, m_configStore->getValue("engine/dspThreadCpu", -1).toInt());
+        m_fftSize = qBound(1024, m_configStore->getValue("engine/fftSize", 4096).toInt(), 8192);
+        m_fftHopSize = qMax(0, m_configStore->getValue("engine/fftHop", 0).toInt());
+        m_bpmHopSize = qMax(0, m_configStore->getValue("engine/bpmHop", 0).toInt());
+        m_fftBackend = m_configStore->getValue("engine/fftBackend", QStringLiteral("auto")).toString();
+        m_tempoEstimator = m_configStore->getValue("engine/tempoEstimator", QStringLiteral("strings")).toString();
+        m_onsetBands = m_configStore->contains("engine/onsetBands")
+            ? onsetBandsFromVariant(m_configStore->getValue("engine/onsetBands"))
+            : OnsetBand::defaults();
         
         m_isValid = true;
     }
@@ -297,6 +611,13 @@ bool SettingsManager::save()
         m_configStore->setValue("osc/useTcp", m_useTcp);
         m_configStore->setValue("osc/useOsc_1_1", m_useOsc_1_1);
         m_configStore->setValue("osc/inputEnabled", m_oscInputEnabled);
+        m_configStore->setValue("osc/bundleFrames", m_oscBundleFrames);
+        m_configStore->setValue("osc/maxBundleSize", m_oscMaxBundleSize);
+        m_configStore->setValue("osc/destinations", destinationsToVariant(m_oscDestinations));
+        m_configStore->setValue("osc/feedbackRoutes", m_oscFeedbackRoutes);
+        m_configStore->setValue("osc/beatEnabled", m_oscBeatEnabled);
+        m_configStore->setValue("osc/beatLatency", m_oscBeatLatency);
+        m_configStore->setValue("osc/onsetsEnabled", m_oscOnsetsEnabled);
         m_configStore->setValue("osc/logIncoming", m_oscLogIncoming);
         m_configStore->setValue("osc/logOutgoing", m_oscLogOutgoing);
         
@@ -304,6 +625,16 @@ bool SettingsManager::save()
         m_configStore->setValue("window/maximized", m_windowMaximized);
         
         m_configStore->setValue("audio/inputDevice", m_inputDeviceName);
+        m_configStore->setValue("audio/sampleRate", m_inputSampleRate);
+
+        m_configStore->setValue("engine/dspThread", m_dspThreadEnabled);
+        m_configStore->setValue("engine/dspThreadCpu", m_dspThreadCpu);
+        m_configStore->setValue("engine/fftSize", m_fftSize);
+        m_configStore->setValue("engine/fftHop", m_fftHopSize);
+        m_configStore->setValue("engine/bpmHop", m_bpmHopSize);
+        m_configStore->setValue("engine/fftBackend", m_fftBackend);
+        m_configStore->setValue("engine/tempoEstimator", m_tempoEstimator);
+        m_configStore->setValue("engine/onsetBands", onsetBandsToVariant(m_onsetBands));
         
         return m_configStore->save();
     }
@@ -347,6 +678,13 @@ void SettingsManager::loadFromQSettings()
     m_useTcp = settings.value("oscUseTcp", false).toBool();
     m_useOsc_1_1 = settings.value("oscUse_1_1", false).toBool();
     m_oscInputEnabled = settings.value("oscInputEnabled", true).toBool();
+    m_oscBundleFrames = settings.value("oscBundleFrames", false).toBool();
+    m_oscMaxBundleSize = qMax(32, settings.value("oscMaxBundleSize", 1472).toInt());
+    m_oscDestinations = destinationsFromVariant(settings.value("oscDestinations"));
+    m_oscFeedbackRoutes = settings.value("oscFeedbackRoutes", OSCRoutes::PRIMARY).toUInt();
+    m_oscBeatEnabled = settings.value("oscBeatEnabled", false).toBool();
+    m_oscBeatLatency = qBound(0, settings.value("oscBeatLatency", 0).toInt(), 1000);
+    m_oscOnsetsEnabled = settings.value("oscOnsetsEnabled", false).toBool();
     
     if (settings.value("oscLogSettingsValid").toBool()) {
         m_oscLogIncoming = settings.value("oscLogIncomingIsEnabled", true).toBool();
@@ -357,6 +695,18 @@ void SettingsManager::loadFromQSettings()
     m_windowMaximized = settings.value("maximized", false).toBool();
     
     m_inputDeviceName = settings.value("inputDeviceName").toString();
+    m_inputSampleRate = qMax(0, settings.value("inputSampleRate", 0).toInt());
+
+    m_dspThreadEnabled = settings.value("dspThreadEnabled", false).toBool();
+    m_dspThreadCpu = qMax(-1, settings.value("dspThreadCpu", -1).toInt());
+    m_fftSize = qBound(1024, settings.value("fftSize", 4096).toInt(), 8192);
+    m_fftHopSize = qMax(0, settings.value("fftHopSize", 0).toInt());
+    m_bpmHopSize = qMax(0, settings.value("bpmHopSize", 0).toInt());
+    m_fftBackend = settings.value("fftBackend", QStringLiteral("auto")).toString();
+    m_tempoEstimator = settings.value("tempoEstimator", QStringLiteral("strings")).toString();
+    m_onsetBands = settings.contains("onsetBands")
+        ? onsetBandsFromVariant(settings.value("onsetBands"))
+        : OnsetBand::defaults();
     
     m_isValid = true;
 }
@@ -375,6 +725,13 @@ void SettingsManager::saveToQSettings()
     settings.setValue("oscUseTcp", m_useTcp);
     settings.setValue("oscUse_1_1", m_useOsc_1_1);
     settings.setValue("oscInputEnabled", m_oscInputEnabled);
+    settings.setValue("oscBundleFrames", m_oscBundleFrames);
+    settings.setValue("oscMaxBundleSize", m_oscMaxBundleSize);
+    settings.setValue("oscDestinations", destinationsToVariant(m_oscDestinations));
+    settings.setValue("oscFeedbackRoutes", m_oscFeedbackRoutes);
+    settings.setValue("oscBeatEnabled", m_oscBeatEnabled);
+    settings.setValue("oscBeatLatency", m_oscBeatLatency);
+    settings.setValue("oscOnsetsEnabled", m_oscOnsetsEnabled);
     
     settings.setValue("oscLogSettingsValid", true);
     settings.setValue("oscLogIncomingIsEnabled", m_oscLogIncoming);
@@ -384,6 +741,16 @@ void SettingsManager::saveToQSettings()
     settings.setValue("maximized", m_windowMaximized);
     
     settings.setValue("inputDeviceName", m_inputDeviceName);
+    settings.setValue("inputSampleRate", m_inputSampleRate);
+
+    settings.setValue("dspThreadEnabled", m_dspThreadEnabled);
+    settings.setValue("dspThreadCpu", m_dspThreadCpu);
+    settings.setValue("fftSize", m_fftSize);
+    settings.setValue("fftHopSize", m_fftHopSize);
+    settings.setValue("bpmHopSize", m_bpmHopSize);
+    settings.setValue("fftBackend", m_fftBackend);
+    settings.setValue("tempoEstimator", m_tempoEstimator);
+    settings.setValue("onsetBands", onsetBandsToVariant(m_onsetBands));
     
     Logger::debug("Settings saved to QSettings");
 }
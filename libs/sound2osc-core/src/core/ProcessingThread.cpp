@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/core/ProcessingThread.h>
+#include <sound2osc/logging/Logger.h>
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace sound2osc {
+
+// The worker re-checks for work after this time even if a wake-up got lost
+// because wake() does not take the mutex.
+static constexpr auto WAKE_TIMEOUT = std::chrono::milliseconds(10);
+
+ProcessingThread::ProcessingThread(std::size_t commandCapacity)
+    : m_commands(commandCapacity)
+{
+}
+
+ProcessingThread::~ProcessingThread()
+{
+    stop();
+}
+
+bool ProcessingThread::start(Function work, int cpuCore)
+{
+    if (isRunning()) return false;
+
+    m_work = std::move(work);
+    m_cpuCore = cpuCore;
+    m_workPending.store(false, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&ProcessingThread::run, this);
+    return true;
+}
+
+void ProcessingThread::stop()
+{
+    if (!m_thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running.store(false, std::memory_order_release);
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+
+    // commands posted after the last run are executed here, on the caller's thread,
+    // so that no control change gets lost when the engine is stopped:
+    executeCommands();
+    m_work = nullptr;
+}
+
+bool ProcessingThread::isCurrentThread() const
+{
+    return m_thread.joinable() && std::this_thread::get_id() == m_thread.get_id();
+}
+
+void ProcessingThread::wake()
+{
+    m_workPending.store(true, std::memory_order_release);
+    m_wakeCondition.notify_one();
+}
+
+bool ProcessingThread::post(Function&& command)
+{
+    if (!m_commands.push(std::move(command))) {
+        return false;
+    }
+    wake();
+    return true;
+}
+
+void ProcessingThread::run()
+{
+    if (m_cpuCore >= 0) {
+        if (pinToCpu(m_cpuCore)) {
+            Logger::info("Processing thread pinned to CPU %1", m_cpuCore);
+        } else {
+            Logger::warning("Could not pin processing thread to CPU %1", m_cpuCore);
+        }
+    }
+
+    while (isRunning()) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait_for(lock, WAKE_TIMEOUT, [this] {
+                return m_workPending.load(std::memory_order_acquire) || !isRunning();
+            });
+        }
+        if (!isRunning()) break;
+
+        m_workPending.store(false, std::memory_order_relaxed);
+        executeCommands();
+        if (m_work) m_work();
+    }
+}
+
+void ProcessingThread::executeCommands()
+{
+    Function command;
+    while (m_commands.pop(command)) {
+        command();
+        command = nullptr;
+    }
+}
+
+bool ProcessingThread::pinToCpu(int cpuCore)
+{
+#if defined(__linux__)
+    if (cpuCore >= CPU_SETSIZE) return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(static_cast<std::size_t>(cpuCore), &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#elif defined(_WIN32)
+    if (cpuCore >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpuCore) != 0;
+#else
+    // macOS and others have no hard affinity API, the hint is ignored
+    Q_UNUSED(cpuCore);
+    return false;
+#endif
+}
+
+} // namespace sound2osc
@@ -9,16 +9,23 @@
 #endif
 #include <sound2osc/logging/Logger.h>
 #include <sound2osc/dsp/FFTAnalyzer.h>
+#include <sound2osc/dsp/FFTBackend.h>
 #include <QJsonArray>
 
+#include <chrono>
+#include <future>
+#include <thread>
+
 namespace sound2osc {
 // ...
 
+// default rate of the FFT and BPM analysis in Hz, the hop in samples is derived from the sample rate
+static constexpr int ANALYSIS_RATE = 44;
+
 Sound2OscEngine::Sound2OscEngine(std::shared_ptr<SettingsManager> settings, QObject *parent)
     : QObject(parent)
     , m_running(false)
     , m_lowSoloMode(false)
-    , m_accumulatedSamples(0)
     , m_settings(std::move(settings))
 {
     initializeComponents();
@@ -34,9 +41,12 @@ void Sound2OscEngine::initializeComponents()
 {
     Logger::info("Initializing Sound2Osc Engine...");
 
-    // 1. Audio Buffer (4x NUM_SAMPLES for overlap/safety)
-    // Using 4096 * 4 samples
-    m_audioBuffer = std::make_unique<MonoAudioBuffer>(4096 * 4);
+    // 1. Audio Buffer (2x MAX_FFT_SIZE for overlap/safety)
+    // Using 8192 * 2 samples
+    m_audioBuffer = std::make_unique<MonoAudioBuffer>(2 * MAX_FFT_SIZE);
+
+    // windowed FFT of the buffer, each frame is computed once for all analysis stages
+    m_stft = std::make_unique<STFTStage>(*m_audioBuffer);
 
     // 2. Audio Input
 #ifdef SOUND2OSC_USE_MINIAUDIO
@@ -56,9 +66,26 @@ void Sound2OscEngine::initializeComponents()
     // 3. OSC Manager
     m_osc = std::make_unique<OSCNetworkManager>();
 
+    // FFT implementation used by the BPM detector and the FFT analyzer
+    if (m_settings && !FFTBackend::select(m_settings->fftBackend().toStdString())) {
+        Logger::warning("Unknown FFT backend %1, using auto", m_settings->fftBackend());
+        FFTBackend::select("auto");
+    }
+    if (FFTBackend::selected() == "auto") {
+        Logger::info("FFT backend: auto (%1)", QString::fromStdString(FFTBackend::fastest(NUM_SAMPLES)));
+    } else {
+        Logger::info("FFT backend: %1", QString::fromStdString(FFTBackend::selected()));
+    }
+
+    // the window sizes that the analysis can switch to (setFftSize(), sample rate of
+    // the BPM detection) are created now, creating an FFT may time or plan it:
+    for (int size = MIN_FFT_SIZE; size <= MAX_FFT_SIZE; size *= 2) {
+        m_stft->prepare(size);
+    }
+
     // 4. BPM Components
     m_bpmOsc = std::make_unique<BPMOscControler>(*m_osc);
-    m_bpmDetector = std::make_unique<BPMDetector>(*m_audioBuffer, m_bpmOsc.get());
+    m_bpmDetector = std::make_unique<BPMDetector>(*m_audioBuffer, m_bpmOsc.get(), m_stft.get());
 
     // 5. Trigger Generators
     // We create them with unique_ptr for ownership, but keep raw pointers in vector for FFTAnalyzer
@@ -77,24 +104,37 @@ void Sound2OscEngine::initializeComponents()
     m_triggerInterfaces.append(m_envelope.get());
     m_triggerInterfaces.append(m_silence.get());
 
+    // user defined bands (empty until configured by a preset or OSC):
+    m_triggerBank = std::make_unique<TriggerBank>(m_osc.get());
+
     // 6. FFT Analyzer
-    m_fft = std::make_unique<FFTAnalyzer>(*m_audioBuffer, m_triggerInterfaces);
+    m_fft = std::make_unique<FFTAnalyzer>(*m_audioBuffer, m_triggerInterfaces, m_stft.get());
+
+    // the copies for the GUI are as large as they can get, publishing them doesn't allocate:
+    const std::size_t spectrumLength = static_cast<std::size_t>(m_fft->getNormalizedSpectrum().size());
+    const std::size_t historyLength = static_cast<std::size_t>(BPMDetector::maxHistoryLength());
+    m_display.initialize([spectrumLength, historyLength](DisplaySnapshot& snapshot) {
+        snapshot.spectrum.reserve(spectrumLength);
+        snapshot.flux.reserve(historyLength);
+        snapshot.onsets.reserve(historyLength);
+        snapshot.colors.reserve(historyLength);
+    });
 }
 
 void Sound2OscEngine::connectComponents()
 {
     // Configure timers
-    // BPM run at ~44 Hz (approx 23ms)
-    // FFT is now event-driven via Audio Input Callback
-    
-    m_bpmTimer.setInterval(1000 / 44);
-    m_bpmTimer.setSingleShot(false);
-    connect(&m_bpmTimer, &QTimer::timeout, this, &Sound2OscEngine::onBpmTimer);
+    // FFT and BPM are event-driven via the Audio Input Callback and the hop schedulers
 
     // Status timer runs every 5 seconds
     m_statusTimer.setInterval(5000);
     m_statusTimer.setSingleShot(false);
     connect(&m_statusTimer, &QTimer::timeout, this, &Sound2OscEngine::onStatusTimer);
+
+    // the trigger delays only end with new samples, this is the wall clock fallback
+    m_stallTimer.setInterval(INPUT_STALL_TIMEOUT / 4);
+    m_stallTimer.setSingleShot(false);
+    connect(&m_stallTimer, &QTimer::timeout, this, &Sound2OscEngine::onStallTimer);
 }
 
 void Sound2OscEngine::applySettings()
@@ -108,8 +148,29 @@ void Sound2OscEngine::applySettings()
     m_osc->setTcpPort(m_settings->oscTcpPort());
     m_osc->setUseTcp(m_settings->useTcp());
     m_osc->setEnabled(m_settings->oscEnabled());
+    m_osc->setMaxBundleSize(m_settings->oscMaxBundleSize());
+    m_osc->setBundleFrames(m_settings->oscBundleFrames());
+    m_osc->setDestinations(m_settings->oscDestinations());
+    m_osc->setFeedbackRoutes(m_settings->oscFeedbackRoutes());
+
+    // Analysis
+    setFftSize(m_settings->fftSize());
+    setAnalysisHopSizes(m_settings->fftHopSize(), m_settings->bpmHopSize());
+    if (m_settings->tempoEstimator() == QLatin1String("autocorrelation")) {
+        m_bpmDetector->setTempoEstimator(BPMDetector::TempoEstimator::Autocorrelation);
+    } else {
+        if (m_settings->tempoEstimator() != QLatin1String("strings")) {
+            Logger::warning("Unknown tempo estimator %1, using strings", m_settings->tempoEstimator());
+        }
+        m_bpmDetector->setTempoEstimator(BPMDetector::TempoEstimator::BeatStrings);
+    }
+    m_bpmDetector->setTransmitBeats(m_settings->oscBeatEnabled());
+    m_bpmDetector->setOnsetBands(m_settings->onsetBands());
+    m_bpmDetector->setTransmitOnsets(m_settings->oscOnsetsEnabled());
+    m_beatLatencySetting = m_settings->oscBeatLatency();
 
     // Audio Input
+    m_audioInput->setPreferredSampleRate(m_settings->inputSampleRate());
     QString inputDevice = m_settings->inputDeviceName();
     if (!inputDevice.isEmpty()) {
         m_audioInput->setInputByName(inputDevice);
@@ -123,10 +184,23 @@ void Sound2OscEngine::start()
     Logger::info("Starting Engine...");
     applySettings();
     
+    // start the analysis schedule at the current position of the input
+    // (hops older than the buffer minus one FFT window can not be analyzed anymore):
+    updateAnalysisSettings();
+    const int64_t position = m_audioBuffer->getNumPutSamples();
+    m_bpmScheduler.setMaxLag(m_audioBuffer->getCapacity() - NUM_SAMPLES);
+    m_fftScheduler.reset(position);
+    m_bpmScheduler.reset(position);
+
     m_running = true;
+    m_releasedAudioTime = m_audioTime.load(std::memory_order_relaxed);
+    if (m_processingMode == ProcessingMode::DedicatedThread) {
+        m_processingThread.start([this]() { processAnalysis(); }, m_processingCpu);
+        Logger::info("Analysis runs on dedicated processing thread");
+    }
     m_audioInput->start();
-    m_bpmTimer.start();
     m_statusTimer.start();
+    m_stallTimer.start();
 }
 
 void Sound2OscEngine::stop()
@@ -136,20 +210,56 @@ void Sound2OscEngine::stop()
     Logger::info("Stopping Engine...");
     m_running = false;
     m_audioInput->stop();
-    m_bpmTimer.stop();
+    m_processingThread.stop();
+    m_analysisPending = false;
     m_statusTimer.stop();
+    m_stallTimer.stop();
+
+    // the worker is joined, the outputs are released by this thread:
+    releaseOutputs();
 }
 
-void Sound2OscEngine::onFftTimer()
+void Sound2OscEngine::setProcessingMode(ProcessingMode mode, int cpuCore)
 {
-    if (!m_running) return;
-    m_fft->calculateFFT(m_lowSoloMode);
+    if (mode == m_processingMode && cpuCore == m_processingCpu) return;
+
+    const bool wasRunning = m_running;
+    if (wasRunning) stop();
+    m_processingMode = mode;
+    m_processingCpu = cpuCore;
+    if (wasRunning) start();
+}
+
+void Sound2OscEngine::runOnProcessingThread(std::function<void()> command)
+{
+    if (!m_processingThread.isRunning() || m_processingThread.isCurrentThread()) {
+        command();
+        return;
+    }
+    // the queue is only full if the worker is stalled, wait until it caught up:
+    while (!m_processingThread.post(std::move(command))) {
+        std::this_thread::yield();
+    }
+}
+
+void Sound2OscEngine::setAnalysisHopSizes(int fftHopSize, int bpmHopSize)
+{
+    // applied by the processing side before the next analysis run
+    m_fftHopSetting = qMax(0, fftHopSize);
+    m_bpmHopSetting = qMax(0, bpmHopSize);
 }
 
-void Sound2OscEngine::onBpmTimer()
+void Sound2OscEngine::setFftSize(int size)
+{
+    // applied by the processing side before the next analysis run
+    m_fftSizeSetting = size;
+}
+
+void Sound2OscEngine::onAnalysisDue()
 {
     if (!m_running) return;
-    m_bpmDetector->detectBPM();
+    m_analysisPending.store(false, std::memory_order_release);
+    runDueAnalysis();
 }
 
 void Sound2OscEngine::onStatusTimer()
@@ -165,15 +275,133 @@ void Sound2OscEngine::onStatusTimer()
                   m_audioInput->getActiveInputName());
 }
 
+void Sound2OscEngine::onStallTimer()
+{
+    if (!m_running) return;
+
+    // once per stall, the triggers start again with the next samples:
+    const int64_t audioTime = m_audioTime.load(std::memory_order_relaxed);
+    if (audioTime == m_releasedAudioTime) return;
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (now - audioTime < static_cast<int64_t>(INPUT_STALL_TIMEOUT) * 1000000) return;
+
+    m_releasedAudioTime = audioTime;
+    Logger::info("No audio input for %1 ms, releasing trigger outputs", INPUT_STALL_TIMEOUT);
+    runOnProcessingThread([this]() { releaseOutputs(); });
+}
+
 void Sound2OscEngine::onAudioProcessed(int count)
 {
-    m_accumulatedSamples += count;
-    // 44100 Hz / 44 Hz = ~1002 samples
-    if (m_accumulatedSamples >= 1000) {
-        m_accumulatedSamples = 0;
+    // the schedulers are keyed on the absolute sample position, not on the callback size
+    Q_UNUSED(count);
+    const int64_t position = m_audioBuffer->getNumPutSamples();
+    m_audioTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    m_audioPosition.store(position, std::memory_order_release);
+    if (!m_fftScheduler.isDue(position) && !m_bpmScheduler.isDue(position)) return;
+
+    // one request at a time, it processes all hops that are due when it runs
+    if (m_analysisPending.exchange(true, std::memory_order_acq_rel)) return;
+    if (m_processingThread.isRunning()) {
+        // Hand over to the worker thread, the event loop is not involved
+        m_processingThread.wake();
+    } else {
         // Invoke on main thread to be safe with shared state
-        QMetaObject::invokeMethod(this, "onFftTimer", Qt::QueuedConnection);
+        QMetaObject::invokeMethod(this, "onAnalysisDue", Qt::QueuedConnection);
+    }
+}
+
+void Sound2OscEngine::processAnalysis()
+{
+    // Called on the processing thread after each wake-up (also for queued commands only)
+    if (!m_analysisPending.exchange(false, std::memory_order_acq_rel)) return;
+    runDueAnalysis();
+}
+
+void Sound2OscEngine::runDueAnalysis()
+{
+    updateAnalysisSettings();
+    const int64_t position = m_audioBuffer->getNumPutSamples();
+    int64_t hopEnd = 0;
+
+    // with bundling enabled, all messages of this pass leave in one bundle:
+    m_osc->beginFrame();
+
+    // catch up with every hop that is due, each run analyzes the samples up to exactly its position:
+    while (m_fftScheduler.next(position, hopEnd)) {
+        m_fft->calculateFFT(m_lowSoloMode, hopEnd);
+        m_triggerBank->evaluate(m_fft->getScaledSpectrum(), m_lowSoloMode, hopEnd);
+    }
+    while (m_bpmScheduler.next(position, hopEnd)) {
+        m_bpmDetector->setBeatLead(beatLead(hopEnd));
+        m_bpmDetector->detectBPM(hopEnd);
     }
+
+    m_osc->endFrame();
+    publishDisplay();
+}
+
+void Sound2OscEngine::releaseOutputs()
+{
+    m_osc->beginFrame();
+    m_fft->releaseOutputs();
+    m_triggerBank->releaseOutputs();
+    m_osc->endFrame();
+}
+
+void Sound2OscEngine::publishDisplay()
+{
+    DisplaySnapshot& snapshot = m_display.back();
+    const QVector<float>& spectrum = m_fft->getNormalizedSpectrum();
+    snapshot.spectrum.assign(spectrum.constBegin(), spectrum.constEnd());
+    const auto& flux = m_bpmDetector->getWaveDisplay();
+    snapshot.flux.assign(flux.begin(), flux.end());
+    const auto& onsets = m_bpmDetector->getOnsets();
+    snapshot.onsets.assign(onsets.begin(), onsets.end());
+    const auto& colors = m_bpmDetector->getWaveColors();
+    snapshot.colors.assign(colors.begin(), colors.end());
+    m_display.publish();
+}
+
+const Sound2OscEngine::DisplaySnapshot& Sound2OscEngine::displaySnapshot()
+{
+    m_display.update();
+    return m_display.front();
+}
+
+int Sound2OscEngine::beatLead(int64_t hopEnd)
+{
+    // the input has moved on since hopEnd (queued analysis, catching up with several hops)
+    // and keeps moving since the last callback:
+    const int sampleRate = m_audioBuffer->getSampleRate();
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const int64_t audioPosition = m_audioPosition.load(std::memory_order_acquire);
+    const double sinceCallback = static_cast<double>(now - m_audioTime.load(std::memory_order_relaxed)) * 1e-9;
+    const double delay = static_cast<double>(audioPosition - hopEnd) + qMax(0.0, sinceCallback) * sampleRate;
+    m_pipelineDelay += 0.1 * (qMax(0.0, delay) - m_pipelineDelay);
+
+    // the beats that are due now are this far ahead of hopEnd
+    const double latency = m_beatLatencySetting.load() * 0.001 * sampleRate;
+    return static_cast<int>(m_pipelineDelay + latency);
+}
+
+void Sound2OscEngine::updateAnalysisSettings()
+{
+    const int sampleRate = m_audioBuffer->getSampleRate();
+    m_fft->setFftSize(m_fftSizeSetting.load());
+    m_fftScheduler.setMaxLag(m_audioBuffer->getCapacity() - m_fft->getFftSize());
+
+    // e.g. 44100 Hz / 44 Hz = ~1002 samples
+    const int defaultHop = sampleRate / ANALYSIS_RATE;
+    const int fftHop = m_fftHopSetting.load();
+    const int bpmHop = m_bpmHopSetting.load();
+    m_fftScheduler.setHopSize(fftHop > 0 ? fftHop : defaultHop);
+    m_bpmScheduler.setHopSize(bpmHop > 0 ? bpmHop : defaultHop);
+
+    // the AGC timings depend on the number of spectrum updates per second:
+    m_fft->getScaledSpectrum().setFrameRate(static_cast<float>(sampleRate) / static_cast<float>(m_fftScheduler.hopSize()));
 }
 
 void Sound2OscEngine::setLowSoloMode(bool enabled)
@@ -196,7 +424,7 @@ QJsonObject Sound2OscEngine::toState() const
     QJsonObject state;
     
     // Global Settings
-    state["lowSoloMode"] = m_lowSoloMode;
+    state["lowSoloMode"] = m_lowSoloMode.load();
     
     // DSP Settings
     QJsonObject dsp;
@@ -222,11 +450,31 @@ QJsonObject Sound2OscEngine::toState() const
     triggers["envelope"] = m_envelope->toState();
     triggers["silence"] = m_silence->toState();
     state["triggers"] = triggers;
+    state["bands"] = m_triggerBank->toState();
     
     return state;
 }
 
 void Sound2OscEngine::fromState(const QJsonObject& state)
+{
+    // Apply between two analysis runs and wait for it,
+    // so that all getters return the restored values afterwards:
+    std::promise<void> applied;
+    std::future<void> done = applied.get_future();
+    runOnProcessingThread([this, &state, &applied]() {
+        applyState(state);
+        applied.set_value();
+    });
+    done.wait();
+
+    // The bank hands its bands over to the analysis by itself, restoring them
+    // here keeps their allocations off the processing thread:
+    if (state.contains("bands")) {
+        m_triggerBank->fromState(state["bands"].toArray());
+    }
+}
+
+void Sound2OscEngine::applyState(const QJsonObject& state)
 {
     // Global Settings
     if (state.contains("lowSoloMode")) {
@@ -22,67 +22,143 @@
 
 #include <sound2osc/dsp/FFTAnalyzer.h>
 
-#include <sound2osc/dsp/FFTRealWrapper.h>
-
-FFTAnalyzer::FFTAnalyzer(const MonoAudioBuffer& buffer,QVector<TriggerGeneratorInterface*>& triggerContainer)
+FFTAnalyzer::FFTAnalyzer(const MonoAudioBuffer& buffer, QVector<TriggerGeneratorInterface*>& triggerContainer, sound2osc::STFTStage* stft)
 	: m_inputBuffer(buffer)
+	, m_fftSize(0)
+	, m_normalization(0)
 	, m_triggerContainer(triggerContainer)
-	, m_buffer(NUM_SAMPLES)
-	, m_window(NUM_SAMPLES)
-	, m_fftOutput(NUM_SAMPLES)
-	, m_linearSpectrum(NUM_SAMPLES / 2)
+	, m_ownStft(stft ? nullptr : std::make_unique<sound2osc::STFTStage>(buffer))
+	, m_stft(stft ? stft : m_ownStft.get())
+	, m_subscription(-1)
+	, m_lowSoloMode(false)
+	, m_hopEnd(0)
+	, m_analyzed(false)
 	, m_scaledSpectrum(SCALED_SPECTRUM_BASE_FREQ, SCALED_SPECTRUM_LENGTH)
 {
-	m_fft = std::make_unique<FFTRealWrapper<NUM_SAMPLES_EXPONENT>>();
-	calculateWindow();
+	m_scaledSpectrum.setSampleRate(buffer.getSampleRate());
+	// setFftSize() is called by the analysis side, it does not allocate then:
+	m_linearSpectrum.reserve(MAX_FFT_SIZE / 2);
+	setFftSize(NUM_SAMPLES);
 }
 
 FFTAnalyzer::~FFTAnalyzer()
 {
+	m_stft->unsubscribe(m_subscription);
+
+	// the triggers may outlive this object:
+	for (TriggerGeneratorInterface* trigger : m_triggerContainer) {
+		TriggerFilter& filter = trigger->getTriggerFilter();
+		if (filter.getTimingWheel() == &m_timingWheel) filter.setTimingWheel(nullptr);
+	}
 }
 
-void FFTAnalyzer::calculateWindow()
+void FFTAnalyzer::setFftSize(int size)
 {
-	// Hann Window function
-	// used to prepare the PCM data for FFT
-	for (int i=0; i<NUM_SAMPLES; ++i) {
-		m_window[i] = 0.5f * (1 - static_cast<float>(qCos((2 * M_PI * i) / (NUM_SAMPLES - 1))));
+	// largest power of 2 that is not above the requested size:
+	int fftSize = MIN_FFT_SIZE;
+	while (fftSize * 2 <= qMin(size, MAX_FFT_SIZE)) {
+		fftSize *= 2;
 	}
+	if (fftSize == m_fftSize) return;
+
+	m_fftSize = fftSize;
+	m_linearSpectrum.resize(m_fftSize / 2);
+
+	// the frames are requested by calculateFFT() (hop 0):
+	if (m_subscription < 0) {
+		m_subscription = m_stft->subscribe(m_fftSize, 0, [this](const sound2osc::STFTFrame& frame) { analyzeFrame(frame); });
+	} else {
+		m_stft->setFormat(m_subscription, m_fftSize, 0);
+	}
+
+	// the Hann window has a coherent gain of 0.5, so the magnitude of a sine
+	// with amplitude 1 is 0.5 * N/2 = N/4 in the bin of its frequency:
+	m_normalization = 4.0f / static_cast<float>(m_fftSize);
 }
 
 void FFTAnalyzer::calculateFFT(bool lowSoloMode)
 {
-	// apply window:
-	int bufferOffset = m_inputBuffer.getCapacity() - NUM_SAMPLES;
-	for (int i=0; i < NUM_SAMPLES; ++i) {
-		m_buffer[i] = static_cast<float>(m_inputBuffer.at(i + bufferOffset)) * m_window[i];
+	// the latest samples:
+	calculateFFT(lowSoloMode, m_inputBuffer.getNumPutSamples());
+}
+
+void FFTAnalyzer::calculateFFT(bool lowSoloMode, int64_t endPosition)
+{
+	m_lowSoloMode = lowSoloMode;
+	m_hopEnd = endPosition;
+	m_analyzed = false;
+
+	// the frame of this hop, or the latest one if its samples were overwritten already:
+	m_stft->request(m_subscription, endPosition);
+	if (!m_analyzed) {
+		m_stft->request(m_subscription, m_inputBuffer.getNumPutSamples());
 	}
+}
 
-	// apply FFT:
-	m_fft->doFft(m_fftOutput.data(), m_buffer.constData());
+void FFTAnalyzer::releaseOutputs()
+{
+	for (int i=0; i<m_triggerContainer.size(); ++i) {
+		TriggerGeneratorInterface* trigger = m_triggerContainer[i];
+		if (i < m_triggerBatch.size() && m_triggerBatch.isActive(i)) {
+			m_triggerBatch.setState(i, false, m_triggerBatch.level(i));
+			trigger->handleTriggerEvent({ i, sound2osc::TriggerEvent::Off, m_triggerBatch.level(i) });
+		}
+		trigger->getTriggerFilter().release();
+	}
+}
+
+void FFTAnalyzer::analyzeFrame(const sound2osc::STFTFrame& frame)
+{
+	m_analyzed = true;
+	const int64_t endPosition = m_hopEnd;
 
-	// convert complex output of FFT to real numbers:
-	for (int i=0; i < NUM_SAMPLES / 2; ++i) {
-		const float real = m_fftOutput[i];
-		const float img = m_fftOutput[NUM_SAMPLES / 2 + i];
-		const float energy = qSqrt(real*real + img*img) / 10;
-		m_linearSpectrum[i] = energy;
+	// magnitudes of the complex output of the FFT, shared with other subscribers of the frame:
+	const float* magnitudes = frame.magnitudes();
+	const int half = m_fftSize / 2;
+	for (int i=0; i < half; ++i) {
+		m_linearSpectrum[i] = magnitudes[i] * m_normalization;
 	}
 	// first value is 0Hz / DC value and is not usefull:
 	m_linearSpectrum[0] = 0.0;
 
-	// give linear spectrum to ScaledSpectrum object to be scalled:
+	// give linear spectrum to ScaledSpectrum object to be scalled
+	// (with the current sample rate, it changes when another input device is opened):
+	m_scaledSpectrum.setSampleRate(m_inputBuffer.getSampleRate());
 	m_scaledSpectrum.updateWithLinearSpectrum(m_linearSpectrum);
 
-    // next element in processing chain: TriggerGenerators
-    bool triggered = false;
-    for (int i=0; i<m_triggerContainer.size(); ++i) {
-        TriggerGeneratorInterface* trigger = m_triggerContainer[i];
-        if (trigger->isBandpass()) {
-            bool active = trigger->checkForTrigger(m_scaledSpectrum, lowSoloMode && triggered);
-            triggered = triggered || active;
-        } else {
-            trigger->checkForTrigger(m_scaledSpectrum, false);
-        }
-    }
+	// delays that ended up to the end of this hop:
+	m_timingWheel.setSampleRate(m_inputBuffer.getSampleRate());
+	m_timingWheel.advance(endPosition);
+
+	// next element in processing chain: TriggerGenerators
+	updateTriggerBatch();
+	m_triggerBatch.evaluate(m_scaledSpectrum, m_lowSoloMode);
+	for (const sound2osc::TriggerEvent& event : m_triggerBatch.events()) {
+		m_triggerContainer[event.trigger]->handleTriggerEvent(event);
+	}
+
+	// delays of 0 started by the events:
+	m_timingWheel.advance(endPosition);
+}
+
+void FFTAnalyzer::updateTriggerBatch()
+{
+	// (re)build the batch when triggers were added or removed:
+	const bool rebuild = m_triggerBatch.size() != m_triggerContainer.size();
+	if (rebuild) m_triggerBatch.clear();
+
+	// only read the parameters of triggers that changed:
+	for (int i=0; i<m_triggerContainer.size(); ++i) {
+		TriggerGeneratorInterface* trigger = m_triggerContainer[i];
+		if (!trigger->takeParametersChanged() && !rebuild) continue;
+		sound2osc::TriggerParameters parameters = trigger->getTriggerParameters(m_scaledSpectrum);
+		// in low solo mode the first active bandpass of the container stays active:
+		parameters.soloOrder = i;
+		if (rebuild) {
+			m_triggerBatch.add(parameters);
+			trigger->getTriggerFilter().setTimingWheel(&m_timingWheel);
+		} else {
+			m_triggerBatch.setParameters(i, parameters);
+		}
+	}
 }
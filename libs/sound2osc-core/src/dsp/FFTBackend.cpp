@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Registry of the available FFT implementations
+
+#include <sound2osc/dsp/FFTBackend.h>
+
+#include <sound2osc/dsp/FFTRealWrapper.h>
+#include <sound2osc/dsp/RadixFFT.h>
+
+#ifdef SOUND2OSC_HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <random>
+
+namespace sound2osc {
+namespace FFTBackend {
+
+namespace {
+
+const char* const AUTO = "auto";
+
+bool isPowerOfTwo(int size)
+{
+    return size > 0 && (size & (size - 1)) == 0;
+}
+
+std::unique_ptr<BasicFFTInterface> createFFTReal(int size)
+{
+    switch (size) {
+    case 1 << 3: return std::make_unique<FFTRealWrapper<3>>();
+    case 1 << 4: return std::make_unique<FFTRealWrapper<4>>();
+    case 1 << 5: return std::make_unique<FFTRealWrapper<5>>();
+    case 1 << 6: return std::make_unique<FFTRealWrapper<6>>();
+    case 1 << 7: return std::make_unique<FFTRealWrapper<7>>();
+    case 1 << 8: return std::make_unique<FFTRealWrapper<8>>();
+    case 1 << 9: return std::make_unique<FFTRealWrapper<9>>();
+    case 1 << 10: return std::make_unique<FFTRealWrapper<10>>();
+    case 1 << 11: return std::make_unique<FFTRealWrapper<11>>();
+    case 1 << 12: return std::make_unique<FFTRealWrapper<12>>();
+    case 1 << 13: return std::make_unique<FFTRealWrapper<13>>();
+    case 1 << 14: return std::make_unique<FFTRealWrapper<14>>();
+    case 1 << 15: return std::make_unique<FFTRealWrapper<15>>();
+    case 1 << 16: return std::make_unique<FFTRealWrapper<16>>();
+    default: return nullptr;
+    }
+}
+
+#ifdef SOUND2OSC_HAVE_FFTW
+// FFTW real-to-halfcomplex transform, reordered to the layout of FFTReal
+class FFTWWrapper : public BasicFFTInterface
+{
+public:
+    explicit FFTWWrapper(int size)
+        : m_size(size)
+        , m_in(fftwf_alloc_real(static_cast<std::size_t>(size)))
+        , m_out(fftwf_alloc_real(static_cast<std::size_t>(size)))
+    {
+        // planning is not thread safe in FFTW:
+        std::lock_guard<std::mutex> lock(planMutex());
+        m_plan = fftwf_plan_r2r_1d(size, m_in, m_out, FFTW_R2HC, FFTW_MEASURE);
+    }
+
+    ~FFTWWrapper() override
+    {
+        std::lock_guard<std::mutex> lock(planMutex());
+        fftwf_destroy_plan(m_plan);
+        fftwf_free(m_in);
+        fftwf_free(m_out);
+    }
+
+    void doFft(float* output, const float* input) override
+    {
+        std::copy(input, input + m_size, m_in);
+        fftwf_execute(m_plan);
+        // halfcomplex: r0, r1, ..., r(n/2), i(n/2-1), ..., i1
+        const int half = m_size / 2;
+        std::copy(m_out, m_out + half + 1, output);
+        for (int k = 1; k < half; ++k) {
+            output[half + k] = -m_out[m_size - k];
+        }
+    }
+
+    int size() const override { return m_size; }
+
+private:
+    static std::mutex& planMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    const int m_size;
+    float* m_in;
+    float* m_out;
+    fftwf_plan m_plan;
+};
+#endif
+
+struct Registry
+{
+    std::mutex mutex;
+    std::string selected = AUTO;
+    std::map<int, std::string> fastest;  // cached result of the measurement per size
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+// best time of a few runs in seconds
+double measure(BasicFFTInterface& fft)
+{
+    const std::size_t size = static_cast<std::size_t>(fft.size());
+    std::vector<float> input(size);
+    std::vector<float> output(size);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (float& value : input) value = distribution(rng);
+
+    fft.doFft(output.data(), input.data());  // warm up
+    double best = 1e300;
+    for (int batch = 0; batch < 5; ++batch) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 8; ++i) {
+            fft.doFft(output.data(), input.data());
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+std::vector<std::string> available()
+{
+    std::vector<std::string> names = { "ffft", "radix" };
+#ifdef SOUND2OSC_HAVE_FFTW
+    names.push_back("fftw");
+#endif
+    return names;
+}
+
+std::unique_ptr<BasicFFTInterface> create(const std::string& name, int size)
+{
+    if (!isPowerOfTwo(size)) return nullptr;
+    if (name == "ffft") {
+        return createFFTReal(size);
+    }
+    if (name == "radix") {
+        if (size < 8) return nullptr;
+        return std::make_unique<RadixFFT>(size);
+    }
+#ifdef SOUND2OSC_HAVE_FFTW
+    if (name == "fftw") {
+        return std::make_unique<FFTWWrapper>(size);
+    }
+#endif
+    return nullptr;
+}
+
+std::unique_ptr<BasicFFTInterface> create(int size)
+{
+    std::string name = selected();
+    if (name == AUTO) {
+        name = fastest(size);
+    }
+    std::unique_ptr<BasicFFTInterface> fft = create(name, size);
+    return fft ? std::move(fft) : createFFTReal(size);
+}
+
+bool select(const std::string& name)
+{
+    const std::vector<std::string> names = available();
+    if (name != AUTO && std::find(names.begin(), names.end(), name) == names.end()) {
+        return false;
+    }
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.selected = name;
+    return true;
+}
+
+std::string selected()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.selected;
+}
+
+std::string fastest(int size)
+{
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        const auto cached = reg.fastest.find(size);
+        if (cached != reg.fastest.end()) return cached->second;
+    }
+
+    std::string best = "ffft";
+    double bestTime = 1e300;
+    for (const std::string& name : available()) {
+        std::unique_ptr<BasicFFTInterface> fft = create(name, size);
+        if (!fft) continue;
+        const double time = measure(*fft);
+        if (time < bestTime) {
+            bestTime = time;
+            best = name;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.fastest[size] = best;
+    return best;
+}
+
+} // namespace FFTBackend
+} // namespace sound2osc
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+//
+// Native real FFT with split real/imaginary storage
+
+#include <sound2osc/dsp/RadixFFT.h>
+
+#include <cmath>
+#include <cstddef>
+
+namespace sound2osc {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+std::size_t idx(int i)
+{
+    return static_cast<std::size_t>(i);
+}
+
+} // namespace
+
+RadixFFT::RadixFFT(int size)
+    : m_size(size)
+    , m_half(size / 2)
+    , m_bitReverse(idx(size / 2))
+    , m_twiddleRe(idx(size / 2))
+    , m_twiddleIm(idx(size / 2))
+    , m_postRe(idx(size / 4 + 1))
+    , m_postIm(idx(size / 4 + 1))
+    , m_re(idx(size / 2))
+    , m_im(idx(size / 2))
+{
+    int bits = 0;
+    while ((1 << bits) < m_half) ++bits;
+    for (int i = 0; i < m_half; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[idx(i)] = reversed;
+    }
+
+    // twiddles e^(-2*pi*i*j/(2h)) of the stage with h butterflies per group:
+    for (int h = 1; h < m_half; h *= 2) {
+        for (int j = 0; j < h; ++j) {
+            const double angle = -PI * j / h;
+            m_twiddleRe[idx(h + j)] = static_cast<float>(std::cos(angle));
+            m_twiddleIm[idx(h + j)] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    // W^k = e^(-2*pi*i*k/N) for the split into the spectrum of the real input:
+    for (int k = 0; k <= m_half / 2; ++k) {
+        const double angle = -2.0 * PI * k / m_size;
+        m_postRe[idx(k)] = static_cast<float>(std::cos(angle));
+        m_postIm[idx(k)] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void RadixFFT::doFft(float* output, const float* input)
+{
+    // pack even samples as real and odd samples as imaginary part, in bit reversed order:
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const int* bitReverse = m_bitReverse.data();
+    for (int i = 0; i < m_half; ++i) {
+        const int source = 2 * bitReverse[i];
+        re[i] = input[source];
+        im[i] = input[source + 1];
+    }
+
+    complexFft();
+
+    // split the complex spectrum Z into the spectrum X of the real input:
+    // E = (Z[k] + conj(Z[M-k])) / 2, O = (Z[k] - conj(Z[M-k])) / 2i
+    // X[k] = E + W^k * O, X[M-k] = conj(E - W^k * O)
+    const int half = m_half;
+    output[0] = re[0] + im[0];
+    output[half] = re[0] - im[0];
+    for (int k = 1; k < half / 2; ++k) {
+        const float zr = re[k];
+        const float zi = im[k];
+        const float yr = re[half - k];
+        const float yi = im[half - k];
+        const float er = 0.5f * (zr + yr);
+        const float ei = 0.5f * (zi - yi);
+        const float orr = 0.5f * (zi + yi);
+        const float oi = -0.5f * (zr - yr);
+        const float wr = m_postRe[idx(k)];
+        const float wi = m_postIm[idx(k)];
+        const float tr = wr * orr - wi * oi;
+        const float ti = wr * oi + wi * orr;
+        // FFTReal layout: real parts first, then the negated imaginary parts
+        output[k] = er + tr;
+        output[half + k] = -(ei + ti);
+        output[half - k] = er - tr;
+        output[m_size - k] = ei - ti;
+    }
+    // W^(M/2) = -i
+    output[half / 2] = re[half / 2];
+    output[half + half / 2] = im[half / 2];
+}
+
+void RadixFFT::complexFft()
+{
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const int n = m_half;
+
+    // first two stages as one radix-4 pass (the twiddles are 1 and -i):
+    for (int i = 0; i < n; i += 4) {
+        const float ar = re[i] + re[i + 1];
+        const float ai = im[i] + im[i + 1];
+        const float br = re[i] - re[i + 1];
+        const float bi = im[i] - im[i + 1];
+        const float cr = re[i + 2] + re[i + 3];
+        const float ci = im[i + 2] + im[i + 3];
+        const float dr = re[i + 2] - re[i + 3];
+        const float di = im[i + 2] - im[i + 3];
+        re[i] = ar + cr;
+        im[i] = ai + ci;
+        re[i + 2] = ar - cr;
+        im[i + 2] = ai - ci;
+        // (dr + i*di) * -i = di - i*dr
+        re[i + 1] = br + di;
+        im[i + 1] = bi - dr;
+        re[i + 3] = br - di;
+        im[i + 3] = bi + dr;
+    }
+
+    // remaining stages, two radix-2 stages are merged into one pass where possible
+    // to halve the memory traffic, the inner loops run over contiguous memory:
+    int h = 4;
+    int stages = 0;
+    for (int size = h; size < n; size *= 2) ++stages;
+    if (stages % 2 == 1) {
+        radix2Pass(h);
+        h *= 2;
+    }
+    for (; h < n; h *= 4) {
+        radix4Pass(h);
+    }
+}
+
+void RadixFFT::radix2Pass(int h)
+{
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const float* wr = m_twiddleRe.data() + h;
+    const float* wi = m_twiddleIm.data() + h;
+    for (int group = 0; group < m_half; group += 2 * h) {
+        float* ar = re + group;
+        float* ai = im + group;
+        float* br = ar + h;
+        float* bi = ai + h;
+        for (int j = 0; j < h; ++j) {
+            const float tr = br[j] * wr[j] - bi[j] * wi[j];
+            const float ti = br[j] * wi[j] + bi[j] * wr[j];
+            br[j] = ar[j] - tr;
+            bi[j] = ai[j] - ti;
+            ar[j] += tr;
+            ai[j] += ti;
+        }
+    }
+}
+
+void RadixFFT::radix4Pass(int h)
+{
+    // the stages with h and 2h butterflies per group in one pass:
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const float* w1r = m_twiddleRe.data() + h;
+    const float* w1i = m_twiddleIm.data() + h;
+    const float* w2r = m_twiddleRe.data() + 2 * h;
+    const float* w2i = m_twiddleIm.data() + 2 * h;
+    const float* w3r = w2r + h;
+    const float* w3i = w2i + h;
+    for (int group = 0; group < m_half; group += 4 * h) {
+        float* ar = re + group;
+        float* ai = im + group;
+        float* br = ar + h;
+        float* bi = ai + h;
+        float* cr = br + h;
+        float* ci = bi + h;
+        float* dr = cr + h;
+        float* di = ci + h;
+        for (int j = 0; j < h; ++j) {
+            // first stage: (a, b) and (c, d) with the same twiddle
+            const float tbr = br[j] * w1r[j] - bi[j] * w1i[j];
+            const float tbi = br[j] * w1i[j] + bi[j] * w1r[j];
+            const float tdr = dr[j] * w1r[j] - di[j] * w1i[j];
+            const float tdi = dr[j] * w1i[j] + di[j] * w1r[j];
+            const float a1r = ar[j] + tbr;
+            const float a1i = ai[j] + tbi;
+            const float b1r = ar[j] - tbr;
+            const float b1i = ai[j] - tbi;
+            const float c1r = cr[j] + tdr;
+            const float c1i = ci[j] + tdi;
+            const float d1r = cr[j] - tdr;
+            const float d1i = ci[j] - tdi;
+            // second stage: (a, c) and (b, d)
+            const float tcr = c1r * w2r[j] - c1i * w2i[j];
+            const float tci = c1r * w2i[j] + c1i * w2r[j];
+            const float tdr2 = d1r * w3r[j] - d1i * w3i[j];
+            const float tdi2 = d1r * w3i[j] + d1i * w3r[j];
+            ar[j] = a1r + tcr;
+            ai[j] = a1i + tci;
+            cr[j] = a1r - tcr;
+            ci[j] = a1i - tci;
+            br[j] = b1r + tdr2;
+            bi[j] = b1i + tdi2;
+            dr[j] = b1r - tdr2;
+            di[j] = b1i - tdi2;
+        }
+    }
+}
+
+} // namespace sound2osc
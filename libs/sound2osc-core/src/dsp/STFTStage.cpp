@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/dsp/STFTStage.h>
+
+#include <sound2osc/audio/MonoAudioBuffer.h>
+#include <sound2osc/dsp/FFTBackend.h>
+
+#include <QtMath>
+
+#include <algorithm>
+#include <limits>
+
+namespace sound2osc {
+
+namespace {
+
+constexpr int64_t NONE_DUE = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+const float* STFTFrame::magnitudes() const
+{
+    if (!m_hasMagnitudes) {
+        // FFTReal layout: real parts in the first half, imaginary parts in the second:
+        const int half = m_size / 2;
+        for (int i = 0; i < half; ++i) {
+            const float real = m_fftOutput[i];
+            const float img = m_fftOutput[half + i];
+            m_magnitudes[i] = qSqrt(real * real + img * img);
+        }
+        m_hasMagnitudes = true;
+    }
+    return m_magnitudes;
+}
+
+STFTStage::STFTStage(const MonoAudioBuffer& buffer)
+    : m_inputBuffer(buffer)
+    , m_nextId(0)
+    , m_transformCount(0)
+{
+}
+
+STFTStage::~STFTStage() = default;
+
+int STFTStage::subscribe(int size, int hop, Callback callback)
+{
+    const int id = m_nextId++;
+    m_subscriptions.push_back({ id, size, std::max(0, hop), NONE_DUE, std::move(callback) });
+    transform(size);
+    setFormat(id, size, hop);
+    return id;
+}
+
+void STFTStage::unsubscribe(int id)
+{
+    m_subscriptions.erase(std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
+                                         [id](const Subscription& subscription) { return subscription.id == id; }),
+                          m_subscriptions.end());
+}
+
+void STFTStage::prepare(int size)
+{
+    transform(size);
+}
+
+void STFTStage::setFormat(int id, int size, int hop)
+{
+    Subscription* subscription = find(id);
+    if (!subscription) return;
+    subscription->size = size;
+    subscription->hop = std::max(0, hop);
+    subscription->next = subscription->hop > 0 ? m_inputBuffer.getNumPutSamples() + size : NONE_DUE;
+    transform(size);
+}
+
+void STFTStage::restart(int id, int64_t endPosition)
+{
+    Subscription* subscription = find(id);
+    if (subscription) subscription->next = endPosition;
+}
+
+void STFTStage::request(int id, int64_t endPosition)
+{
+    restart(id, endPosition);
+    process(endPosition);
+}
+
+void STFTStage::process(int64_t endPosition)
+{
+    // frames that are not completely received yet stay due:
+    endPosition = std::min(endPosition, m_inputBuffer.getNumPutSamples());
+
+    for (;;) {
+        // the oldest due frame of all subscriptions:
+        const Subscription* due = nullptr;
+        for (const Subscription& subscription : m_subscriptions) {
+            if (subscription.next > endPosition) continue;
+            if (!due || subscription.next < due->next
+                    || (subscription.next == due->next && subscription.size < due->size)) {
+                due = &subscription;
+            }
+        }
+        if (!due) return;
+
+        // transform it once for all subscriptions that need the same frame:
+        const int size = due->size;
+        const int64_t frameEnd = due->next;
+        Transform& frameTransform = transform(size);
+        const bool available = compute(frameTransform, frameEnd);
+        m_frame.m_size = size;
+        m_frame.m_endPosition = frameEnd;
+        m_frame.m_fftOutput = frameTransform.output.data();
+        m_frame.m_magnitudes = frameTransform.magnitudes.data();
+        m_frame.m_hasMagnitudes = false;
+
+        for (Subscription& subscription : m_subscriptions) {
+            if (subscription.size != size || subscription.next != frameEnd) continue;
+            if (available) {
+                subscription.next = subscription.hop > 0 ? frameEnd + subscription.hop : NONE_DUE;
+                subscription.callback(m_frame);
+            } else {
+                subscription.next = firstAvailable(subscription);
+            }
+        }
+    }
+}
+
+STFTStage::Subscription* STFTStage::find(int id)
+{
+    for (Subscription& subscription : m_subscriptions) {
+        if (subscription.id == id) return &subscription;
+    }
+    return nullptr;
+}
+
+STFTStage::Transform& STFTStage::transform(int size)
+{
+    for (Transform& existing : m_transforms) {
+        if (existing.size == size) return existing;
+    }
+
+    Transform created;
+    created.size = size;
+    created.fft = FFTBackend::create(size);
+    created.window.resize(static_cast<std::size_t>(size));
+    created.samples.resize(static_cast<std::size_t>(size));
+    created.output.resize(static_cast<std::size_t>(size));
+    created.magnitudes.resize(static_cast<std::size_t>(size / 2));
+
+    // Hann window, the same that the analysis stages used before:
+    for (int i = 0; i < size; ++i) {
+        created.window[static_cast<std::size_t>(i)] =
+            0.5f * (1 - static_cast<float>(qCos((2 * M_PI * i) / (size - 1))));
+    }
+
+    m_transforms.push_back(std::move(created));
+    return m_transforms.back();
+}
+
+bool STFTStage::compute(Transform& frameTransform, int64_t endPosition)
+{
+    const int size = frameTransform.size;
+    float* samples = frameTransform.samples.data();
+    if (!m_inputBuffer.copySamples(endPosition - size, size, samples)) return false;
+
+    const float* window = frameTransform.window.data();
+    for (int i = 0; i < size; ++i) {
+        samples[i] *= window[i];
+    }
+    frameTransform.fft->doFft(frameTransform.output.data(), samples);
+    ++m_transformCount;
+    return true;
+}
+
+int64_t STFTStage::firstAvailable(const Subscription& subscription) const
+{
+    if (subscription.hop <= 0) return NONE_DUE;
+    // the oldest sample that is still in the buffer:
+    const int64_t oldest = m_inputBuffer.getNumPutSamples() - m_inputBuffer.getCapacity();
+    const int64_t missing = oldest + subscription.size - subscription.next;
+    const int64_t hops = std::max<int64_t>(1, (missing + subscription.hop - 1) / subscription.hop);
+    return subscription.next + hops * subscription.hop;
+}
+
+} // namespace sound2osc
@@ -25,85 +25,173 @@
 #include <QtMath>
 #include <QDebug>
 
+#include <algorithm>
+
 #include <sound2osc/dsp/FFTAnalyzer.h>
+#include <sound2osc/dsp/FastMath.h>
 
 ScaledSpectrum::ScaledSpectrum(const int &baseFreq, const int &scaledLength)
     : m_baseFreq(baseFreq)
     , m_scaledLength(scaledLength)
     , m_freqScaleFactor(0)
+	, m_sampleRate(static_cast<int>(2 * SCALED_SPECTRUM_MAX_FREQ))
 	, m_gain(1)
 	, m_compression(1)
 	, m_convertToDecibel(false)
     , m_normSpectrum(scaledLength)
 	, m_agcEnabled(true)
-	, m_lastMaxValues(AGC_AVERAGING_LENGTH)
+	, m_frameRate(0)
+	, m_agcIncrementStep(0)
+	, m_agcDecrementStep(0)
+	, m_lastMaxValues(1)
+	, m_mappedLength(0)
+	, m_mappedSampleRate(0)
+	, m_bandStart(scaledLength)
+	, m_bandCount(scaledLength)
+	, m_bandEnergy(scaledLength)
+	, m_maxLevel(0)
 {
-    // freqScaleFactor is a constant that is used in for-loop in updateWithLinearSpectrum
+    // freqScaleFactor is a constant that is used in for-loop in updateBinMap
     // to calculate the next frequency in logarithmic scale:
-    m_freqScaleFactor = qPow(22050.0 / baseFreq, 1./scaledLength);
+    m_freqScaleFactor = qPow(SCALED_SPECTRUM_MAX_FREQ / baseFreq, 1./scaledLength);
 
     // logOfFreqScaleFactor is a constant used in getIndexForFreq
     // to convert a frequency back to the index in the logarithmic array:
-	m_logOfFreqScaleFactor = qLn(22050. / baseFreq) / scaledLength;
+	m_logOfFreqScaleFactor = qLn(SCALED_SPECTRUM_MAX_FREQ / baseFreq) / scaledLength;
+
+	setFrameRate(AGC_DEFAULT_FRAME_RATE);
+
+	// floor(log2(n)) for all range lengths and the levels of the sparse table:
+	m_rangeLevel.resize(scaledLength + 1);
+	m_rangeLevel[0] = 0;
+	for (int n = 1; n <= scaledLength; ++n) {
+		m_rangeLevel[n] = (n == 1) ? 0 : m_rangeLevel[n / 2] + 1;
+	}
+	m_rangeMax.fill(0.0f, (m_rangeLevel[scaledLength] + 1) * scaledLength);
+}
+
+void ScaledSpectrum::setFrameRate(float framesPerSecond)
+{
+	framesPerSecond = qMax(1.0f, framesPerSecond);
+	if (qFuzzyCompare(framesPerSecond, m_frameRate)) return;
+	m_frameRate = framesPerSecond;
+
+	// convert the AGC timings to frames:
+	m_agcIncrementStep = 1.0f / (AGC_INCREMENT_TIME * m_frameRate);
+	m_agcDecrementStep = 1.0f / (AGC_DECREMENT_TIME * m_frameRate);
+	const int averagingLength = qMax(1, qRound(AGC_AVERAGING_TIME * m_frameRate));
 
 	// initialize lastMaxValues with 0:
-	for (int i=0; i<m_lastMaxValues.size(); ++i) {
-		m_lastMaxValues.push_back(0.0f);
+	m_lastMaxValues = Qt3DCore::QCircularBuffer<float>(averagingLength, 0.0f);
+}
+
+void ScaledSpectrum::updateBinMap(int linearLength)
+{
+	m_mappedLength = linearLength;
+	m_mappedSampleRate = m_sampleRate;
+	// the linear spectrum covers 0Hz to the Nyquist frequency:
+	const double binsPerHz = linearLength / (m_sampleRate / 2.0);
+
+	// This for-loop generates frequencies so that there are equally many steps between every octave of frequencies:
+	// (There are as many steps between 100Hz and 200Hz as between 400Hz and 800Hz.)
+	double freq = m_baseFreq;
+	for (int i = 0; i<m_scaledLength; ++i) {
+		// calculate begin and end frequency of this step:
+		double nextFreq = m_baseFreq * qPow(m_freqScaleFactor, i+1);
+		const int startIndex = static_cast<int>(qMin(freq * binsPerHz, double(linearLength)));
+		const int endIndex = static_cast<int>(qMin(nextFreq * binsPerHz, double(linearLength)));
+		freq = nextFreq;
+
+		// each band contains at least the element at its start frequency
+		// (there are no elements above the Nyquist frequency):
+		m_bandStart[i] = qMin(startIndex, linearLength - 1);
+		m_bandCount[i] = startIndex < linearLength ? qMax(1, endIndex - startIndex) : 0;
 	}
 }
 
 void ScaledSpectrum::updateWithLinearSpectrum(const QVector<float>& linearSpectrum)
 {
-    const int linearLength = static_cast<int>(linearSpectrum.size());
-	double freq = m_baseFreq;
-	float maxValue = 0;
+	const int linearLength = static_cast<int>(linearSpectrum.size());
+	if (linearLength != m_mappedLength || m_sampleRate != m_mappedSampleRate) {
+		updateBinMap(linearLength);
+	}
+	const float gain = m_gain;
+	const float exponent = 1 / m_compression;
+	const bool convertToDecibel = m_convertToDecibel;
+	const int length = m_scaledLength;
 
+	// Sum up the energies of all FFT elements of each band:
+	const float* linear = linearSpectrum.constData();
+	float* bandEnergy = m_bandEnergy.data();
+	float maxEnergy = 0;
+	for (int i = 0; i < length; ++i) {
+		const float* bins = linear + m_bandStart[i];
+		const int count = m_bandCount[i];
+		float energy = 0.0f;
+		for (int j = 0; j < count; ++j) {
+			energy += bins[j];
+		}
+		bandEnergy[i] = energy;
+		maxEnergy = qMax(maxEnergy, energy);
+	}
 
-    // This for-loop generates frequencies so that there are equally many steps between every octave of frequencies:
-    // (There are as many steps between 100Hz and 200Hz as between 400Hz and 800Hz.)
-    for (int i = 0; i<m_scaledLength; ++i) {
-        // calculate begin and end frequency of this step:
-        double nextFreq = m_baseFreq * qPow(m_freqScaleFactor, i+1);
-        const std::size_t startIndex = static_cast<std::size_t>(freq / 22050 * (linearLength));
-        const std::size_t endIndex = static_cast<std::size_t>(nextFreq / 22050 * (linearLength));
-        const std::size_t valuesTillNext = endIndex - startIndex;
-        freq = nextFreq;
-
-        // Sum up the energies of all FFT elements betwen the two frequencies:
-        float energy = linearSpectrum[static_cast<int>(startIndex)];
-        for (std::size_t j=1; j < valuesTillNext; ++j) {
-            energy += linearSpectrum[static_cast<int>(startIndex+j)];
-        }
-
-        // Maximum of FFT is sqrt(NUM_SAMPLES)
-        // in this case: sqrt(2048) = 45.2548339959
-
-		//const float maxPossibleEnergy = (MAX_FFT_VALUE*qMax(std::size_t(1), valuesTillNext));
-		const float maxPossibleEnergy = MAX_FFT_VALUE;
-
-        if (m_convertToDecibel) {
-            // Convert energy to dB:
-			float dB = 20.0f * static_cast<float>(qLn(static_cast<double>(energy) / static_cast<double>(maxPossibleEnergy)) / qLn(10.0));
-			float valueBeforeGain = (dB + 60.0f) / 60.0f;
-			maxValue = qMax(maxValue, valueBeforeGain);
-
-            // Scale the value with factor and exponent:
-			m_normSpectrum[i] = qPow(qMax(0.0f, qMin(valueBeforeGain * m_gain, 1.0f)), (1 / m_compression));
-        } else {
-            // Apply reasonable scale:
-			energy /= maxPossibleEnergy;
-			maxValue = qMax(maxValue, energy);
-			energy *= m_gain;
-
-            // Scale the value with factor and exponent:
-			m_normSpectrum[i] = qPow(qMax(0.0f, qMin(energy, 1.0f)), (1 / m_compression));
+	// The linear spectrum is normalized by the FFTAnalyzer,
+	// a full scale sine results in 1.0 independent of the FFT size.
+	// The following loops only use FastMath and are vectorized:
+	float maxValue = 0;
+	float* norm = m_normSpectrum.data();
+	if (convertToDecibel) {
+		// Convert energy to dB and map -60dB...0dB to 0...1:
+		// (20 * log10(energy) + 60) / 60 = 1 + log2(energy) * log10(2) / 3
+		const float log2ToValue = 0.100343331f;
+		for (int i = 0; i < length; ++i) {
+			const float energy = sound2osc::FastMath::clamp(bandEnergy[i], 1e-30f, 1e30f);
+			const float valueBeforeGain = 1.0f + sound2osc::FastMath::log2(energy) * log2ToValue;
+			norm[i] = sound2osc::FastMath::clamp(valueBeforeGain * gain, 0.0f, 1.0f);
+		}
+		// the conversion is monotonic, the max value is the one of the max energy:
+		maxValue = qMax(0.0f, 1.0f + sound2osc::FastMath::log2(qMax(maxEnergy, 1e-30f)) * log2ToValue);
+	} else {
+		for (int i = 0; i < length; ++i) {
+			norm[i] = sound2osc::FastMath::clamp(bandEnergy[i] * gain, 0.0f, 1.0f);
 		}
-    }
+		maxValue = maxEnergy;
+	}
+
+	// Scale the values with the compression exponent:
+	if (exponent != 1.0f) {
+		for (int i = 0; i < length; ++i) {
+			norm[i] = sound2osc::FastMath::pow(norm[i], exponent);
+		}
+	}
+
+	updateRangeMax();
+
 	// add maximum value to circular buffer:
 	m_lastMaxValues.push_back(maxValue);
 	updateAGC();
 }
 
+void ScaledSpectrum::updateRangeMax()
+{
+	const int length = m_scaledLength;
+	const int levels = m_rangeLevel[length] + 1;
+	float* table = m_rangeMax.data();
+	std::copy(m_normSpectrum.constBegin(), m_normSpectrum.constEnd(), table);
+
+	// the max of 2^k values is the max of the two halves of 2^(k-1) values:
+	for (int k = 1; k < levels; ++k) {
+		const float* previous = table + (k - 1) * length;
+		float* current = table + k * length;
+		const int half = 1 << (k - 1);
+		const int count = length - 2 * half + 1;
+		for (int i = 0; i < count; ++i) {
+			current[i] = std::max(previous[i], previous[i + half]);
+		}
+	}
+	m_maxLevel = getMaxLevel(0, length - 1);
+}
+
 int ScaledSpectrum::getIndexForFreq(const int &freq) const
 {
     // convert a frequency back to the index in the logarithmic array:
@@ -116,27 +204,49 @@ double ScaledSpectrum::getFreqAtPosition(const double &value) const
 	return freq;
 }
 
-float ScaledSpectrum::getMaxLevel(const int &midFreq, const qreal &width) const
+void ScaledSpectrum::getBandRange(const int &midFreq, const qreal &width, int &startIndex, int &endIndex) const
 {
 	int midIndex = getIndexForFreq(midFreq);
-	int startIndex = qMax(0, qMin(int(midIndex - m_scaledLength*width/2), m_scaledLength - 1));
-	int endIndex = qMax(0, qMin(int(midIndex + m_scaledLength*width/2), m_scaledLength - 1));
+	startIndex = qMax(0, qMin(int(midIndex - m_scaledLength*width/2), m_scaledLength - 1));
+	endIndex = qMax(0, qMin(int(midIndex + m_scaledLength*width/2), m_scaledLength - 1));
 	if (endIndex == startIndex) ++endIndex;
-    // get max level between both indexes:
-    float max = 0.0;
-    for (int i=startIndex; i<=endIndex; ++i) {
-        max = qMax(m_normSpectrum[i], max);
-    }
-    return max;
+	endIndex = qMin(endIndex, m_scaledLength - 1);
+}
+
+float ScaledSpectrum::getMaxLevel(const int &midFreq, const qreal &width) const
+{
+	int startIndex = 0;
+	int endIndex = 0;
+	getBandRange(midFreq, width, startIndex, endIndex);
+	return getMaxLevel(startIndex, endIndex);
 }
 
-float ScaledSpectrum::getMaxLevel() const
+float ScaledSpectrum::getMaxLevel(int startIndex, int endIndex) const
 {
-    float max = 0.0;
-    for (int i=0; i<m_scaledLength; ++i) {
-        max = qMax(m_normSpectrum[i], max);
-    }
-	return max;
+	startIndex = qMax(0, startIndex);
+	endIndex = qMin(endIndex, m_scaledLength - 1);
+	if (endIndex < startIndex) return 0.0f;
+	// two (overlapping) ranges of 2^k values cover the whole range:
+	const int k = m_rangeLevel[endIndex - startIndex + 1];
+	const float* level = m_rangeMax.constData() + k * m_scaledLength;
+	return qMax(level[startIndex], level[endIndex - (1 << k) + 1]);
+}
+
+void ScaledSpectrum::getMaxLevels(const int* startIndexes, const int* endIndexes, float* maxLevels, int count) const
+{
+	const float* rangeMax = m_rangeMax.constData();
+	const int* rangeLevel = m_rangeLevel.constData();
+	for (int i = 0; i < count; ++i) {
+		const int startIndex = qMax(0, startIndexes[i]);
+		const int endIndex = qMin(endIndexes[i], m_scaledLength - 1);
+		if (endIndex < startIndex) {
+			maxLevels[i] = 0.0f;
+			continue;
+		}
+		const int k = rangeLevel[endIndex - startIndex + 1];
+		const float* level = rangeMax + k * m_scaledLength;
+		maxLevels[i] = qMax(level[startIndex], level[endIndex - (1 << k) + 1]);
+	}
 }
 
 void ScaledSpectrum::updateAGC()
@@ -159,9 +269,10 @@ void ScaledSpectrum::updateAGC()
 	float requiredGain = (1 - AGC_HEADROOM) / maxValue;
 
 	// adjust gain in small steps:
-	if (requiredGain < m_gain) {
-		m_gain = qMax(AGC_MIN_GAIN, qMax(requiredGain, m_gain - AGC_DECREMENT_STEPSIZE));
+	const float gain = m_gain;
+	if (requiredGain < gain) {
+		m_gain = qMax(AGC_MIN_GAIN, qMax(requiredGain, gain - m_agcDecrementStep));
 	} else {
-		m_gain = qMin(AGC_MAX_GAIN, qMin(requiredGain, m_gain + AGC_INCREMENT_STEPSIZE));
+		m_gain = qMin(AGC_MAX_GAIN, qMin(requiredGain, gain + m_agcIncrementStep));
 	}
 }
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/OSCDestination.h>
+
+namespace sound2osc {
+
+bool OSCDestination::operator==(const OSCDestination& other) const
+{
+    return name == other.name && address == other.address && port == other.port
+        && protocol == other.protocol && enabled == other.enabled;
+}
+
+QVariantMap OSCDestination::toVariant() const
+{
+    QVariantMap map;
+    map["name"] = name;
+    map["host"] = address.toString();
+    map["port"] = port;
+    map["protocol"] = protocolName(protocol);
+    map["enabled"] = enabled;
+    return map;
+}
+
+OSCDestination OSCDestination::fromVariant(const QVariant& value)
+{
+    const QVariantMap map = value.toMap();
+    OSCDestination destination;
+    destination.name = map.value("name").toString();
+    destination.address = QHostAddress(map.value("host", "127.0.0.1").toString());
+    destination.port = static_cast<quint16>(qBound(0, map.value("port", 8000).toInt(), 65535));
+    destination.protocol = protocolFromName(map.value("protocol").toString());
+    destination.enabled = map.value("enabled", true).toBool();
+    return destination;
+}
+
+QString OSCDestination::protocolName(Protocol protocol)
+{
+    switch (protocol) {
+    case Protocol::Tcp: return "tcp";
+    case Protocol::Slip: return "slip";
+    case Protocol::Udp: break;
+    }
+    return "udp";
+}
+
+OSCDestination::Protocol OSCDestination::protocolFromName(const QString& name)
+{
+    if (name == "tcp") return Protocol::Tcp;
+    if (name == "slip") return Protocol::Slip;
+    return Protocol::Udp;
+}
+
+} // namespace sound2osc
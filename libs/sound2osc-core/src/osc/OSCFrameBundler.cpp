@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/OSCFrameBundler.h>
+
+#include <sound2osc/osc/OSCParser.h>
+
+#include <algorithm>
+
+namespace sound2osc {
+
+namespace {
+
+// seconds from 1900-01-01 (NTP epoch) to 1970-01-01 (Unix epoch)
+constexpr uint64_t NTP_UNIX_OFFSET = 2208988800ull;
+
+QByteArray createBundle(const std::vector<QByteArray>& packets, std::size_t begin, std::size_t end, uint64_t timeTag)
+{
+    OSCBundleWriter writer;
+    writer.SetTimeTag(timeTag);
+    for (std::size_t i = begin; i < end; ++i) {
+        writer.AddPacket(new OSCRawPacket(packets[i].constData(), static_cast<size_t>(packets[i].size())));
+    }
+
+    size_t size = 0;
+    char* bundle = writer.Create(size);
+    if (!bundle) return QByteArray();
+    QByteArray result(bundle, static_cast<qsizetype>(size));
+    delete[] bundle;
+    return result;
+}
+
+} // namespace
+
+void OSCFrameBundler::setMaxBundleSize(int size)
+{
+    m_maxBundleSize = std::max(MIN_BUNDLE_SIZE, size);
+}
+
+void OSCFrameBundler::add(const QByteArray& packet, OSCRoutes::Mask routes)
+{
+    if (packet.isEmpty() || routes == 0) return;
+    m_packets.push_back(packet);
+    m_routes.push_back(routes);
+}
+
+std::vector<QByteArray> OSCFrameBundler::takeBundles(uint64_t timeTag)
+{
+    std::vector<QByteArray> bundles = packBundles(m_packets, timeTag);
+    clear();
+    return bundles;
+}
+
+std::vector<QByteArray> OSCFrameBundler::takePackets()
+{
+    std::vector<QByteArray> packets;
+    packets.swap(m_packets);
+    m_routes.clear();
+    return packets;
+}
+
+std::vector<OSCFrameBundler::RoutedDatagrams> OSCFrameBundler::takeRouted(bool bundle, uint64_t timeTag)
+{
+    std::vector<RoutedDatagrams> groups;
+    if (m_packets.empty()) return groups;
+
+    OSCRoutes::Mask used = 0;
+    bool sameRoutes = true;
+    for (OSCRoutes::Mask routes : m_routes) {
+        used |= routes;
+        sameRoutes = sameRoutes && routes == m_routes.front();
+    }
+
+    if (sameRoutes) {
+        // usual case, all packets go to the same destinations:
+        groups.push_back({ used, bundle ? packBundles(m_packets, timeTag) : m_packets });
+        clear();
+        return groups;
+    }
+
+    // destinations that receive exactly the same packets form a group,
+    // the first destination of a group represents it:
+    std::vector<int> firstDestinations;
+    for (int destination = 0; destination < OSCRoutes::MAX_DESTINATIONS; ++destination) {
+        if (!(used & OSCRoutes::forDestination(destination))) continue;
+        std::size_t group = 0;
+        for (; group < groups.size(); ++group) {
+            const int first = firstDestinations[group];
+            const bool samePackets = std::all_of(m_routes.begin(), m_routes.end(), [=](OSCRoutes::Mask routes) {
+                return ((routes >> destination) & 1u) == ((routes >> first) & 1u);
+            });
+            if (samePackets) break;
+        }
+        if (group == groups.size()) {
+            groups.emplace_back();
+            firstDestinations.push_back(destination);
+        }
+        groups[group].routes |= OSCRoutes::forDestination(destination);
+    }
+
+    for (std::size_t group = 0; group < groups.size(); ++group) {
+        const OSCRoutes::Mask first = OSCRoutes::forDestination(firstDestinations[group]);
+        std::vector<QByteArray> packets;
+        for (std::size_t i = 0; i < m_packets.size(); ++i) {
+            if (m_routes[i] & first) packets.push_back(m_packets[i]);
+        }
+        groups[group].datagrams = bundle ? packBundles(packets, timeTag) : std::move(packets);
+    }
+    clear();
+    return groups;
+}
+
+std::vector<QByteArray> OSCFrameBundler::packBundles(const std::vector<QByteArray>& packets, uint64_t timeTag) const
+{
+    std::vector<QByteArray> bundles;
+    std::size_t begin = 0;
+    qsizetype size = BUNDLE_HEADER_SIZE;
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        // each element is prefixed with its size:
+        const qsizetype elementSize = 4 + packets[i].size();
+        if (i > begin && size + elementSize > m_maxBundleSize) {
+            bundles.push_back(createBundle(packets, begin, i, timeTag));
+            begin = i;
+            size = BUNDLE_HEADER_SIZE;
+        }
+        size += elementSize;
+    }
+    if (begin < packets.size()) {
+        bundles.push_back(createBundle(packets, begin, packets.size(), timeTag));
+    }
+    return bundles;
+}
+
+QByteArray OSCFrameBundler::bundle(const QByteArray& packet, uint64_t timeTag)
+{
+    return createBundle({ packet }, 0, 1, timeTag);
+}
+
+uint64_t OSCFrameBundler::toTimeTag(std::chrono::system_clock::time_point time)
+{
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+    const uint64_t nanoseconds = static_cast<uint64_t>((sinceEpoch - seconds).count());
+    const uint64_t ntpSeconds = static_cast<uint64_t>(seconds.count()) + NTP_UNIX_OFFSET;
+    const uint64_t fraction = (nanoseconds << 32) / 1000000000ull;
+    return (ntpSeconds << 32) | fraction;
+}
+
+} // namespace sound2osc
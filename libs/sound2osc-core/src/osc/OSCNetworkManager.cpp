@@ -22,15 +22,11 @@
 
 #include <sound2osc/osc/OSCNetworkManager.h>
 
+#include <QThread>
 #include <QTime>
+#include <QtEndian>
 
-// http://www.rfc-editor.org/rfc/rfc1055.txt
-#define SLIP_END		0xc0    /* indicates end of packet */
-#define SLIP_ESC		0xdb    /* indicates byte stuffing */
-#define SLIP_ESC_END	0xdc    /* ESC ESC_END means END data byte */
-#define SLIP_ESC_ESC	0xdd    /* ESC ESC_ESC means ESC data byte */
-
-#define SLIP_CHAR(x)	static_cast<char>(static_cast<unsigned char>(x))
+#include <chrono>
 
 OSCNetworkManager::OSCNetworkManager()
 	: m_ipAddress(QHostAddress::LocalHost)
@@ -44,7 +40,26 @@ OSCNetworkManager::OSCNetworkManager()
 	, m_logIncomingMsg(true)
 	, m_logOutgoingMsg(true)
 	, m_eosUser("0")
-	, m_incompleteStreamData()
+	, m_streamDeframer(m_tcpFrameMode)
+	, m_bundleFrames(false)
+	, m_maxBundleSize(sound2osc::OSCFrameBundler::DEFAULT_MAX_BUNDLE_SIZE)
+	, m_frameThread(nullptr)
+	, m_frame()
+	, m_frameLog()
+	, m_frameUser()
+	, m_frameTime()
+	, m_frameBundled(false)
+	, m_udpBatchSender()
+	, m_destinations()
+	, m_destinationSockets()
+	, m_feedbackRoutes(sound2osc::OSCRoutes::PRIMARY)
+	, m_hasDestinations(false)
+	, m_sendTargets()
+	, m_workerSocket()
+	, m_workerBatchSender()
+	, m_workerDatagrams()
+	, m_workerLog()
+	, m_workerNotifyPending(false)
 {
 	// prepare timer that is used to try to connect again to TCP target:
 	m_tryConnectAgainTimer.setSingleShot(true);
@@ -59,6 +74,7 @@ OSCNetworkManager::OSCNetworkManager()
 	// try to connect:
 	reconnect();
 	updateUdpBinding();
+	updateSendTargets();
 }
 
 void OSCNetworkManager::setIpAddress(const QHostAddress &value)
@@ -68,6 +84,7 @@ void OSCNetworkManager::setIpAddress(const QHostAddress &value)
 	m_ipAddress = value;
 	reconnect();
 	updateUdpBinding();
+	updateSendTargets();
 	emit addressChanged();
 }
 
@@ -79,16 +96,71 @@ void OSCNetworkManager::setTcpPort(const quint16 &value)
 	emit addressChanged();
 }
 
-void OSCNetworkManager::sendMessage(QString messageString, bool forced)
+void OSCNetworkManager::setDestinations(const QList<sound2osc::OSCDestination>& destinations)
+{
+	// destination 0 is the primary destination:
+	const QList<sound2osc::OSCDestination> limited = destinations.mid(0, sound2osc::OSCRoutes::MAX_DESTINATIONS - 1);
+	if (limited == m_destinations) return;
+
+	m_destinations = limited;
+	m_destinationSockets.clear();
+	for (const sound2osc::OSCDestination& destination : m_destinations) {
+		std::unique_ptr<QTcpSocket> socket;
+		if (destination.enabled && destination.protocol != sound2osc::OSCDestination::Protocol::Udp) {
+			socket = std::make_unique<QTcpSocket>();
+			QTcpSocket* tcpSocket = socket.get();
+			const QHostAddress address = destination.address;
+			const quint16 port = destination.port;
+			// incoming data is only processed for the primary destination:
+			connect(tcpSocket, &QTcpSocket::readyRead, tcpSocket, [tcpSocket]() { tcpSocket->readAll(); });
+			// try to connect again after an error:
+			connect(tcpSocket, &QAbstractSocket::errorOccurred, tcpSocket, [tcpSocket, address, port]() {
+				QTimer::singleShot(TRY_CONNECT_AGAIN_TIME, tcpSocket, [tcpSocket, address, port]() {
+					if (tcpSocket->state() == QAbstractSocket::UnconnectedState) tcpSocket->connectToHost(address, port);
+				});
+			});
+			tcpSocket->connectToHost(address, port);
+		}
+		m_destinationSockets.push_back(std::move(socket));
+	}
+	m_hasDestinations = !m_destinations.isEmpty();
+	updateSendTargets();
+	emit addressChanged();
+}
+
+void OSCNetworkManager::sendMessageTo(sound2osc::OSCRoutes::Mask routes, QString messageString, bool forced)
 {
 	if (!m_isEnabled && !forced) return;
+	routes = resolveRoutes(routes, forced);
+
+	// messages of an analysis frame are collected and sent by endFrame():
+	if (isFrameOpen()) {
+		messageString.replace("<USER>", m_frameUser);
+		size_t outSize;
+		char* packet = OSCPacketWriter::CreateForString(messageString.toLatin1().data(), outSize);
+		if (packet) addToFrame(QByteArray(packet, static_cast<qsizetype>(outSize)), routes, "[Out] " + messageString);
+		delete[] packet;
+		return;
+	}
+
+	// the Qt sockets must only be used by the thread they belong to,
+	// other threads (i.e. the processing thread) send UDP datagrams themselves:
+	if (QThread::currentThread() != thread()) {
+		messageString.replace("<USER>", sendTargets()->eosUser);
+		size_t outSize;
+		char* packet = OSCPacketWriter::CreateForString(messageString.toLatin1().data(), outSize);
+		if (packet) sendPacketFromWorker(QByteArray(packet, static_cast<qsizetype>(outSize)), routes, "[Out] " + messageString);
+		delete[] packet;
+		return;
+	}
 
 	// replace <USER> with chosen user number, used for Eos messages
 	messageString.replace("<USER>", m_eosUser);
 
 	size_t outSize;
 	char* packet = OSCPacketWriter::CreateForString(messageString.toLatin1().data(), outSize);
-	sendMessageData(packet, outSize);
+	sendMessageData(packet, outSize, routes);
+	delete[] packet;
 
 	// Log if logging of outgoing messages is enabled:
 	if (m_logOutgoingMsg) {
@@ -96,9 +168,32 @@ void OSCNetworkManager::sendMessage(QString messageString, bool forced)
 	}
 }
 
-void OSCNetworkManager::sendMessage(QString path, QString argument, bool forced)
+void OSCNetworkManager::sendMessage(QString path, QString argument, bool forced, sound2osc::OSCRoutes::Mask routes)
 {
 	if (!m_isEnabled && !forced) return;
+	routes = resolveRoutes(routes, forced);
+
+	if (isFrameOpen()) {
+		path.replace("<USER>", m_frameUser);
+		size_t outSize;
+		OSCPacketWriter packetWriter(path.toStdString());
+		packetWriter.AddString(argument.toStdString());
+		char* packet = packetWriter.Create(outSize);
+		if (packet) addToFrame(QByteArray(packet, static_cast<qsizetype>(outSize)), routes, "[Out] " + path + "=" + argument);
+		delete[] packet;
+		return;
+	}
+
+	if (QThread::currentThread() != thread()) {
+		path.replace("<USER>", sendTargets()->eosUser);
+		size_t outSize;
+		OSCPacketWriter packetWriter(path.toStdString());
+		packetWriter.AddString(argument.toStdString());
+		char* packet = packetWriter.Create(outSize);
+		if (packet) sendPacketFromWorker(QByteArray(packet, static_cast<qsizetype>(outSize)), routes, "[Out] " + path + "=" + argument);
+		delete[] packet;
+		return;
+	}
 
 	// replace <USER> with chosen user number, used for Eos messages
 	path.replace("<USER>", m_eosUser);
@@ -107,7 +202,8 @@ void OSCNetworkManager::sendMessage(QString path, QString argument, bool forced)
 	OSCPacketWriter packetWriter(path.toStdString());
 	packetWriter.AddString(argument.toStdString());
 	char* packet = packetWriter.Create(outSize);
-	sendMessageData(packet, outSize);
+	sendMessageData(packet, outSize, routes);
+	delete[] packet;
 
 	// Log if logging of outgoing messages is enabled:
 	if (m_logOutgoingMsg) {
@@ -115,7 +211,81 @@ void OSCNetworkManager::sendMessage(QString path, QString argument, bool forced)
 	}
 }
 
-void OSCNetworkManager::sendMessageData(char* packet, size_t outSize)
+void OSCNetworkManager::sendMessage(const sound2osc::OSCPacketTemplate& message, double value, bool forced, sound2osc::OSCRoutes::Mask routes)
+{
+	if (!m_isEnabled && !forced) return;
+	if (message.isEmpty()) return;
+	routes = resolveRoutes(routes, forced);
+
+	if (isFrameOpen()) {
+		// the log text is only formatted if it is needed:
+		const QByteArray packet = message.create(m_frameUser, value);
+		if (!packet.isEmpty()) addToFrame(packet, routes, m_logOutgoingMsg ? "[Out] " + message.toString(m_frameUser, value) : QString());
+		return;
+	}
+
+	if (QThread::currentThread() != thread()) {
+		const QString user = sendTargets()->eosUser;
+		const QByteArray packet = message.create(user, value);
+		if (!packet.isEmpty()) sendPacketFromWorker(packet, routes, m_logOutgoingMsg ? "[Out] " + message.toString(user, value) : QString());
+		return;
+	}
+
+	// only the user and the value are patched into the encoded packet:
+	const QByteArray packet = message.create(m_eosUser, value);
+	if (packet.isEmpty()) return;
+	sendMessageData(packet.constData(), static_cast<size_t>(packet.size()), routes);
+
+	// Log if logging of outgoing messages is enabled:
+	if (m_logOutgoingMsg) {
+		addToLog("[Out] " + message.toString(m_eosUser, value));
+	}
+}
+
+sound2osc::OSCRoutes::Mask OSCNetworkManager::resolveRoutes(sound2osc::OSCRoutes::Mask routes, bool forced) const
+{
+	if (routes != sound2osc::OSCRoutes::DEFAULT) return routes;
+	// forced messages are the feedback of sound2osc (e.g. /sound2osc/out/bpm):
+	return forced ? m_feedbackRoutes.load() : sound2osc::OSCRoutes::PRIMARY;
+}
+
+void OSCNetworkManager::sendMessageData(const char* packet, size_t outSize, sound2osc::OSCRoutes::Mask routes)
+{
+	// the packet is encoded once and sent to all destinations of the routes:
+	const int destinationCount = static_cast<int>(m_destinations.size());
+	for (int index = 0; index <= destinationCount; ++index) {
+		if (routes & sound2osc::OSCRoutes::forDestination(index)) {
+			sendToDestination(index, packet, outSize);
+		}
+	}
+
+	emit packetSent();
+}
+
+void OSCNetworkManager::sendToDestination(int index, const char* packet, size_t outSize)
+{
+	if (index == 0) {
+		sendToPrimary(packet, outSize);
+		return;
+	}
+
+	const sound2osc::OSCDestination& destination = m_destinations[index - 1];
+	if (!destination.enabled) return;
+	if (destination.protocol == sound2osc::OSCDestination::Protocol::Udp) {
+		m_udpSocket.writeDatagram(packet, static_cast<qint64>(outSize), destination.address, destination.port);
+		return;
+	}
+
+	QTcpSocket* socket = m_destinationSockets[static_cast<size_t>(index - 1)].get();
+	if (!socket || socket->state() != QAbstractSocket::ConnectedState) return;
+	const OSCStream::EnumFrameMode frameMode = destination.protocol == sound2osc::OSCDestination::Protocol::Slip
+		? OSCStream::FRAME_MODE_1_1 : OSCStream::FRAME_MODE_1_0;
+	char* framedPacket = OSCStream::CreateFrame(frameMode, packet, outSize);
+	socket->write(framedPacket, static_cast<qint64>(outSize));
+	delete[] framedPacket;
+}
+
+void OSCNetworkManager::sendToPrimary(const char* packet, size_t outSize)
 {
 	// send packet either with UDP or TCP:
 	if (m_useTcp) {
@@ -131,14 +301,244 @@ void OSCNetworkManager::sendMessageData(char* packet, size_t outSize)
 		// use UDP:
 		m_udpSocket.writeDatagram(packet, outSize, m_ipAddress, m_udpTxPort);
 	}
+}
 
-	delete[] packet;
-	emit packetSent();
+void OSCNetworkManager::beginFrame()
+{
+	const std::shared_ptr<const SendTargets> targets = sendTargets();
+	const bool batchUdp = sound2osc::UdpBatchSender::isSupported() && (!targets->useTcp || !targets->destinations.isEmpty());
+	if ((!m_bundleFrames && !batchUdp) || isFrameOpen()) return;
+
+	m_frameBundled = m_bundleFrames;
+
+	m_frameUser = targets->eosUser;
+	m_frameTime = std::chrono::system_clock::now();
+	m_frame.setMaxBundleSize(m_maxBundleSize);
+	m_frameThread = QThread::currentThread();
+}
+
+void OSCNetworkManager::endFrame()
+{
+	if (!isFrameOpen()) return;
+	m_frameThread = nullptr;
+
+	QStringList log;
+	log.swap(m_frameLog);
+	// the packets (or bundles) are created once for all destinations that receive the same messages:
+	const uint64_t timeTag = sound2osc::OSCFrameBundler::toTimeTag(m_frameTime);
+	const std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams> groups = m_frame.takeRouted(m_frameBundled, timeTag);
+	if (groups.empty()) return;
+
+	// the frame is sent by the calling thread, also if it is not the owner thread:
+	if (QThread::currentThread() != thread()) {
+		sendFrameFromWorker(groups, log);
+		return;
+	}
+	sendFrame(groups, log);
+}
+
+bool OSCNetworkManager::isFrameOpen() const
+{
+	return m_frameThread.load() == QThread::currentThread();
+}
+
+bool OSCNetworkManager::isFrameTimeTagged() const
+{
+	return isFrameOpen() && m_frameBundled;
+}
+
+void OSCNetworkManager::sendMessageAt(double delay, const sound2osc::OSCPacketTemplate& message, double value, sound2osc::OSCRoutes::Mask routes)
+{
+	if (!isFrameTimeTagged()) {
+		sendMessage(message, value, false, routes);
+		return;
+	}
+	if (!m_isEnabled || message.isEmpty()) return;
+
+	const QByteArray packet = message.create(m_frameUser, value);
+	if (packet.isEmpty()) return;
+	// the time tag of a bundle within a bundle must not be earlier than the outer one:
+	const std::chrono::system_clock::time_point time = m_frameTime
+		+ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(qMax(0.0, delay)));
+	addToFrame(sound2osc::OSCFrameBundler::bundle(packet, sound2osc::OSCFrameBundler::toTimeTag(time)), resolveRoutes(routes, false),
+			   m_logOutgoingMsg ? "[Out] " + message.toString(m_frameUser, value) : QString());
+}
+
+void OSCNetworkManager::addToFrame(const QByteArray& packet, sound2osc::OSCRoutes::Mask routes, const QString& logText)
+{
+	m_frame.add(packet, routes);
+	if (m_logOutgoingMsg && !logText.isEmpty()) {
+		m_frameLog.append(logText);
+	}
+}
+
+void OSCNetworkManager::sendFrame(const std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams>& groups, const QStringList& log)
+{
+	const int destinationCount = static_cast<int>(m_destinations.size());
+	for (const sound2osc::OSCFrameBundler::RoutedDatagrams& group : groups) {
+		for (int index = 0; index <= destinationCount; ++index) {
+			if (group.routes & sound2osc::OSCRoutes::forDestination(index)) {
+				sendFrameToDestination(index, group.datagrams);
+			}
+		}
+		for (size_t i = 0; i < group.datagrams.size(); ++i) {
+			emit packetSent();
+		}
+	}
+
+	// Log if logging of outgoing messages is enabled:
+	for (const QString& text : log) {
+		addToLog(text);
+	}
+}
+
+void OSCNetworkManager::sendFrameToDestination(int index, const std::vector<QByteArray>& datagrams)
+{
+	// with UDP all datagrams are sent with one system call if supported:
+	size_t sent = 0;
+	if (index == 0) {
+		if (!m_useTcp) {
+			sent = static_cast<size_t>(m_udpBatchSender.send(m_udpSocket.socketDescriptor(), m_ipAddress, m_udpTxPort, datagrams));
+		}
+	} else {
+		const sound2osc::OSCDestination& destination = m_destinations[index - 1];
+		if (!destination.enabled) return;
+		if (destination.protocol == sound2osc::OSCDestination::Protocol::Udp) {
+			sent = static_cast<size_t>(m_udpBatchSender.send(m_udpSocket.socketDescriptor(), destination.address, destination.port, datagrams));
+		}
+	}
+
+	// the rest (or all with TCP) is sent one by one:
+	for (size_t i = sent; i < datagrams.size(); ++i) {
+		sendToDestination(index, datagrams[i].constData(), static_cast<size_t>(datagrams[i].size()));
+	}
+}
+
+void OSCNetworkManager::updateSendTargets()
+{
+	auto targets = std::make_shared<SendTargets>();
+	targets->address = m_ipAddress;
+	targets->udpTxPort = m_udpTxPort;
+	targets->useTcp = m_useTcp;
+	targets->eosUser = m_eosUser;
+	targets->destinations = m_destinations;
+
+	QMutexLocker locker(&m_sendTargetsMutex);
+	m_sendTargets = std::move(targets);
+}
+
+std::shared_ptr<const OSCNetworkManager::SendTargets> OSCNetworkManager::sendTargets() const
+{
+	// only the pointer is copied under the lock:
+	QMutexLocker locker(&m_sendTargetsMutex);
+	return m_sendTargets;
+}
+
+void OSCNetworkManager::sendPacketFromWorker(const QByteArray& packet, sound2osc::OSCRoutes::Mask routes, const QString& logText)
+{
+	sound2osc::OSCRoutes::Mask ownerRoutes = 0;
+	{
+		QMutexLocker locker(&m_workerMutex);
+		m_workerDatagrams.assign(1, packet);
+		ownerRoutes = sendFromWorker(m_workerDatagrams, routes);
+		m_workerDatagrams.clear();
+	}
+	if (ownerRoutes) {
+		QMetaObject::invokeMethod(this, [this, packet, ownerRoutes]() {
+			sendMessageData(packet.constData(), static_cast<size_t>(packet.size()), ownerRoutes);
+		}, Qt::QueuedConnection);
+	}
+
+	QStringList log;
+	if (!logText.isEmpty()) log.append(logText);
+	notifyOwner(log);
+}
+
+void OSCNetworkManager::sendFrameFromWorker(const std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams>& groups, const QStringList& log)
+{
+	std::vector<sound2osc::OSCFrameBundler::RoutedDatagrams> ownerGroups;
+	{
+		QMutexLocker locker(&m_workerMutex);
+		for (const sound2osc::OSCFrameBundler::RoutedDatagrams& group : groups) {
+			const sound2osc::OSCRoutes::Mask ownerRoutes = sendFromWorker(group.datagrams, group.routes);
+			if (ownerRoutes) ownerGroups.push_back({ ownerRoutes, group.datagrams });
+		}
+	}
+	if (!ownerGroups.empty()) {
+		QMetaObject::invokeMethod(this, [this, ownerGroups]() {
+			sendFrame(ownerGroups, QStringList());
+		}, Qt::QueuedConnection);
+	}
+	notifyOwner(log);
+}
+
+sound2osc::OSCRoutes::Mask OSCNetworkManager::sendFromWorker(const std::vector<QByteArray>& datagrams, sound2osc::OSCRoutes::Mask routes)
+{
+	// without a socket of its own everything is sent by the owner thread:
+	if (!m_workerSocket.open()) return routes;
+
+	const std::shared_ptr<const SendTargets> targets = sendTargets();
+	sound2osc::OSCRoutes::Mask ownerRoutes = 0;
+	const int destinationCount = static_cast<int>(targets->destinations.size());
+	for (int index = 0; index <= destinationCount; ++index) {
+		const sound2osc::OSCRoutes::Mask route = sound2osc::OSCRoutes::forDestination(index);
+		if (!(routes & route)) continue;
+
+		const QHostAddress* address = &targets->address;
+		quint16 port = targets->udpTxPort;
+		if (index == 0) {
+			if (targets->useTcp) {
+				ownerRoutes |= route;
+				continue;
+			}
+		} else {
+			const sound2osc::OSCDestination& destination = targets->destinations[index - 1];
+			if (!destination.enabled) continue;
+			if (destination.protocol != sound2osc::OSCDestination::Protocol::Udp) {
+				ownerRoutes |= route;
+				continue;
+			}
+			address = &destination.address;
+			port = destination.port;
+		}
+
+		// all datagrams with one system call if supported, the rest one by one:
+		const size_t sent = static_cast<size_t>(m_workerBatchSender.send(m_workerSocket.descriptor(), *address, port, datagrams));
+		for (size_t i = sent; i < datagrams.size(); ++i) {
+			m_workerSocket.send(*address, port, datagrams[i].constData(), static_cast<size_t>(datagrams[i].size()));
+		}
+	}
+	return ownerRoutes;
+}
+
+void OSCNetworkManager::notifyOwner(const QStringList& log)
+{
+	if (m_logOutgoingMsg && !log.isEmpty()) {
+		QMutexLocker locker(&m_workerMutex);
+		m_workerLog.append(log);
+		// the owner thread may be blocked, the log doesn't grow beyond its length:
+		while (m_workerLog.size() > MAX_LOG_LENGTH) m_workerLog.removeFirst();
+	}
+
+	if (m_workerNotifyPending.exchange(true)) return;
+	QMetaObject::invokeMethod(this, [this]() {
+		m_workerNotifyPending = false;
+		QStringList pendingLog;
+		{
+			QMutexLocker locker(&m_workerMutex);
+			pendingLog.swap(m_workerLog);
+		}
+		for (const QString& text : pendingLog) {
+			addToLog(text);
+		}
+		emit packetSent();
+	}, Qt::QueuedConnection);
 }
 
 void OSCNetworkManager::setUseTcp(bool value)
 {
 	m_useTcp = value;
+	updateSendTargets();
 
 	// try to connect:
 	m_tryConnectAgainTimer.stop();
@@ -158,6 +558,7 @@ bool OSCNetworkManager::getUseOsc_1_1() const
 void OSCNetworkManager::setUseOsc_1_1(bool value)
 {
 	m_tcpFrameMode = value ? OSCStream::FRAME_MODE_1_1 : OSCStream::FRAME_MODE_1_0;
+	m_streamDeframer.setFrameMode(m_tcpFrameMode);
 }
 
 void OSCNetworkManager::reconnect()
@@ -182,100 +583,8 @@ void OSCNetworkManager::updateUdpBinding()
 		m_udpSocket.close();
 		m_udpSocket.bind(m_udpRxPort);
 	}
-}
-
-QByteArray OSCNetworkManager::popPacketFromStreamData(QByteArray& data) const
-{
-	if (m_tcpFrameMode == OSCStream::FRAME_MODE_1_0) {
-		return popPacketLengthFramedPacketFromStreamData(data);
-	} else {
-		return popSlipFramedPacketFromStreamData(data);
-	}
-}
-
-QByteArray OSCNetworkManager::popPacketLengthFramedPacketFromStreamData(QByteArray& tcpData) const
-{
-	// the first 4 bytes are the length of the OSC message following as an int32:
-	int32_t messageLength = reinterpret_cast<int32_t*>(tcpData.data())[0];
-	// adjust the network byte order (?):
-	OSCArgument::Swap32(&messageLength);
-
-	// check if the messageLength is in the range of a valid message:
-	if (messageLength <= 0 || messageLength > 512) {
-		// this is not a valid OSC message
-		// received data will be discarded:
-		addToLog("[In] Invalid data received (message length in TCP packet is out of range). Check Protocol Settings.");
-		tcpData.resize(0);
-		return QByteArray();
-	}
-
-	// check if the message is completely received:
-	if (messageLength > tcpData.size()) {
-		// the message length is greater than the size of the data received
-		// so there is nothing to pop / return yet:
-		return QByteArray();
-	}
-
-	// create a new QByteArray containing only the OSC message data:
-	QByteArray messageData = QByteArray(tcpData.data() + sizeof(messageLength), messageLength);
-	// remove the messageLength and the message data from the received data:
-	tcpData.remove(0, messageLength + sizeof(messageLength));
-
-	return messageData;
-}
-
-QByteArray OSCNetworkManager::popSlipFramedPacketFromStreamData(QByteArray& tcpData) const
-{
-	// A SLIP framed packet begins and ends with a SLIP END character.
-
-	// find first SLIP END character:
-	// most probably it is the first character:
-	int firstSlipEndPosition = 0;
-	if (tcpData[0] != SLIP_CHAR(SLIP_END)) {
-		for (int i=1; i<tcpData.size(); ++i) {
-			if (tcpData[i] == SLIP_CHAR(SLIP_END)) {
-				firstSlipEndPosition = i;
-				break;
-			}
-		}
-		if (firstSlipEndPosition == 0) {
-			// if first slip end postion is still 0,
-			// this means there is no SLIP END character in the data
-			// -> discard the data and return nothing:
-			addToLog("[In] Invalid data received (missing SLIP END character). Check Protocol Settings.");
-			tcpData.resize(0);
-			return QByteArray();
-		}
-	}
-
-	// find second SLIP END character:
-	int secondSlipEndPosition = -1;
-	for (int i=firstSlipEndPosition+1; i<tcpData.size(); ++i) {
-		if (tcpData[i] == SLIP_CHAR(SLIP_END)) {
-			secondSlipEndPosition = i;
-			break;
-		}
-	}
-	if (secondSlipEndPosition < 0) {
-		// there is no second SLIP END character
-		// -> message is not yet complete:
-		return QByteArray();
-	}
-
-	// at this point we should have found two SLIP END characters
-	Q_ASSERT(secondSlipEndPosition > firstSlipEndPosition);
-
-	int messageLength = secondSlipEndPosition - firstSlipEndPosition - 1;
-	// create a new QByteArray containing only the OSC message data:
-	QByteArray messageData = QByteArray(tcpData.data() + firstSlipEndPosition + 1, messageLength);
-	// remove everything before the second SLIP END from the received data:
-	tcpData.remove(0, secondSlipEndPosition + 1);
-
-	// replace characters that have been escaped because of SLIP framing:
-	messageData.replace(SLIP_CHAR(SLIP_ESC) + SLIP_CHAR(SLIP_ESC_END), SLIP_CHAR(SLIP_END));
-	messageData.replace(SLIP_CHAR(SLIP_ESC) + SLIP_CHAR(SLIP_ESC_ESC), SLIP_CHAR(SLIP_ESC));
-
-	return messageData;
+	// the socket descriptor may have changed:
+	m_udpBatchSender.reset();
 }
 
 void OSCNetworkManager::addToLog(QString text) const
@@ -297,6 +606,8 @@ void OSCNetworkManager::tryToConnectTCP()
 
 void OSCNetworkManager::onConnected()
 {
+	// a new stream begins:
+	m_streamDeframer.clear();
 	emit isConnectedChanged();
 }
 
@@ -340,46 +651,56 @@ void OSCNetworkManager::readIncomingUdpDatagrams()
 
 void OSCNetworkManager::readIncomingTcpStream()
 {
-	QByteArray streamData = m_tcpSocket.readAll();
-
-	// check if there is incomplete stream data left from last call:
-	if (!m_incompleteStreamData.isEmpty()) {
-		streamData = m_incompleteStreamData + streamData;
+	// append the received data to the data left from the last call:
+	if (!m_streamDeframer.readFrom(m_tcpSocket)) {
+		addToLog("[In] Invalid data received (too much data without a complete packet). Check Protocol Settings.");
+		return;
 	}
 
-	// as long as there is stream data left:
-	while (streamData.size()) {
-		// try to get a complete packet from the stream data:
-		QByteArray packet = popPacketFromStreamData(streamData);
-
-		if (packet.isEmpty()) {
-			// there is no more complete packet
-			// but maybe there is incomplete packet data left:
-			m_incompleteStreamData = streamData;
+	// as long as there are complete packets in the stream data:
+	QByteArray packet;
+	for (;;) {
+		const sound2osc::OSCStreamDeframer::Result result = m_streamDeframer.next(packet);
+		if (result == sound2osc::OSCStreamDeframer::Result::Packet) {
+			// the packet refers to the stream data and is valid until the next read:
+			processIncomingRawData(packet);
+		} else if (result == sound2osc::OSCStreamDeframer::Result::Invalid) {
+			// the received data was discarded:
+			if (m_tcpFrameMode == OSCStream::FRAME_MODE_1_0) {
+				addToLog("[In] Invalid data received (message length in TCP packet is out of range). Check Protocol Settings.");
+			} else {
+				addToLog("[In] Invalid data received (missing SLIP END character). Check Protocol Settings.");
+			}
+			return;
+		} else {
+			// there is no more complete packet,
+			// the rest of the data is kept for the next call:
 			return;
 		}
-
-		processIncomingRawData(packet);
 	}
 }
 
-void OSCNetworkManager::processIncomingRawData(QByteArray msgData)
+void OSCNetworkManager::processIncomingRawData(const QByteArray& msgData)
 {
 	// check if the data is a single message or a bundle of messages:
-	if (msgData[0] == '/') {
+	if (msgData.startsWith('/')) {
 		// it starts with a "/" -> it is a single message:
 		processIncomingRawMessage(msgData);
 	} else if (msgData.startsWith("#bundle")) {
-		// it starts with "#bundle" -> it is a bundle
-		// remove "#bundle" string (8 bytes) and unused timetag (8 bytes):
-		msgData.remove(0, 16);
-		// try to get all messages in the bundle:
-		while (msgData.size()) {
-			// each message starts with the length of the message as int32
-			// this is the same as a TCP 1.0 packet, so the function for that can be used:
-			QByteArray message = popPacketLengthFramedPacketFromStreamData(msgData);
-			// process the message:
-			processIncomingRawMessage(message);
+		// it is a bundle
+		// skip "#bundle" string (8 bytes) and unused timetag (8 bytes):
+		qsizetype position = 16;
+		// each message starts with the length of the message as int32:
+		while (position + 4 <= msgData.size()) {
+			const qint32 messageLength = qFromBigEndian<qint32>(msgData.constData() + position);
+			position += 4;
+			if (messageLength <= 0 || messageLength > msgData.size() - position) {
+				addToLog("[In] Invalid data received (message length in OSC bundle is out of range).");
+				return;
+			}
+			// process the message (without copying it):
+			processIncomingRawMessage(QByteArray::fromRawData(msgData.constData() + position, messageLength));
+			position += messageLength;
 		}
 	} else {
 		// invalid data
@@ -387,7 +708,7 @@ void OSCNetworkManager::processIncomingRawData(QByteArray msgData)
 	}
 }
 
-void OSCNetworkManager::processIncomingRawMessage(QByteArray msgData)
+void OSCNetworkManager::processIncomingRawMessage(const QByteArray& msgData)
 {
 	// build an OSC message from the data:
 	OSCMessage msg(msgData);
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/OSCPacketTemplate.h>
+
+#include <sound2osc/osc/OSCParser.h>
+
+#include <QtEndian>
+
+#include <cmath>
+#include <memory>
+
+namespace sound2osc {
+
+namespace {
+
+constexpr char USER_PLACEHOLDER[] = "<USER>";
+
+int alignedSize(int size)
+{
+    return (size + 3) & ~3;
+}
+
+qint32 toInt32(double value)
+{
+    return static_cast<qint32>(std::lround(qBound(-2147483648.0, value, 2147483647.0)));
+}
+
+// encodes the text form, level messages get a value argument that is patched later
+QByteArray encode(const QString& text, bool hasValue, OSCPacketTemplate::ValueType valueType)
+{
+    const QByteArray latin1 = text.toLatin1();
+    std::unique_ptr<OSCPacketWriter> writer(OSCPacketWriter::CreatePacketWriterForString(latin1.constData()));
+    if (!writer) return QByteArray();
+    if (hasValue) {
+        if (valueType == OSCPacketTemplate::ValueType::Int) {
+            writer->AddInt32(0);
+        } else {
+            writer->AddFloat32(0.0f);
+        }
+    }
+
+    size_t size = 0;
+    char* packet = writer->Create(size);
+    if (!packet) return QByteArray();
+    QByteArray result(packet, static_cast<qsizetype>(size));
+    delete[] packet;
+    return result;
+}
+
+// writes the value to the last argument of the packet (4 bytes for all value types)
+void patchValue(QByteArray& packet, OSCPacketTemplate::ValueType valueType, double value)
+{
+    char* argument = packet.data() + packet.size() - 4;
+    switch (valueType) {
+    case OSCPacketTemplate::ValueType::Rounded:
+        // same precision as the text form "/path=0.123":
+        qToBigEndian(static_cast<float>(std::round(value * 1000.0) / 1000.0), argument);
+        break;
+    case OSCPacketTemplate::ValueType::Float:
+        qToBigEndian(static_cast<float>(value), argument);
+        break;
+    case OSCPacketTemplate::ValueType::Int:
+        qToBigEndian(toInt32(value), argument);
+        break;
+    }
+}
+
+} // namespace
+
+OSCPacketTemplate::OSCPacketTemplate(const QString& message, ValueType valueType)
+    : m_message(message)
+    , m_valueType(valueType)
+    , m_hasValue(message.endsWith('=') || (message.endsWith(',') && message.contains('=')))
+{
+    const QByteArray packet = encode(message, m_hasValue, m_valueType);
+    if (packet.isEmpty()) return;
+
+    // the path is the first zero terminated string of the packet:
+    const int pathSize = static_cast<int>(qstrnlen(packet.constData(), static_cast<size_t>(packet.size())));
+    const qsizetype usersInPath = QByteArray::fromRawData(packet.constData(), pathSize).count(USER_PLACEHOLDER);
+    if (usersInPath != message.count(USER_PLACEHOLDER)) {
+        // "<USER>" in an argument, the size of the argument depends on the user:
+        return;
+    }
+
+    m_packet = packet;
+    m_pathSize = pathSize;
+    m_userInPath = usersInPath > 0;
+}
+
+QByteArray OSCPacketTemplate::create(const QString& user, double value) const
+{
+    QByteArray packet;
+    if (m_packet.isEmpty()) {
+        if (isEmpty()) return packet;
+        QString text = m_message;
+        text.replace(USER_PLACEHOLDER, user);
+        packet = encode(text, m_hasValue, m_valueType);
+        if (packet.isEmpty()) return packet;
+    } else if (m_userInPath) {
+        // replace the user in the path and pad it to 4 bytes again:
+        QByteArray path = m_packet.left(m_pathSize);
+        path.replace(USER_PLACEHOLDER, user.toLatin1());
+        const int argumentsStart = alignedSize(m_pathSize + 1);
+        const int pathEnd = alignedSize(static_cast<int>(path.size()) + 1);
+        packet.reserve(pathEnd + m_packet.size() - argumentsStart);
+        packet.append(path);
+        packet.append(pathEnd - static_cast<int>(path.size()), '\0');
+        packet.append(m_packet.constData() + argumentsStart, m_packet.size() - argumentsStart);
+    } else {
+        packet = m_packet;
+    }
+
+    if (m_hasValue) patchValue(packet, m_valueType, value);
+    return packet;
+}
+
+QString OSCPacketTemplate::toString(const QString& user, double value) const
+{
+    QString text = m_message;
+    if (m_hasValue) {
+        switch (m_valueType) {
+        case ValueType::Rounded:
+            text += QString::number(value, 'f', 3);
+            break;
+        case ValueType::Float:
+            text += QString::number(value, 'g', 7);
+            break;
+        case ValueType::Int:
+            text += QString::number(toInt32(value));
+            break;
+        }
+    }
+    text.replace(USER_PLACEHOLDER, user);
+    return text;
+}
+
+QString OSCPacketTemplate::valueTypeName(ValueType valueType)
+{
+    switch (valueType) {
+    case ValueType::Float: return "float";
+    case ValueType::Int: return "int";
+    case ValueType::Rounded: break;
+    }
+    return "rounded";
+}
+
+OSCPacketTemplate::ValueType OSCPacketTemplate::valueTypeFromName(const QString& name)
+{
+    if (name == "float") return ValueType::Float;
+    if (name == "int") return ValueType::Int;
+    return ValueType::Rounded;
+}
+
+} // namespace sound2osc
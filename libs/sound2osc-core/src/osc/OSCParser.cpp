@@ -2089,6 +2089,7 @@ void OSCPacketWriter::MakeListPath(size_t index, size_t total, std::string &path
 ////////////////////////////////////////////////////////////////////////////////
 
 OSCBundleWriter::OSCBundleWriter()
+	: m_TimeTag(0)
 {
 }
 
@@ -2140,7 +2141,8 @@ bool OSCBundleWriter::Write(char *buf, size_t size) const
 			// OSC bundle time-tag
 			if(size >= 8)
 			{
-				memset(buf, 0, 8);
+				memcpy(buf, &m_TimeTag, 8);
+				OSCArgument::Swap64(buf);
 				buf += 8;
 				size -= 8;
 
@@ -2207,6 +2209,31 @@ void OSCBundleWriter::AddPacket(OSCPacketElement *packet)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+OSCRawPacket::OSCRawPacket(const char *data, size_t size)
+	: m_Data(data ? std::string(data,size) : std::string())
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t OSCRawPacket::ComputeSize() const
+{
+	return m_Data.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCRawPacket::Write(char *buf, size_t size) const
+{
+	if(!buf || size<m_Data.size())
+		return false;
+
+	memcpy(buf, m_Data.data(), m_Data.size());
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 OSCMethod::OSCMethod()
 {
 }
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/OSCStreamDeframer.h>
+
+#include <QIODevice>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sound2osc {
+
+namespace {
+
+// http://www.rfc-editor.org/rfc/rfc1055.txt
+constexpr char SLIP_END = static_cast<char>(0xc0);  // indicates end of packet
+constexpr char SLIP_ESC = static_cast<char>(0xdb);  // indicates byte stuffing
+constexpr char SLIP_ESC_END = static_cast<char>(0xdc);  // ESC ESC_END means END data byte
+constexpr char SLIP_ESC_ESC = static_cast<char>(0xdd);  // ESC ESC_ESC means ESC data byte
+
+constexpr qsizetype SIZE_HEADER = 4;  // int32 size of OSC 1.0 packets
+
+} // namespace
+
+OSCStreamDeframer::OSCStreamDeframer(OSCStream::EnumFrameMode frameMode)
+    : m_frameMode(frameMode)
+    , m_buffer()
+    , m_begin(0)
+    , m_end(0)
+    , m_decoded(0)
+    , m_scanned(0)
+    , m_escape(false)
+{
+}
+
+void OSCStreamDeframer::setFrameMode(OSCStream::EnumFrameMode frameMode)
+{
+    m_frameMode = frameMode;
+    clear();
+}
+
+void OSCStreamDeframer::clear()
+{
+    m_begin = 0;
+    m_end = 0;
+    m_decoded = 0;
+    m_scanned = 0;
+    m_escape = false;
+}
+
+char* OSCStreamDeframer::reserve(qsizetype size)
+{
+    if (m_begin == m_end) {
+        // everything was returned, start at the front again:
+        m_begin = 0;
+        m_end = 0;
+        m_decoded = 0;
+        m_scanned = 0;
+    }
+
+    const qsizetype capacity = static_cast<qsizetype>(m_buffer.size());
+    if (capacity - m_end < size) {
+        // move the rest that was not returned yet to the front:
+        if (m_begin > 0) {
+            std::memmove(m_buffer.data(), m_buffer.data() + m_begin, static_cast<std::size_t>(m_end - m_begin));
+            m_end -= m_begin;
+            m_decoded -= m_begin;
+            m_scanned -= m_begin;
+            m_begin = 0;
+        }
+        if (capacity - m_end < size) {
+            m_buffer.resize(static_cast<std::size_t>(std::max(m_end + size, 2 * capacity)));
+        }
+    }
+    return m_buffer.data() + m_end;
+}
+
+bool OSCStreamDeframer::append(const char* data, qsizetype size)
+{
+    if (!data || size <= 0) return true;
+    if (bufferedSize() + size > OSCStream::MAX_BUF_SIZE) {
+        clear();
+        return false;
+    }
+    std::memcpy(reserve(size), data, static_cast<std::size_t>(size));
+    m_end += size;
+    return true;
+}
+
+bool OSCStreamDeframer::readFrom(QIODevice& device)
+{
+    const qint64 available = device.bytesAvailable();
+    if (available <= 0) return true;
+    if (bufferedSize() + available > OSCStream::MAX_BUF_SIZE) {
+        device.skip(available);
+        clear();
+        return false;
+    }
+    const qint64 read = device.read(reserve(available), available);
+    if (read < 0) return false;
+    m_end += read;
+    return true;
+}
+
+OSCStreamDeframer::Result OSCStreamDeframer::next(QByteArray& packet)
+{
+    if (m_frameMode == OSCStream::FRAME_MODE_1_1) {
+        return nextSlipFramed(packet);
+    }
+    return nextLengthFramed(packet);
+}
+
+OSCStreamDeframer::Result OSCStreamDeframer::nextLengthFramed(QByteArray& packet)
+{
+    // the first 4 bytes are the size of the packet following as a big endian int32:
+    if (m_end - m_begin < SIZE_HEADER) return Result::Incomplete;
+    const char* data = m_buffer.data() + m_begin;
+    const qint32 size = qFromBigEndian<qint32>(data);
+    if (size <= 0 || size > OSCStream::MAX_FRAME_SIZE) {
+        clear();
+        return Result::Invalid;
+    }
+    if (m_end - m_begin - SIZE_HEADER < size) return Result::Incomplete;
+
+    packet = QByteArray::fromRawData(data + SIZE_HEADER, size);
+    m_begin += SIZE_HEADER + size;
+    return Result::Packet;
+}
+
+OSCStreamDeframer::Result OSCStreamDeframer::nextSlipFramed(QByteArray& packet)
+{
+    char* data = m_buffer.data();
+
+    // decodes the escapes in place, m_decoded equals m_scanned until the first escape:
+    while (m_scanned < m_end) {
+        const char c = data[m_scanned++];
+        if (m_escape) {
+            m_escape = false;
+            if (c == SLIP_ESC_END) {
+                data[m_decoded++] = SLIP_END;
+            } else if (c == SLIP_ESC_ESC) {
+                data[m_decoded++] = SLIP_ESC;
+            } else {
+                data[m_decoded++] = c;
+            }
+        } else if (c == SLIP_ESC) {
+            m_escape = true;
+        } else if (c == SLIP_END) {
+            // the END of a packet is also the begin of the next one
+            // (single-ended SLIP without a leading END is accepted, see RFC 1055):
+            const qsizetype begin = m_begin;
+            const qsizetype size = m_decoded - m_begin;
+            m_begin = m_scanned;
+            m_decoded = m_scanned;
+            if (size == 0) continue;  // two END characters in a row
+            packet = QByteArray::fromRawData(data + begin, size);
+            return Result::Packet;
+        } else {
+            data[m_decoded++] = c;
+        }
+    }
+    return Result::Incomplete;
+}
+
+} // namespace sound2osc
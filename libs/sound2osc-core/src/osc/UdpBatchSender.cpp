@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/UdpBatchSender.h>
+
+#include <QtEndian>
+
+#include <algorithm>
+
+#ifdef SOUND2OSC_HAVE_SENDMMSG
+#include <cerrno>
+#include <cstring>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace sound2osc {
+
+#ifdef SOUND2OSC_HAVE_SENDMMSG
+
+namespace {
+
+// the kernel accepts at most UIO_MAXIOV messages per call
+constexpr std::size_t MAX_MESSAGES_PER_CALL = 1024;
+
+} // namespace
+
+struct UdpBatchSender::Batch
+{
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+    sockaddr_storage destination;
+    socklen_t destinationSize = 0;
+
+    // address family of the last socket, queried once per socket:
+    qintptr socketDescriptor = -1;
+    int family = AF_UNSPEC;
+
+    bool updateDestination(qintptr descriptor, const QHostAddress& host, quint16 port);
+};
+
+bool UdpBatchSender::Batch::updateDestination(qintptr descriptor, const QHostAddress& host, quint16 port)
+{
+    if (descriptor != socketDescriptor) {
+        sockaddr_storage local;
+        socklen_t localSize = sizeof(local);
+        if (getsockname(static_cast<int>(descriptor), reinterpret_cast<sockaddr*>(&local), &localSize) != 0) return false;
+        socketDescriptor = descriptor;
+        family = local.ss_family;
+    }
+
+    std::memset(&destination, 0, sizeof(destination));
+    destinationSize = 0;
+    if (family == AF_INET) {
+        bool isIPv4 = false;
+        const quint32 ipv4 = host.toIPv4Address(&isIPv4);
+        if (!isIPv4) return false;
+        sockaddr_in* target = reinterpret_cast<sockaddr_in*>(&destination);
+        target->sin_family = AF_INET;
+        target->sin_port = qToBigEndian(port);
+        target->sin_addr.s_addr = qToBigEndian(ipv4);
+        destinationSize = sizeof(sockaddr_in);
+    } else if (family == AF_INET6) {
+        // the dual stack socket of QUdpSocket::bind(port) reaches IPv4 hosts by their mapped address:
+        const Q_IPV6ADDR ipv6 = host.toIPv6Address();
+        sockaddr_in6* target = reinterpret_cast<sockaddr_in6*>(&destination);
+        target->sin6_family = AF_INET6;
+        target->sin6_port = qToBigEndian(port);
+        std::memcpy(&target->sin6_addr, &ipv6, sizeof(target->sin6_addr));
+        destinationSize = sizeof(sockaddr_in6);
+    }
+    return destinationSize > 0;
+}
+
+UdpBatchSender::UdpBatchSender()
+    : m_batch(std::make_unique<Batch>())
+{
+}
+
+bool UdpBatchSender::isSupported()
+{
+    return true;
+}
+
+int UdpBatchSender::send(qintptr socketDescriptor, const QHostAddress& address, quint16 port,
+                         const std::vector<QByteArray>& datagrams)
+{
+    if (socketDescriptor < 0 || datagrams.empty()) return 0;
+    Batch& batch = *m_batch;
+    if (!batch.updateDestination(socketDescriptor, address, port)) return 0;
+
+    const std::size_t count = datagrams.size();
+    batch.messages.resize(count);
+    batch.vectors.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        iovec& vector = batch.vectors[i];
+        vector.iov_base = const_cast<char*>(datagrams[i].constData());
+        vector.iov_len = static_cast<std::size_t>(datagrams[i].size());
+
+        mmsghdr& message = batch.messages[i];
+        std::memset(&message, 0, sizeof(message));
+        message.msg_hdr.msg_name = &batch.destination;
+        message.msg_hdr.msg_namelen = batch.destinationSize;
+        message.msg_hdr.msg_iov = &vector;
+        message.msg_hdr.msg_iovlen = 1;
+    }
+
+    // usually all datagrams are accepted at once, the kernel may stop early:
+    std::size_t sent = 0;
+    while (sent < count) {
+        const std::size_t chunk = std::min(count - sent, MAX_MESSAGES_PER_CALL);
+        ++m_systemCalls;
+        const int result = sendmmsg(static_cast<int>(socketDescriptor), batch.messages.data() + sent,
+                                    static_cast<unsigned int>(chunk), 0);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (result == 0) break;
+        sent += static_cast<std::size_t>(result);
+    }
+    return static_cast<int>(sent);
+}
+
+void UdpBatchSender::reset()
+{
+    m_batch->socketDescriptor = -1;
+}
+
+#else // SOUND2OSC_HAVE_SENDMMSG
+
+struct UdpBatchSender::Batch
+{
+};
+
+UdpBatchSender::UdpBatchSender()
+{
+}
+
+bool UdpBatchSender::isSupported()
+{
+    return false;
+}
+
+int UdpBatchSender::send(qintptr, const QHostAddress&, quint16, const std::vector<QByteArray>&)
+{
+    return 0;
+}
+
+void UdpBatchSender::reset()
+{
+}
+
+#endif // SOUND2OSC_HAVE_SENDMMSG
+
+UdpBatchSender::~UdpBatchSender() = default;
+
+} // namespace sound2osc
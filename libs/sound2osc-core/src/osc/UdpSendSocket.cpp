@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/osc/UdpSendSocket.h>
+
+#include <QtEndian>
+
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace sound2osc {
+
+namespace {
+
+#if defined(_WIN32)
+using NativeSocket = SOCKET;
+const NativeSocket INVALID_NATIVE_SOCKET = INVALID_SOCKET;
+#else
+using NativeSocket = int;
+const NativeSocket INVALID_NATIVE_SOCKET = -1;
+#endif
+
+// fills the socket address of a host for a socket of the given family, returns its size (0 = unreachable)
+socklen_t toSocketAddress(int family, const QHostAddress& host, quint16 port, sockaddr_storage& target)
+{
+    std::memset(&target, 0, sizeof(target));
+    if (family == AF_INET) {
+        bool isIPv4 = false;
+        const quint32 ipv4 = host.toIPv4Address(&isIPv4);
+        if (!isIPv4) return 0;
+        sockaddr_in* address = reinterpret_cast<sockaddr_in*>(&target);
+        address->sin_family = AF_INET;
+        address->sin_port = qToBigEndian(port);
+        address->sin_addr.s_addr = qToBigEndian(ipv4);
+        return sizeof(sockaddr_in);
+    }
+    if (family == AF_INET6) {
+        // IPv4 hosts are reached by their mapped address:
+        const Q_IPV6ADDR ipv6 = host.toIPv6Address();
+        sockaddr_in6* address = reinterpret_cast<sockaddr_in6*>(&target);
+        address->sin6_family = AF_INET6;
+        address->sin6_port = qToBigEndian(port);
+        std::memcpy(&address->sin6_addr, &ipv6, sizeof(address->sin6_addr));
+        return sizeof(sockaddr_in6);
+    }
+    return 0;
+}
+
+void closeNative(NativeSocket socket)
+{
+#if defined(_WIN32)
+    closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+} // namespace
+
+UdpSendSocket::UdpSendSocket()
+    : m_descriptor(-1)
+    , m_family(AF_UNSPEC)
+{
+}
+
+UdpSendSocket::~UdpSendSocket()
+{
+    close();
+}
+
+bool UdpSendSocket::open()
+{
+    if (isOpen()) return true;
+
+#if defined(_WIN32)
+    // reference counted by the system, released in close():
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+
+    NativeSocket socket = ::socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    int family = AF_INET6;
+    if (socket != INVALID_NATIVE_SOCKET) {
+        // accept IPv4 mapped addresses as well:
+        int v6only = 0;
+        setsockopt(socket, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&v6only), sizeof(v6only));
+    } else {
+        socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        family = AF_INET;
+    }
+    if (socket == INVALID_NATIVE_SOCKET) {
+#if defined(_WIN32)
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    m_descriptor = static_cast<qintptr>(socket);
+    m_family = family;
+    return true;
+}
+
+void UdpSendSocket::close()
+{
+    if (!isOpen()) return;
+    closeNative(static_cast<NativeSocket>(m_descriptor));
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+    m_descriptor = -1;
+    m_family = AF_UNSPEC;
+}
+
+bool UdpSendSocket::send(const QHostAddress& address, quint16 port, const char* data, std::size_t size)
+{
+    if (!isOpen()) return false;
+    sockaddr_storage target;
+    const socklen_t targetSize = toSocketAddress(m_family, address, port, target);
+    if (targetSize == 0) return false;
+
+#if defined(_WIN32)
+    const int result = ::sendto(static_cast<NativeSocket>(m_descriptor), data, static_cast<int>(size), 0,
+                                reinterpret_cast<const sockaddr*>(&target), targetSize);
+#else
+    const ssize_t result = ::sendto(static_cast<NativeSocket>(m_descriptor), data, size, 0,
+                                    reinterpret_cast<const sockaddr*>(&target), targetSize);
+#endif
+    return result >= 0;
+}
+
+} // namespace sound2osc
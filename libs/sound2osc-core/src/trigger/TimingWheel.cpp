@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/trigger/TimingWheel.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sound2osc {
+
+namespace {
+
+// number of ticks covered by one slot of the given level
+constexpr int64_t slotTicks(int level)
+{
+    return int64_t(1) << (TimingWheel::SLOT_BITS * level);
+}
+
+} // namespace
+
+TimingWheel::TimingWheel(int sampleRate)
+    : m_sampleRate(std::max(1, sampleRate))
+    , m_position(0)
+    , m_tick(0)
+    , m_activeTimers(0)
+    , m_levelTimers()
+    , m_slots(static_cast<std::size_t>(LEVELS * SLOTS), -1)
+{
+}
+
+void TimingWheel::setSampleRate(int sampleRate)
+{
+    m_sampleRate = std::max(1, sampleRate);
+}
+
+int64_t TimingWheel::samplesFor(double seconds) const
+{
+    return std::max<int64_t>(0, std::llround(seconds * m_sampleRate));
+}
+
+int TimingWheel::createTimer(Callback callback)
+{
+    int timer;
+    if (m_freeTimers.empty()) {
+        timer = static_cast<int>(m_timers.size());
+        m_timers.emplace_back();
+    } else {
+        timer = m_freeTimers.back();
+        m_freeTimers.pop_back();
+    }
+    m_timers[static_cast<std::size_t>(timer)].callback = std::move(callback);
+    return timer;
+}
+
+void TimingWheel::destroyTimer(int timer)
+{
+    stop(timer);
+    Timer& data = m_timers[static_cast<std::size_t>(timer)];
+    data.callback = nullptr;
+    data.deadline = 0;
+    m_freeTimers.push_back(timer);
+}
+
+void TimingWheel::reserve(int count)
+{
+    m_timers.reserve(static_cast<std::size_t>(count));
+    m_freeTimers.reserve(static_cast<std::size_t>(count));
+    m_due.reserve(static_cast<std::size_t>(count));
+}
+
+void TimingWheel::start(int timer, int64_t deadline)
+{
+    stop(timer);
+    m_timers[static_cast<std::size_t>(timer)].deadline = deadline;
+    insert(timer);
+    ++m_activeTimers;
+}
+
+void TimingWheel::stop(int timer)
+{
+    if (!isActive(timer)) return;
+    unlink(timer);
+    --m_activeTimers;
+}
+
+void TimingWheel::insert(int timer)
+{
+    Timer& data = m_timers[static_cast<std::size_t>(timer)];
+
+    // the lowest level whose range covers the distance to the deadline:
+    int64_t tick = std::max(data.deadline >> TICK_SHIFT, m_tick);
+    const int64_t distance = tick - m_tick;
+    int level = 0;
+    while (level < LEVELS - 1 && distance >= slotTicks(level + 1)) {
+        ++level;
+    }
+    if (distance >= slotTicks(LEVELS)) {
+        // beyond the range, sorted in again when the last slot of the top level is reached:
+        tick = m_tick + slotTicks(LEVELS) - 1;
+    }
+
+    const int slot = level * SLOTS + static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    int& first = m_slots[static_cast<std::size_t>(slot)];
+    data.slot = slot;
+    data.previous = -1;
+    data.next = first;
+    if (first >= 0) m_timers[static_cast<std::size_t>(first)].previous = timer;
+    first = timer;
+    ++m_levelTimers[level];
+}
+
+void TimingWheel::unlink(int timer)
+{
+    Timer& data = m_timers[static_cast<std::size_t>(timer)];
+    if (data.previous >= 0) {
+        m_timers[static_cast<std::size_t>(data.previous)].next = data.next;
+    } else {
+        m_slots[static_cast<std::size_t>(data.slot)] = data.next;
+    }
+    if (data.next >= 0) m_timers[static_cast<std::size_t>(data.next)].previous = data.previous;
+    --m_levelTimers[data.slot / SLOTS];
+    data.slot = -1;
+    data.next = -1;
+    data.previous = -1;
+}
+
+void TimingWheel::cascade()
+{
+    // when a level completes a rotation, the next slot of the level above is distributed:
+    for (int level = 1; level < LEVELS; ++level) {
+        if ((m_tick & (slotTicks(level) - 1)) != 0) break;
+        const int slot = level * SLOTS + static_cast<int>((m_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        int timer = m_slots[static_cast<std::size_t>(slot)];
+        while (timer >= 0) {
+            const int next = m_timers[static_cast<std::size_t>(timer)].next;
+            unlink(timer);
+            insert(timer);
+            timer = next;
+        }
+    }
+}
+
+bool TimingWheel::expireCurrentSlot()
+{
+    // collect the due timers of the current tick, later deadlines of the same tick stay:
+    m_due.clear();
+    int timer = m_slots[static_cast<std::size_t>(m_tick & (SLOTS - 1))];
+    while (timer >= 0) {
+        const Timer& data = m_timers[static_cast<std::size_t>(timer)];
+        if (data.deadline <= m_position) m_due.push_back(timer);
+        timer = data.next;
+    }
+    if (m_due.empty()) return false;
+
+    std::sort(m_due.begin(), m_due.end(), [this](int a, int b) {
+        const int64_t deadlineA = m_timers[static_cast<std::size_t>(a)].deadline;
+        const int64_t deadlineB = m_timers[static_cast<std::size_t>(b)].deadline;
+        return deadlineA < deadlineB || (deadlineA == deadlineB && a < b);
+    });
+
+    // a callback may stop or restart the following timers:
+    for (std::size_t i = 0; i < m_due.size(); ++i) {
+        const int due = m_due[i];
+        if (!isActive(due) || m_timers[static_cast<std::size_t>(due)].deadline > m_position) continue;
+        stop(due);
+        // the callback may destroy the timer, so it is called on a copy:
+        const Callback callback = m_timers[static_cast<std::size_t>(due)].callback;
+        if (callback) callback();
+    }
+    return true;
+}
+
+void TimingWheel::advance(int64_t position)
+{
+    if (position < m_position) return;
+    m_position = position;
+    const int64_t target = position >> TICK_SHIFT;
+
+    for (;;) {
+        // repeated for timers that were started by the callbacks with a deadline that is due already:
+        while (expireCurrentSlot()) {}
+        if (m_tick >= target) break;
+
+        if (m_activeTimers == 0) {
+            m_tick = target;
+            continue;
+        }
+
+        // skip the ticks of levels without timers, up to the next rotation of the level above:
+        int64_t next = m_tick + 1;
+        for (int level = 0; level < LEVELS - 1 && m_levelTimers[level] == 0; ++level) {
+            next = ((m_tick >> (SLOT_BITS * (level + 1))) + 1) << (SLOT_BITS * (level + 1));
+        }
+        m_tick = std::min(next, target);
+        cascade();
+    }
+}
+
+} // namespace sound2osc
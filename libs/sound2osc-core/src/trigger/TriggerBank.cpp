@@ -0,0 +1,501 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/trigger/TriggerBank.h>
+
+#include <sound2osc/core/utils.h>
+#include <sound2osc/osc/OSCNetworkManager.h>
+
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace sound2osc {
+
+TriggerBank::Output::Output(OSCNetworkManager* osc)
+    : oscParameters()
+    , filter(osc, oscParameters, false)
+{
+}
+
+TriggerBank::TriggerBank(OSCNetworkManager* osc)
+    : m_osc(osc)
+    , m_generation(0)
+    , m_adoptedGeneration(0)
+    , m_rangeValid()
+{
+    // evaluate() does not allocate, up to MAX_BANDS:
+    m_wheel.reserve(3 * MAX_BANDS);
+    m_batch.reserve(MAX_BANDS);
+    m_bands.reserve(MAX_BANDS);
+}
+
+TriggerBank::~TriggerBank() = default;
+
+int TriggerBank::addBand(const QString& name, int midFreq, qreal width)
+{
+    QMutexLocker locker(&m_mutex);
+    const int index = addBandLocked(name, midFreq, width);
+    if (index >= 0) publishLocked();
+    return index;
+}
+
+int TriggerBank::addBandLocked(const QString& name, int midFreq, qreal width)
+{
+    if (!isValidName(name) || findLocked(name) >= 0) return -1;
+    if (static_cast<int>(m_bands.size()) >= MAX_BANDS) return -1;
+
+    auto output = std::make_unique<Output>(m_osc);
+    const QString path = "/sound2osc/out/band/" + name;
+    output->oscParameters.setOnMessage(path + "/trigger=1");
+    output->oscParameters.setOffMessage(path + "/trigger=0");
+    output->oscParameters.setLevelMessage(path + "/level=");
+
+    m_bands.push_back({ name, limit(10, midFreq, 22050), limit(0.00001, width, 1), 0.5f, false, std::move(output) });
+    return static_cast<int>(m_bands.size()) - 1;
+}
+
+bool TriggerBank::removeBand(int index)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isValidIndex(index)) return false;
+    removeBandLocked(index);
+    publishLocked();
+    return true;
+}
+
+void TriggerBank::removeBandLocked(int index)
+{
+    // evaluate() may still use the Output until it adopted the next generation:
+    m_retired.emplace_back(m_generation + 1, std::move(m_bands[static_cast<std::size_t>(index)].output));
+    m_bands.erase(m_bands.begin() + index);
+}
+
+void TriggerBank::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_bands.empty()) removeBandLocked(static_cast<int>(m_bands.size()) - 1);
+    publishLocked();
+}
+
+void TriggerBank::publishLocked()
+{
+    Parameters& parameters = m_published.back();
+    parameters.count = static_cast<int>(m_bands.size());
+    parameters.generation = ++m_generation;
+    for (std::size_t i = 0; i < m_bands.size(); ++i) {
+        const Band& band = m_bands[i];
+        parameters.outputs[i] = band.output.get();
+        parameters.midFreqs[i] = band.midFreq;
+        parameters.widths[i] = band.width;
+        parameters.thresholds[i] = band.threshold;
+        parameters.mutes[i] = band.mute;
+    }
+    m_published.publish();
+
+    // release the Outputs that evaluate() does not use anymore:
+    const uint64_t adopted = m_adoptedGeneration.load(std::memory_order_acquire);
+    m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+                                   [adopted](const auto& retired) { return retired.first <= adopted; }),
+                    m_retired.end());
+}
+
+int TriggerBank::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_bands.size());
+}
+
+int TriggerBank::find(const QString& nameOrNumber) const
+{
+    QMutexLocker locker(&m_mutex);
+    return findLocked(nameOrNumber);
+}
+
+int TriggerBank::findLocked(const QString& nameOrNumber) const
+{
+    bool isNumber = false;
+    const int number = nameOrNumber.toInt(&isNumber);
+    if (isNumber) {
+        return isValidIndex(number - 1) ? number - 1 : -1;
+    }
+    for (int i = 0; i < static_cast<int>(m_bands.size()); ++i) {
+        if (m_bands[static_cast<std::size_t>(i)].name == nameOrNumber) return i;
+    }
+    return -1;
+}
+
+bool TriggerBank::isValidName(const QString& name)
+{
+    if (name.isEmpty() || name == "add" || name == "clear") return false;
+    bool isNumber = false;
+    name.toInt(&isNumber);
+    if (isNumber) return false;
+    for (const QChar c : name) {
+        if (c == '/' || c.isSpace()) return false;
+    }
+    return true;
+}
+
+QString TriggerBank::name(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].name : QString();
+}
+
+int TriggerBank::midFreq(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].midFreq : 0;
+}
+
+void TriggerBank::setMidFreq(int index, int value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isValidIndex(index)) return;
+    m_bands[static_cast<std::size_t>(index)].midFreq = limit(10, value, 22050);
+    publishLocked();
+}
+
+qreal TriggerBank::width(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].width : 0.0;
+}
+
+void TriggerBank::setWidth(int index, qreal value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isValidIndex(index)) return;
+    m_bands[static_cast<std::size_t>(index)].width = limit(0.00001, value, 1);
+    publishLocked();
+}
+
+qreal TriggerBank::threshold(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? static_cast<qreal>(m_bands[static_cast<std::size_t>(index)].threshold) : 0.0;
+}
+
+void TriggerBank::setThreshold(int index, qreal value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isValidIndex(index)) return;
+    m_bands[static_cast<std::size_t>(index)].threshold = static_cast<float>(limit(0, value, 1));
+    publishLocked();
+}
+
+bool TriggerBank::mute(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) && m_bands[static_cast<std::size_t>(index)].mute;
+}
+
+void TriggerBank::setMute(int index, bool value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isValidIndex(index)) return;
+    Band& band = m_bands[static_cast<std::size_t>(index)];
+    band.mute = value;
+    band.output->filter.setMute(value);
+    publishLocked();
+    sendMuteFeedback(index);
+}
+
+qreal TriggerBank::level(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? static_cast<qreal>(m_bands[static_cast<std::size_t>(index)].output->level.load()) : 0.0;
+}
+
+bool TriggerBank::isActive(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) && m_bands[static_cast<std::size_t>(index)].output->active;
+}
+
+// The settings of the filters and OSC parameters are synchronized by
+// themselves, the mutex only keeps the Output of the band alive:
+
+qreal TriggerBank::onDelay(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->filter.getOnDelay() : 0.0;
+}
+
+void TriggerBank::setOnDelay(int index, qreal value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->filter.setOnDelay(value);
+}
+
+qreal TriggerBank::offDelay(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->filter.getOffDelay() : 0.0;
+}
+
+void TriggerBank::setOffDelay(int index, qreal value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->filter.setOffDelay(value);
+}
+
+qreal TriggerBank::maxHold(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->filter.getMaxHold() : 0.0;
+}
+
+void TriggerBank::setMaxHold(int index, qreal value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->filter.setMaxHold(value);
+}
+
+bool TriggerBank::isOutputActive(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) && m_bands[static_cast<std::size_t>(index)].output->filter.getOutputIsActive();
+}
+
+QString TriggerBank::onMessage(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->oscParameters.getOnMessage() : QString();
+}
+
+void TriggerBank::setOnMessage(int index, const QString& value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->oscParameters.setOnMessage(value);
+}
+
+QString TriggerBank::offMessage(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->oscParameters.getOffMessage() : QString();
+}
+
+void TriggerBank::setOffMessage(int index, const QString& value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->oscParameters.setOffMessage(value);
+}
+
+QString TriggerBank::levelMessage(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->oscParameters.getLevelMessage() : QString();
+}
+
+void TriggerBank::setLevelMessage(int index, const QString& value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->oscParameters.setLevelMessage(value);
+}
+
+OSCRoutes::Mask TriggerBank::routes(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return isValidIndex(index) ? m_bands[static_cast<std::size_t>(index)].output->oscParameters.getRoutes() : OSCRoutes::PRIMARY;
+}
+
+void TriggerBank::setRoutes(int index, OSCRoutes::Mask value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isValidIndex(index)) m_bands[static_cast<std::size_t>(index)].output->oscParameters.setRoutes(value);
+}
+
+void TriggerBank::sendMuteFeedback(int index) const
+{
+    if (!m_osc) return;
+    const Band& band = m_bands[static_cast<std::size_t>(index)];
+    m_osc->sendMessage("/sound2osc/out/band/" + band.name + "/mute", (band.mute ? "1" : "0"), true);
+}
+
+void TriggerBank::evaluate(const ScaledSpectrum& spectrum, bool lowSoloMode, int64_t position)
+{
+    // changes of the bands since the last evaluation:
+    if (m_published.update()) adopt(m_published.front());
+
+    // delays that ended up to the end of the analyzed samples:
+    m_wheel.setSampleRate(spectrum.getSampleRate());
+    m_wheel.advance(position);
+
+    // the index range of a band only changes with its parameters:
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_current.count); ++i) {
+        if (m_rangeValid[i]) continue;
+        int startIndex = 0;
+        int endIndex = 0;
+        spectrum.getBandRange(m_current.midFreqs[i], m_current.widths[i], startIndex, endIndex);
+        m_batch.setRange(static_cast<int>(i), startIndex, endIndex);
+        m_rangeValid[i] = true;
+    }
+
+    m_batch.evaluate(spectrum, lowSoloMode);
+
+    for (const TriggerEvent& event : m_batch.events()) {
+        Output& output = *m_current.outputs[static_cast<std::size_t>(event.trigger)];
+        switch (event.type) {
+        case TriggerEvent::On:
+            output.active = true;
+            output.filter.triggerOn();
+            break;
+        case TriggerEvent::Off:
+            output.active = false;
+            output.filter.triggerOff();
+            break;
+        case TriggerEvent::Level:
+            output.level = event.value;
+            sendLevel(event.trigger, event.value);
+            break;
+        }
+    }
+
+    // delays of 0 started by the events:
+    m_wheel.advance(position);
+}
+
+void TriggerBank::releaseOutputs()
+{
+    // also the bands that were removed since the last evaluate():
+    if (m_published.update()) adopt(m_published.front());
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_current.count); ++i) {
+        Output& output = *m_current.outputs[i];
+        output.active = false;
+        output.filter.release();
+        m_batch.setState(static_cast<int>(i), false, output.level);
+    }
+}
+
+void TriggerBank::adopt(const Parameters& parameters)
+{
+    // release the bands that were removed:
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_current.count); ++i) {
+        Output* output = m_current.outputs[i];
+        const auto end = parameters.outputs.begin() + parameters.count;
+        if (std::find(parameters.outputs.begin(), end, output) != end) continue;
+        if (output->filter.getOutputIsActive()) output->filter.onOffDelayEnd();
+        output->filter.setTimingWheel(nullptr);
+    }
+
+    // rebuild the batch, the state of the remaining bands is kept in their Outputs:
+    m_current = parameters;
+    m_batch.clear();
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_current.count); ++i) {
+        Output& output = *m_current.outputs[i];
+        output.filter.setTimingWheel(&m_wheel);
+
+        TriggerParameters trigger;
+        trigger.threshold = m_current.thresholds[i];
+        trigger.lowSolo = true;
+        // lowest frequency first, the lower index if two bands have the same frequency:
+        trigger.soloOrder = m_current.midFreqs[i] * MAX_BANDS + static_cast<int>(i);
+        const int index = m_batch.add(trigger);
+        m_batch.setState(index, output.active, output.level);
+        m_rangeValid[i] = false;
+    }
+
+    m_adoptedGeneration.store(parameters.generation, std::memory_order_release);
+}
+
+void TriggerBank::sendLevel(int index, float value) const
+{
+    // send level if levelMessage is set and band is not muted:
+    const std::size_t i = static_cast<std::size_t>(index);
+    const float threshold = m_current.thresholds[i];
+    if (!m_osc || threshold <= 0 || m_current.mutes[i]) return;
+    // template, min and max value and routes of the same change, without a lock:
+    const TriggerOscParameters::Messages& messages = m_current.outputs[i]->oscParameters.messages();
+    if (messages.level.isEmpty()) return;
+
+    const qreal valueUnderThreshold = limit(0, static_cast<qreal>(value / threshold), 1);
+    m_osc->sendMessage(messages.level, messages.scaleLevel(valueUnderThreshold), false, messages.routes);
+}
+
+QJsonArray TriggerBank::toState() const
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonArray state;
+    for (const Band& band : m_bands) {
+        QJsonObject object;
+        object["name"] = band.name;
+        object["midFreq"] = band.midFreq;
+        object["width"] = band.width;
+        object["threshold"] = static_cast<double>(band.threshold);
+        object["mute"] = band.mute;
+        object["filter"] = band.output->filter.toState();
+        object["osc"] = band.output->oscParameters.toState();
+        state.append(object);
+    }
+    return state;
+}
+
+void TriggerBank::fromState(const QJsonArray& state)
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_bands.empty()) removeBandLocked(static_cast<int>(m_bands.size()) - 1);
+    for (const QJsonValue& value : state) {
+        const QJsonObject object = value.toObject();
+        const int index = addBandLocked(object["name"].toString(), object["midFreq"].toInt(1000),
+                                        object["width"].toDouble(0.1));
+        if (index < 0) continue;
+
+        Band& band = m_bands[static_cast<std::size_t>(index)];
+        band.threshold = static_cast<float>(limit(0, object["threshold"].toDouble(0.5), 1));
+        band.mute = object["mute"].toBool(false);
+        band.output->filter.setMute(band.mute);
+        if (object.contains("filter")) {
+            band.output->filter.fromState(object["filter"].toObject());
+        }
+        if (object.contains("osc")) {
+            band.output->oscParameters.fromState(object["osc"].toObject());
+        }
+    }
+    // all changes are handed over at once:
+    publishLocked();
+}
+
+bool TriggerBank::handleMessage(OSCMessage msg)
+{
+    const QStringList& path = msg.path();
+    if (path.size() < 3 || path[0] != "sound2osc" || path[1] != "band") return false;
+
+    const QVector<QVariant>& arguments = msg.arguments();
+    if (path[2] == "add") {
+        if (arguments.isEmpty()) return true;
+        const int midFreq = arguments.size() > 1 ? arguments[1].toInt() : 1000;
+        const qreal width = arguments.size() > 2 ? arguments[2].toDouble() : 0.1;
+        addBand(arguments[0].toString(), midFreq, width);
+        return true;
+    }
+    if (path[2] == "clear") {
+        if (msg.isTrue()) clear();
+        return true;
+    }
+
+    const int index = find(path[2]);
+    if (index < 0 || path.size() < 4) return true;
+
+    const QString& command = path[3];
+    if (command == "remove") {
+        if (msg.isTrue()) removeBand(index);
+    } else if (command == "mid_freq") {
+        if (!arguments.isEmpty()) setMidFreq(index, arguments[0].toInt());
+    } else if (command == "width") {
+        if (!arguments.isEmpty()) setWidth(index, msg.value());
+    } else if (command == "threshold") {
+        if (!arguments.isEmpty()) setThreshold(index, msg.value());
+    } else if (command == "mute") {
+        if (path.size() > 4 && path[4] == "toggle") {
+            if (msg.isTrue()) setMute(index, !mute(index));
+        } else {
+            setMute(index, msg.isTrue());
+        }
+    }
+    return true;
+}
+
+} // namespace sound2osc
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026-present Christian Schliz <code+sound2osc@foxat.de>
+
+#include <sound2osc/trigger/TriggerBatch.h>
+
+#include <sound2osc/dsp/ScaledSpectrum.h>
+
+#include <algorithm>
+#include <climits>
+
+namespace sound2osc {
+
+namespace {
+
+// bits of m_changes:
+constexpr int CHANGE_ON = 1;
+constexpr int CHANGE_OFF = 2;
+constexpr int CHANGE_LEVEL = 4;
+
+template<typename T>
+void eraseAt(std::vector<T>& values, int index)
+{
+    values.erase(values.begin() + index);
+}
+
+} // namespace
+
+int TriggerBatch::add(const TriggerParameters& parameters)
+{
+    m_startIndexes.push_back(0);
+    m_endIndexes.push_back(0);
+    m_thresholds.push_back(0.0f);
+    m_inverts.push_back(0.0f);
+    m_lowSolo.push_back(0);
+    m_soloOrders.push_back(0);
+    m_active.push_back(0);
+    m_levels.push_back(0.0f);
+    m_values.push_back(0.0f);
+    m_changes.push_back(0);
+    const int index = size() - 1;
+    setParameters(index, parameters);
+    return index;
+}
+
+void TriggerBatch::remove(int index)
+{
+    if (index < 0 || index >= size()) return;
+    eraseAt(m_startIndexes, index);
+    eraseAt(m_endIndexes, index);
+    eraseAt(m_thresholds, index);
+    eraseAt(m_inverts, index);
+    eraseAt(m_lowSolo, index);
+    eraseAt(m_soloOrders, index);
+    eraseAt(m_active, index);
+    eraseAt(m_levels, index);
+    eraseAt(m_values, index);
+    eraseAt(m_changes, index);
+    m_events.clear();
+}
+
+void TriggerBatch::clear()
+{
+    m_startIndexes.clear();
+    m_endIndexes.clear();
+    m_thresholds.clear();
+    m_inverts.clear();
+    m_lowSolo.clear();
+    m_soloOrders.clear();
+    m_active.clear();
+    m_levels.clear();
+    m_values.clear();
+    m_changes.clear();
+    m_events.clear();
+}
+
+void TriggerBatch::reserve(int count)
+{
+    const std::size_t capacity = static_cast<std::size_t>(count);
+    m_startIndexes.reserve(capacity);
+    m_endIndexes.reserve(capacity);
+    m_thresholds.reserve(capacity);
+    m_inverts.reserve(capacity);
+    m_lowSolo.reserve(capacity);
+    m_soloOrders.reserve(capacity);
+    m_active.reserve(capacity);
+    m_levels.reserve(capacity);
+    m_values.reserve(capacity);
+    m_changes.reserve(capacity);
+    // up to an On or Off and a Level event per trigger:
+    m_events.reserve(capacity * 2);
+}
+
+void TriggerBatch::setParameters(int index, const TriggerParameters& parameters)
+{
+    const std::size_t i = static_cast<std::size_t>(index);
+    setRange(index, parameters.startIndex, parameters.endIndex);
+    setThreshold(index, parameters.threshold);
+    m_inverts[i] = parameters.invert ? 1.0f : 0.0f;
+    m_lowSolo[i] = parameters.lowSolo ? 1 : 0;
+    m_soloOrders[i] = parameters.soloOrder;
+}
+
+void TriggerBatch::setRange(int index, int startIndex, int endIndex)
+{
+    m_startIndexes[static_cast<std::size_t>(index)] = startIndex;
+    m_endIndexes[static_cast<std::size_t>(index)] = endIndex;
+}
+
+void TriggerBatch::setThreshold(int index, float threshold)
+{
+    m_thresholds[static_cast<std::size_t>(index)] = threshold;
+}
+
+void TriggerBatch::setSoloOrder(int index, int order)
+{
+    m_soloOrders[static_cast<std::size_t>(index)] = order;
+}
+
+void TriggerBatch::setState(int index, bool active, float level)
+{
+    m_active[static_cast<std::size_t>(index)] = active ? 1 : 0;
+    m_levels[static_cast<std::size_t>(index)] = level;
+}
+
+void TriggerBatch::evaluate(const ScaledSpectrum& spectrum, bool lowSoloMode)
+{
+    const int count = size();
+    float* values = m_values.data();
+    const float* thresholds = m_thresholds.data();
+    const float* inverts = m_inverts.data();
+    const int* lowSolo = m_lowSolo.data();
+    const int* soloOrders = m_soloOrders.data();
+    int* active = m_active.data();
+    float* levels = m_levels.data();
+    int* changes = m_changes.data();
+
+    // max level of each band (O(1) lookups in the sparse table of the spectrum):
+    spectrum.getMaxLevels(m_startIndexes.data(), m_endIndexes.data(), values, count);
+
+    // invert and find the lowest solo order of all lowSolo triggers at or above the threshold:
+    int soloOrder = INT_MAX;
+    for (int i = 0; i < count; ++i) {
+        // exact select of v or 1 - v (inverts[i] is 0 or 1):
+        const float value = values[i] * (1.0f - inverts[i]) + (1.0f - values[i]) * inverts[i];
+        values[i] = value;
+        // INT_MAX for triggers that are not candidates (solo orders are >= 0, no multiplications):
+        const int candidate = static_cast<int>(value >= thresholds[i]) & lowSolo[i];
+        soloOrder = std::min(soloOrder, soloOrders[i] | ((candidate - 1) & INT_MAX));
+    }
+    const int solo = lowSoloMode ? 1 : 0;
+
+    // threshold crossings as bit masks:
+    for (int i = 0; i < count; ++i) {
+        const int released = solo & lowSolo[i] & static_cast<int>(soloOrders[i] != soloOrder);
+        const int isActive = static_cast<int>(values[i] >= thresholds[i]) & (1 - released);
+        const int changed = isActive ^ active[i];
+        changes[i] = -changed & (isActive * CHANGE_ON + (1 - isActive) * CHANGE_OFF);
+        active[i] = isActive;
+    }
+
+    // level changes since the last Level event
+    // (a separate loop, mixing the float and int lanes above prevents vectorization):
+    for (int i = 0; i < count; ++i) {
+        const float value = values[i];
+        const float difference = value - levels[i];
+        const int levelChanged = static_cast<int>(difference > MIN_LEVEL_CHANGE)
+                                 | static_cast<int>(difference < -MIN_LEVEL_CHANGE);
+        changes[i] += levelChanged * CHANGE_LEVEL;
+        levels[i] = levelChanged ? value : levels[i];
+    }
+
+    // collect the events of the (usually few) triggers that changed:
+    m_events.clear();
+    for (int i = 0; i < count; ++i) {
+        const int change = changes[i];
+        if (change == 0) continue;
+        if (change & CHANGE_ON) m_events.push_back({ i, TriggerEvent::On, values[i] });
+        if (change & CHANGE_OFF) m_events.push_back({ i, TriggerEvent::Off, values[i] });
+        if (change & CHANGE_LEVEL) m_events.push_back({ i, TriggerEvent::Level, values[i] });
+    }
+}
+
+} // namespace sound2osc
@@ -23,9 +23,9 @@
 #include <sound2osc/trigger/TriggerFilter.h>
 
 #include <sound2osc/osc/OSCNetworkManager.h>
+#include <sound2osc/trigger/TimingWheel.h>
 
 #include <QDebug>
-#include <QTimer>
 
 TriggerFilter::TriggerFilter(OSCNetworkManager* osc, TriggerOscParameters& oscParameters, bool mute)
 	: QObject(0)
@@ -34,66 +34,120 @@ TriggerFilter::TriggerFilter(OSCNetworkManager* osc, TriggerOscParameters& oscPa
 	, m_offDelay(0.0)
 	, m_maxHold(0.0)
 	, m_outputIsActive(false)
+	, m_wheel(nullptr)
+	, m_onDelayTimer(-1)
+	, m_maxHoldTimer(-1)
+	, m_offDelayTimer(-1)
 	, m_osc(osc)
 	, m_oscParameters(oscParameters)
 {
-	m_onDelayTimer.setSingleShot(true);
-	connect(&m_onDelayTimer, &QTimer::timeout, this, &TriggerFilter::onOnDelayEnd);
-	m_maxHoldTimer.setSingleShot(true);
-	connect(&m_maxHoldTimer, &QTimer::timeout, this, &TriggerFilter::onMaxHoldEnd);
-	m_offDelayTimer.setSingleShot(true);
-	connect(&m_offDelayTimer, &QTimer::timeout, this, &TriggerFilter::onOffDelayEnd);
+}
+
+TriggerFilter::~TriggerFilter()
+{
+	setTimingWheel(nullptr);
+}
+
+void TriggerFilter::setTimingWheel(sound2osc::TimingWheel* wheel)
+{
+	if (wheel == m_wheel) return;
+
+	if (m_wheel) {
+		m_wheel->destroyTimer(m_onDelayTimer);
+		m_wheel->destroyTimer(m_maxHoldTimer);
+		m_wheel->destroyTimer(m_offDelayTimer);
+	}
+	m_wheel = wheel;
+	if (m_wheel) {
+		m_onDelayTimer = m_wheel->createTimer([this]() { onOnDelayEnd(); });
+		m_maxHoldTimer = m_wheel->createTimer([this]() { onMaxHoldEnd(); });
+		m_offDelayTimer = m_wheel->createTimer([this]() { onOffDelayEnd(); });
+	} else {
+		m_onDelayTimer = -1;
+		m_maxHoldTimer = -1;
+		m_offDelayTimer = -1;
+	}
 }
 
 void TriggerFilter::triggerOn()
 {
-	// stop releaseDelayTimer if it is running:
-	m_offDelayTimer.stop();
+	if (!m_wheel) {
+		// no sample clock, send the signal without delay:
+		if (!m_outputIsActive) onOnDelayEnd();
+		return;
+	}
+
+	// stop off delay if it is running:
+	m_wheel->stop(m_offDelayTimer);
 
 	// ignore triggerOn if output is still active:
 	if (m_outputIsActive) return;
 
-	// ignore triggerOn if onDelayTimer of previous triggerOn is still running:
-	if (m_onDelayTimer.isActive()) return;
+	// ignore triggerOn if on delay of previous triggerOn is still running:
+	if (m_wheel->isActive(m_onDelayTimer)) return;
 
 	// call onOnDelayEnd() after onDelay time:
-	m_onDelayTimer.start(static_cast<int>(m_onDelay * 1000));
+	m_wheel->startAfter(m_onDelayTimer, m_onDelay);
 }
 
 void TriggerFilter::triggerOff()
 {
-	// stop onDelayTimer if it is running:
-	m_onDelayTimer.stop();
+	if (!m_wheel) {
+		if (m_outputIsActive) onOffDelayEnd();
+		return;
+	}
+
+	// stop on delay if it is running:
+	m_wheel->stop(m_onDelayTimer);
 
 	// ignore triggerOff if output is not active:
 	if (!m_outputIsActive) return;
 
-	// ignore triggerOff if offDelayTimer of previous triggerOff is still running:
-	if (m_offDelayTimer.isActive()) return;
+	// ignore triggerOff if off delay of previous triggerOff is still running:
+	if (m_wheel->isActive(m_offDelayTimer)) return;
 
 	// call onOffDelayEnd() after offDelay time:
-	m_offDelayTimer.start(static_cast<int>(m_offDelay * 1000));
+	m_wheel->startAfter(m_offDelayTimer, m_offDelay);
+}
+
+void TriggerFilter::release()
+{
+	if (m_wheel) {
+		m_wheel->stop(m_onDelayTimer);
+		m_wheel->stop(m_maxHoldTimer);
+		m_wheel->stop(m_offDelayTimer);
+	}
+
+	// the off delay and max hold can not end without new samples:
+	if (!m_outputIsActive) return;
+	m_outputIsActive = false;
+	sendOffSignal();
 }
 
 void TriggerFilter::sendOnSignal()
 {
-	QString message = m_oscParameters.getOnMessage();
-    if (!message.isEmpty() && !m_mute)	m_osc->sendMessage(message);
+	if (!m_mute && m_osc) {
+		// template and routes of the same change:
+		const TriggerOscParameters::Messages& messages = m_oscParameters.messages();
+		m_osc->sendMessage(messages.on, 0.0, false, messages.routes);
+	}
 	emit onSignalSent();
 }
 
 void TriggerFilter::sendOffSignal()
 {
-	QString message = m_oscParameters.getOffMessage();
-    if (!message.isEmpty() && !m_mute) m_osc->sendMessage(message);
+	if (!m_mute && m_osc) {
+		const TriggerOscParameters::Messages& messages = m_oscParameters.messages();
+		m_osc->sendMessage(messages.off, 0.0, false, messages.routes);
+	}
 	emit offSignalSent();
 }
 
 void TriggerFilter::save(const QString name, QSettings &settings) const
 {
-	settings.setValue(name + "/onDelay", m_onDelay);
-	settings.setValue(name + "/offDelay", m_offDelay);
-	settings.setValue(name + "/maxHold", m_maxHold);
+	settings.setValue(name + "/onDelay", m_onDelay.load());
+	settings.setValue(name + "/offDelay", m_offDelay.load());
+	settings.setValue(name + "/maxHold", m_maxHold.load());
 }
 
 void TriggerFilter::restore(const QString name, QSettings &settings)
@@ -106,9 +160,9 @@ void TriggerFilter::restore(const QString name, QSettings &settings)
 QJsonObject TriggerFilter::toState() const
 {
     QJsonObject state;
-    state["onDelay"] = m_onDelay;
-    state["offDelay"] = m_offDelay;
-    state["maxHold"] = m_maxHold;
+    state["onDelay"] = m_onDelay.load();
+    state["offDelay"] = m_offDelay.load();
+    state["maxHold"] = m_maxHold.load();
     return state;
 }
 
@@ -127,8 +181,8 @@ void TriggerFilter::onOnDelayEnd()
 	sendOnSignal();
 
 	// if maxHold is set, call onMaxHoldEnd after maxHold time:
-	if (m_maxHold > 0) {
-		m_maxHoldTimer.start(static_cast<int>(m_maxHold * 1000));
+	if (m_maxHold > 0 && m_wheel) {
+		m_wheel->startAfter(m_maxHoldTimer, m_maxHold);
 	}
 }
 
@@ -139,8 +193,8 @@ void TriggerFilter::onMaxHoldEnd()
 	m_outputIsActive = false;
 	sendOffSignal();
 
-	// if offDelayTimer is running, stop it:
-	m_offDelayTimer.stop();
+	// if off delay is running, stop it:
+	if (m_wheel) m_wheel->stop(m_offDelayTimer);
 }
 
 void TriggerFilter::onOffDelayEnd()
@@ -150,6 +204,6 @@ void TriggerFilter::onOffDelayEnd()
 	m_outputIsActive = false;
 	sendOffSignal();
 
-	// if maxHoldTimer is running, stop it:
-	m_maxHoldTimer.stop();
+	// if max hold is running, stop it:
+	if (m_wheel) m_wheel->stop(m_maxHoldTimer);
 }
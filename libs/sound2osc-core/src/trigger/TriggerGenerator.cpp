@@ -39,6 +39,11 @@ TriggerGenerator::TriggerGenerator(QString name, OSCNetworkManager* osc, bool is
 	, m_width(0.1)
 	, m_threshold(0.5)
 	, m_isActive(false)
+	, m_lastValue(0)
+	, m_rangeMidFreq(-1)
+	, m_rangeWidth(-1)
+	, m_rangeStart(0)
+	, m_rangeEnd(0)
 	, m_oscParameters()
     , m_filter(osc, m_oscParameters, m_mute)
 {
@@ -65,39 +70,79 @@ bool TriggerGenerator::checkForTrigger(const ScaledSpectrum &spectrum, bool forc
 {
 	qreal value;
 	if (m_isBandpass) {
-		value = spectrum.getMaxLevel(m_midFreq, m_width);
+		// the index range of the band only changes with its parameters:
+		const int midFreq = m_midFreq;
+		const qreal width = m_width;
+		if (midFreq != m_rangeMidFreq || width != m_rangeWidth) {
+			spectrum.getBandRange(midFreq, width, m_rangeStart, m_rangeEnd);
+			m_rangeMidFreq = midFreq;
+			m_rangeWidth = width;
+		}
+		value = spectrum.getMaxLevel(m_rangeStart, m_rangeEnd);
 	} else {
 		value = spectrum.getMaxLevel();
 	}
 	if (m_invert) value = 1 - value;
 
     // check for trigger:
+    const float level = static_cast<float>(value);
     if ((!m_isActive && value >= m_threshold) && !forceRelease) {
 		// activate trigger:
-		m_isActive = true;
-		m_filter.triggerOn();
+		handleTriggerEvent({ 0, sound2osc::TriggerEvent::On, level });
     } else if ((m_isActive && value < m_threshold) || forceRelease) {
 		// release trigger:
-		m_isActive = false;
-		m_filter.triggerOff();
+		handleTriggerEvent({ 0, sound2osc::TriggerEvent::Off, level });
     }
 
-    // send level if levelMessage is set and band is not muted:
-	// and if difference to last value is greater than 0.001:
-    qreal diff = qAbs(m_lastValue - value);
-    if (diff > 0.001 && !m_oscParameters.getLevelMessage().isEmpty() && m_threshold > 0 && !m_mute) {
-        qreal valueUnderThreshold = limit(0, (value / m_threshold), 1);
-        qreal minValue = m_oscParameters.getMinLevelValue();
-        qreal maxValue = m_oscParameters.getMaxLevelValue();
-        qreal scaledValue = minValue + valueUnderThreshold * (maxValue - minValue);
-        QString oscMessage = m_oscParameters.getLevelMessage() + QString::number(scaledValue, 'f', 3);
-        m_osc->sendMessage(oscMessage);
+	// send level if difference to last sent value is greater than 0.001:
+    if (qAbs(m_lastValue - value) > static_cast<qreal>(sound2osc::TriggerBatch::MIN_LEVEL_CHANGE)) {
+		handleTriggerEvent({ 0, sound2osc::TriggerEvent::Level, level });
     }
 
-	m_lastValue = value;
     return m_isActive;
 }
 
+sound2osc::TriggerParameters TriggerGenerator::getTriggerParameters(const ScaledSpectrum& spectrum) const
+{
+	sound2osc::TriggerParameters parameters;
+	if (m_isBandpass) {
+		spectrum.getBandRange(m_midFreq, m_width, parameters.startIndex, parameters.endIndex);
+	} else {
+		parameters.startIndex = 0;
+		parameters.endIndex = static_cast<int>(spectrum.getNormalizedSpectrum().size()) - 1;
+	}
+	parameters.threshold = static_cast<float>(m_threshold.load());
+	parameters.invert = m_invert;
+	parameters.lowSolo = m_isBandpass;
+	return parameters;
+}
+
+void TriggerGenerator::handleTriggerEvent(const sound2osc::TriggerEvent& event)
+{
+	switch (event.type) {
+	case sound2osc::TriggerEvent::On:
+		m_isActive = true;
+		m_filter.triggerOn();
+		break;
+	case sound2osc::TriggerEvent::Off:
+		m_isActive = false;
+		m_filter.triggerOff();
+		break;
+	case sound2osc::TriggerEvent::Level: {
+		const qreal value = static_cast<qreal>(event.value);
+		m_lastValue = value;
+		// send level if levelMessage is set and band is not muted:
+		const qreal threshold = m_threshold;
+		if (threshold <= 0 || m_mute || !m_osc) break;
+		const TriggerOscParameters::Messages& messages = m_oscParameters.messages();
+		if (messages.level.isEmpty()) break;
+		qreal valueUnderThreshold = limit(0, (value / threshold), 1);
+		m_osc->sendMessage(messages.level, messages.scaleLevel(valueUnderThreshold), false, messages.routes);
+		break;
+	}
+	}
+}
+
 void TriggerGenerator::save(QSettings& settings) const
 {
     settings.setValue(m_name + "/mute", m_mute.load());
@@ -28,18 +28,81 @@ TriggerOscParameters::TriggerOscParameters()
 	, m_levelMessage()
 	, m_minLevelValue(0)
 	, m_maxLevelValue(1)
+	, m_routes(sound2osc::OSCRoutes::PRIMARY)
 	, m_labelText()
 {
 
 }
 
+void TriggerOscParameters::setOnMessage(const QString& value)
+{
+	const sound2osc::OSCPacketTemplate message(value);
+	QMutexLocker locker(&m_mutex);
+	m_onMessage = message;
+	publishLocked();
+}
+
+void TriggerOscParameters::setOffMessage(const QString& value)
+{
+	const sound2osc::OSCPacketTemplate message(value);
+	QMutexLocker locker(&m_mutex);
+	m_offMessage = message;
+	publishLocked();
+}
+
+void TriggerOscParameters::setLevelMessage(const QString& value)
+{
+	setLevel(&value, nullptr);
+}
+
+void TriggerOscParameters::setLevelValueType(sound2osc::OSCPacketTemplate::ValueType value)
+{
+	setLevel(nullptr, &value);
+}
+
+void TriggerOscParameters::setLevel(const QString* message, const sound2osc::OSCPacketTemplate::ValueType* valueType)
+{
+	QMutexLocker locker(&m_mutex);
+	for (;;) {
+		// the other part of the current Level message:
+		const QString text = message ? *message : m_levelMessage.message();
+		const sound2osc::OSCPacketTemplate::ValueType type = valueType ? *valueType : m_levelMessage.valueType();
+
+		locker.unlock();
+		const sound2osc::OSCPacketTemplate level(text, type);
+		locker.relock();
+
+		// encode again if another thread changed the other part in the meantime:
+		const bool changed = message ? type != m_levelMessage.valueType() : text != m_levelMessage.message();
+		if (changed) continue;
+		m_levelMessage = level;
+		publishLocked();
+		return;
+	}
+}
+
+void TriggerOscParameters::publishLocked()
+{
+	Messages& messages = m_published.back();
+	messages.on = m_onMessage;
+	messages.off = m_offMessage;
+	messages.level = m_levelMessage;
+	messages.minLevelValue = m_minLevelValue;
+	messages.maxLevelValue = m_maxLevelValue;
+	messages.routes = m_routes;
+	m_published.publish();
+}
+
 void TriggerOscParameters::save(const QString name, QSettings &settings) const
 {
-	settings.setValue(name + "/osc/onMessage", m_onMessage);
-	settings.setValue(name + "/osc/offMessage", m_offMessage);
-	settings.setValue(name + "/osc/levelMessage", m_levelMessage);
+	QMutexLocker locker(&m_mutex);
+	settings.setValue(name + "/osc/onMessage", m_onMessage.message());
+	settings.setValue(name + "/osc/offMessage", m_offMessage.message());
+	settings.setValue(name + "/osc/levelMessage", m_levelMessage.message());
+	settings.setValue(name + "/osc/levelType", sound2osc::OSCPacketTemplate::valueTypeName(m_levelMessage.valueType()));
 	settings.setValue(name + "/osc/minLevelValue", m_minLevelValue);
 	settings.setValue(name + "/osc/maxLevelValue", m_maxLevelValue);
+	settings.setValue(name + "/osc/routes", m_routes);
 	settings.setValue(name + "/osc/labelText", m_labelText);
 }
 
@@ -47,32 +110,48 @@ void TriggerOscParameters::restore(const QString name, QSettings &settings)
 {
 	setOnMessage(settings.value(name + "/osc/onMessage").toString());
 	setOffMessage(settings.value(name + "/osc/offMessage").toString());
+	setLevelValueType(sound2osc::OSCPacketTemplate::valueTypeFromName(settings.value(name + "/osc/levelType").toString()));
 	setLevelMessage(settings.value(name + "/osc/levelMessage").toString());
 	setMinLevelValue(settings.value(name + "/osc/minLevelValue").toReal());
 	setMaxLevelValue(settings.value(name + "/osc/maxLevelValue").toReal());
+	setRoutes(settings.value(name + "/osc/routes", sound2osc::OSCRoutes::PRIMARY).toUInt());
 	setLabelText(settings.value(name + "/osc/labelText").toString());
 }
 
 QJsonObject TriggerOscParameters::toState() const
 {
+    QMutexLocker locker(&m_mutex);
     QJsonObject state;
-    if (!m_onMessage.isEmpty()) state["onMessage"] = m_onMessage;
-    if (!m_offMessage.isEmpty()) state["offMessage"] = m_offMessage;
-    if (!m_levelMessage.isEmpty()) state["levelMessage"] = m_levelMessage;
+    if (!m_onMessage.isEmpty()) state["onMessage"] = m_onMessage.message();
+    if (!m_offMessage.isEmpty()) state["offMessage"] = m_offMessage.message();
+    if (!m_levelMessage.isEmpty()) state["levelMessage"] = m_levelMessage.message();
+    if (m_levelMessage.valueType() != sound2osc::OSCPacketTemplate::ValueType::Rounded) {
+        state["levelType"] = sound2osc::OSCPacketTemplate::valueTypeName(m_levelMessage.valueType());
+    }
     if (m_minLevelValue != 0.0) state["minLevelValue"] = m_minLevelValue;
     if (m_maxLevelValue != 1.0) state["maxLevelValue"] = m_maxLevelValue;
+    if (m_routes != sound2osc::OSCRoutes::PRIMARY) state["routes"] = static_cast<qint64>(m_routes);
     if (!m_labelText.isEmpty()) state["labelText"] = m_labelText;
     return state;
 }
 
 void TriggerOscParameters::fromState(const QJsonObject& state)
 {
-    m_onMessage = state["onMessage"].toString("");
-    m_offMessage = state["offMessage"].toString("");
-    m_levelMessage = state["levelMessage"].toString("");
+    // encoded before the mutex is locked:
+    const sound2osc::OSCPacketTemplate onMessage(state["onMessage"].toString(""));
+    const sound2osc::OSCPacketTemplate offMessage(state["offMessage"].toString(""));
+    const sound2osc::OSCPacketTemplate levelMessage(state["levelMessage"].toString(""),
+        sound2osc::OSCPacketTemplate::valueTypeFromName(state["levelType"].toString()));
+
+    QMutexLocker locker(&m_mutex);
+    m_onMessage = onMessage;
+    m_offMessage = offMessage;
+    m_levelMessage = levelMessage;
     m_minLevelValue = state["minLevelValue"].toDouble(0.0);
     m_maxLevelValue = state["maxLevelValue"].toDouble(1.0);
+    m_routes = static_cast<sound2osc::OSCRoutes::Mask>(state["routes"].toInteger(sound2osc::OSCRoutes::PRIMARY));
     m_labelText = state["labelText"].toString("");
+    publishLocked();
 }
 
 void TriggerOscParameters::resetParameters()
@@ -80,7 +159,9 @@ void TriggerOscParameters::resetParameters()
 	setOnMessage("");
 	setOffMessage("");
 	setLevelMessage("");
+	setLevelValueType(sound2osc::OSCPacketTemplate::ValueType::Rounded);
 	setMinLevelValue(0.0);
 	setMaxLevelValue(1.0);
+	setRoutes(sound2osc::OSCRoutes::PRIMARY);
 	setLabelText("");
 }
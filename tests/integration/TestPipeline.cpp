@@ -41,8 +41,17 @@ class TestPipeline : public QObject
     Q_OBJECT
 
 private slots:
+    void testFullPipeline_data()
+    {
+        QTest::addColumn<bool>("dedicatedThread");
+        QTest::newRow("event loop") << false;
+        QTest::newRow("dedicated thread") << true;
+    }
+
     void testFullPipeline()
     {
+        QFETCH(bool, dedicatedThread);
+
         // 1. Setup UDP Receiver (Mock OSC Target)
         QUdpSocket receiver;
         bool bound = receiver.bind(QHostAddress::LocalHost, 9000); // Use 9000 for test
@@ -63,7 +72,10 @@ private slots:
         auto mockInputPtr = std::make_unique<MockAudioInput>(engine.getAudioBuffer());
         MockAudioInput* mockInput = mockInputPtr.get();
         engine.setAudioInput(std::move(mockInputPtr));
-        
+
+        if (dedicatedThread) {
+            engine.setProcessingMode(sound2osc::Sound2OscEngine::ProcessingMode::DedicatedThread);
+        }
         engine.start();
         
         // Ensure Bass Trigger is sensitive
@@ -91,7 +103,12 @@ private slots:
             mockInput->pushData(chunk);
             
             // Process events to let Engine timers/slots fire
-            QCoreApplication::processEvents();
+            // (the processing thread sends its UDP output itself, without the event loop of this thread)
+            if (dedicatedThread) {
+                receiver.waitForReadyRead(5);
+            } else {
+                QCoreApplication::processEvents();
+            }
             
             // Check Receiver
             while (receiver.hasPendingDatagrams()) {
@@ -112,6 +129,208 @@ private slots:
         
         engine.stop();
     }
+
+    void testDisplaySnapshot()
+    {
+        // the GUI reads copies of the display data while the worker analyzes and even
+        // reallocates the flux history (sample rate change in the middle of the stream)
+        auto settings = std::make_shared<sound2osc::SettingsManager>();
+        settings->setOscEnabled(false);
+        sound2osc::Sound2OscEngine engine(settings);
+        auto mockInputPtr = std::make_unique<MockAudioInput>(engine.getAudioBuffer());
+        MockAudioInput* mockInput = mockInputPtr.get();
+        engine.setAudioInput(std::move(mockInputPtr));
+        engine.setProcessingMode(sound2osc::Sound2OscEngine::ProcessingMode::DedicatedThread);
+        engine.start();
+
+        const int chunkSize = 1024;
+        QVector<qreal> chunk(chunkSize);
+        int64_t position = 0;
+        int snapshots = 0;
+        while (position < 44100 * 8) {
+            if (position == chunkSize * 200) {
+                engine.getAudioBuffer()->setSampleRate(48000);
+            }
+            for (int i = 0; i < chunkSize; ++i) {
+                chunk[i] = 0.5 * qSin(2.0 * M_PI * 100.0 * static_cast<double>(position + i) / 44100.0);
+            }
+            mockInput->pushData(chunk);
+            position += chunkSize;
+
+            const auto& snapshot = engine.displaySnapshot();
+            QCOMPARE(snapshot.onsets.size(), snapshot.flux.size());
+            QCOMPARE(snapshot.colors.size(), snapshot.flux.size());
+            QVERIFY(static_cast<int>(snapshot.flux.size()) <= BPMDetector::maxHistoryLength());
+            if (!snapshot.spectrum.empty()) ++snapshots;
+            QThread::usleep(200);
+        }
+        engine.stop();
+
+        // the last analysis run is published as well
+        const auto& last = engine.displaySnapshot();
+        qDebug() << "Snapshots with a spectrum:" << snapshots << "flux frames:" << last.flux.size();
+        QVERIFY(snapshots > 0);
+        QCOMPARE(static_cast<int>(last.spectrum.size()), engine.fft()->getNormalizedSpectrum().size());
+        QVERIFY(!last.flux.empty());
+    }
+
+    void testReleaseOutputs_data()
+    {
+        QTest::addColumn<bool>("dedicatedThread");
+        QTest::addColumn<bool>("stall");
+        QTest::newRow("stop, event loop") << false << false;
+        QTest::newRow("stop, dedicated thread") << true << false;
+        QTest::newRow("stalled input, dedicated thread") << true << true;
+    }
+
+    void testReleaseOutputs()
+    {
+        // the max hold and off delay only end with new samples, an active output
+        // must still get its Off message when the input ends
+        QFETCH(bool, dedicatedThread);
+        QFETCH(bool, stall);
+
+        QUdpSocket receiver;
+        QVERIFY2(receiver.bind(QHostAddress::LocalHost, 9000), "Could not bind UDP receiver port 9000");
+
+        auto settings = std::make_shared<sound2osc::SettingsManager>();
+        settings->setOscIpAddress("127.0.0.1");
+        settings->setOscUdpTxPort(9000);
+        settings->setOscEnabled(true);
+        settings->setUseTcp(false);
+
+        sound2osc::Sound2OscEngine engine(settings);
+        auto mockInputPtr = std::make_unique<MockAudioInput>(engine.getAudioBuffer());
+        MockAudioInput* mockInput = mockInputPtr.get();
+        engine.setAudioInput(std::move(mockInputPtr));
+        if (dedicatedThread) {
+            engine.setProcessingMode(sound2osc::Sound2OscEngine::ProcessingMode::DedicatedThread);
+        }
+        engine.start();
+
+        TriggerGenerator* bass = engine.getBass();
+        bass->setThreshold(0.001);
+        bass->getOscParameters().setOnMessage("/bass/on");
+        bass->getOscParameters().setOffMessage("/bass/off");
+        bass->getTriggerFilter().setOnDelay(0.0);
+        bass->getTriggerFilter().setOffDelay(10.0);
+        bass->getTriggerFilter().setMaxHold(10.0);
+
+        TriggerBank* bank = engine.triggerBank();
+        const int band = bank->addBand("kick", 50);
+        bank->setThreshold(band, 0.001);
+        bank->setOnDelay(band, 0.0);
+        bank->setOffDelay(band, 10.0);
+        bank->setMaxHold(band, 10.0);
+
+        // 1 s of a 50 Hz sine, the level stays above the thresholds
+        const int chunkSize = 1024;
+        QVector<qreal> chunk(chunkSize);
+        for (int64_t position = 0; position < 44100; position += chunkSize) {
+            for (int i = 0; i < chunkSize; ++i) {
+                chunk[i] = qSin(2.0 * M_PI * 50.0 * static_cast<double>(position + i) / 44100.0);
+            }
+            mockInput->pushData(chunk);
+            QCoreApplication::processEvents();
+        }
+        QTRY_VERIFY(bass->getTriggerFilter().getOutputIsActive());
+        QTRY_VERIFY(bank->isOutputActive(band));
+
+        auto receive = [&receiver](QList<QByteArray>& addresses) {
+            while (receiver.hasPendingDatagrams() || receiver.waitForReadyRead(200)) {
+                const QByteArray data = receiver.receiveDatagram().data();
+                addresses.append(data.left(data.indexOf('\0')));
+            }
+        };
+        QList<QByteArray> addresses;
+        receive(addresses);
+        QVERIFY(addresses.contains("/bass/on"));
+        QVERIFY(!addresses.contains("/bass/off"));
+
+        if (stall) {
+            // no stop(), the input just delivers no more samples
+            QTRY_VERIFY_WITH_TIMEOUT(!bass->getTriggerFilter().getOutputIsActive(),
+                                     3 * sound2osc::Sound2OscEngine::INPUT_STALL_TIMEOUT);
+            QTRY_VERIFY(!bank->isOutputActive(band));
+        } else {
+            engine.stop();
+            QVERIFY(!bass->getTriggerFilter().getOutputIsActive());
+            QVERIFY(!bank->isOutputActive(band));
+        }
+
+        addresses.clear();
+        receive(addresses);
+        qDebug() << "Messages after the release:" << addresses;
+        QVERIFY(addresses.contains("/bass/off"));
+        QVERIFY(addresses.contains("/sound2osc/out/band/kick/trigger"));
+
+        engine.stop();
+    }
+
+    void testBeatTicks_data()
+    {
+        QTest::addColumn<int>("latency");
+        QTest::newRow("no latency") << 0;
+        QTest::newRow("200 ms latency") << 200;
+    }
+
+    void testBeatTicks()
+    {
+        QFETCH(int, latency);
+
+        QUdpSocket receiver;
+        QVERIFY2(receiver.bind(QHostAddress::LocalHost, 9000), "Could not bind UDP receiver port 9000");
+
+        auto settings = std::make_shared<sound2osc::SettingsManager>();
+        settings->setOscIpAddress("127.0.0.1");
+        settings->setOscUdpTxPort(9000);
+        settings->setOscEnabled(true);
+        settings->setUseTcp(false);
+        settings->setOscBeatEnabled(true);
+        settings->setOscBeatLatency(latency);
+
+        sound2osc::Sound2OscEngine engine(settings);
+        auto mockInputPtr = std::make_unique<MockAudioInput>(engine.getAudioBuffer());
+        MockAudioInput* mockInput = mockInputPtr.get();
+        engine.setAudioInput(std::move(mockInputPtr));
+        engine.start();
+
+        // 120 BPM kick drum, the kicks start at sample 0 of the input
+        const int sampleRate = 44100;
+        const int beatInterval = sampleRate / 2;
+        const int kickLength = sampleRate / 22;
+        const int chunkSize = 1024;
+        int64_t position = 0;
+        int ticks = 0;
+        int maxError = 0;
+        QVector<qreal> chunk(chunkSize);
+        while (position < sampleRate * 12) {
+            for (int i = 0; i < chunkSize; ++i) {
+                const int positionInBeat = static_cast<int>((position + i) % beatInterval);
+                chunk[i] = positionInBeat < kickLength
+                    ? qSin(2.0 * M_PI * 100.0 * positionInBeat / sampleRate) * (1.0 - static_cast<double>(positionInBeat) / kickLength)
+                    : 0.0;
+            }
+            mockInput->pushData(chunk);
+            position += chunkSize;
+            QCoreApplication::processEvents();
+
+            // a tick is sent the processing delay and the latency ahead of its beat
+            // (the analysis runs right after each chunk, so the processing delay is below a hop)
+            while (receiver.hasPendingDatagrams()) {
+                if (!receiver.receiveDatagram().data().startsWith("/sound2osc/beat")) continue;
+                const int64_t beat = position + static_cast<int64_t>(latency) * sampleRate / 1000;
+                const int64_t error = beat - (beat + beatInterval / 2) / beatInterval * beatInterval;
+                maxError = qMax(maxError, static_cast<int>(qAbs(error)));
+                ++ticks;
+            }
+        }
+        engine.stop();
+
+        qDebug() << "Beat ticks:" << ticks << "max error:" << maxError << "samples";
+        QVERIFY(ticks >= 6);
+        QVERIFY(maxError < 2500);  // two hops and the error of the tracker, 200 ms are 8820 samples
+    }
 };
 
 QTEST_GUILESS_MAIN(TestPipeline)
@@ -0,0 +1,359 @@
+#include <QtTest>
+#include "sound2osc/audio/MonoAudioBuffer.h"
+#include "sound2osc/audio/SampleConversion.h"
+#include "sound2osc/core/RingBuffer.h"
+#include "sound2osc/core/HopScheduler.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using sound2osc::RingBuffer;
+using sound2osc::HopScheduler;
+namespace SampleConversion = sound2osc::SampleConversion;
+
+class TestAudio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRingBufferInitiallyZero()
+    {
+        RingBuffer<double> ring(100);
+        QCOMPARE(ring.capacity(), 100);
+        QCOMPARE(ring.writePosition(), int64_t(0));
+
+        // the window before the first write reads as silence:
+        std::vector<double> out(100, 1.0);
+        QVERIFY(ring.copy(-100, 100, out.data()));
+        for (double value : out) {
+            QCOMPARE(value, 0.0);
+        }
+    }
+
+    void testRingBufferWrap()
+    {
+        RingBuffer<double> ring(100);
+        std::vector<double> data(70);
+        double next = 0.0;
+
+        // write more than the storage size to wrap around several times:
+        for (int chunk = 0; chunk < 20; ++chunk) {
+            for (double& value : data) value = next++;
+            ring.write(data.data(), static_cast<int>(data.size()));
+        }
+        QCOMPARE(ring.writePosition(), int64_t(1400));
+
+        std::vector<double> out(100);
+        const int64_t start = ring.copyLatest(100, out.data());
+        QCOMPARE(start, int64_t(1300));
+        for (int i = 0; i < 100; ++i) {
+            QCOMPARE(out[static_cast<std::size_t>(i)], 1300.0 + i);
+        }
+        QCOMPARE(ring.at(1399), 1399.0);
+    }
+
+    void testRingBufferLargeWrite()
+    {
+        // a single write larger than the storage keeps the newest elements:
+        RingBuffer<double> ring(10);
+        std::vector<double> data(1000);
+        for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<double>(i);
+        ring.write(data.data(), static_cast<int>(data.size()));
+
+        std::vector<double> out(10);
+        QCOMPARE(ring.copyLatest(10, out.data()), int64_t(990));
+        QCOMPARE(out.front(), 990.0);
+        QCOMPARE(out.back(), 999.0);
+    }
+
+    void testSnapshotSpans()
+    {
+        RingBuffer<double> ring(8);  // storage of 16 elements
+        std::vector<double> data(12);
+        for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<double>(i);
+        ring.write(data.data(), 12);
+        ring.write(data.data(), 8);  // positions 12..19 wrap around the storage end
+
+        const auto view = ring.latest(8);
+        QVERIFY(view.valid);
+        QCOMPARE(view.start, int64_t(12));
+        QCOMPARE(view.size(), 8);
+        QCOMPARE(view.firstSize, 4);
+        QCOMPARE(view.secondSize, 4);
+        QCOMPARE(view.first[0], 0.0);
+        QCOMPARE(view.second[3], 7.0);
+        QVERIFY(ring.isIntact(view));
+
+        // overwriting the viewed range invalidates the snapshot:
+        ring.write(data.data(), 4);
+        QVERIFY(!ring.isIntact(view));
+    }
+
+    void testSnapshotOutOfRange()
+    {
+        RingBuffer<double> ring(8);
+        std::vector<double> data(20, 1.0);
+        ring.write(data.data(), 20);
+
+        double out[8];
+        QVERIFY(!ring.snapshot(11, 8).valid);  // too old
+        QVERIFY(!ring.snapshot(14, 8).valid);  // not yet written
+        QVERIFY(!ring.snapshot(12, 9).valid);  // larger than the capacity
+        QVERIFY(!ring.copy(0, 8, out));
+        QVERIFY(ring.copy(12, 8, out));
+    }
+
+    void testConcurrentReader()
+    {
+        // the writer produces a ramp, every window a reader copies must be a
+        // contiguous part of it (i.e. no torn reads):
+        RingBuffer<double> ring(1024);
+        std::atomic<bool> done{false};
+        std::atomic<int> tornReads{0};
+        std::atomic<int> reads{0};
+
+        std::thread reader([&] {
+            std::vector<double> out(512);
+            while (!done.load()) {
+                const int64_t start = ring.copyLatest(512, out.data());
+                if (start < 0) continue;
+                for (std::size_t i = 0; i < out.size(); ++i) {
+                    if (out[i] != static_cast<double>(start) + static_cast<double>(i)) {
+                        tornReads++;
+                        break;
+                    }
+                }
+                reads++;
+            }
+        });
+
+        std::vector<double> chunk(256);
+        double next = 0.0;
+        for (int n = 0; n < 4000 || reads.load() < 10; ++n) {
+            for (double& value : chunk) value = next++;
+            ring.write(chunk.data(), static_cast<int>(chunk.size()));
+            if (n % 64 == 0) std::this_thread::yield();
+        }
+        done = true;
+        reader.join();
+
+        QCOMPARE(tornReads.load(), 0);
+    }
+
+    void testMonoAudioBufferPositions()
+    {
+        MonoAudioBuffer buffer(16);
+        QVector<qreal> samples;
+        for (int i = 0; i < 20; ++i) samples.append(i);
+        buffer.putSamples(samples, 1);
+
+        QCOMPARE(buffer.getNumPutSamples(), int64_t(20));
+        QCOMPARE(buffer.at(0), 4.0f);  // oldest sample in the window
+        QCOMPARE(buffer.at(15), 19.0f);
+
+        float out[4];
+        QVERIFY(buffer.copySamples(10, 4, out));
+        QCOMPARE(out[0], 10.0f);
+        QCOMPARE(out[3], 13.0f);
+        QVERIFY(!buffer.copySamples(2, 4, out));
+        QCOMPARE(buffer.copyLatestSamples(4, out), int64_t(16));
+        QCOMPARE(out[3], 19.0f);
+    }
+
+    void testMonoAudioBufferDownmix()
+    {
+        MonoAudioBuffer buffer(8);
+        QVector<qreal> stereo = {1.0, 0.0, 0.5, 0.5, -1.0, 1.0};
+        buffer.putSamples(stereo, 2);
+
+        QCOMPARE(buffer.getNumPutSamples(), int64_t(3));
+        float out[3];
+        QVERIFY(buffer.copySamples(0, 3, out));
+        QCOMPARE(out[0], 0.5f);
+        QCOMPARE(out[1], 0.5f);
+        QCOMPARE(out[2], 0.0f);
+    }
+
+    void testPutInterleavedFormats()
+    {
+        MonoAudioBuffer buffer(16);
+        float out[2];
+
+        const float floats[] = {0.5f, -0.5f, 1.0f, 0.0f};
+        buffer.putInterleaved(floats, 2, 2);
+        QVERIFY(buffer.copySamples(0, 2, out));
+        QCOMPARE(out[0], 0.0f);
+        QCOMPARE(out[1], 0.5f);
+
+        const int16_t shorts[] = {16384, -32768};
+        buffer.putInterleaved(shorts, 2, 1);
+        QVERIFY(buffer.copySamples(2, 2, out));
+        QCOMPARE(out[0], 0.5f);
+        QCOMPARE(out[1], -1.0f);
+
+        const int32_t ints[] = {1073741824, 1073741824, 0, -1073741824};
+        buffer.putInterleaved(ints, 2, 2);
+        QVERIFY(buffer.copySamples(4, 2, out));
+        QCOMPARE(out[0], 0.5f);
+        QCOMPARE(out[1], -0.25f);
+
+        const uint8_t bytes[] = {128, 192, 64, 0, 255, 128};
+        buffer.putInterleaved(bytes, 2, 3);
+        QVERIFY(buffer.copySamples(6, 2, out));
+        QCOMPARE(out[0], 0.0f);
+        // converted with single precision:
+        QCOMPARE(out[1], (127.0f / 128.0f + 0.0f - 1.0f) / 3.0f);
+
+        QCOMPARE(buffer.getNumPutSamples(), int64_t(8));
+    }
+
+    void testPutInterleavedWrapsAroundStorage()
+    {
+        // chunks larger than the free space are split and still downmixed correctly:
+        MonoAudioBuffer buffer(4);
+        std::vector<float> stereo;
+        for (int i = 0; i < 50; ++i) {
+            stereo.push_back(static_cast<float>(i));
+            stereo.push_back(static_cast<float>(i) + 1.0f);
+        }
+        buffer.putInterleaved(stereo.data(), 50, 2);
+
+        float out[4];
+        QCOMPARE(buffer.copyLatestSamples(4, out), int64_t(46));
+        QCOMPARE(out[0], 46.5f);
+        QCOMPARE(out[3], 49.5f);
+    }
+
+    void testSimdConversionMatchesScalar_data()
+    {
+        QTest::addColumn<int>("channelCount");
+        QTest::addColumn<int>("frameCount");
+
+        // odd frame counts exercise the scalar tails of the vector loops:
+        for (int channels : {1, 2, 3, 4, 6, 8, 12}) {
+            for (int frames : {1, 7, 513}) {
+                QTest::newRow(qPrintable(QString("%1ch %2 frames").arg(channels).arg(frames))) << channels << frames;
+            }
+        }
+    }
+
+    void testSimdConversionMatchesScalar()
+    {
+        QFETCH(int, channelCount);
+        QFETCH(int, frameCount);
+
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> distribution(-32768, 32767);
+        const std::size_t sampleCount = static_cast<std::size_t>(frameCount * channelCount);
+        std::vector<int16_t> shorts(sampleCount);
+        std::vector<int32_t> ints(sampleCount);
+        std::vector<uint8_t> bytes(sampleCount);
+        std::vector<float> floats(sampleCount);
+        for (std::size_t i = 0; i < sampleCount; ++i) {
+            const int value = distribution(rng);
+            shorts[i] = static_cast<int16_t>(value);
+            ints[i] = value * 65536;
+            bytes[i] = static_cast<uint8_t>((value + 32768) >> 8);
+            floats[i] = static_cast<float>(value) / 32768.0f;
+        }
+
+        const auto convertAll = [&](std::vector<float>& out) {
+            out.assign(static_cast<std::size_t>(frameCount) * 4, 0.0f);
+            SampleConversion::interleavedToMono(shorts.data(), frameCount, channelCount, out.data());
+            SampleConversion::interleavedToMono(ints.data(), frameCount, channelCount, out.data() + frameCount);
+            SampleConversion::interleavedToMono(bytes.data(), frameCount, channelCount, out.data() + 2 * frameCount);
+            SampleConversion::interleavedToMono(floats.data(), frameCount, channelCount, out.data() + 3 * frameCount);
+        };
+
+        std::vector<float> simd;
+        std::vector<float> scalar;
+        convertAll(simd);
+        SampleConversion::setSimdEnabled(false);
+        convertAll(scalar);
+        SampleConversion::setSimdEnabled(true);
+
+        for (std::size_t i = 0; i < simd.size(); ++i) {
+            // summation order differs between the kernels:
+            QVERIFY2(qAbs(simd[i] - scalar[i]) < 1e-6f, qPrintable(QString("index %1 (%2)").arg(i).arg(SampleConversion::kernelName())));
+        }
+    }
+
+    void testHopSchedulerIndependentOfCallbackSize_data()
+    {
+        QTest::addColumn<int>("callbackSize");
+        QTest::newRow("64") << 64;
+        QTest::newRow("999") << 999;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("4096") << 4096;
+    }
+
+    void testHopSchedulerIndependentOfCallbackSize()
+    {
+        QFETCH(int, callbackSize);
+
+        const int64_t first = 123;  // the stream doesn't start at a multiple of the hop
+        const int hop = 1000;
+        HopScheduler scheduler(hop);
+        scheduler.reset(first);
+
+        // the hops are at exact multiples of the hop size, no matter how the samples arrive,
+        // and each one is returned by the first callback that contains its end:
+        QVector<int64_t> hops;
+        int64_t hopEnd = 0;
+        int64_t lastPosition = first;
+        for (int64_t position = first + callbackSize; position <= first + 20000; position += callbackSize) {
+            while (scheduler.next(position, hopEnd)) {
+                QVERIFY(hopEnd > lastPosition && hopEnd <= position);
+                hops.append(hopEnd);
+            }
+            lastPosition = position;
+        }
+        QCOMPARE(hops.size(), static_cast<int>((lastPosition - first) / hop));
+        for (int i = 0; i < hops.size(); ++i) {
+            QCOMPARE(hops[i], first + int64_t(i + 1) * hop);
+        }
+        QCOMPARE(scheduler.nextPosition(), first + int64_t(hops.size() + 1) * hop);
+        QCOMPARE(scheduler.skippedHops(), uint64_t(0));
+    }
+
+    void testHopSchedulerMaxLag()
+    {
+        HopScheduler scheduler(100);
+        scheduler.setMaxLag(250);
+        scheduler.reset(0);
+
+        // far behind: the oldest hops are skipped in whole hops, the phase is kept
+        int64_t hopEnd = 0;
+        QVERIFY(scheduler.next(1000, hopEnd));
+        QCOMPARE(hopEnd, int64_t(800));
+        QCOMPARE(scheduler.skippedHops(), uint64_t(7));
+        QVERIFY(scheduler.next(1000, hopEnd));
+        QCOMPARE(hopEnd, int64_t(900));
+        QVERIFY(scheduler.next(1000, hopEnd));
+        QCOMPARE(hopEnd, int64_t(1000));
+        QVERIFY(!scheduler.next(1000, hopEnd));
+        QVERIFY(!scheduler.isDue(1099));
+        QVERIFY(scheduler.isDue(1100));
+    }
+
+    void testHopSchedulerHopSizeChange()
+    {
+        HopScheduler scheduler(100);
+        scheduler.reset(50);
+        int64_t hopEnd = 0;
+        QVERIFY(scheduler.next(150, hopEnd));
+        QCOMPARE(hopEnd, int64_t(150));
+
+        // the next hop is relative to the last one
+        scheduler.setHopSize(40);
+        QCOMPARE(scheduler.nextPosition(), int64_t(190));
+        QVERIFY(scheduler.next(200, hopEnd));
+        QCOMPARE(hopEnd, int64_t(190));
+        QVERIFY(!scheduler.next(200, hopEnd));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestAudio)
+#include "TestAudio.moc"
@@ -3,8 +3,105 @@
 #include <QRandomGenerator>
 #include "sound2osc/bpm/BPMDetector.h"
 #include "sound2osc/bpm/BPMOscControler.h"
+#include "sound2osc/bpm/TempoAutocorrelation.h"
+#include "sound2osc/bpm/BeatTracker.h"
+#include "sound2osc/bpm/OnsetBand.h"
+#include "sound2osc/bpm/OnsetStream.h"
 #include "sound2osc/audio/MonoAudioBuffer.h"
 #include "sound2osc/osc/OSCNetworkManager.h"
+#include <QNetworkDatagram>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Feeds a kick drum (a decaying 100 Hz sine, 120 BPM by default) with some noise to the buffer
+// in chunks of 1024 samples at the sample rate of the buffer and calls analyze after each chunk.
+// The kicks start at sample 0 of the buffer. With withHihat a hi-hat (high passed noise burst)
+// plays on the off-beats. The noise is seeded, so every run gets the same signal.
+void feedKickDrum(MonoAudioBuffer& buffer, int seconds, bool withHihat, unsigned int seed,
+                  const std::function<void()>& analyze, float bpm = 120.0f)
+{
+    const int sampleRate = buffer.getSampleRate();
+    const int beatInterval = static_cast<int>(static_cast<float>(sampleRate) * 60.0f / bpm);
+    const int kickLength = sampleRate / 22;
+    const int hihatLength = sampleRate / 73;
+    const int chunkSize = 1024;
+    QVector<float> chunk(chunkSize);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    float lastNoise = 0.0f;
+
+    for (int currentSample = 0; currentSample < sampleRate * seconds; currentSample += chunkSize) {
+        for (int i = 0; i < chunkSize; ++i) {
+            const int positionInBeat = (currentSample + i) % beatInterval;
+            float sample = 0.0f;
+            if (positionInBeat < kickLength) {
+                const float t = static_cast<float>(positionInBeat) / sampleRate;
+                sample = qSin(2.0f * M_PI * 100.0f * t);
+                sample *= qMax(0.0f, 1.0f - static_cast<float>(positionInBeat) / kickLength);
+            }
+            const int positionInOffBeat = (currentSample + i + beatInterval / 2) % beatInterval;
+            if (withHihat && positionInOffBeat < hihatLength) {
+                const float value = noise(random);
+                sample += (value - lastNoise) * 0.15f * (1.0f - static_cast<float>(positionInOffBeat) / hihatLength);
+                lastNoise = value;
+            }
+            sample += noise(random) * 0.05f;
+            chunk[i] = sample;
+        }
+        buffer.putSamples(chunk, 1);
+        analyze();
+    }
+}
+
+// Runs the detection after each chunk of the kick drum above
+void feedKickDrum(MonoAudioBuffer& buffer, BPMDetector& detector, int seconds, bool withHihat = false,
+                  unsigned int seed = 1, float bpm = 120.0f)
+{
+    feedKickDrum(buffer, seconds, withHihat, seed, [&detector]() { detector.detectBPM(); }, bpm);
+}
+
+// Receives the bundles of the analysis frames and returns the time tag of each beat tick relative to
+// the time tag of its frame in seconds (each tick is a bundle of its own within the frame)
+QList<double> receiveBeatTicks(QUdpSocket& socket)
+{
+    const QByteArray bundleHeader("#bundle", 8);
+    QList<double> delays;
+    while (socket.hasPendingDatagrams()) {
+        const QByteArray frame = socket.receiveDatagram().data();
+        if (!frame.startsWith(bundleHeader)) continue;
+        const quint64 frameTimeTag = qFromBigEndian<quint64>(frame.constData() + 8);
+        qsizetype offset = 16;
+        while (offset + 4 <= frame.size()) {
+            const qsizetype size = qFromBigEndian<qint32>(frame.constData() + offset);
+            const QByteArray element = frame.mid(offset + 4, size);
+            offset += 4 + size;
+            if (element.startsWith(bundleHeader) && element.mid(20).startsWith("/sound2osc/beat")) {
+                const quint64 timeTag = qFromBigEndian<quint64>(element.constData() + 8);
+                delays.append(static_cast<double>(static_cast<qint64>(timeTag - frameTimeTag)) / 4294967296.0);
+            }
+        }
+    }
+    return delays;
+}
+
+// True if one of the pending datagrams of the socket contains a beat tick
+bool receivedBeatTick(QUdpSocket& socket)
+{
+    bool received = false;
+    while (socket.hasPendingDatagrams()) {
+        received = socket.receiveDatagram().data().contains("/sound2osc/beat") || received;
+    }
+    return received;
+}
+
+} // namespace
 
 class TestBPM : public QObject
 {
@@ -79,6 +176,348 @@ private slots:
         QVERIFY(detected > 110.0f && detected < 130.0f);
     }
 
+    void testBPMDetectionAtSampleRate_data()
+    {
+        QTest::addColumn<int>("sampleRate");
+        QTest::newRow("48kHz") << 48000;
+        QTest::newRow("96kHz") << 96000;
+    }
+
+    void testBPMDetectionAtSampleRate()
+    {
+        QFETCH(int, sampleRate);
+
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096 * 4);
+        buffer.setSampleRate(sampleRate);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+
+        // 120 BPM kick with the same duration at every sample rate
+        feedKickDrum(buffer, bpmDetector, 10);
+
+        const float detected = bpmDetector.getBPM();
+        qDebug() << "Detected BPM at" << sampleRate << "Hz:" << detected;
+        QVERIFY(detected > 110.0f && detected < 130.0f);
+    }
+
+    void testTempoAutocorrelation()
+    {
+        // pulse train with an interval of 86.13 frames (120 BPM at 44.1 kHz / 256) and some noise
+        const int length = 860;
+        std::vector<float> signal(length);
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> noise(0.0f, 0.3f);
+        for (int i = 0; i < length; ++i) {
+            signal[i] = noise(random);
+        }
+        for (double t = 7.3; t < length; t += 86.13) {
+            signal[static_cast<int>(t)] += 3.0f;
+        }
+
+        sound2osc::TempoAutocorrelation autocorrelation;
+        autocorrelation.setFormat(length, 34, 207);
+        const auto& candidates = autocorrelation.analyze(signal.data());
+        QVERIFY(!candidates.empty());
+        QVERIFY(static_cast<int>(candidates.size()) <= sound2osc::TempoAutocorrelation::MAX_CANDIDATES);
+        for (size_t i = 1; i < candidates.size(); ++i) {
+            QVERIFY(candidates[i - 1].score >= candidates[i].score);
+        }
+        qDebug() << "Strongest interval:" << candidates.front().interval;
+        QVERIFY(qAbs(candidates.front().interval - 86.13f) < 1.0f);
+        QCOMPARE(autocorrelation.autocorrelation().front(), 1.0f);
+
+        // a silent signal has no candidates
+        std::fill(signal.begin(), signal.end(), 0.0f);
+        QVERIFY(autocorrelation.analyze(signal.data()).empty());
+    }
+
+    void testBPMDetectionWithAutocorrelation()
+    {
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+        bpmDetector.setTempoEstimator(BPMDetector::TempoEstimator::Autocorrelation);
+
+        // 120 BPM kick for 10 seconds
+        feedKickDrum(buffer, bpmDetector, 10);
+
+        const float detected = bpmDetector.getBPM();
+        qDebug() << "Detected BPM with autocorrelation:" << detected;
+        QVERIFY(detected > 115.0f && detected < 125.0f);
+    }
+
+    void testAutocorrelationWithHihat_data()
+    {
+        QTest::addColumn<unsigned int>("seed");
+        QTest::newRow("seed 1") << 1u;
+        QTest::newRow("seed 2") << 2u;
+        QTest::newRow("seed 3") << 3u;
+    }
+
+    void testAutocorrelationWithHihat()
+    {
+        // The beat interval at 160 BPM is not a whole number of flux frames, so the
+        // single frame peaks of the kicks miss the lags of the comb. Without the
+        // widened onset strength the estimate was 106.6 BPM (2/3) or none at all.
+        QFETCH(unsigned int, seed);
+
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+        bpmDetector.setTempoEstimator(BPMDetector::TempoEstimator::Autocorrelation);
+        bpmDetector.setMinBPM(0);  // no folding into 75 ... 150 BPM, like BenchTempo
+
+        // 160 BPM kick with hi-hat eighths for 12 seconds
+        feedKickDrum(buffer, bpmDetector, 12, true, seed, 160.0f);
+
+        const float detected = bpmDetector.getBPM();
+        qDebug() << "Detected BPM with autocorrelation:" << detected;
+        QVERIFY(detected > 155.0f && detected < 165.0f);
+    }
+
+    void testOnsetsOfKicks()
+    {
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+
+        // 120 BPM kick for 10 seconds, the onsets are evaluated incrementally with every call
+        feedKickDrum(buffer, bpmDetector, 10);
+
+        // the history of five seconds contains about ten kicks, one onset each
+        const auto& onsets = bpmDetector.getOnsets();
+        QCOMPARE(onsets.size(), bpmDetector.getWaveDisplay().size());
+        int count = 0;
+        int lastOnset = -1;
+        int minDistance = onsets.size();
+        for (int i = 0; i < onsets.size(); ++i) {
+            if (!onsets.at(i)) continue;
+            if (lastOnset >= 0) minDistance = qMin(minDistance, i - lastOnset);
+            lastOnset = i;
+            ++count;
+        }
+        qDebug() << "Onsets:" << count << "min distance:" << minDistance << "frames";
+        QVERIFY(count >= 8 && count <= 12);
+        QVERIFY(minDistance > onsets.size() / 20);  // more than a quarter second at 5 seconds
+
+        bpmDetector.resetCache();
+        QVERIFY(bpmDetector.getOnsets().isEmpty());
+    }
+
+    void testOnsetStreamMaximum()
+    {
+        // the running maximum equals the largest flux of the history, also after the
+        // loudest frame left it and after a reset
+        sound2osc::OnsetStream stream(50);
+        QCOMPARE(stream.maximum(), 0.0f);
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        for (int i = 0; i < 500; ++i) {
+            if (i == 260) stream.reset();
+            stream.add(uniform(random) * uniform(random));
+            stream.update();
+            float max = 0.0f;
+            for (int k = 0; k < stream.flux().size(); ++k) {
+                max = qMax(max, stream.flux()[k]);
+            }
+            QCOMPARE(stream.maximum(), max);
+        }
+    }
+
+    void testBandOnsets()
+    {
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+        QList<sound2osc::OnsetBand> bands;
+        bands.append({ QStringLiteral("kick"), 30, 150 });
+        bands.append({ QStringLiteral("hihat"), 6000, 16000 });
+        bpmDetector.setOnsetBands(bands);
+
+        // 120 BPM kick with a hi-hat on the off-beats for 10 seconds
+        feedKickDrum(buffer, bpmDetector, 10, true, 7);
+
+        // each band has about ten onsets in the history of five seconds, the kicks are
+        // half a beat away from the hi-hats
+        QCOMPARE(bpmDetector.getBandCount(), 2);
+        const auto& kicks = bpmDetector.getBandOnsets(0);
+        const auto& hihats = bpmDetector.getBandOnsets(1);
+        QCOMPARE(kicks.size(), bpmDetector.getWaveDisplay().size());
+        const int halfBeat = kicks.size() / 20;  // frames of a quarter second at 5 seconds
+        int kickCount = 0;
+        int hihatCount = 0;
+        for (int i = 0; i < kicks.size(); ++i) {
+            if (kicks.at(i)) {
+                ++kickCount;
+                for (int k = qMax(0, i - halfBeat / 2); k < qMin(hihats.size(), i + halfBeat / 2); ++k) {
+                    QVERIFY(!hihats.at(k));
+                }
+            }
+            if (hihats.at(i)) ++hihatCount;
+        }
+        qDebug() << "Band onsets: kick" << kickCount << "hihat" << hihatCount;
+        QVERIFY(kickCount >= 8 && kickCount <= 12);
+        QVERIFY(hihatCount >= 8 && hihatCount <= 12);
+
+        // the bands are applied with the next detection run
+        bpmDetector.setOnsetBands({});
+        bpmDetector.detectBPM();
+        QCOMPARE(bpmDetector.getBandCount(), 0);
+    }
+
+    void testOnsetBandNames()
+    {
+        // the name is a part of the OSC path of the onsets
+        QVERIFY(sound2osc::OnsetBand::isValidName(QStringLiteral("kick")));
+        QVERIFY(sound2osc::OnsetBand::isValidName(QStringLiteral("sub-bass_2")));
+        const QStringList invalidNames { "", "hi hat", "hi/hat", "hat=1", "a,b", "hat*", "[x]", "#1" };
+        for (const QString& name : invalidNames) {
+            QVERIFY2(!sound2osc::OnsetBand::isValidName(name), qPrintable(name));
+        }
+
+        const sound2osc::OnsetBand kick { QStringLiteral("kick"), 30, 150 };
+        QCOMPARE(sound2osc::OnsetBand::fromVariant(kick.toVariant()), kick);
+        QVariantMap map = kick.toVariant();
+        map["name"] = QStringLiteral("kick/2");
+        const sound2osc::OnsetBand invalid = sound2osc::OnsetBand::fromVariant(map);
+        QVERIFY(invalid.name.isEmpty());
+        QVERIFY(!invalid.isValid());
+
+        // the detector ignores invalid bands
+        OSCNetworkManager osc;
+        BPMOscControler bpmOsc(osc);
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+        bpmDetector.setOnsetBands({ kick, { QStringLiteral("hi hat"), 6000, 16000 } });
+        bpmDetector.detectBPM();
+        QCOMPARE(bpmDetector.getBandCount(), 1);
+    }
+
+    void testBeatTracker()
+    {
+        // strong onsets on the beats and weak off-beats, +-150 samples of jitter, a tempo
+        // that is 1% off and onsets that are reported 4000 samples late (like the detection)
+        const double interval = 22050.0;
+        const double firstBeat = 5000.0;
+        const double onsetDelay = 4000.0;
+        const double hop = 1002.0;
+        const double lead = 3000.0;
+        std::mt19937 random(5);
+        std::normal_distribution<double> jitter(0.0, 150.0);
+        std::vector<std::pair<double, float>> onsets;
+        for (int beat = 0; beat < 100; ++beat) {
+            const double position = firstBeat + beat * interval;
+            onsets.emplace_back(position + jitter(random), 3.0f);
+            onsets.emplace_back(position + interval / 2 + jitter(random), 1.0f);
+        }
+
+        sound2osc::BeatTracker tracker;
+        tracker.setInterval(interval * 1.01);
+        QVERIFY(!tracker.isLocked());
+
+        std::size_t nextOnset = 0;
+        int beats = 0;
+        double lastBeat = -1.0;
+        double maxError = 0.0;
+        for (double position = 0.0; position < 100 * interval; position += hop) {
+            while (nextOnset < onsets.size() && onsets[nextOnset].first + onsetDelay <= position) {
+                tracker.addOnset(onsets[nextOnset].first, onsets[nextOnset].second);
+                ++nextOnset;
+            }
+            double beat = 0.0;
+            while (tracker.takeBeat(position, position + lead + hop / 2, beat)) {
+                QVERIFY(beat >= position);  // never late
+                QVERIFY(beat > lastBeat);  // every beat once
+                lastBeat = beat;
+                if (position < 20 * interval) continue;
+
+                // on the beats, not on the off-beats
+                const double error = beat - (firstBeat + qRound((beat - firstBeat) / interval) * interval);
+                maxError = qMax(maxError, qAbs(error));
+                ++beats;
+            }
+        }
+        qDebug() << "Predicted beats:" << beats << "max error:" << maxError << "samples";
+        QVERIFY(tracker.isLocked());
+        QVERIFY(qAbs(tracker.interval() - interval) < 0.01 * interval);
+        QVERIFY(beats >= 78 && beats <= 81);
+        QVERIFY(maxError < 0.02 * interval);
+
+        // without a tempo there are no beats
+        tracker.setInterval(0.0);
+        QVERIFY(!tracker.isLocked());
+        double beat = 0.0;
+        QVERIFY(!tracker.takeBeat(0.0, 200 * interval, beat));
+    }
+
+    void testBeatTicks()
+    {
+        // the ticks go to the destinations of the BPM commands, here only to destination 1
+        QUdpSocket primary;
+        QUdpSocket destination;
+        QVERIFY(primary.bind(QHostAddress::LocalHost, 9010));
+        QVERIFY(destination.bind(QHostAddress::LocalHost, 9011));
+        OSCNetworkManager osc;
+        osc.setIpAddress(QHostAddress(QHostAddress::LocalHost));
+        osc.setUdpTxPort(9010);
+        sound2osc::OSCDestination target;
+        target.port = 9011;
+        osc.setDestinations({ target });
+        osc.setBundleFrames(true);
+        osc.setEnabled(true);
+        BPMOscControler bpmOsc(osc);
+        bpmOsc.setRoutes(sound2osc::OSCRoutes::forDestination(1));
+        MonoAudioBuffer buffer(4096);
+        BPMDetector bpmDetector(buffer, &bpmOsc);
+        bpmDetector.setTransmitBeats(true);
+        const int lead = 3000;  // the beat at the analyzed position + lead is due now
+        bpmDetector.setBeatLead(lead);
+
+        // every call is a bundled frame like in Sound2OscEngine, muted after 12 seconds
+        const int sampleRate = buffer.getSampleRate();
+        const int beatInterval = sampleRate / 2;
+        int64_t lastPosition = 0;
+        int ticks = 0;
+        int mutedTicks = 0;
+        double minDelay = 1.0;
+        double maxDelayInHops = 0.0;
+        double maxError = 0.0;
+        feedKickDrum(buffer, 14, false, 1, [&]() {
+            const int64_t position = buffer.getNumPutSamples();
+            if (position >= 12 * sampleRate && !bpmOsc.getBPMMute()) bpmOsc.setBPMMute(true);
+            osc.beginFrame();
+            bpmDetector.detectBPM(position);
+            osc.endFrame();
+
+            for (const double delay : receiveBeatTicks(destination)) {
+                if (bpmOsc.getBPMMute()) {
+                    ++mutedTicks;
+                    continue;
+                }
+                // the beats until the next call are sent, the receiver executes each on its beat
+                minDelay = qMin(minDelay, delay);
+                maxDelayInHops = qMax(maxDelayInHops, delay * sampleRate / static_cast<double>(position - lastPosition));
+                const double beat = static_cast<double>(position + lead) + delay * sampleRate;
+                maxError = qMax(maxError, qAbs(beat - qRound(beat / beatInterval) * beatInterval));
+                ++ticks;
+            }
+            lastPosition = position;
+        });
+        qDebug() << "Beat ticks:" << ticks << "max error:" << maxError << "samples";
+        QVERIFY(bpmDetector.beatIsLocked());
+        QVERIFY(ticks >= 6 && ticks <= 14);  // at most one per beat after the history of 5 seconds
+        QVERIFY(minDelay >= 0.0);
+        QVERIFY(maxDelayInHops <= 1.01);
+        QVERIFY(maxError < 0.03 * beatInterval);
+        QCOMPARE(mutedTicks, 0);
+        QVERIFY(!receivedBeatTick(primary));
+    }
+
     void testBPMStepChange()
     {
         // 1. Setup
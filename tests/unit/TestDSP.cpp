@@ -1,6 +1,9 @@
 #include <QtTest>
 #include <QtMath>
 #include "sound2osc/dsp/FFTAnalyzer.h"
+#include "sound2osc/dsp/FFTBackend.h"
+#include "sound2osc/dsp/FastMath.h"
+#include "sound2osc/dsp/STFTStage.h"
 #include "sound2osc/audio/MonoAudioBuffer.h"
 #include "sound2osc/trigger/TriggerGeneratorInterface.h"
 #include "sound2osc/trigger/TriggerFilter.h"
@@ -20,6 +23,15 @@ public:
         Q_UNUSED(forceRelease);
         return false;
     }
+
+    sound2osc::TriggerParameters getTriggerParameters(const ScaledSpectrum& spectrum) const override {
+        Q_UNUSED(spectrum);
+        return sound2osc::TriggerParameters();
+    }
+
+    void handleTriggerEvent(const sound2osc::TriggerEvent& event) override {
+        Q_UNUSED(event);
+    }
     
     TriggerFilter& getTriggerFilter() override {
         return m_filter;
@@ -103,6 +115,282 @@ private slots:
         qDebug() << "TestDSP: Peak at bin:" << maxBin << "Value:" << maxVal;
     }
 
+    void testFrequencyMappingAtSampleRate_data()
+    {
+        QTest::addColumn<int>("sampleRate");
+        QTest::newRow("44.1kHz") << 44100;
+        QTest::newRow("48kHz") << 48000;
+        QTest::newRow("96kHz") << 96000;
+    }
+
+    void testFrequencyMappingAtSampleRate()
+    {
+        QFETCH(int, sampleRate);
+
+        MonoAudioBuffer buffer(NUM_SAMPLES);
+        buffer.setSampleRate(sampleRate);
+
+        const double frequency = 1000.0;
+        QVector<float> samples(NUM_SAMPLES);
+        for (int i = 0; i < NUM_SAMPLES; ++i) {
+            samples[i] = static_cast<float>(0.5 * qSin(2.0 * M_PI * frequency * i / sampleRate));
+        }
+        buffer.putSamples(samples, 1);
+
+        QVector<TriggerGeneratorInterface*> triggers;
+        FFTAnalyzer fft(buffer, triggers);
+        fft.calculateFFT(false);
+
+        const ScaledSpectrum& spectrum = fft.getScaledSpectrum();
+        QCOMPARE(spectrum.getSampleRate(), sampleRate);
+
+        const QVector<float>& bins = spectrum.getNormalizedSpectrum();
+        int maxBin = 0;
+        for (int i = 1; i < bins.size(); ++i) {
+            if (bins[i] > bins[maxBin]) maxBin = i;
+        }
+
+        // the tone has to show up at the same position on the frequency axis at every sample rate
+        const int expectedBin = spectrum.getIndexForFreq(static_cast<int>(frequency));
+        QVERIFY2(qAbs(maxBin - expectedBin) <= 2,
+                 qPrintable(QString("Peak at bin %1, expected %2").arg(maxBin).arg(expectedBin)));
+    }
+
+    void testFftBackendsMatchReference_data()
+    {
+        QTest::addColumn<QString>("backend");
+        QTest::addColumn<int>("size");
+        for (const std::string& name : sound2osc::FFTBackend::available()) {
+            for (int size : { 8, 1024, 2048, 4096, 8192 }) {
+                QTest::newRow(qPrintable(QString("%1 %2").arg(QString::fromStdString(name)).arg(size)))
+                    << QString::fromStdString(name) << size;
+            }
+        }
+    }
+
+    void testFftBackendsMatchReference()
+    {
+        QFETCH(QString, backend);
+        QFETCH(int, size);
+
+        auto reference = sound2osc::FFTBackend::create("ffft", size);
+        auto fft = sound2osc::FFTBackend::create(backend.toStdString(), size);
+        QVERIFY(reference);
+        QVERIFY(fft);
+        QCOMPARE(fft->size(), size);
+
+        // two tones and a DC offset:
+        QVector<float> input(size);
+        for (int i = 0; i < size; ++i) {
+            input[i] = static_cast<float>(0.2 + 0.5 * qSin(0.37 * i) + 0.25 * qCos(1.3 * i));
+        }
+        QVector<float> expected(size);
+        QVector<float> actual(size);
+        reference->doFft(expected.data(), input.constData());
+        fft->doFft(actual.data(), input.constData());
+
+        // same layout and values within the precision of float:
+        float maxValue = 0.0f;
+        float maxError = 0.0f;
+        for (int i = 0; i < size; ++i) {
+            maxValue = qMax(maxValue, qAbs(expected[i]));
+            maxError = qMax(maxError, qAbs(expected[i] - actual[i]));
+        }
+        QVERIFY2(maxError <= 1e-4f * maxValue,
+                 qPrintable(QString("Max error %1 of max value %2").arg(maxError).arg(maxValue)));
+    }
+
+    void testFftBackendSelection()
+    {
+        QVERIFY(!sound2osc::FFTBackend::select("unknown"));
+        QCOMPARE(sound2osc::FFTBackend::selected(), std::string("auto"));
+
+        QVERIFY(sound2osc::FFTBackend::select("radix"));
+        QCOMPARE(sound2osc::FFTBackend::create(NUM_SAMPLES)->size(), NUM_SAMPLES);
+        QVERIFY(sound2osc::FFTBackend::select("auto"));
+
+        const std::vector<std::string> names = sound2osc::FFTBackend::available();
+        const std::string fastest = sound2osc::FFTBackend::fastest(NUM_SAMPLES);
+        QVERIFY(std::find(names.begin(), names.end(), fastest) != names.end());
+    }
+
+    void testFftSizeNormalization_data()
+    {
+        QTest::addColumn<int>("fftSize");
+        QTest::newRow("1024") << 1024;
+        QTest::newRow("2048") << 2048;
+        QTest::newRow("4096") << 4096;
+        QTest::newRow("8192") << 8192;
+    }
+
+    void testFftSizeNormalization()
+    {
+        QFETCH(int, fftSize);
+
+        // 3 * 44100 / 1024 Hz is at the center of a bin for all sizes:
+        const int sampleRate = 44100;
+        const double frequency = 3.0 * sampleRate / MIN_FFT_SIZE;
+        const float amplitude = 0.5f;
+        MonoAudioBuffer buffer(MAX_FFT_SIZE);
+        QVector<float> samples(MAX_FFT_SIZE);
+        for (int i = 0; i < MAX_FFT_SIZE; ++i) {
+            samples[i] = static_cast<float>(amplitude * qSin(2.0 * M_PI * frequency * i / sampleRate));
+        }
+        buffer.putSamples(samples, 1);
+
+        QVector<TriggerGeneratorInterface*> triggers;
+        FFTAnalyzer fft(buffer, triggers);
+        fft.setFftSize(fftSize);
+        QCOMPARE(fft.getFftSize(), fftSize);
+        fft.getScaledSpectrum().setAgcEnabled(false);
+        fft.calculateFFT(false);
+
+        // the level of the tone must not depend on the FFT size:
+        const float level = fft.getScaledSpectrum().getMaxLevel();
+        QVERIFY2(qAbs(level - amplitude) < 0.05f * amplitude,
+                 qPrintable(QString("Level %1 at FFT size %2").arg(level).arg(fftSize)));
+    }
+
+    void testFftSizeIsRounded()
+    {
+        MonoAudioBuffer buffer(MAX_FFT_SIZE);
+        QVector<TriggerGeneratorInterface*> triggers;
+        FFTAnalyzer fft(buffer, triggers);
+        QCOMPARE(fft.getFftSize(), NUM_SAMPLES);
+
+        fft.setFftSize(3000);
+        QCOMPARE(fft.getFftSize(), 2048);
+        fft.setFftSize(100);
+        QCOMPARE(fft.getFftSize(), MIN_FFT_SIZE);
+        fft.setFftSize(1 << 16);
+        QCOMPARE(fft.getFftSize(), MAX_FFT_SIZE);
+    }
+
+    void testSTFTStageSharesFrames()
+    {
+        MonoAudioBuffer buffer(MAX_FFT_SIZE);
+        sound2osc::STFTStage stft(buffer);
+
+        // hops of 256 and 1024 samples: every 4th frame is the same for both
+        QVector<int64_t> fineFrames;
+        QVector<int64_t> coarseFrames;
+        QVector<float> coarseMagnitudes;
+        stft.subscribe(2048, 256, [&](const sound2osc::STFTFrame& frame) { fineFrames.append(frame.endPosition()); });
+        stft.subscribe(2048, 1024, [&](const sound2osc::STFTFrame& frame) {
+            coarseFrames.append(frame.endPosition());
+            coarseMagnitudes = QVector<float>(frame.magnitudes(), frame.magnitudes() + frame.size() / 2);
+        });
+        // on request only:
+        int requested = 0;
+        const int onRequest = stft.subscribe(2048, 0, [&](const sound2osc::STFTFrame&) { ++requested; });
+
+        QVector<float> samples(4096);
+        for (int i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<float>(qSin(2.0 * M_PI * 1000.0 * i / 44100.0));
+        }
+        buffer.putSamples(samples, 1);
+        stft.process(buffer.getNumPutSamples());
+
+        QCOMPARE(fineFrames, QVector<int64_t>({ 2048, 2304, 2560, 2816, 3072, 3328, 3584, 3840, 4096 }));
+        QCOMPARE(coarseFrames, QVector<int64_t>({ 2048, 3072, 4096 }));
+        QCOMPARE(requested, 0);
+        QCOMPARE(stft.transformCount(), uint64_t(9));
+
+        // frames are not cached, a frame that is requested later is transformed again:
+        stft.request(onRequest, 4096);
+        QCOMPARE(requested, 1);
+        QCOMPARE(stft.transformCount(), uint64_t(10));
+
+        // the same spectrum as an FFT of the windowed samples:
+        std::unique_ptr<BasicFFTInterface> fft = sound2osc::FFTBackend::create(2048);
+        QVector<float> windowed(2048);
+        QVector<float> output(2048);
+        for (int i = 0; i < 2048; ++i) {
+            const float window = 0.5f * (1 - static_cast<float>(qCos((2 * M_PI * i) / 2047)));
+            windowed[i] = samples[2048 + i] * window;
+        }
+        fft->doFft(output.data(), windowed.constData());
+        for (int i = 1; i < 1024; ++i) {
+            const float magnitude = qSqrt(output[i] * output[i] + output[1024 + i] * output[1024 + i]);
+            QVERIFY(qAbs(coarseMagnitudes[i] - magnitude) <= 1e-4f * qMax(1.0f, magnitude));
+        }
+    }
+
+    void testAgcStepFollowsFrameRate_data()
+    {
+        QTest::addColumn<float>("frameRate");
+        QTest::newRow("10 fps") << 10.0f;
+        QTest::newRow("44 fps") << 44.0f;
+        QTest::newRow("100 fps") << 100.0f;
+    }
+
+    void testAgcStepFollowsFrameRate()
+    {
+        QFETCH(float, frameRate);
+
+        ScaledSpectrum spectrum(SCALED_SPECTRUM_BASE_FREQ, SCALED_SPECTRUM_LENGTH);
+        spectrum.setFrameRate(frameRate);
+        QCOMPARE(spectrum.getFrameRate(), frameRate);
+
+        // a loud spectrum lowers the gain by one step per frame,
+        // so a gain change from 1 to 0 takes AGC_DECREMENT_TIME independent of the frame rate:
+        QVector<float> loud(NUM_SAMPLES / 2, 1.0f);
+        spectrum.updateWithLinearSpectrum(loud);
+        QVERIFY(qAbs(spectrum.getGain() - (1.0f - 1.0f / (AGC_DECREMENT_TIME * frameRate))) < 1e-5f);
+    }
+
+    void testRangeMaxMatchesScan()
+    {
+        ScaledSpectrum spectrum(SCALED_SPECTRUM_BASE_FREQ, SCALED_SPECTRUM_LENGTH);
+        spectrum.setAgcEnabled(false);
+        QVector<float> linear(NUM_SAMPLES / 2);
+        quint32 seed = 12345;
+        for (float& value : linear) {
+            seed = seed * 1664525u + 1013904223u;
+            value = static_cast<float>(seed >> 8) / 16777216.0f * 0.05f;
+        }
+        spectrum.updateWithLinearSpectrum(linear);
+
+        // every range query must return exactly the max of a linear scan:
+        const QVector<float>& norm = spectrum.getNormalizedSpectrum();
+        float overall = 0.0f;
+        for (int start = 0; start < SCALED_SPECTRUM_LENGTH; ++start) {
+            float max = 0.0f;
+            for (int end = start; end < SCALED_SPECTRUM_LENGTH; ++end) {
+                max = qMax(max, norm[end]);
+                if (spectrum.getMaxLevel(start, end) != max) {
+                    QFAIL(qPrintable(QString("range %1...%2").arg(start).arg(end)));
+                }
+            }
+            overall = qMax(overall, norm[start]);
+        }
+        QCOMPARE(spectrum.getMaxLevel(), overall);
+        QCOMPARE(spectrum.getMaxLevel(10, 5), 0.0f);
+    }
+
+    void testFastMathAccuracy()
+    {
+        // log2 over the range of spectrum energies:
+        for (double x = 1e-12; x < 1e6; x *= 1.37) {
+            const float value = static_cast<float>(x);
+            QVERIFY(qAbs(sound2osc::FastMath::log2(value) - std::log2(value)) < 1e-5f);
+        }
+        // exp2 and pow with the compression exponents (0.1...100):
+        for (float y = -100.0f; y < 100.0f; y += 0.173f) {
+            QVERIFY(qAbs(sound2osc::FastMath::exp2(y) / std::exp2(y) - 1.0f) < 1e-6f);
+        }
+        for (float x = 0.001f; x <= 1.0f; x += 0.0137f) {
+            for (float exponent : { 0.1f, 0.5f, 2.0f, 10.0f }) {
+                const float expected = std::pow(x, exponent);
+                QVERIFY(qAbs(sound2osc::FastMath::pow(x, exponent) - expected) <= 1e-5f * expected + 1e-30f);
+            }
+        }
+        QCOMPARE(sound2osc::FastMath::pow(0.0f, 0.5f), 0.0f);
+        QCOMPARE(sound2osc::FastMath::clamp(1.5f, 0.0f, 1.0f), 1.0f);
+        QCOMPARE(sound2osc::FastMath::clamp(-0.5f, 0.0f, 1.0f), 0.0f);
+        QCOMPARE(sound2osc::FastMath::clamp(0.25f, 0.0f, 1.0f), 0.25f);
+    }
+
     void testSquareWaveHarmonics()
     {
         // 1. Setup Buffer
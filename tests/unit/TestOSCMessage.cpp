@@ -1,6 +1,80 @@
 #include <QtTest>
+#include <QUdpSocket>
+#include <QNetworkDatagram>
 #include "sound2osc/osc/OSCMessage.h"
 #include "sound2osc/osc/OSCParser.h"
+#include "sound2osc/osc/OSCPacketTemplate.h"
+#include "sound2osc/osc/OSCFrameBundler.h"
+#include "sound2osc/osc/OSCDestination.h"
+#include "sound2osc/osc/OSCStreamDeframer.h"
+#include "sound2osc/osc/OSCNetworkManager.h"
+#include "sound2osc/osc/UdpBatchSender.h"
+#include "sound2osc/osc/UdpSendSocket.h"
+
+#include <thread>
+
+using sound2osc::OSCDestination;
+using sound2osc::OSCFrameBundler;
+using sound2osc::OSCPacketTemplate;
+using sound2osc::OSCStreamDeframer;
+using sound2osc::UdpBatchSender;
+using sound2osc::UdpSendSocket;
+
+// encodes a message in text form like OSCNetworkManager::sendMessage(QString)
+static QByteArray encodeTextForm(const QString& text)
+{
+    size_t size = 0;
+    char* rawData = OSCPacketWriter::CreateForString(text.toLatin1().constData(), size);
+    QByteArray data(rawData, static_cast<int>(size));
+    delete[] rawData;
+    return data;
+}
+
+// frames a packet for a TCP stream like OSCNetworkManager
+static QByteArray frameForStream(OSCStream::EnumFrameMode frameMode, const QByteArray& packet)
+{
+    size_t size = static_cast<size_t>(packet.size());
+    char* rawData = OSCStream::CreateFrame(frameMode, packet.constData(), size);
+    QByteArray data(rawData, static_cast<int>(size));
+    delete[] rawData;
+    return data;
+}
+
+// splits an OSC bundle into its time tag and elements
+static bool readBundle(const QByteArray& bundle, quint64& timeTag, QList<QByteArray>& elements)
+{
+    if (!bundle.startsWith(QByteArray("#bundle", 8)) || bundle.size() < 16) return false;
+    timeTag = qFromBigEndian<quint64>(bundle.constData() + 8);
+    qsizetype pos = 16;
+    while (pos + 4 <= bundle.size()) {
+        const qint32 size = qFromBigEndian<qint32>(bundle.constData() + pos);
+        pos += 4;
+        if (size < 0 || pos + size > bundle.size()) return false;
+        elements.append(bundle.mid(pos, size));
+        pos += size;
+    }
+    return pos == bundle.size();
+}
+
+// the datagrams that arrive at the receiver until none follows within 500 ms
+static QList<QByteArray> receiveDatagrams(QUdpSocket& receiver)
+{
+    QList<QByteArray> datagrams;
+    while (receiver.hasPendingDatagrams() || receiver.waitForReadyRead(500)) {
+        datagrams.append(receiver.receiveDatagram().data());
+    }
+    return datagrams;
+}
+
+// a frame of numbered datagrams, the one at oversizedIndex is too large for UDP
+static std::vector<QByteArray> makeFrame(int count, int oversizedIndex = -1)
+{
+    std::vector<QByteArray> datagrams;
+    for (int i = 0; i < count; ++i) {
+        datagrams.push_back(i == oversizedIndex ? QByteArray(70000, 'x') : encodeTextForm(QString("/frame/%1").arg(i)));
+    }
+    return datagrams;
+}
 
 class TestOSCMessage : public QObject
 {
@@ -34,6 +108,363 @@ private slots:
         QVERIFY(qAbs(args[1].toFloat() - 3.14f) < 0.0001f); 
         QCOMPARE(args[2].toString(), QString("hello"));
     }
+
+    void testPacketTemplate()
+    {
+        // the encoded packets are the same as the text form with the user and value:
+        const QStringList messages = {
+            "/eos/user/<USER>/chan/1=",  // level message with user in the path
+            "/eos/chan/1=",
+            "/eos/chan/1=full,",  // level value after a string argument
+            "/eos/user/<USER>/chan/1=100",  // on / off messages
+            "/eos/key/go_0",
+            "/x/<USER>=<USER>,",  // user in an argument, created from the text form
+        };
+        const QStringList users = { "0", "12", "12345" };
+        const QVector<double> values = { 0.0, 0.25, 0.1234567, -1.5, 255.0 };
+
+        for (const QString& message : messages) {
+            const OSCPacketTemplate packetTemplate(message);
+            QCOMPARE(packetTemplate.message(), message);
+            for (const QString& user : users) {
+                for (double value : values) {
+                    const QString text = packetTemplate.toString(user, value);
+                    QCOMPARE(packetTemplate.create(user, value), encodeTextForm(text));
+                }
+            }
+        }
+
+        QVERIFY(OSCPacketTemplate("/eos/chan/1=").hasValue());
+        QVERIFY(!OSCPacketTemplate("/eos/chan/1=100").hasValue());
+        QVERIFY(OSCPacketTemplate("/eos/user/<USER>/chan/1=").isEncoded());
+        QVERIFY(!OSCPacketTemplate("/x/<USER>=<USER>,").isEncoded());
+        QVERIFY(OSCPacketTemplate().create("0").isEmpty());
+
+        // the value is a float32 argument with 3 decimals like the text form:
+        OSCMessage msg(OSCPacketTemplate("/eos/user/<USER>/sub/3=").create("5", 0.12345));
+        QVERIFY(msg.isValid());
+        QCOMPARE(msg.pathString(), QString("/eos/user/5/sub/3"));
+        QCOMPARE(msg.arguments().size(), 1);
+        QCOMPARE(msg.arguments()[0].toFloat(), 0.123f);
+    }
+
+    void testPacketTemplateValueTypes()
+    {
+        // float32 with full precision:
+        const OSCPacketTemplate floatTemplate("/eos/user/<USER>/sub/3=", OSCPacketTemplate::ValueType::Float);
+        OSCMessage floatMsg(floatTemplate.create("1", 0.1234567));
+        QCOMPARE(floatMsg.pathString(), QString("/eos/user/1/sub/3"));
+        QCOMPARE(floatMsg.arguments().size(), 1);
+        QCOMPARE(floatMsg.arguments()[0].typeId(), static_cast<int>(QMetaType::Double));  // float32 and float64 are read as double
+        QVERIFY(floatMsg.arguments()[0].toFloat() == 0.1234567f);
+
+        // int32 rounded to the nearest integer, after the other arguments:
+        const OSCPacketTemplate intTemplate("/dmx=1,", OSCPacketTemplate::ValueType::Int);
+        OSCMessage intMsg(intTemplate.create("0", 254.6));
+        QCOMPARE(intMsg.arguments().size(), 2);
+        QCOMPARE(intMsg.arguments()[0].toInt(), 1);
+        QCOMPARE(intMsg.arguments()[1].typeId(), static_cast<int>(QMetaType::Int));
+        QCOMPARE(intMsg.arguments()[1].toInt(), 255);
+        QCOMPARE(intTemplate.toString("0", 254.6), QString("/dmx=1,255"));
+
+        QCOMPARE(OSCPacketTemplate::valueTypeFromName(OSCPacketTemplate::valueTypeName(OSCPacketTemplate::ValueType::Int)),
+                 OSCPacketTemplate::ValueType::Int);
+        QCOMPARE(OSCPacketTemplate::valueTypeFromName("unknown"), OSCPacketTemplate::ValueType::Rounded);
+    }
+
+    void testFrameBundler()
+    {
+        const OSCPacketTemplate level("/sound2osc/out/band/<USER>/level=");
+        QList<QByteArray> packets;
+        for (int i = 0; i < 30; ++i) {
+            packets.append(level.create(QString::number(i), i / 40.0));
+        }
+
+        // all packets fit into one bundle:
+        OSCFrameBundler bundler;
+        for (const QByteArray& packet : packets) bundler.add(packet);
+        QCOMPARE(bundler.packetCount(), 30);
+        const quint64 timeTag = 0x123456789abcdef0ull;
+        std::vector<QByteArray> bundles = bundler.takeBundles(timeTag);
+        QVERIFY(bundler.isEmpty());
+        QCOMPARE(bundles.size(), std::size_t(1));
+        QVERIFY(bundles[0].size() <= OSCFrameBundler::DEFAULT_MAX_BUNDLE_SIZE);
+        quint64 readTimeTag = 0;
+        QList<QByteArray> elements;
+        QVERIFY(readBundle(bundles[0], readTimeTag, elements));
+        QCOMPARE(readTimeTag, timeTag);
+        QCOMPARE(elements, packets);
+
+        // split at the maximum size, the order is kept:
+        bundler.setMaxBundleSize(200);
+        for (const QByteArray& packet : packets) bundler.add(packet);
+        bundles = bundler.takeBundles(timeTag);
+        QVERIFY(bundles.size() > 1);
+        elements.clear();
+        for (const QByteArray& bundle : bundles) {
+            QVERIFY(bundle.size() <= 200);
+            QVERIFY(readBundle(bundle, readTimeTag, elements));
+            QCOMPARE(readTimeTag, timeTag);
+        }
+        QCOMPARE(elements, packets);
+
+        // a packet larger than the maximum size is sent in a bundle of its own:
+        bundler.setMaxBundleSize(OSCFrameBundler::MIN_BUNDLE_SIZE);
+        bundler.add(packets[0]);
+        bundler.add(packets[1]);
+        bundles = bundler.takeBundles(timeTag);
+        QCOMPARE(bundles.size(), std::size_t(2));
+        QVERIFY(bundler.takeBundles(timeTag).empty());
+
+        // the elements are the unchanged messages:
+        OSCMessage msg(elements[3]);
+        QCOMPARE(msg.pathString(), QString("/sound2osc/out/band/3/level"));
+
+        // NTP time tag: seconds since 1900 and a 32 bit fraction
+        const auto time = std::chrono::system_clock::time_point(std::chrono::milliseconds(1500));
+        QCOMPARE(OSCFrameBundler::toTimeTag(time), (quint64(2208988801ull) << 32) | 0x80000000ull);
+    }
+
+    void testFrameBundlerRoutes()
+    {
+        const QByteArray a = encodeTextForm("/a=1");
+        const QByteArray b = encodeTextForm("/b=2");
+        const QByteArray c = encodeTextForm("/c=3");
+
+        // destinations 0 and 2 receive the same packets and share a group:
+        OSCFrameBundler bundler;
+        bundler.add(a, 0b101);
+        bundler.add(b, 0b111);
+        bundler.add(c, 0b010);
+        bundler.add(c, 0);  // no destination, dropped
+        std::vector<OSCFrameBundler::RoutedDatagrams> groups = bundler.takeRouted(false, 0);
+        QVERIFY(bundler.isEmpty());
+        QCOMPARE(groups.size(), std::size_t(2));
+        QCOMPARE(groups[0].routes, sound2osc::OSCRoutes::Mask(0b101));
+        QCOMPARE(groups[0].datagrams, std::vector<QByteArray>({ a, b }));
+        QCOMPARE(groups[1].routes, sound2osc::OSCRoutes::Mask(0b010));
+        QCOMPARE(groups[1].datagrams, std::vector<QByteArray>({ b, c }));
+
+        // the same routes for all packets, bundled once:
+        bundler.add(a, 0b11);
+        bundler.add(b, 0b11);
+        groups = bundler.takeRouted(true, 1);
+        QCOMPARE(groups.size(), std::size_t(1));
+        QCOMPARE(groups[0].routes, sound2osc::OSCRoutes::Mask(0b11));
+        QCOMPARE(groups[0].datagrams.size(), std::size_t(1));
+        quint64 timeTag = 0;
+        QList<QByteArray> elements;
+        QVERIFY(readBundle(groups[0].datagrams[0], timeTag, elements));
+        QCOMPARE(elements, QList<QByteArray>({ a, b }));
+    }
+
+    void testDestination()
+    {
+        OSCDestination destination;
+        destination.name = "visualizer";
+        destination.address = QHostAddress("10.0.0.30");
+        destination.port = 3032;
+        destination.protocol = OSCDestination::Protocol::Slip;
+        destination.enabled = false;
+        QCOMPARE(OSCDestination::fromVariant(destination.toVariant()), destination);
+        QCOMPARE(destination.toVariant().value("protocol").toString(), QString("slip"));
+        QCOMPARE(OSCDestination::protocolFromName("unknown"), OSCDestination::Protocol::Udp);
+        QCOMPARE(sound2osc::OSCRoutes::forDestination(3), sound2osc::OSCRoutes::Mask(8));
+    }
+
+    void testStreamDeframer_data()
+    {
+        QTest::addColumn<int>("frameMode");
+        QTest::addColumn<int>("chunkSize");
+        for (int chunkSize : { 1, 3, 64, 4096 }) {
+            QTest::addRow("OSC 1.0, %d bytes per read", chunkSize) << int(OSCStream::FRAME_MODE_1_0) << chunkSize;
+            QTest::addRow("OSC 1.1, %d bytes per read", chunkSize) << int(OSCStream::FRAME_MODE_1_1) << chunkSize;
+        }
+    }
+
+    void testStreamDeframer()
+    {
+        QFETCH(int, frameMode);
+        QFETCH(int, chunkSize);
+        const auto mode = static_cast<OSCStream::EnumFrameMode>(frameMode);
+
+        // packets with SLIP END and ESC characters in the arguments:
+        QList<QByteArray> packets;
+        for (int i = 0; i < 50; ++i) {
+            QByteArray packet = encodeTextForm(QString("/eos/out/chan/%1=%2").arg(i).arg(i * 7));
+            packet.append(QByteArray("\xc0\xdb\xdc\xdd", 4));
+            packet.append(QByteArray(i, char(i % 2 ? 0xc0 : 0xdb)));
+            packets.append(packet);
+        }
+        QByteArray stream;
+        for (const QByteArray& packet : packets) stream.append(frameForStream(mode, packet));
+
+        OSCStreamDeframer deframer(mode);
+        QList<QByteArray> received;
+        for (qsizetype pos = 0; pos < stream.size(); pos += chunkSize) {
+            QVERIFY(deframer.append(stream.constData() + pos, qMin<qsizetype>(chunkSize, stream.size() - pos)));
+            QByteArray packet;
+            OSCStreamDeframer::Result result;
+            while ((result = deframer.next(packet)) == OSCStreamDeframer::Result::Packet) {
+                received.append(QByteArray(packet.constData(), packet.size()));
+            }
+            QCOMPARE(result, OSCStreamDeframer::Result::Incomplete);
+        }
+        QCOMPARE(received, packets);
+        QCOMPARE(deframer.bufferedSize(), qsizetype(0));
+    }
+
+    void testStreamDeframerInvalid()
+    {
+        QByteArray packet;
+
+        // a size that is out of range discards the data:
+        OSCStreamDeframer lengthFramed(OSCStream::FRAME_MODE_1_0);
+        QVERIFY(lengthFramed.append("\xc0/eos\xc0", 6));
+        QCOMPARE(lengthFramed.next(packet), OSCStreamDeframer::Result::Invalid);
+        QCOMPARE(lengthFramed.bufferedSize(), qsizetype(0));
+
+        // SLIP: a packet starts at the first byte that is not an END,
+        // a stream without a leading END is read as well (single-ended SLIP):
+        OSCStreamDeframer slipFramed(OSCStream::FRAME_MODE_1_1);
+        QVERIFY(slipFramed.append("/eos\0\0\0\0", 8));
+        QCOMPARE(slipFramed.next(packet), OSCStreamDeframer::Result::Incomplete);
+        QVERIFY(slipFramed.append("\xc0/a\0\0\xc0\xc0/b\0\0\xc0", 12));
+        QCOMPARE(slipFramed.next(packet), OSCStreamDeframer::Result::Packet);
+        QCOMPARE(packet, QByteArray("/eos\0\0\0\0", 8));
+        QCOMPARE(slipFramed.next(packet), OSCStreamDeframer::Result::Packet);
+        QCOMPARE(packet, QByteArray("/a\0\0", 4));
+        QCOMPARE(slipFramed.next(packet), OSCStreamDeframer::Result::Packet);
+        QCOMPARE(packet, QByteArray("/b\0\0", 4));
+        QCOMPARE(slipFramed.next(packet), OSCStreamDeframer::Result::Incomplete);
+    }
+    void testUdpBatchSender()
+    {
+        QUdpSocket receiver;
+        QVERIFY(receiver.bind(QHostAddress::LocalHost, 0));
+        const QHostAddress address = QHostAddress::LocalHost;
+        const quint16 port = receiver.localPort();
+
+        // dual stack like the socket of OSCNetworkManager, the IPv4 host is reached by its mapped address:
+        QUdpSocket dualStack;
+        QVERIFY(dualStack.bind(QHostAddress::Any, 0));
+        UdpBatchSender sender;
+        const std::vector<QByteArray> frame = makeFrame(100);
+        const int sent = sender.send(dualStack.socketDescriptor(), address, port, frame);
+        if (!UdpBatchSender::isSupported()) {
+            // the caller sends everything one by one:
+            QCOMPARE(sent, 0);
+            QCOMPARE(sender.systemCalls(), uint64_t(0));
+            return;
+        }
+        QCOMPARE(sent, 100);
+        QCOMPARE(sender.systemCalls(), uint64_t(1));
+        const QList<QByteArray> received = receiveDatagrams(receiver);
+        QCOMPARE(received.size(), qsizetype(100));
+        for (int i = 0; i < 100; ++i) {
+            QCOMPARE(received[i], frame[static_cast<size_t>(i)]);
+        }
+
+        // IPv4 socket: IPv4 hosts only, the family is queried again for another socket
+        QUdpSocket ipv4;
+        QVERIFY(ipv4.bind(QHostAddress::AnyIPv4, 0));
+        QCOMPARE(sender.send(ipv4.socketDescriptor(), address, port, makeFrame(3)), 3);
+        QCOMPARE(receiveDatagrams(receiver).size(), qsizetype(3));
+        QCOMPARE(sender.send(ipv4.socketDescriptor(), QHostAddress::LocalHostIPv6, port, makeFrame(3)), 0);
+        QCOMPARE(sender.send(-1, address, port, makeFrame(3)), 0);
+
+        // the kernel stops at a datagram it rejects, the count tells the caller where to continue:
+        QCOMPARE(sender.send(dualStack.socketDescriptor(), address, port, makeFrame(5, 2)), 2);
+        QCOMPARE(receiveDatagrams(receiver).size(), qsizetype(2));
+    }
+
+    void testUdpSendSocket()
+    {
+        QUdpSocket receiver;
+        QVERIFY(receiver.bind(QHostAddress::LocalHost, 0));
+        const quint16 port = receiver.localPort();
+
+        UdpSendSocket socket;
+        QVERIFY(!socket.send(QHostAddress::LocalHost, port, "/a\0\0", 4));
+        QVERIFY(socket.open());
+        QVERIFY(socket.isOpen());
+        QVERIFY(socket.descriptor() >= 0);
+
+        // IPv4 destination, also on a dual stack socket:
+        const std::vector<QByteArray> frame = makeFrame(10);
+        for (const QByteArray& datagram : frame) {
+            QVERIFY(socket.send(QHostAddress::LocalHost, port, datagram.constData(), static_cast<size_t>(datagram.size())));
+        }
+        QList<QByteArray> received = receiveDatagrams(receiver);
+        QCOMPARE(received.size(), qsizetype(10));
+        QCOMPARE(received.first(), frame.front());
+        QCOMPARE(received.last(), frame.back());
+
+        // the descriptor is used by the batch sender of the processing thread:
+        UdpBatchSender sender;
+        const int sent = sender.send(socket.descriptor(), QHostAddress::LocalHost, port, frame);
+        QCOMPARE(sent, UdpBatchSender::isSupported() ? 10 : 0);
+        QCOMPARE(receiveDatagrams(receiver).size(), qsizetype(sent));
+
+        // IPv6 destination if the system has IPv6 and the socket is dual stack:
+        QUdpSocket receiver6;
+        if (receiver6.bind(QHostAddress::LocalHostIPv6, 0)) {
+            if (socket.send(QHostAddress::LocalHostIPv6, receiver6.localPort(), "/a\0\0", 4)) {
+                QCOMPARE(receiveDatagrams(receiver6).size(), qsizetype(1));
+            }
+        }
+
+        socket.close();
+        QVERIFY(!socket.isOpen());
+        QVERIFY(!socket.send(QHostAddress::LocalHost, port, "/a\0\0", 4));
+    }
+
+    void testNetworkManagerFrame_data()
+    {
+        QTest::addColumn<bool>("worker");
+        QTest::newRow("owner thread") << false;
+        QTest::newRow("worker thread") << true;
+    }
+
+    void testNetworkManagerFrame()
+    {
+        // a datagram that can't be sent (too large for UDP) ends the batch, the
+        // following ones are sent one by one and arrive in order
+        QFETCH(bool, worker);
+
+        QUdpSocket receiver;
+        QVERIFY(receiver.bind(QHostAddress::LocalHost, 0));
+
+        OSCNetworkManager osc;
+        osc.setUseTcp(false);
+        osc.setUdpRxPort(0);
+        osc.setIpAddress(QHostAddress::LocalHost);
+        osc.setUdpTxPort(receiver.localPort());
+        osc.setEnabled(true);
+
+        auto sendFrame = [&osc]() {
+            osc.beginFrame();
+            osc.sendMessage("/frame/0", "a");
+            osc.sendMessage("/frame/1", "b");
+            osc.sendMessage("/frame/2", QString(70000, 'x'));
+            osc.sendMessage("/frame/3", "c");
+            osc.sendMessage("/frame/4", "d");
+            osc.endFrame();
+        };
+        if (worker) {
+            std::thread thread(sendFrame);
+            thread.join();
+        } else {
+            sendFrame();
+        }
+
+        const QList<QByteArray> received = receiveDatagrams(receiver);
+        QCOMPARE(received.size(), qsizetype(4));
+        QVERIFY(received[0].startsWith("/frame/0"));
+        QVERIFY(received[1].startsWith("/frame/1"));
+        QVERIFY(received[2].startsWith("/frame/3"));
+        QVERIFY(received[3].startsWith("/frame/4"));
+    }
 };
 
 QTEST_GUILESS_MAIN(TestOSCMessage)
@@ -1,7 +1,37 @@
 #include <QtTest>
 #include "sound2osc/trigger/TriggerGenerator.h"
+#include "sound2osc/trigger/TriggerBank.h"
+#include "sound2osc/trigger/TriggerBatch.h"
+#include "sound2osc/trigger/TimingWheel.h"
 #include "sound2osc/dsp/ScaledSpectrum.h"
 #include "sound2osc/osc/OSCNetworkManager.h"
+#include "sound2osc/osc/OSCParser.h"
+
+using sound2osc::TimingWheel;
+using sound2osc::TriggerBank;
+using sound2osc::TriggerBatch;
+using sound2osc::TriggerEvent;
+using sound2osc::TriggerParameters;
+
+// creates an OSCMessage as it would be received from the network
+static OSCMessage makeMessage(const char* path, const QVariantList& arguments = QVariantList())
+{
+    OSCPacketWriter writer(path);
+    for (const QVariant& argument : arguments) {
+        if (argument.typeId() == QMetaType::QString) {
+            writer.AddString(argument.toString().toStdString());
+        } else if (argument.typeId() == QMetaType::Double) {
+            writer.AddFloat32(argument.toFloat());
+        } else {
+            writer.AddInt32(argument.toInt());
+        }
+    }
+    size_t size;
+    char* rawData = writer.Create(size);
+    QByteArray data(rawData, static_cast<int>(size));
+    delete[] rawData;
+    return OSCMessage(data);
+}
 
 class TestTrigger : public QObject
 {
@@ -66,9 +96,18 @@ private slots:
         TriggerGenerator trigger("TestTrigger", nullptr, false, false); // Envelope trigger
         trigger.setThreshold(0.5);
         
+        // The delays are deadlines on the sample clock of a TimingWheel,
+        // so the test advances the clock instead of waiting:
+        TimingWheel wheel(44100);
+        trigger.getTriggerFilter().setTimingWheel(&wheel);
+        int64_t position = 0;
+        auto wait = [&](double seconds) {
+            position += wheel.samplesFor(seconds);
+            wheel.advance(position);
+        };
+        
         // Configure Delays
-        // Use substantial delays to be robust against test timing jitters
-        double delayTime = 0.2; // 200ms
+        double delayTime = 0.2; // 200ms = 8820 samples
         trigger.getTriggerFilter().setOnDelay(delayTime);
         trigger.getTriggerFilter().setOffDelay(delayTime);
         
@@ -96,24 +135,19 @@ private slots:
         QCOMPARE(spyOn.count(), 0);
         
         // Wait half the delay
-        QTest::qWait(100); 
-        // Need to keep "poking" the generator? 
-        // No, TriggerFilter uses QTimer, independent of checkForTrigger loop once activated.
-        // However, TriggerGenerator::checkForTrigger calls filter.triggerOn() repeatedly.
-        // Let's verify if TriggerFilter handles re-triggering correctly (it should, usually restarting or ignoring timer).
-        // Actually, usually triggerOn() is idempotent or re-triggering logic depends on implementation.
-        // If it uses QTimer::start(), it resets the timer! This would be a bug if called every frame.
-        // Let's assume the implementation checks state.
-        
-        // Let's simulate the loop behavior (calling checkForTrigger continuously)
+        wait(0.1);
+        
+        // Simulate the loop behavior (calling checkForTrigger continuously),
+        // a running on delay must not be restarted:
         trigger.checkForTrigger(spectrum, false);
         
         QCOMPARE(spyOn.count(), 0); // Still waiting
         
-        // Wait rest of delay + buffer
-        QTest::qWait(150);
+        // Exactly at the deadline of the first detection
+        wait(0.1);
         
         QCOMPARE(spyOn.count(), 1); // Should have fired
+        QVERIFY(trigger.getTriggerFilter().getOutputIsActive());
         
         // 4. Test Off Delay
         // Remove signal
@@ -122,12 +156,89 @@ private slots:
         
         QCOMPARE(spyOff.count(), 0); // Should be waiting
         
-        QTest::qWait(100);
+        wait(0.1);
         trigger.checkForTrigger(spectrum, false);
         QCOMPARE(spyOff.count(), 0);
         
-        QTest::qWait(150);
+        // One sample before the deadline
+        position += wheel.samplesFor(0.1) - 1;
+        wheel.advance(position);
+        QCOMPARE(spyOff.count(), 0);
+        
+        wait(1.0 / 44100);
         QCOMPARE(spyOff.count(), 1); // Should have released
+        QCOMPARE(wheel.activeTimers(), 0);
+        
+        // 5. Test Max Hold
+        trigger.getTriggerFilter().setOnDelay(0.0);
+        trigger.getTriggerFilter().setMaxHold(0.5);
+        spectrum.updateWithLinearSpectrum(strongSignal);
+        trigger.checkForTrigger(spectrum, false);
+        wheel.advance(position); // a delay of 0 is due at the current position
+        QCOMPARE(spyOn.count(), 2);
+        
+        wait(0.5);
+        QCOMPARE(spyOff.count(), 2); // released by max hold while the signal is still present
+        
+        trigger.getTriggerFilter().setTimingWheel(nullptr);
+    }
+
+    void testTimingWheel()
+    {
+        TimingWheel wheel(1000);
+        QCOMPARE(wheel.samplesFor(0.25), int64_t(250));
+        
+        QVector<int> fired;
+        QVector<int64_t> firedAt;
+        QVector<int> timers;
+        for (int i = 0; i < 4; ++i) {
+            timers.append(wheel.createTimer([&, i]() {
+                fired.append(i);
+                firedAt.append(wheel.deadline(timers[i]));
+            }));
+        }
+        
+        // far deadlines are cascaded down from the upper levels, all fire in deadline order:
+        wheel.start(timers[0], 5000000);
+        wheel.start(timers[1], 70);
+        wheel.start(timers[2], 300000);
+        wheel.start(timers[3], 69);
+        QCOMPARE(wheel.activeTimers(), 4);
+        
+        wheel.advance(68);
+        QVERIFY(fired.isEmpty());
+        
+        wheel.advance(10000000);
+        QCOMPARE(fired, QVector<int>({ 3, 1, 2, 0 }));
+        QCOMPARE(firedAt, QVector<int64_t>({ 69, 70, 300000, 5000000 }));
+        QCOMPARE(wheel.activeTimers(), 0);
+        QCOMPARE(wheel.position(), int64_t(10000000));
+        
+        // stopped timers do not fire, restarted timers use the new deadline:
+        fired.clear();
+        firedAt.clear();
+        wheel.startAfter(timers[0], 1.0);
+        wheel.startAfter(timers[1], 1.0);
+        wheel.stop(timers[0]);
+        wheel.start(timers[1], wheel.position() + 10);
+        QVERIFY(!wheel.isActive(timers[0]));
+        wheel.advance(wheel.position() + 2000);
+        QCOMPARE(fired, QVector<int>({ 1 }));
+        QCOMPARE(firedAt, QVector<int64_t>({ 10000010 }));
+        
+        // a callback can start timers that are due in the same advance():
+        fired.clear();
+        const int chained = wheel.createTimer([&]() {
+            fired.append(10);
+            wheel.start(timers[2], wheel.position());
+        });
+        wheel.start(chained, wheel.position() + 5);
+        wheel.advance(wheel.position() + 100);
+        QCOMPARE(fired, QVector<int>({ 10, 2 }));
+        
+        // destroyed timers are reused:
+        wheel.destroyTimer(chained);
+        QCOMPARE(wheel.createTimer(nullptr), chained);
     }
 
     void testExtremeThresholds()
@@ -162,6 +273,241 @@ private slots:
 
         QVERIFY2(!fired, "Threshold 1.0 should not fire with weak signal and AGC off");
     }
+
+    void testTriggerBatchEvents()
+    {
+        ScaledSpectrum spectrum(20, 200);
+        spectrum.setAgcEnabled(false);
+        QVector<float> linearSpectrum(2048, 0.0f);
+
+        TriggerBatch batch;
+        TriggerParameters low;
+        spectrum.getBandRange(100, 0.05, low.startIndex, low.endIndex);
+        low.lowSolo = true;
+        low.soloOrder = 0;
+        TriggerParameters mid;
+        spectrum.getBandRange(1000, 0.05, mid.startIndex, mid.endIndex);
+        mid.lowSolo = true;
+        mid.soloOrder = 1;
+        TriggerParameters silence;
+        silence.endIndex = 199;
+        silence.threshold = 0.9f;
+        silence.invert = true;
+        QCOMPARE(batch.add(low), 0);
+        QCOMPARE(batch.add(mid), 1);
+        QCOMPARE(batch.add(silence), 2);
+
+        auto hasEvent = [&batch](int trigger, TriggerEvent::Type type) {
+            for (const TriggerEvent& event : batch.events()) {
+                if (event.trigger == trigger && event.type == type) return true;
+            }
+            return false;
+        };
+
+        // silence: only the inverted trigger changes
+        spectrum.updateWithLinearSpectrum(linearSpectrum);
+        batch.evaluate(spectrum, false);
+        QCOMPARE(batch.events().size(), size_t(2));
+        QCOMPARE(batch.events()[0].trigger, 2);
+        QCOMPARE(batch.events()[0].type, TriggerEvent::On);
+        QCOMPARE(batch.events()[1].type, TriggerEvent::Level);
+        QCOMPARE(batch.events()[1].value, 1.0f);
+        QVERIFY(batch.isActive(2));
+
+        // 1000 Hz: mid is activated, silence is released
+        linearSpectrum[93] = 1.0f;
+        spectrum.updateWithLinearSpectrum(linearSpectrum);
+        batch.evaluate(spectrum, false);
+        QVERIFY(hasEvent(1, TriggerEvent::On));
+        QVERIFY(hasEvent(1, TriggerEvent::Level));
+        QVERIFY(hasEvent(2, TriggerEvent::Off));
+        QVERIFY(!hasEvent(0, TriggerEvent::Level));
+        QVERIFY(batch.level(1) > 0.5f);
+
+        // no change, no events:
+        batch.evaluate(spectrum, false);
+        QVERIFY(batch.events().empty());
+
+        // 100 Hz and 1000 Hz in low solo mode: only the lower band is active
+        linearSpectrum[9] = 1.0f;
+        spectrum.updateWithLinearSpectrum(linearSpectrum);
+        batch.evaluate(spectrum, true);
+        QVERIFY(hasEvent(0, TriggerEvent::On));
+        QVERIFY(hasEvent(1, TriggerEvent::Off));
+        QVERIFY(!hasEvent(1, TriggerEvent::Level));
+        QVERIFY(batch.isActive(0));
+        QVERIFY(!batch.isActive(1));
+
+        // moving the band away from the signal releases it:
+        batch.setRange(0, 190, 199);
+        batch.evaluate(spectrum, false);
+        QVERIFY(hasEvent(0, TriggerEvent::Off));
+        QVERIFY(hasEvent(1, TriggerEvent::On));
+    }
+
+    void testTriggerBankBands()
+    {
+        TriggerBank bank(nullptr);
+        QCOMPARE(bank.addBand("kick", 60), 0);
+        QCOMPARE(bank.addBand("snare", 200, 0.05), 1);
+        QCOMPARE(bank.addBand("hat", 8000), 2);
+        QCOMPARE(bank.size(), 3);
+
+        // names must be unique and must not be numbers or contain a slash:
+        QCOMPARE(bank.addBand("kick", 80), -1);
+        QCOMPARE(bank.addBand("12", 80), -1);
+        QCOMPARE(bank.addBand("a/b", 80), -1);
+        QCOMPARE(bank.addBand("", 80), -1);
+
+        // find by name or by 1-based number:
+        QCOMPARE(bank.find("snare"), 1);
+        QCOMPARE(bank.find("2"), 1);
+        QCOMPARE(bank.find("4"), -1);
+        QCOMPARE(bank.find("tom"), -1);
+
+        // removing a band moves the following ones down:
+        QVERIFY(bank.removeBand(0));
+        QCOMPARE(bank.size(), 2);
+        QCOMPARE(bank.name(0), QString("snare"));
+        QCOMPARE(bank.width(0), 0.05);
+        QCOMPARE(bank.midFreq(1), 8000);
+        QVERIFY(!bank.removeBand(2));
+
+        bank.clear();
+        for (int i = 0; i < TriggerBank::MAX_BANDS; ++i) {
+            QCOMPARE(bank.addBand(QString("band%1").arg(i), 100 + i * 100), i);
+        }
+        QCOMPARE(bank.addBand("oneTooMany", 1000), -1);
+    }
+
+    void testTriggerBankEvaluate()
+    {
+        TriggerBank bank(nullptr);
+        const int low = bank.addBand("low", 100, 0.05);
+        const int mid = bank.addBand("mid", 1000, 0.05);
+        bank.setThreshold(low, 0.5);
+        bank.setThreshold(mid, 0.5);
+
+        ScaledSpectrum spectrum(20, 200);
+        spectrum.setAgcEnabled(false);
+        QVector<float> linearSpectrum(2048, 0.0f);
+        int64_t position = 0;  // sample position of the spectrum, one hop per evaluation
+
+        // 1000 Hz only (see testBandpassTrigger):
+        linearSpectrum[93] = 1.0f;
+        spectrum.updateWithLinearSpectrum(linearSpectrum);
+        bank.evaluate(spectrum, false, position += 1024);
+        QVERIFY(!bank.isActive(low));
+        QVERIFY(bank.isActive(mid));
+        QVERIFY(bank.level(mid) > 0.5);
+        QVERIFY(bank.isOutputActive(mid));  // without on delay
+
+        // 100 Hz and 1000 Hz, in low solo mode only the lower band is active:
+        linearSpectrum[9] = 1.0f;
+        spectrum.updateWithLinearSpectrum(linearSpectrum);
+        bank.evaluate(spectrum, false, position += 1024);
+        QVERIFY(bank.isActive(low));
+        QVERIFY(bank.isActive(mid));
+        bank.evaluate(spectrum, true, position += 1024);
+        QVERIFY(bank.isActive(low));
+        QVERIFY(!bank.isActive(mid));
+
+        // moving the band away from the signal releases it:
+        bank.setMidFreq(low, 5000);
+        bank.evaluate(spectrum, false, position += 1024);
+        QVERIFY(!bank.isActive(low));
+
+        // removing a band keeps the state of the others, an active output is released:
+        bank.removeBand(low);
+        QCOMPARE(bank.name(0), QString("mid"));
+        bank.evaluate(spectrum, false, position += 1024);
+        QVERIFY(bank.isActive(0));
+        QVERIFY(bank.isOutputActive(0));
+        bank.clear();
+        bank.evaluate(spectrum, false, position += 1024);
+        QCOMPARE(bank.size(), 0);
+    }
+
+    void testTriggerBankState()
+    {
+        TriggerBank bank(nullptr);
+        bank.addBand("kick", 60, 0.02);
+        bank.addBand("hat", 8000);
+        bank.setThreshold(1, 0.25);
+        bank.setMute(1, true);
+        bank.setOffDelay(0, 0.3);
+        bank.setOnMessage(1, "/eos/hat=1");
+
+        TriggerBank restored(nullptr);
+        restored.addBand("other", 500);
+        restored.fromState(bank.toState());
+
+        QCOMPARE(restored.size(), 2);
+        QCOMPARE(restored.name(0), QString("kick"));
+        QCOMPARE(restored.midFreq(0), 60);
+        QCOMPARE(restored.width(0), 0.02);
+        QCOMPARE(restored.offDelay(0), 0.3);
+        QCOMPARE(restored.onMessage(0), QString("/sound2osc/out/band/kick/trigger=1"));
+        QCOMPARE(restored.threshold(1), 0.25);
+        QVERIFY(restored.mute(1));
+        QCOMPARE(restored.onMessage(1), QString("/eos/hat=1"));
+    }
+
+    void testTriggerBankOscControl()
+    {
+        TriggerBank bank(nullptr);
+        QVERIFY(bank.handleMessage(makeMessage("/sound2osc/band/add", { QString("kick"), 60, 0.02 })));
+        QVERIFY(bank.handleMessage(makeMessage("/sound2osc/band/add", { QString("hat") })));
+        QCOMPARE(bank.size(), 2);
+        QCOMPARE(bank.midFreq(0), 60);
+        QCOMPARE(bank.midFreq(1), 1000);
+
+        // by name and by number:
+        bank.handleMessage(makeMessage("/sound2osc/band/kick/threshold", { 0.75 }));
+        QCOMPARE(bank.threshold(0), 0.75);
+        bank.handleMessage(makeMessage("/sound2osc/band/2/mid_freq", { 9000 }));
+        QCOMPARE(bank.midFreq(1), 9000);
+        bank.handleMessage(makeMessage("/sound2osc/band/2/mute/toggle"));
+        QVERIFY(bank.mute(1));
+        bank.handleMessage(makeMessage("/sound2osc/band/hat/mute", { 0 }));
+        QVERIFY(!bank.mute(1));
+
+        bank.handleMessage(makeMessage("/sound2osc/band/1/remove"));
+        QCOMPARE(bank.size(), 1);
+        QCOMPARE(bank.name(0), QString("hat"));
+
+        // messages for other targets are not handled:
+        QVERIFY(!bank.handleMessage(makeMessage("/sound2osc/bass/mute")));
+    }
+    void testOscParameterMessages()
+    {
+        // the processing side reads one consistent copy of everything it sends
+        TriggerOscParameters parameters;
+        QVERIFY(parameters.messages().on.isEmpty());
+        QCOMPARE(parameters.messages().routes, sound2osc::OSCRoutes::PRIMARY);
+
+        parameters.setOnMessage("/kick/on");
+        parameters.setLevelMessage("/kick/level=");
+        parameters.setLevelValueType(sound2osc::OSCPacketTemplate::ValueType::Int);
+        parameters.setMinLevelValue(10);
+        parameters.setMaxLevelValue(20);
+        parameters.setRoutes(3);
+
+        const TriggerOscParameters::Messages& messages = parameters.messages();
+        QCOMPARE(messages.on.message(), QString("/kick/on"));
+        QVERIFY(messages.off.isEmpty());
+        // the value type keeps the text of the Level message and vice versa:
+        QCOMPARE(messages.level.message(), QString("/kick/level="));
+        QCOMPARE(messages.level.valueType(), sound2osc::OSCPacketTemplate::ValueType::Int);
+        QCOMPARE(messages.scaleLevel(0.5), 15.0);
+        QCOMPARE(messages.routes, sound2osc::OSCRoutes::Mask(3));
+
+        QJsonObject state = parameters.toState();
+        state["offMessage"] = "/kick/off";
+        parameters.fromState(state);
+        QCOMPARE(parameters.messages().off.message(), QString("/kick/off"));
+        QCOMPARE(parameters.messages().level.valueType(), sound2osc::OSCPacketTemplate::ValueType::Int);
+    }
 };
 
 QTEST_GUILESS_MAIN(TestTrigger)